@@ -0,0 +1,246 @@
+#include "EZAssetPack.h"
+#include "EZError.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// Asset packs start with this header. Every field is little endian.
+// Offset Size
+//  0      8   Magic "EZAssets"
+//  8      4   AssetPackVersion
+// 12      4   Header size in bytes. The index starts here.
+// 16      4   Asset count
+// 20      4   Index size in bytes
+// 24      4   FNV-1a hash of the index
+// 28      4   Reserved, always 0
+// The index is one entry per asset sorted by name followed by the names, each ending with a 0 byte.
+// Entry offset Size
+//  0      4   Offset of the name from the start of the file
+//  4      4   Name length in bytes, not counting the 0 byte
+//  8      4   Width in pixels
+// 12      4   Height in pixels
+// 16      8   Offset of the pixels from the start of the file, a multiple of AssetAlignment
+// The pixels come after the index, each bitmap padded with zeros up to the next multiple of AssetAlignment.
+constexpr BYTE AssetPackMagic[8] = { 'E', 'Z', 'A', 's', 's', 'e', 't', 's' };
+constexpr UINT32 AssetPackHeaderSize = 32;
+constexpr UINT32 AssetEntrySize = 24;
+
+namespace {
+	UINT32 HashIndex(const BYTE* index, UINT64 size) {
+		UINT32 hash = 2166136261u;
+		for (UINT64 i = 0; i < size; i++) {
+			hash = (hash ^ index[i]) * 16777619u;
+		}
+		return hash;
+	}
+	void WriteLittleEndian(BYTE* destination, UINT64 value, UINT32 size) {
+		for (UINT32 i = 0; i < size; i++) {
+			destination[i] = static_cast<BYTE>(value >> (i * 8));
+		}
+	}
+	UINT64 ReadLittleEndian(const BYTE* source, UINT32 size) {
+		UINT64 value = 0;
+		for (UINT32 i = 0; i < size; i++) {
+			value |= static_cast<UINT64>(source[i]) << (i * 8);
+		}
+		return value;
+	}
+	UINT64 AlignUp(UINT64 value) {
+		return (value + EZ::AssetAlignment - 1) & ~static_cast<UINT64>(EZ::AssetAlignment - 1);
+	}
+}
+
+EZ::AssetPack::AssetPack(LPCSTR filePath) {
+	_file = new EZ::MappedFile(filePath);
+	const BYTE* data = _file->GetData();
+	UINT64 size = _file->GetSize();
+	if (data == nullptr || size < AssetPackHeaderSize || memcmp(data, AssetPackMagic, sizeof(AssetPackMagic)) != 0) {
+		delete _file;
+		throw EZ::Error("The file is not an EZ asset pack.");
+	}
+	if (ReadLittleEndian(data + 8, 4) != AssetPackVersion) {
+		delete _file;
+		throw EZ::Error("The asset pack is from a different version of EZ.");
+	}
+	UINT64 headerSize = ReadLittleEndian(data + 12, 4);
+	_assetCount = static_cast<UINT32>(ReadLittleEndian(data + 16, 4));
+	UINT64 indexSize = ReadLittleEndian(data + 20, 4);
+	if (headerSize < AssetPackHeaderSize || headerSize > size || indexSize > size - headerSize
+		|| static_cast<UINT64>(_assetCount) * AssetEntrySize > indexSize) {
+		delete _file;
+		throw EZ::Error("The asset pack header is corrupt.");
+	}
+	_index = data + headerSize;
+	if (HashIndex(_index, indexSize) != ReadLittleEndian(data + 24, 4)) {
+		delete _file;
+		throw EZ::Error("The asset pack index is corrupt.");
+	}
+
+	// Checking every entry once here is what lets GetBitmap and FindAsset trust the index without any checks of their own.
+	// Only the index is read so none of the pixels are paged in.
+	UINT64 namesStart = headerSize + (static_cast<UINT64>(_assetCount) * AssetEntrySize);
+	UINT64 namesEnd = headerSize + indexSize;
+	for (UINT32 i = 0; i < _assetCount; i++) {
+		const BYTE* entry = _index + (static_cast<UINT64>(i) * AssetEntrySize);
+		UINT64 nameOffset = ReadLittleEndian(entry, 4);
+		UINT64 nameLength = ReadLittleEndian(entry + 4, 4);
+		UINT64 pixelCount = ReadLittleEndian(entry + 8, 4) * ReadLittleEndian(entry + 12, 4);
+		UINT64 pixelOffset = ReadLittleEndian(entry + 16, 8);
+		BOOL valid = nameOffset >= namesStart && nameOffset < namesEnd && nameLength < namesEnd - nameOffset
+			&& data[nameOffset + nameLength] == 0 && strlen(reinterpret_cast<const char*>(data + nameOffset)) == nameLength
+			&& pixelOffset % AssetAlignment == 0 && pixelOffset >= namesEnd && pixelOffset <= size && pixelCount <= (size - pixelOffset) / 4;
+		if (valid && i > 0) {
+			valid = strcmp(GetName(i - 1), GetName(i)) < 0;
+		}
+		if (!valid) {
+			delete _file;
+			throw EZ::Error("The asset pack index is corrupt.");
+		}
+	}
+}
+EZ::BitmapAsset EZ::AssetPack::GetBitmap(LPCSTR name) const {
+	UINT32 index = 0;
+	if (!FindAsset(name, &index)) {
+		throw EZ::Error("The asset pack has no bitmap with that name.");
+	}
+	return GetBitmap(index);
+}
+EZ::BitmapAsset EZ::AssetPack::GetBitmap(UINT32 index) const {
+	const BYTE* entry = _index + (static_cast<UINT64>(index) * AssetEntrySize);
+	EZ::BitmapAsset asset = { };
+	asset.Width = static_cast<UINT32>(ReadLittleEndian(entry + 8, 4));
+	asset.Height = static_cast<UINT32>(ReadLittleEndian(entry + 12, 4));
+	asset.Buffer = _file->GetData() + ReadLittleEndian(entry + 16, 8);
+	return asset;
+}
+LPCSTR EZ::AssetPack::GetName(UINT32 index) const {
+	const BYTE* entry = _index + (static_cast<UINT64>(index) * AssetEntrySize);
+	return reinterpret_cast<LPCSTR>(_file->GetData() + ReadLittleEndian(entry, 4));
+}
+BOOL EZ::AssetPack::FindAsset(LPCSTR name, UINT32* index) const {
+	UINT32 low = 0;
+	UINT32 high = _assetCount;
+	while (low < high) {
+		UINT32 middle = low + ((high - low) / 2);
+		int order = strcmp(GetName(middle), name);
+		if (order == 0) {
+			*index = middle;
+			return TRUE;
+		}
+		if (order < 0) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return FALSE;
+}
+EZ::AssetPack::~AssetPack() {
+	delete _file;
+	_file = nullptr;
+	_index = nullptr;
+	_assetCount = 0;
+}
+
+UINT32 EZ::AssetPack::GetAssetCount() const {
+	return _assetCount;
+}
+
+EZ::AssetPackWriter::AssetPackWriter() {
+}
+void EZ::AssetPackWriter::AddBitmap(LPCSTR name, EZ::BitmapAsset asset) {
+	if (name == nullptr || name[0] == '\0') {
+		throw EZ::Error("Asset names must not be empty.");
+	}
+	if (asset.Width == 0 || asset.Height == 0 || asset.Buffer == nullptr) {
+		throw EZ::Error("Bitmaps must not be empty.");
+	}
+	for (const Bitmap& bitmap : _bitmaps) {
+		if (bitmap.Name == name) {
+			throw EZ::Error("The asset pack already has a bitmap with that name.");
+		}
+	}
+	Bitmap bitmap;
+	bitmap.Name = name;
+	bitmap.Width = asset.Width;
+	bitmap.Height = asset.Height;
+	bitmap.Pixels.assign(asset.Buffer, asset.Buffer + (static_cast<size_t>(asset.Width) * asset.Height * 4));
+	_bitmaps.push_back(std::move(bitmap));
+}
+void EZ::AssetPackWriter::Save(LPCSTR filePath) const {
+	// The reader binary searches the names so they are written in strcmp order.
+	std::vector<const Bitmap*> sorted;
+	for (const Bitmap& bitmap : _bitmaps) {
+		sorted.push_back(&bitmap);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const Bitmap* a, const Bitmap* b) { return strcmp(a->Name.c_str(), b->Name.c_str()) < 0; });
+
+	UINT64 indexSize = static_cast<UINT64>(sorted.size()) * AssetEntrySize;
+	for (const Bitmap* bitmap : sorted) {
+		indexSize += bitmap->Name.size() + 1;
+	}
+	std::vector<BYTE> head(static_cast<size_t>(AlignUp(AssetPackHeaderSize + indexSize)), 0);
+	BYTE* index = head.data() + AssetPackHeaderSize;
+	UINT64 nameOffset = AssetPackHeaderSize + (static_cast<UINT64>(sorted.size()) * AssetEntrySize);
+	UINT64 pixelOffset = head.size();
+	for (size_t i = 0; i < sorted.size(); i++) {
+		const Bitmap* bitmap = sorted[i];
+		BYTE* entry = index + (i * AssetEntrySize);
+		WriteLittleEndian(entry, nameOffset, 4);
+		WriteLittleEndian(entry + 4, bitmap->Name.size(), 4);
+		WriteLittleEndian(entry + 8, bitmap->Width, 4);
+		WriteLittleEndian(entry + 12, bitmap->Height, 4);
+		WriteLittleEndian(entry + 16, pixelOffset, 8);
+		memcpy(head.data() + nameOffset, bitmap->Name.c_str(), bitmap->Name.size() + 1);
+		nameOffset += bitmap->Name.size() + 1;
+		pixelOffset = AlignUp(pixelOffset + bitmap->Pixels.size());
+	}
+	if (indexSize > 0xFFFFFFFFull) {
+		throw EZ::Error("The asset pack index is too large.");
+	}
+	memcpy(head.data(), AssetPackMagic, sizeof(AssetPackMagic));
+	WriteLittleEndian(head.data() + 8, AssetPackVersion, 4);
+	WriteLittleEndian(head.data() + 12, AssetPackHeaderSize, 4);
+	WriteLittleEndian(head.data() + 16, sorted.size(), 4);
+	WriteLittleEndian(head.data() + 20, indexSize, 4);
+	WriteLittleEndian(head.data() + 24, HashIndex(index, indexSize), 4);
+
+	std::ofstream file(filePath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(head.data()), static_cast<std::streamsize>(head.size()));
+	const BYTE padding[AssetAlignment] = { };
+	for (const Bitmap* bitmap : sorted) {
+		file.write(reinterpret_cast<const char*>(bitmap->Pixels.data()), static_cast<std::streamsize>(bitmap->Pixels.size()));
+		file.write(reinterpret_cast<const char*>(padding), static_cast<std::streamsize>(AlignUp(bitmap->Pixels.size()) - bitmap->Pixels.size()));
+	}
+	file.close();
+	if (file.fail()) {
+		throw EZ::Error("Failed to write the asset pack file.");
+	}
+}
+EZ::AssetPackWriter::~AssetPackWriter() {
+	_bitmaps.clear();
+}
+
+UINT32 EZ::AssetPackWriter::GetAssetCount() const {
+	return static_cast<UINT32>(_bitmaps.size());
+}
+
+void EZ::PremultiplyRGBA(const BYTE* source, BYTE* destination, UINT32 count) {
+	for (UINT32 i = 0; i < count; i++) {
+		UINT32 red = source[0];
+		UINT32 green = source[1];
+		UINT32 blue = source[2];
+		UINT32 alpha = source[3];
+		// Rounds x * alpha / 255 to the nearest integer without a division.
+		UINT32 r = red * alpha + 128;
+		UINT32 g = green * alpha + 128;
+		UINT32 b = blue * alpha + 128;
+		destination[0] = static_cast<BYTE>((b + (b >> 8)) >> 8);
+		destination[1] = static_cast<BYTE>((g + (g >> 8)) >> 8);
+		destination[2] = static_cast<BYTE>((r + (r >> 8)) >> 8);
+		destination[3] = static_cast<BYTE>(alpha);
+		source += 4;
+		destination += 4;
+	}
+}
\ No newline at end of file
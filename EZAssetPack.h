@@ -0,0 +1,68 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZBitmap.h"
+#include "EZMappedFile.h"
+#include <string>
+#include <vector>
+
+namespace EZ {
+	// Written into every asset pack. Bump it whenever the layout or meaning of anything in the file changes
+	// so old packs are refused instead of being drawn wrong.
+	constexpr UINT32 AssetPackVersion = 1;
+	// Pixels of every bitmap in a pack start at a multiple of this many bytes from the start of the file, so rows can be
+	// read with aligned vector loads and no two bitmaps share a cache line.
+	constexpr UINT32 AssetAlignment = 64;
+	// Bitmaps stored ahead of time in the exact layout EZ::BitmapAsset describes, with a sorted index of their names.
+	// The pack is mapped read only and GetBitmap returns views straight into the mapping, so loading a bitmap decodes
+	// and copies nothing. Its pixels are read from disk by the page faults of whoever first touches them, and are shared
+	// by every process which opens the same pack.
+	class AssetPack {
+	public:
+		// Maps filePath and checks its header and index. Pixels are not read until they are used.
+		// Throws an EZ::Error if the file is from a different AssetPackVersion or its index is corrupt.
+		AssetPack(LPCSTR filePath);
+		// Returns the bitmap named name by binary searching the index.
+		// Throws an EZ::Error if the pack has no bitmap with that name.
+		EZ::BitmapAsset GetBitmap(LPCSTR name) const;
+		// Returns the asset at index, in the order of the names. index must be less than GetAssetCount().
+		EZ::BitmapAsset GetBitmap(UINT32 index) const;
+		// Returns the name of the asset at index. The name points into the mapping and lives as long as the pack.
+		LPCSTR GetName(UINT32 index) const;
+		// Returns TRUE and the index of name or FALSE if the pack has no asset with that name.
+		BOOL FindAsset(LPCSTR name, UINT32* index) const;
+		~AssetPack();
+
+		UINT32 GetAssetCount() const;
+
+	private:
+		EZ::MappedFile* _file;
+		const BYTE* _index;
+		UINT32 _assetCount;
+	};
+	// Collects bitmaps and writes them out as an asset pack. This is the offline half of EZ::AssetPack,
+	// run by tools like TinyPack rather than by the program loading the pack.
+	class AssetPackWriter {
+	public:
+		AssetPackWriter();
+		// Copies asset into the pack as name. asset must already hold premultiplied B8G8R8A8 pixels.
+		// Throws an EZ::Error if name is empty or already taken or the bitmap is empty.
+		void AddBitmap(LPCSTR name, EZ::BitmapAsset asset);
+		// Writes every bitmap added so far to filePath. Throws an EZ::Error if the file can't be written.
+		void Save(LPCSTR filePath) const;
+		~AssetPackWriter();
+
+		UINT32 GetAssetCount() const;
+
+	private:
+		struct Bitmap {
+			std::string Name;
+			UINT32 Width;
+			UINT32 Height;
+			std::vector<BYTE> Pixels;
+		};
+		std::vector<Bitmap> _bitmaps;
+	};
+	// Converts count straight alpha R8G8B8A8 pixels, the layout most image files use, into premultiplied B8G8R8A8
+	// pixels. source and destination may be the same buffer.
+	void PremultiplyRGBA(const BYTE* source, BYTE* destination, UINT32 count);
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "EZAudio.h"
+#include "EZClock.h"
+#include "EZError.h"
+
+// How long the stream's thread sleeps when the ring is empty. Far shorter than a frame so samples reach the sink
+// soon after they are written, and far longer than it takes to drain a frame's worth.
+constexpr UINT64 AudioPollNanoseconds = 1000000;
+// Samples the stream's thread hands the sink at most per call.
+constexpr UINT32 AudioChunkSamples = 1024;
+constexpr UINT32 WavHeaderSize = 44;
+
+namespace {
+	void DiscardSamples(void* context, const INT16* samples, UINT32 sampleCount) {
+	}
+	void WriteLittleEndian(BYTE* destination, UINT32 value, UINT32 size) {
+		for (UINT32 i = 0; i < size; i++) {
+			destination[i] = static_cast<BYTE>(value >> (i * 8));
+		}
+	}
+}
+
+EZ::AudioSink EZ::GetNullAudioSink() {
+	return { nullptr, DiscardSamples };
+}
+
+EZ::WavFileSink::WavFileSink(LPCSTR filePath, UINT32 sampleRate) {
+	_sampleRate = sampleRate;
+	_sampleCount = 0;
+	_file.open(filePath, std::ios::binary | std::ios::trunc);
+	if (!_file.is_open()) {
+		throw EZ::Error("Failed to create the WAV file.");
+	}
+	WriteHeader();
+}
+EZ::AudioSink EZ::WavFileSink::GetSink() {
+	return { this, WriteSamples };
+}
+void EZ::WavFileSink::WriteSamples(void* context, const INT16* samples, UINT32 sampleCount) {
+	EZ::WavFileSink* sink = reinterpret_cast<EZ::WavFileSink*>(context);
+	// WAV samples are little endian like every platform Tiny runs on so they are written as they are.
+	sink->_file.write(reinterpret_cast<const char*>(samples), static_cast<std::streamsize>(sampleCount) * sizeof(INT16));
+	sink->_sampleCount += sampleCount;
+}
+void EZ::WavFileSink::WriteHeader() {
+	// Sizes are capped at what 32 bit RIFF sizes can hold.
+	UINT64 dataBytes = _sampleCount * sizeof(INT16);
+	UINT32 dataSize = dataBytes > 0xFFFFFFFFull - WavHeaderSize ? 0xFFFFFFFFu - WavHeaderSize : static_cast<UINT32>(dataBytes);
+	BYTE header[WavHeaderSize] = { };
+	memcpy(header, "RIFF", 4);
+	WriteLittleEndian(header + 4, (WavHeaderSize - 8) + dataSize, 4);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	WriteLittleEndian(header + 16, 16, 4); // fmt chunk size
+	WriteLittleEndian(header + 20, 1, 2); // PCM
+	WriteLittleEndian(header + 22, 1, 2); // Mono
+	WriteLittleEndian(header + 24, _sampleRate, 4);
+	WriteLittleEndian(header + 28, _sampleRate * sizeof(INT16), 4); // Bytes per second
+	WriteLittleEndian(header + 32, sizeof(INT16), 2); // Bytes per sample
+	WriteLittleEndian(header + 34, 16, 2); // Bits per sample
+	memcpy(header + 36, "data", 4);
+	WriteLittleEndian(header + 40, dataSize, 4);
+	_file.seekp(0);
+	_file.write(reinterpret_cast<const char*>(header), WavHeaderSize);
+	_file.seekp(0, std::ios::end);
+}
+EZ::WavFileSink::~WavFileSink() {
+	WriteHeader();
+	_file.close();
+}
+
+UINT64 EZ::WavFileSink::GetSampleCount() const {
+	return _sampleCount;
+}
+
+EZ::AudioStream::AudioStream(EZ::AudioStreamSettings settings) {
+	_settings = settings;
+	if (_settings.RingSamples == 0) {
+		_settings.RingSamples = DefaultAudioRingSamples;
+	}
+	if (_settings.Sink.Write == nullptr) {
+		_settings.Sink = EZ::GetNullAudioSink();
+	}
+	_ring = new EZ::SpscRing<INT16>(_settings.RingSamples);
+	_stopping.store(FALSE);
+	_samplesWritten.store(0);
+	_samplesDropped.store(0);
+	_samplesDelivered.store(0);
+	_consumer = std::thread(&EZ::AudioStream::ConsumerMain, this);
+}
+UINT32 EZ::AudioStream::Write(const INT16* samples, UINT32 sampleCount) {
+	UINT32 pushed = _ring->Push(samples, sampleCount);
+	_samplesWritten.store(_samplesWritten.load(std::memory_order_relaxed) + sampleCount, std::memory_order_relaxed);
+	if (pushed < sampleCount) {
+		_samplesDropped.store(_samplesDropped.load(std::memory_order_relaxed) + (sampleCount - pushed), std::memory_order_relaxed);
+	}
+	return pushed;
+}
+void EZ::AudioStream::Flush() {
+	UINT64 accepted = _samplesWritten.load(std::memory_order_relaxed) - _samplesDropped.load(std::memory_order_relaxed);
+	while (_samplesDelivered.load(std::memory_order_acquire) < accepted) {
+		std::this_thread::yield();
+	}
+}
+void EZ::AudioStream::ConsumerMain() {
+	INT16 chunk[AudioChunkSamples];
+	while (TRUE) {
+		// Read stopping before popping so nothing written before the destructor set it can be left behind.
+		BOOL stopping = _stopping.load(std::memory_order_acquire);
+		UINT32 count = _ring->Pop(chunk, AudioChunkSamples);
+		if (count != 0) {
+			_settings.Sink.Write(_settings.Sink.Context, chunk, count);
+			_samplesDelivered.store(_samplesDelivered.load(std::memory_order_relaxed) + count, std::memory_order_release);
+		}
+		else if (stopping) {
+			break;
+		}
+		else {
+			EZ::SleepNanoseconds(AudioPollNanoseconds);
+		}
+	}
+}
+EZ::AudioStream::~AudioStream() {
+	_stopping.store(TRUE, std::memory_order_release);
+	_consumer.join();
+	delete _ring;
+	_ring = nullptr;
+}
+
+EZ::AudioStreamStats EZ::AudioStream::GetStats() const {
+	return { _samplesWritten.load(), _samplesDropped.load(), _samplesDelivered.load() };
+}
+EZ::AudioStreamSettings EZ::AudioStream::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZSpscRing.h"
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace EZ {
+	// Samples each AudioStream ring holds by default. A little over 0.17 seconds at 48000 Hz, room for 10 frames at
+	// 60 FPS so a producer which runs a few frames ahead never has to drop anything.
+	constexpr UINT32 DefaultAudioRingSamples = 8192;
+	// Called on the AudioStream's thread with the next sampleCount mono 16 bit samples.
+	typedef void (*AudioWriteCallback)(void* context, const INT16* samples, UINT32 sampleCount);
+	// Somewhere finished samples go, such as a WAV file or an audio device.
+	struct AudioSink {
+		// This is a user defined pointer which is passed to Write.
+		void* Context;
+		AudioWriteCallback Write;
+	};
+	// Returns a sink which throws every sample away so the cost of producing audio can be measured on its own.
+	EZ::AudioSink GetNullAudioSink();
+	// Writes mono 16 bit PCM samples to a WAV file. The header is filled in with the final size when the sink is
+	// destroyed, so a file cut short by a crash still plays up to the last sample written.
+	class WavFileSink {
+	public:
+		// Throws an EZ::Error if the file can't be created.
+		WavFileSink(LPCSTR filePath, UINT32 sampleRate);
+		// Returns the sink to hand to AudioStreamSettings::Sink. It must only be used while this object lives.
+		EZ::AudioSink GetSink();
+		~WavFileSink();
+
+		UINT64 GetSampleCount() const;
+
+	private:
+		static void WriteSamples(void* context, const INT16* samples, UINT32 sampleCount);
+		// Writes the RIFF and fmt headers for _sampleCount samples at the start of the file.
+		void WriteHeader();
+
+		std::ofstream _file;
+		UINT32 _sampleRate;
+		UINT64 _sampleCount;
+	};
+	struct AudioStreamSettings {
+		// Where the samples go. Sink.Write is only ever called on the stream's own thread.
+		EZ::AudioSink Sink;
+		// If RingSamples == 0 then DefaultAudioRingSamples is used.
+		UINT32 RingSamples;
+	};
+	struct AudioStreamStats {
+		// Samples passed to Write, samples Write had no room for and samples handed to the sink.
+		UINT64 SamplesWritten;
+		UINT64 SamplesDropped;
+		UINT64 SamplesDelivered;
+	};
+	// Hands audio from the thread producing it to a thread of its own which feeds the sink, so however slow the sink is
+	// the producer only ever pays for a copy into a lock free ring.
+	// Samples are mono 16 bit PCM. A producer which gets too far ahead has what doesn't fit dropped and counted
+	// rather than waiting, since stalling the frame loop would cost more than a gap in the sound.
+	class AudioStream {
+	public:
+		AudioStream(EZ::AudioStreamSettings settings);
+		// Copies sampleCount samples into the ring without locking or waiting and returns how many fit.
+		// Only one thread may call Write.
+		UINT32 Write(const INT16* samples, UINT32 sampleCount);
+		// Waits until every sample Write took has been handed to the sink.
+		void Flush();
+		// Hands the sink what is left in the ring, then stops the thread.
+		~AudioStream();
+
+		EZ::AudioStreamStats GetStats() const;
+		EZ::AudioStreamSettings GetSettings() const;
+
+	private:
+		void ConsumerMain();
+
+		EZ::SpscRing<INT16>* _ring;
+		std::thread _consumer;
+		std::atomic<BOOL> _stopping;
+		// Only written by the producer.
+		std::atomic<UINT64> _samplesWritten;
+		std::atomic<UINT64> _samplesDropped;
+		// Only written by the consumer.
+		std::atomic<UINT64> _samplesDelivered;
+		EZ::AudioStreamSettings _settings;
+	};
+}
\ No newline at end of file
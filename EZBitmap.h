@@ -0,0 +1,13 @@
+#pragma once
+#include "EZPlatform.h"
+
+namespace EZ {
+	// Width * Height premultiplied B8G8R8A8 pixels, top row first, with no padding between rows.
+	// This is the layout EZ::Renderer uploads as is so nothing has to be decoded or converted to draw it.
+	// The asset does not own Buffer. It usually points into an EZ::AssetPack or into data compiled into the program.
+	struct BitmapAsset {
+		UINT32 Width;
+		UINT32 Height;
+		const BYTE* Buffer;
+	};
+}
\ No newline at end of file
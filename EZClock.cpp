@@ -0,0 +1,59 @@
+#include "EZClock.h"
+#ifdef _WIN32
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#else
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+static LONGLONG QueryFrequency() {
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return frequency.QuadPart;
+}
+#endif
+
+UINT64 EZ::GetNanoseconds() {
+#ifdef _WIN32
+	static const LONGLONG frequency = QueryFrequency();
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	// Split the conversion so ticks * 1000000000 can't overflow.
+	UINT64 seconds = static_cast<UINT64>(ticks.QuadPart / frequency);
+	UINT64 remainder = static_cast<UINT64>(ticks.QuadPart % frequency);
+	return (seconds * 1000000000ull) + ((remainder * 1000000000ull) / static_cast<UINT64>(frequency));
+#else
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (static_cast<UINT64>(now.tv_sec) * 1000000000ull) + static_cast<UINT64>(now.tv_nsec);
+#endif
+}
+void EZ::SleepNanoseconds(UINT64 nanoseconds) {
+#ifdef _WIN32
+	static const MMRESULT timerResolution = timeBeginPeriod(1);
+	(void)timerResolution;
+	DWORD milliseconds = static_cast<DWORD>(nanoseconds / 1000000);
+	if (milliseconds > 0) {
+		Sleep(milliseconds);
+	}
+#else
+	timespec duration;
+	duration.tv_sec = static_cast<time_t>(nanoseconds / 1000000000ull);
+	duration.tv_nsec = static_cast<long>(nanoseconds % 1000000000ull);
+	nanosleep(&duration, nullptr);
+#endif
+}
+
+static UINT64 SystemClockNow(void* context) {
+	return EZ::GetNanoseconds();
+}
+static void SystemClockSleep(void* context, UINT64 nanoseconds) {
+	EZ::SleepNanoseconds(nanoseconds);
+}
+EZ::Clock EZ::GetSystemClock() {
+	EZ::Clock clock = { };
+	clock.Now = SystemClockNow;
+	clock.Sleep = SystemClockSleep;
+	return clock;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include "EZPlatform.h"
+
+namespace EZ {
+	typedef UINT64 (*ClockNowCallback)(void* context);
+	typedef void (*ClockSleepCallback)(void* context, UINT64 nanoseconds);
+	// A source of time which anything that waits or measures takes instead of calling the OS directly.
+	// This lets code which paces itself run against a fake clock in headless tests and benchmarks.
+	struct Clock {
+		// This is a user defined pointer which is passed to both callbacks.
+		void* Context;
+		// Returns a monotonic time in nanoseconds. Only differences between two calls mean anything.
+		ClockNowCallback Now;
+		// Blocks the calling thread for about nanoseconds. It may wake up late but never meaningfully early.
+		ClockSleepCallback Sleep;
+	};
+	// Returns a monotonic time in nanoseconds from QueryPerformanceCounter on Windows and CLOCK_MONOTONIC elsewhere.
+	UINT64 GetNanoseconds();
+	// Sleeps the calling thread without spinning. On Windows the first call raises the system timer resolution
+	// to 1 millisecond because the default 15.6 millisecond resolution is far too coarse for frame pacing.
+	void SleepNanoseconds(UINT64 nanoseconds);
+	// Returns a Clock which uses GetNanoseconds and SleepNanoseconds.
+	EZ::Clock GetSystemClock();
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "EZCompression.h"
+#include <cstring>
+
+// Every compressed sequence is a token byte, literals, a 2 byte offset and extra match length bytes.
+// The high 4 bits of the token are the literal count and the low 4 bits are the match length minus MinMatch.
+// A nibble of 15 means more length bytes follow, each adding up to 255 until one is less than 255.
+// The last sequence has literals only and ends exactly at the end of the compressed data.
+constexpr UINT32 MinMatch = 4;
+constexpr UINT32 MaxOffset = 0xFFFF;
+constexpr UINT32 HashBits = 12;
+
+namespace {
+	UINT32 Read32(const BYTE* bytes) {
+		UINT32 value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	UINT64 Read64(const BYTE* bytes) {
+		UINT64 value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	UINT32 Hash(UINT32 value) {
+		return (value * 2654435761u) >> (32 - HashBits);
+	}
+	BYTE* WriteLength(BYTE* output, UINT32 length) {
+		while (length >= 255) {
+			*output++ = 255;
+			length -= 255;
+		}
+		*output++ = static_cast<BYTE>(length);
+		return output;
+	}
+	BYTE* WriteSequence(BYTE* output, const BYTE* literals, UINT32 literalCount, UINT32 offset, UINT32 matchLength) {
+		BYTE* token = output++;
+		*token = static_cast<BYTE>((literalCount < 15 ? literalCount : 15) << 4);
+		if (literalCount >= 15) {
+			output = WriteLength(output, literalCount - 15);
+		}
+		memcpy(output, literals, literalCount);
+		output += literalCount;
+		if (matchLength == 0) {
+			return output;
+		}
+		*output++ = static_cast<BYTE>(offset);
+		*output++ = static_cast<BYTE>(offset >> 8);
+		UINT32 length = matchLength - MinMatch;
+		*token |= static_cast<BYTE>(length < 15 ? length : 15);
+		if (length >= 15) {
+			output = WriteLength(output, length - 15);
+		}
+		return output;
+	}
+	// Reads the extra length bytes after a nibble of 15. Returns FALSE if they run past end.
+	BOOL ReadLength(const BYTE*& input, const BYTE* end, UINT32& length) {
+		BYTE value;
+		do {
+			if (input >= end) {
+				return FALSE;
+			}
+			value = *input++;
+			length += value;
+		} while (value == 255);
+		return TRUE;
+	}
+}
+
+UINT32 EZ::GetCompressBound(UINT32 sourceSize) {
+	return sourceSize + (sourceSize / 255) + 16;
+}
+UINT32 EZ::Compress(const BYTE* source, UINT32 sourceSize, BYTE* destination) {
+	// Positions plus 1 of the last 4 bytes seen with each hash so 0 means none.
+	UINT32 table[1 << HashBits] = { };
+	BYTE* output = destination;
+	UINT32 anchor = 0;
+	UINT32 position = 0;
+	UINT32 misses = 0;
+	while (position + MinMatch <= sourceSize) {
+		UINT32 value = Read32(source + position);
+		UINT32 hash = Hash(value);
+		UINT32 candidate = table[hash];
+		table[hash] = position + 1;
+		if (candidate == 0 || position - (candidate - 1) > MaxOffset || Read32(source + candidate - 1) != value) {
+			// Step further the longer nothing matches so data which doesn't compress goes through quickly.
+			position += 1 + (misses++ >> 5);
+			continue;
+		}
+		misses = 0;
+		UINT32 match = candidate - 1;
+		UINT32 length = MinMatch;
+		// Compare 8 bytes at a time until something differs. Long runs of zeros are common so this matters.
+		while (position + length + 8 <= sourceSize && Read64(source + match + length) == Read64(source + position + length)) {
+			length += 8;
+		}
+		while (position + length < sourceSize && source[match + length] == source[position + length]) {
+			length++;
+		}
+		output = WriteSequence(output, source + anchor, position - anchor, position - match, length);
+		position += length;
+		anchor = position;
+	}
+	output = WriteSequence(output, source + anchor, sourceSize - anchor, 0, 0);
+	return static_cast<UINT32>(output - destination);
+}
+BOOL EZ::Decompress(const BYTE* source, UINT32 sourceSize, BYTE* destination, UINT32 destinationSize) {
+	const BYTE* input = source;
+	const BYTE* inputEnd = source + sourceSize;
+	BYTE* output = destination;
+	BYTE* outputEnd = destination + destinationSize;
+	while (input < inputEnd) {
+		BYTE token = *input++;
+		UINT32 literalCount = token >> 4;
+		if (literalCount == 15 && !ReadLength(input, inputEnd, literalCount)) {
+			return FALSE;
+		}
+		if (literalCount > static_cast<UINT32>(inputEnd - input) || literalCount > static_cast<UINT32>(outputEnd - output)) {
+			return FALSE;
+		}
+		memcpy(output, input, literalCount);
+		input += literalCount;
+		output += literalCount;
+		if (input == inputEnd) {
+			break;
+		}
+
+		if (inputEnd - input < 2) {
+			return FALSE;
+		}
+		UINT32 offset = input[0] | (input[1] << 8);
+		input += 2;
+		UINT32 length = token & 15;
+		if (length == 15 && !ReadLength(input, inputEnd, length)) {
+			return FALSE;
+		}
+		length += MinMatch;
+		if (offset == 0 || offset > static_cast<UINT32>(output - destination) || length > static_cast<UINT32>(outputEnd - output)) {
+			return FALSE;
+		}
+		const BYTE* match = output - offset;
+		if (offset >= length) {
+			memcpy(output, match, length);
+			output += length;
+		}
+		else {
+			// The match overlaps the bytes it produces, which is how runs are stored. The output repeats every offset
+			// bytes so copy whole repeats, each time from as far back as has already been written.
+			UINT32 copied = 0;
+			UINT32 distance = offset;
+			while (copied < length) {
+				UINT32 chunk = distance < length - copied ? distance : length - copied;
+				memcpy(output + copied, output + copied - distance, chunk);
+				copied += chunk;
+				distance = offset + copied;
+			}
+			output += length;
+		}
+	}
+	return output == outputEnd;
+}
\ No newline at end of file
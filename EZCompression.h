@@ -0,0 +1,16 @@
+#pragma once
+#include "EZPlatform.h"
+
+namespace EZ {
+	// Returns the most bytes Compress can write for sourceSize bytes of input.
+	// Data which doesn't compress at all grows by a little under 0.5%.
+	UINT32 GetCompressBound(UINT32 sourceSize);
+	// Compresses sourceSize bytes with a byte oriented LZ77 in the style of LZ4 which favors speed over ratio.
+	// Runs of one byte and repeats of earlier data within 64KB become a few bytes each, which is what
+	// emulator memory and deltas between frames mostly are.
+	// destination must hold GetCompressBound(sourceSize) bytes. Returns the number of bytes written.
+	UINT32 Compress(const BYTE* source, UINT32 sourceSize, BYTE* destination);
+	// Reverses Compress. The data is checked as it is decoded so corrupt input can't read or write out of bounds.
+	// Returns TRUE only if source decoded to exactly destinationSize bytes.
+	BOOL Decompress(const BYTE* source, UINT32 sourceSize, BYTE* destination, UINT32 destinationSize);
+}
\ No newline at end of file
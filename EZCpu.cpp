@@ -0,0 +1,71 @@
+#include "EZCpu.h"
+#ifdef EZ_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef EZ_X86
+static void Cpuid(UINT32 leaf, UINT32 subleaf, UINT32 registers[4]) {
+#ifdef _MSC_VER
+	int output[4];
+	__cpuidex(output, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (int i = 0; i < 4; i++) {
+		registers[i] = static_cast<UINT32>(output[i]);
+	}
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+// Reads XCR0 which says which register files the OS saves and restores.
+static UINT64 ReadXCR0() {
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	UINT32 low;
+	UINT32 high;
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return (static_cast<UINT64>(high) << 32) | low;
+#endif
+}
+#endif
+
+static EZ::CpuFeatures DetectCpuFeatures() {
+	EZ::CpuFeatures features = { };
+#ifdef EZ_X86
+	UINT32 registers[4] = { };
+	Cpuid(0, 0, registers);
+	UINT32 maxLeaf = registers[0];
+
+	Cpuid(1, 0, registers);
+	features.SSE2 = (registers[3] >> 26) & 1;
+	features.SSSE3 = (registers[2] >> 9) & 1;
+	features.SSE41 = (registers[2] >> 19) & 1;
+	BOOL osxsave = (registers[2] >> 27) & 1;
+	BOOL avx = (registers[2] >> 28) & 1;
+
+	UINT64 xcr0 = 0;
+	if (osxsave) {
+		xcr0 = ReadXCR0();
+	}
+	// Bits 1 and 2 are the XMM and YMM state. Bits 5, 6 and 7 are the opmask and ZMM state.
+	BOOL osSavesYmm = (xcr0 & 0x06) == 0x06;
+	BOOL osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+
+	if (maxLeaf >= 7) {
+		Cpuid(7, 0, registers);
+		features.AVX2 = avx && osSavesYmm && ((registers[1] >> 5) & 1);
+		features.BMI2 = (registers[1] >> 8) & 1;
+		features.AVX512F = osSavesZmm && ((registers[1] >> 16) & 1);
+		features.AVX512BW = features.AVX512F && ((registers[1] >> 30) & 1);
+	}
+#endif
+	return features;
+}
+
+const EZ::CpuFeatures& EZ::GetCpuFeatures() {
+	static const EZ::CpuFeatures features = DetectCpuFeatures();
+	return features;
+}
\ No newline at end of file
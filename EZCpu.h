@@ -0,0 +1,34 @@
+#pragma once
+#include "EZPlatform.h"
+
+// EZ_X86 is defined when compiling for 32 or 64 bit x86 where the SSE/AVX intrinsics are availible.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define EZ_X86 1
+#endif
+
+// EZ_TARGET lets a single function use instructions beyond the baseline the rest of the file is compiled for.
+// MSVC allows any intrinsic anywhere so it expands to nothing there.
+// GCC and Clang need to be told per function, for example EZ_TARGET("avx2").
+// Functions marked with EZ_TARGET must only be called after checking EZ::GetCpuFeatures().
+#if defined(_MSC_VER) && !defined(__clang__)
+#define EZ_TARGET(features)
+#else
+#define EZ_TARGET(features) __attribute__((target(features)))
+#endif
+
+namespace EZ {
+	struct CpuFeatures {
+		BOOL SSE2;
+		BOOL SSSE3;
+		BOOL SSE41;
+		// AVX2 is only reported if the OS also saves the YMM registers on context switches.
+		BOOL AVX2;
+		BOOL BMI2;
+		// AVX512F and AVX512BW are only reported if the OS also saves the ZMM and mask registers.
+		BOOL AVX512F;
+		BOOL AVX512BW;
+	};
+	// Runs CPUID the first time it is called and returns the cached result after that.
+	// On non x86 platforms every feature is FALSE.
+	const EZ::CpuFeatures& GetCpuFeatures();
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "EZDrawList.h"
+
+namespace {
+	UINT32 PackChannel(FLOAT value) {
+		if (!(value > 0.0f)) {
+			return 0;
+		}
+		if (value >= 1.0f) {
+			return 255;
+		}
+		return static_cast<UINT32>((value * 255.0f) + 0.5f);
+	}
+}
+
+UINT32 EZ::PackColor(D2D1_COLOR_F color) {
+	FLOAT alpha = color.a < 0.0f ? 0.0f : (color.a > 1.0f ? 1.0f : color.a);
+	return (PackChannel(alpha) << 24) | (PackChannel(color.r * alpha) << 16) | (PackChannel(color.g * alpha) << 8) | PackChannel(color.b * alpha);
+}
+
+EZ::DrawList::DrawList() {
+	_firstVisibleCommand = 0;
+	_dipSize = { };
+	_pixelSize = { };
+}
+void EZ::DrawList::Reset(D2D1_SIZE_F dipSize, D2D1_SIZE_U pixelSize) {
+	_commands.clear();
+	_bitmaps.clear();
+	_firstVisibleCommand = 0;
+	_dipSize = dipSize;
+	_pixelSize = pixelSize;
+}
+void EZ::DrawList::Clear(D2D1_COLOR_F color) {
+	_firstVisibleCommand = static_cast<UINT32>(_commands.size());
+	EZ::DrawCommand command = { };
+	command.Type = EZ::DrawCommandType::Clear;
+	command.Color = EZ::PackColor(color);
+	_commands.push_back(command);
+}
+void EZ::DrawList::FillRect(D2D1_RECT_L rect, D2D1_COLOR_F color) {
+	EZ::DrawCommand command = { };
+	command.Type = EZ::DrawCommandType::FillRect;
+	command.Color = EZ::PackColor(color);
+	command.Destination = EZ::TransformRect(rect, _dipSize, _pixelSize);
+	_commands.push_back(command);
+}
+void EZ::DrawList::DrawBitmap(EZ::BitmapRef bitmap, D2D1_POINT_2L position) {
+	D2D1_RECT_L destination = EZ::RectL(position.x, position.y, bitmap.PixelSize.width, bitmap.PixelSize.height);
+	D2D1_RECT_L source = EZ::RectL(0, 0, bitmap.PixelSize.width, bitmap.PixelSize.height);
+	DrawBitmap(bitmap, source, destination);
+}
+void EZ::DrawList::DrawBitmap(EZ::BitmapRef bitmap, D2D1_RECT_L destination) {
+	D2D1_RECT_L source = EZ::RectL(0, 0, bitmap.PixelSize.width, bitmap.PixelSize.height);
+	DrawBitmap(bitmap, source, destination);
+}
+void EZ::DrawList::DrawBitmap(EZ::BitmapRef bitmap, D2D1_RECT_L source, D2D1_RECT_L destination) {
+	EZ::DrawCommand command = { };
+	command.Type = EZ::DrawCommandType::DrawBitmap;
+	command.Bitmap = AddBitmap(bitmap);
+	command.Destination = EZ::TransformRect(destination, _dipSize, _pixelSize);
+	command.Source = EZ::TransformRect(source, bitmap.DipSize, bitmap.PixelSize);
+	_commands.push_back(command);
+}
+UINT32 EZ::DrawList::AddBitmap(EZ::BitmapRef bitmap) {
+	if (_bitmaps.empty() || _bitmaps.back().Handle != bitmap.Handle) {
+		_bitmaps.push_back(bitmap);
+	}
+	return static_cast<UINT32>(_bitmaps.size() - 1);
+}
+EZ::DrawList::~DrawList() {
+	_commands.clear();
+	_bitmaps.clear();
+}
+
+const EZ::DrawCommand* EZ::DrawList::GetCommands() const {
+	return _commands.data();
+}
+UINT32 EZ::DrawList::GetCommandCount() const {
+	return static_cast<UINT32>(_commands.size());
+}
+UINT32 EZ::DrawList::GetFirstVisibleCommand() const {
+	return _firstVisibleCommand;
+}
+const EZ::BitmapRef* EZ::DrawList::GetBitmaps() const {
+	return _bitmaps.data();
+}
+UINT32 EZ::DrawList::GetBitmapCount() const {
+	return static_cast<UINT32>(_bitmaps.size());
+}
+D2D1_SIZE_F EZ::DrawList::GetDipSize() const {
+	return _dipSize;
+}
+D2D1_SIZE_U EZ::DrawList::GetPixelSize() const {
+	return _pixelSize;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZGeometry.h"
+#include <vector>
+
+namespace EZ {
+	// Names a bitmap in a draw list without the list knowing what kind of bitmap it is. Handle is whatever the backend
+	// the list is submitted to draws from: an ID2D1Bitmap* for EZ::Renderer and an EZ::BitmapAsset* for EZ::SoftwareRenderer.
+	// Each backend has a GetBitmapRef which fills in the sizes.
+	struct BitmapRef {
+		const void* Handle;
+		D2D1_SIZE_F DipSize;
+		D2D1_SIZE_U PixelSize;
+	};
+	enum class DrawCommandType : BYTE {
+		// Replaces every pixel of the target with Color.
+		Clear = 0,
+		// Blends Color over Destination.
+		FillRect = 1,
+		// Blends Source of bitmap Bitmap over Destination, scaled with nearest neighbour sampling.
+		DrawBitmap = 2,
+	};
+	// One recorded draw call with everything the backend needs already worked out. It holds no pointers or handles so
+	// a list of them can be copied, sorted or merged freely.
+	struct DrawCommand {
+		EZ::DrawCommandType Type;
+		// Premultiplied B8G8R8A8 packed the way a UINT32 reads it from memory, so 0xAARRGGBB.
+		UINT32 Color;
+		// Index into the bitmaps of the list.
+		UINT32 Bitmap;
+		// Where to draw in the target's DIP space with y counting down, as EZ::TransformRect returns it.
+		D2D1_RECT_F Destination;
+		// What to draw in the bitmap's DIP space with y counting down.
+		D2D1_RECT_F Source;
+	};
+	// Converts color into the premultiplied packed form DrawCommand::Color uses. Channels are clamped to 0 - 1.
+	UINT32 PackColor(D2D1_COLOR_F color);
+	// Records a frame of Clear, FillRect and DrawBitmap calls, taking the same arguments as EZ::Renderer, so they can be
+	// handed to a backend in one Submit. Colors are packed and every rect goes through TransformRect once while recording
+	// so backends only walk a flat array. Reset keeps the memory of the last frame so recording allocates nothing once
+	// the list has grown to the size of a frame.
+	class DrawList {
+	public:
+		DrawList();
+		// Throws away every command and sets the size of the target the next frame will be submitted to.
+		// The y flip and DPI scaling of every rect recorded until the next Reset are worked out from these sizes.
+		void Reset(D2D1_SIZE_F dipSize, D2D1_SIZE_U pixelSize);
+		void Clear(D2D1_COLOR_F color);
+		void FillRect(D2D1_RECT_L rect, D2D1_COLOR_F color);
+		void DrawBitmap(EZ::BitmapRef bitmap, D2D1_POINT_2L position);
+		void DrawBitmap(EZ::BitmapRef bitmap, D2D1_RECT_L destination);
+		void DrawBitmap(EZ::BitmapRef bitmap, D2D1_RECT_L source, D2D1_RECT_L destination);
+		~DrawList();
+
+		const EZ::DrawCommand* GetCommands() const;
+		UINT32 GetCommandCount() const;
+		// Returns the first command whose output can still be seen. Everything before the last Clear is painted over by
+		// it so backends start here.
+		UINT32 GetFirstVisibleCommand() const;
+		const EZ::BitmapRef* GetBitmaps() const;
+		UINT32 GetBitmapCount() const;
+		D2D1_SIZE_F GetDipSize() const;
+		D2D1_SIZE_U GetPixelSize() const;
+
+	private:
+		// Returns the index of bitmap in _bitmaps, adding it if it isn't the bitmap drawn last.
+		// Draws of the same bitmap usually come in runs so only the last one is checked.
+		UINT32 AddBitmap(EZ::BitmapRef bitmap);
+
+		std::vector<EZ::DrawCommand> _commands;
+		std::vector<EZ::BitmapRef> _bitmaps;
+		UINT32 _firstVisibleCommand;
+		D2D1_SIZE_F _dipSize;
+		D2D1_SIZE_U _pixelSize;
+	};
+}
\ No newline at end of file
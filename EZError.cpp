@@ -1,6 +1,11 @@
 #include "EZError.h"
+#ifdef _WIN32
 #include <Windows.h>
 #include <comdef.h>
+#else
+#include <cstdio>
+#include <cstdlib>
+#endif
 
 EZ::Error::Error(LPCWSTR message) {
 	_isWideMessage = TRUE;
@@ -27,6 +32,7 @@ EZ::Error::Error(LPSTR message, EZ::Error::DisposalMethod disposalMethod) {
 	_message = const_cast<void*>(reinterpret_cast<const void*>(message));
 }
 void EZ::Error::PrintAndFree() {
+#ifdef _WIN32
 	HANDLE stdoutHandle = GetStdHandle(STD_OUTPUT_HANDLE);
 
 	// Get initial console attributes.
@@ -57,6 +63,15 @@ void EZ::Error::PrintAndFree() {
 
 	// Restore initial console attributes.
 	SetConsoleTextAttribute(stdoutHandle, savedAttributes);
+#else
+	// There is no console API off Windows so use ANSI escape codes for the red text instead.
+	if (_isWideMessage) {
+		fprintf(stderr, "\x1b[91mERROR: %ls\x1b[0m\n", reinterpret_cast<LPCWSTR>(_message));
+	}
+	else {
+		fprintf(stderr, "\x1b[91mERROR: %s\x1b[0m\n", reinterpret_cast<LPCSTR>(_message));
+	}
+#endif
 
 	// Dispose of string if needed.
 	if (!_isConstMessage) {
@@ -68,7 +83,11 @@ void EZ::Error::PrintAndFree() {
 			delete[] const_cast<void*>(_message);
 			break;
 		case EZ::Error::DisposalMethod::LocalFree:
+#ifdef _WIN32
 			::LocalFree(const_cast<void*>(_message));
+#else
+			free(const_cast<void*>(_message));
+#endif
 			break;
 		default: break;
 		}
@@ -79,6 +98,7 @@ EZ::Error::~Error() {
 
 }
 
+#ifdef _WIN32
 void EZ::Error::ThrowFromHR(HRESULT hr) {
 	if (SUCCEEDED(hr)) {
 		return;
@@ -112,4 +132,5 @@ void EZ::Error::ThrowFromCode(DWORD errorCode) {
 }
 void EZ::Error::ThrowFromLastError() {
 	EZ::Error::ThrowFromCode(GetLastError());
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
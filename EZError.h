@@ -1,5 +1,5 @@
 #pragma once
-#include <Windows.h>
+#include "EZPlatform.h"
 
 namespace EZ {
 	class Error {
@@ -19,9 +19,11 @@ namespace EZ {
 		void PrintAndFree();
 		~Error();
 
+#ifdef _WIN32
 		static void ThrowFromHR(HRESULT hr);
 		static void ThrowFromCode(DWORD errorCode);
 		static void ThrowFromLastError();
+#endif
 
 	private:
 		BOOL _isWideMessage = TRUE;
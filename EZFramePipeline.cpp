@@ -0,0 +1,151 @@
+#include "EZFramePipeline.h"
+#include "EZError.h"
+#include <cstring>
+
+constexpr BYTE TripleBufferIndexMask = 0x3;
+constexpr BYTE TripleBufferNewBit = 0x4;
+
+EZ::TripleBuffer::TripleBuffer(UINT32 size) {
+	_size = size;
+	for (UINT32 i = 0; i < 3; i++) {
+		_buffers[i] = new BYTE[size];
+		memset(_buffers[i], 0, size);
+		_sequences[i] = 0;
+	}
+	_back = 0;
+	_published = 0;
+	_front = 1;
+	_middle.store(2);
+}
+BYTE* EZ::TripleBuffer::GetBackBuffer() {
+	return _buffers[_back];
+}
+UINT64 EZ::TripleBuffer::Publish() {
+	_published++;
+	_sequences[_back] = _published;
+	// Release so the consumer sees the whole frame once it sees the new middle, acquire so the buffer handed back
+	// isn't written until the consumer is done reading it. Sequentially consistent so FramePipeline can pair it
+	// with its check of whether the presenter is waiting.
+	BYTE middle = _middle.exchange(static_cast<BYTE>(_back | TripleBufferNewBit), std::memory_order_seq_cst);
+	_back = middle & TripleBufferIndexMask;
+	return _published;
+}
+BOOL EZ::TripleBuffer::Acquire() {
+	// Cheap check first so a consumer polling with nothing new doesn't keep taking the cache line from the producer.
+	if ((_middle.load(std::memory_order_relaxed) & TripleBufferNewBit) == 0) {
+		return FALSE;
+	}
+	BYTE middle = _middle.exchange(_front, std::memory_order_acq_rel);
+	_front = middle & TripleBufferIndexMask;
+	return TRUE;
+}
+EZ::TripleBuffer::~TripleBuffer() {
+	for (UINT32 i = 0; i < 3; i++) {
+		delete[] _buffers[i];
+		_buffers[i] = nullptr;
+	}
+}
+
+const BYTE* EZ::TripleBuffer::GetFrontBuffer() const {
+	return _buffers[_front];
+}
+UINT64 EZ::TripleBuffer::GetFrontSequence() const {
+	return _sequences[_front];
+}
+BOOL EZ::TripleBuffer::HasNewFrame() const {
+	return (_middle.load(std::memory_order_seq_cst) & TripleBufferNewBit) != 0;
+}
+UINT32 EZ::TripleBuffer::GetSize() const {
+	return _size;
+}
+
+EZ::FramePipeline::FramePipeline(EZ::FramePipelineSettings settings) {
+	if (settings.FrameBytes == 0) {
+		throw EZ::Error("FrameBytes must not be 0.");
+	}
+	if (settings.Present == nullptr) {
+		throw EZ::Error("Present must not be nullptr.");
+	}
+	_settings = settings;
+	_frames = new EZ::TripleBuffer(_settings.FrameBytes);
+	_presenterWaiting.store(FALSE);
+	_redrawRequested.store(FALSE);
+	_stopping.store(FALSE);
+	_framesPublished.store(0);
+	_framesPresented.store(0);
+	_framesSkipped.store(0);
+	_presentedSequence.store(0);
+	_presenter = std::thread(&EZ::FramePipeline::PresenterMain, this);
+}
+BYTE* EZ::FramePipeline::GetBackBuffer() {
+	return _frames->GetBackBuffer();
+}
+void EZ::FramePipeline::Publish() {
+	UINT64 sequence = _frames->Publish();
+	_framesPublished.store(sequence, std::memory_order_release);
+	if (_presenterWaiting.load(std::memory_order_seq_cst)) {
+		Wake();
+	}
+}
+void EZ::FramePipeline::Redraw() {
+	_redrawRequested.store(TRUE, std::memory_order_seq_cst);
+	if (_presenterWaiting.load(std::memory_order_seq_cst)) {
+		Wake();
+	}
+}
+void EZ::FramePipeline::Flush() {
+	UINT64 published = _framesPublished.load(std::memory_order_acquire);
+	while (_presentedSequence.load(std::memory_order_acquire) < published) {
+		std::this_thread::yield();
+	}
+}
+UINT64 EZ::FramePipeline::GetPresentedSequence() const {
+	return _presentedSequence.load(std::memory_order_acquire);
+}
+void EZ::FramePipeline::PresenterMain() {
+	while (TRUE) {
+		BOOL acquired = _frames->Acquire();
+		BOOL redraw = _redrawRequested.exchange(FALSE, std::memory_order_acq_rel);
+		if (acquired || redraw) {
+			UINT64 sequence = _frames->GetFrontSequence();
+			if (acquired) {
+				_framesSkipped.store(_framesSkipped.load(std::memory_order_relaxed) + (sequence - _presentedSequence.load(std::memory_order_relaxed) - 1), std::memory_order_relaxed);
+			}
+			// Nothing is on screen to redraw until the first frame arrives.
+			if (sequence != 0) {
+				_settings.Present(_settings.Context, _frames->GetFrontBuffer(), _settings.FrameBytes);
+				_framesPresented.store(_framesPresented.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+			_presentedSequence.store(sequence, std::memory_order_release);
+			continue;
+		}
+		if (_stopping.load(std::memory_order_acquire)) {
+			break;
+		}
+		std::unique_lock<std::mutex> lock(_mutex);
+		_presenterWaiting.store(TRUE, std::memory_order_seq_cst);
+		if (!_frames->HasNewFrame() && !_redrawRequested.load(std::memory_order_seq_cst) && !_stopping.load(std::memory_order_seq_cst)) {
+			_wake.wait(lock);
+		}
+		_presenterWaiting.store(FALSE, std::memory_order_relaxed);
+	}
+}
+void EZ::FramePipeline::Wake() {
+	// Taking the lock means the presenter is either already inside wait or hasn't checked for work yet.
+	std::lock_guard<std::mutex> lock(_mutex);
+	_wake.notify_one();
+}
+EZ::FramePipeline::~FramePipeline() {
+	_stopping.store(TRUE, std::memory_order_seq_cst);
+	Wake();
+	_presenter.join();
+	delete _frames;
+	_frames = nullptr;
+}
+
+EZ::FramePipelineStats EZ::FramePipeline::GetStats() const {
+	return { _framesPublished.load(), _framesPresented.load(), _framesSkipped.load() };
+}
+EZ::FramePipelineSettings EZ::FramePipeline::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
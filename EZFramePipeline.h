@@ -0,0 +1,118 @@
+#pragma once
+#include "EZPlatform.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace EZ {
+	// Hands whole frames from one producer thread to one consumer thread without either ever waiting for the other.
+	// Of the three buffers the producer owns the back one, the consumer owns the front one and the middle one holds
+	// the newest finished frame. Publish and Acquire each swap their buffer with the middle one in a single atomic
+	// exchange, so the consumer always gets the newest frame and frames it was too slow for are simply replaced.
+	class TripleBuffer {
+	public:
+		// Every buffer holds size bytes and starts out zeroed.
+		TripleBuffer(UINT32 size);
+		// Producer only. Returns the buffer to write the next frame into. It changes with every Publish and holds
+		// whatever was in it from an older frame, so write all of it.
+		BYTE* GetBackBuffer();
+		// Producer only. Makes the back buffer the newest frame and returns its sequence number, counting from 1.
+		UINT64 Publish();
+		// Consumer only. Returns TRUE and makes the newest frame the front buffer if one was published since the
+		// last Acquire. Else returns FALSE and the front buffer stays as it was.
+		BOOL Acquire();
+		~TripleBuffer();
+
+		// Consumer only. Returns the frame taken by the last Acquire, or zeros before the first one.
+		const BYTE* GetFrontBuffer() const;
+		// Consumer only. Returns the sequence number of the front buffer, 0 before the first Acquire.
+		UINT64 GetFrontSequence() const;
+		// Returns TRUE if a frame was published which Acquire hasn't taken yet. Safe on any thread.
+		BOOL HasNewFrame() const;
+		UINT32 GetSize() const;
+
+	private:
+		BYTE* _buffers[3];
+		// The sequence number of the frame in each buffer.
+		UINT64 _sequences[3];
+		UINT32 _size;
+		// Only touched by the producer.
+		BYTE _back;
+		UINT64 _published;
+		// Only touched by the consumer.
+		BYTE _front;
+		// The index of the middle buffer in bits 0 and 1. Bit 2 is set while it holds a frame Acquire hasn't taken.
+		// It sits on its own cache line since it is the only thing both threads write.
+		alignas(64) std::atomic<BYTE> _middle;
+	};
+
+	typedef void (*PresentCallback)(void* context, const BYTE* frame, UINT32 size);
+	struct FramePipelineSettings {
+		// The size of every frame in bytes. Must not be 0.
+		UINT32 FrameBytes;
+		// This is a user defined pointer which is passed to Present.
+		void* Context;
+		// Called on the pipeline's own thread with the newest published frame, or with the last one again after
+		// Redraw. It may take as long as it likes, for example waiting for vsync, without holding up the producer.
+		// Must not be nullptr.
+		PresentCallback Present;
+	};
+	struct FramePipelineStats {
+		UINT64 FramesPublished;
+		// Calls to Present, which includes redraws.
+		UINT64 FramesPresented;
+		// Frames replaced by a newer one before Present got to them.
+		UINT64 FramesSkipped;
+	};
+	// Overlaps producing frames with presenting them. The producer writes frame N + 1 into a TripleBuffer while a
+	// thread of the pipeline's own presents frame N, so a slow present never stalls the producer and a frame which
+	// takes as long to present as to produce costs the time of the slower of the two rather than both.
+	// When the producer runs ahead the presenter skips straight to the newest frame instead of falling behind.
+	class FramePipeline {
+	public:
+		// Starts the presenter thread. Throws an EZ::Error if FrameBytes == 0 or Present == nullptr.
+		FramePipeline(EZ::FramePipelineSettings settings);
+		// Producer only. Returns the buffer to write the next frame into. See TripleBuffer::GetBackBuffer.
+		BYTE* GetBackBuffer();
+		// Producer only. Hands the back buffer to the presenter. Never waits. Only wakes the presenter thread with
+		// a lock if it was asleep with nothing to present.
+		void Publish();
+		// Asks the presenter to present the last frame again even though nothing new was published, for example
+		// because the window was resized. Safe on any thread.
+		void Redraw();
+		// Waits until the newest published frame was presented.
+		void Flush();
+		// Returns the sequence number of the last frame Present returned from, counting published frames from 1, or 0
+		// before the first. Safe on any thread. Frames after it may be replaced before they are presented, so a producer
+		// sending only what changed must send everything which changed since this frame.
+		UINT64 GetPresentedSequence() const;
+		// Presents the newest frame if it wasn't yet, then stops the presenter thread.
+		~FramePipeline();
+
+		EZ::FramePipelineStats GetStats() const;
+		EZ::FramePipelineSettings GetSettings() const;
+
+	private:
+		void PresenterMain();
+		// Wakes the presenter thread if it is waiting.
+		void Wake();
+
+		EZ::TripleBuffer* _frames;
+		std::thread _presenter;
+		// The presenter sleeps on _wake only after setting _presenterWaiting and checking for work once more, so a
+		// producer which sees _presenterWaiting clear knows the presenter will find its frame without being woken.
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		std::atomic<BOOL> _presenterWaiting;
+		std::atomic<BOOL> _redrawRequested;
+		std::atomic<BOOL> _stopping;
+		// Only written by the producer.
+		std::atomic<UINT64> _framesPublished;
+		// Only written by the presenter.
+		std::atomic<UINT64> _framesPresented;
+		std::atomic<UINT64> _framesSkipped;
+		std::atomic<UINT64> _presentedSequence;
+		EZ::FramePipelineSettings _settings;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "EZFrameScheduler.h"
+#include "EZCpu.h"
+#include <cmath>
+#ifdef EZ_X86
+#include <emmintrin.h>
+#endif
+
+// Sleeps usually wake up within this long on a quiet machine. The real figure is learned as the scheduler runs.
+constexpr UINT64 InitialSpinNanoseconds = 1000000;
+constexpr UINT64 MinimumSpinNanoseconds = 50000;
+
+EZ::FrameScheduler::FrameScheduler(EZ::FrameSchedulerSettings settings) {
+	_settings = settings;
+	if (_settings.MaxStepsPerFrame == 0) {
+		_settings.MaxStepsPerFrame = DefaultMaxStepsPerFrame;
+	}
+	if (_settings.Clock.Now == nullptr) {
+		_settings.Clock = EZ::GetSystemClock();
+	}
+	_framePeriod = _settings.MaximumFramerate == 0 ? 0 : 1000000000ull / _settings.MaximumFramerate;
+	_stepPeriod = _settings.StepRate == 0 ? 0 : 1000000000ull / _settings.StepRate;
+
+	_started = FALSE;
+	_frameStart = 0;
+	_nextFrame = 0;
+	_stepTime = 0;
+	_lastStepCheck = 0;
+	_spinNanoseconds = InitialSpinNanoseconds;
+
+	ResetStats();
+}
+UINT32 EZ::FrameScheduler::BeginFrame() {
+	UINT64 now = _settings.Clock.Now(_settings.Clock.Context);
+	if (!_started) {
+		// The first frame runs one step right away and starts the frame deadlines from now.
+		_started = TRUE;
+		_nextFrame = now;
+		_stepTime = _stepPeriod;
+		_lastStepCheck = now;
+	}
+	else {
+		UINT64 frameNanoseconds = now - _frameStart;
+		double frameMicroseconds = frameNanoseconds / 1000.0;
+		_stats.Frames++;
+		_frameSum += frameMicroseconds;
+		_frameSquareSum += frameMicroseconds * frameMicroseconds;
+		if (frameNanoseconds < _stats.MinFrameNanoseconds) {
+			_stats.MinFrameNanoseconds = frameNanoseconds;
+		}
+		if (frameNanoseconds > _stats.MaxFrameNanoseconds) {
+			_stats.MaxFrameNanoseconds = frameNanoseconds;
+		}
+	}
+	_frameStart = now;
+
+	if (_stepPeriod == 0) {
+		_stats.Steps++;
+		return 1;
+	}
+	_stepTime += now - _lastStepCheck;
+	_lastStepCheck = now;
+	UINT64 steps = _stepTime / _stepPeriod;
+	_stepTime -= steps * _stepPeriod;
+	if (steps > _settings.MaxStepsPerFrame) {
+		_stats.StepsDropped += steps - _settings.MaxStepsPerFrame;
+		steps = _settings.MaxStepsPerFrame;
+	}
+	_stats.Steps += steps;
+	return static_cast<UINT32>(steps);
+}
+void EZ::FrameScheduler::EndFrame() {
+	if (_framePeriod == 0 && _stepPeriod == 0) {
+		return;
+	}
+	UINT64 now = _settings.Clock.Now(_settings.Clock.Context);
+	UINT64 deadline = now;
+
+	if (_framePeriod != 0) {
+		if (now > _nextFrame + _framePeriod) {
+			// More than a whole frame behind. Start counting again from now instead of rushing frames out to catch up.
+			_nextFrame = now;
+		}
+		if (_nextFrame > deadline) {
+			deadline = _nextFrame;
+		}
+	}
+	if (_stepPeriod != 0) {
+		// Presenting again before the next step is due would show exactly the same frame.
+		UINT64 pending = _stepTime + (now - _lastStepCheck);
+		if (pending < _stepPeriod && now + (_stepPeriod - pending) > deadline) {
+			deadline = now + (_stepPeriod - pending);
+		}
+	}
+
+	WaitUntil(deadline);
+
+	if (_framePeriod != 0) {
+		// Advance from the deadline, not from when the wait returned, so lateness is made up next frame.
+		if (deadline > _nextFrame) {
+			_nextFrame = deadline;
+		}
+		_nextFrame += _framePeriod;
+	}
+}
+void EZ::FrameScheduler::WaitUntil(UINT64 deadline) {
+	UINT64 now = _settings.Clock.Now(_settings.Clock.Context);
+	if (deadline > now + _spinNanoseconds) {
+		UINT64 sleepNanoseconds = deadline - now - _spinNanoseconds;
+		_settings.Clock.Sleep(_settings.Clock.Context, sleepNanoseconds);
+
+		// Grow the spin right away when a sleep wakes up later than expected but shrink it slowly
+		// so one lucky sleep doesn't make the next frame late.
+		UINT64 woke = _settings.Clock.Now(_settings.Clock.Context);
+		UINT64 overshoot = woke > now + sleepNanoseconds ? woke - (now + sleepNanoseconds) : 0;
+		if (overshoot > _spinNanoseconds) {
+			_spinNanoseconds = overshoot;
+		}
+		else {
+			_spinNanoseconds -= (_spinNanoseconds - overshoot) / 16;
+		}
+		if (_spinNanoseconds < MinimumSpinNanoseconds) {
+			_spinNanoseconds = MinimumSpinNanoseconds;
+		}
+		if (_framePeriod != 0 && _spinNanoseconds > _framePeriod) {
+			_spinNanoseconds = _framePeriod;
+		}
+		now = woke;
+	}
+	while (now < deadline) {
+#ifdef EZ_X86
+		_mm_pause();
+#endif
+		now = _settings.Clock.Now(_settings.Clock.Context);
+	}
+
+	if (now - deadline > _stats.MaxWakeLatenessNanoseconds) {
+		_stats.MaxWakeLatenessNanoseconds = now - deadline;
+	}
+}
+void EZ::FrameScheduler::ResetStats() {
+	_stats = { };
+	_stats.MinFrameNanoseconds = ~0ull;
+	_frameSum = 0.0;
+	_frameSquareSum = 0.0;
+}
+EZ::FrameScheduler::~FrameScheduler() {
+	_started = FALSE;
+}
+
+EZ::FrameStats EZ::FrameScheduler::GetStats() const {
+	EZ::FrameStats stats = _stats;
+	if (stats.Frames == 0) {
+		stats.MinFrameNanoseconds = 0;
+		return stats;
+	}
+	double mean = _frameSum / stats.Frames;
+	double variance = (_frameSquareSum / stats.Frames) - (mean * mean);
+	stats.MeanFrameNanoseconds = static_cast<UINT64>(mean * 1000.0);
+	stats.JitterNanoseconds = variance > 0.0 ? static_cast<UINT64>(std::sqrt(variance) * 1000.0) : 0;
+	return stats;
+}
+EZ::FrameSchedulerSettings EZ::FrameScheduler::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
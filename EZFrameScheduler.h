@@ -0,0 +1,78 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZClock.h"
+
+namespace EZ {
+	// The most fixed steps BeginFrame hands out at once by default.
+	// After a long stall anything beyond this is dropped rather than run all at once.
+	constexpr UINT32 DefaultMaxStepsPerFrame = 4;
+	struct FrameSchedulerSettings {
+		// The maximum number of frames presented per second. 0 means frames are not capped.
+		UINT32 MaximumFramerate;
+		// The number of fixed steps per second, independent of how often frames are presented.
+		// If StepRate == 0 then every frame runs exactly one step.
+		UINT32 StepRate;
+		// If MaxStepsPerFrame == 0 then DefaultMaxStepsPerFrame is used.
+		UINT32 MaxStepsPerFrame;
+		// If Clock.Now == nullptr then EZ::GetSystemClock() is used.
+		// A fake clock must move time forward in Sleep and a little on every Now because waits spin on Now.
+		EZ::Clock Clock;
+	};
+	struct FrameStats {
+		// Number of frames measured. The first frame has no previous frame so it is never measured.
+		UINT64 Frames;
+		// Mean and standard deviation of the time from the start of one frame to the start of the next.
+		// The standard deviation is the frame time jitter.
+		UINT64 MeanFrameNanoseconds;
+		UINT64 JitterNanoseconds;
+		UINT64 MinFrameNanoseconds;
+		UINT64 MaxFrameNanoseconds;
+		// The latest any wait returned after the time it was waiting for.
+		UINT64 MaxWakeLatenessNanoseconds;
+		// Total fixed steps handed out and steps thrown away because too many were due at once.
+		UINT64 Steps;
+		UINT64 StepsDropped;
+	};
+	// Paces a loop which steps a simulation at a fixed rate and presents frames at most MaximumFramerate times a second.
+	// Each loop calls BeginFrame, runs the steps it returns, presents and then calls EndFrame which waits out the rest
+	// of the frame. Waits sleep until shortly before the deadline and spin for the rest, where the spin is sized from how
+	// late sleeps have been waking up, so an idle loop uses almost no CPU but frames still start on time.
+	// Deadlines are advanced by exactly one frame period rather than from when the frame finished so
+	// small errors don't add up into drift.
+	class FrameScheduler {
+	public:
+		FrameScheduler(EZ::FrameSchedulerSettings settings);
+		// Returns the number of fixed steps which are due. This can be 0 if frames are presented faster than StepRate.
+		UINT32 BeginFrame();
+		// Waits until the next frame should begin. Returns right away if neither MaximumFramerate nor StepRate is set.
+		void EndFrame();
+		// Clears the statistics returned by GetStats.
+		void ResetStats();
+		~FrameScheduler();
+
+		EZ::FrameStats GetStats() const;
+		EZ::FrameSchedulerSettings GetSettings() const;
+
+	private:
+		// Sleeps then spins until the clock reads deadline.
+		void WaitUntil(UINT64 deadline);
+
+		EZ::FrameSchedulerSettings _settings;
+		UINT64 _framePeriod;
+		UINT64 _stepPeriod;
+		BOOL _started;
+		// Time the current frame began and when the next one may begin.
+		UINT64 _frameStart;
+		UINT64 _nextFrame;
+		// Time not yet used up by steps. Always less than one step period after BeginFrame.
+		UINT64 _stepTime;
+		UINT64 _lastStepCheck;
+		// Estimate of how late a sleep wakes up. Waits stop sleeping this long before the deadline and spin instead.
+		UINT64 _spinNanoseconds;
+
+		EZ::FrameStats _stats;
+		// Running sums for the mean and standard deviation of the frame time, in microseconds to avoid overflow.
+		double _frameSum;
+		double _frameSquareSum;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "EZGeometry.h"
+
+D2D1_RECT_F EZ::RectF(FLOAT x, FLOAT y, FLOAT width, FLOAT height) {
+	return { x, y + height, x + width, y };
+}
+D2D1_RECT_L EZ::RectL(INT32 x, INT32 y, INT32 width, INT32 height) {
+	return { x, y + height, x + width, y };
+}
+D2D1_RECT_U EZ::RectU(UINT32 x, UINT32 y, UINT32 width, UINT32 height) {
+	return { x, y + height, x + width, y };
+}
+D2D1_RECT_F EZ::TransformRect(D2D1_RECT_L source, D2D1_SIZE_F dipSize, D2D1_SIZE_U pixelSize) {
+	FLOAT left = (static_cast<FLOAT>(source.left) * dipSize.width) / pixelSize.width;
+	FLOAT top = dipSize.height - ((static_cast<FLOAT>(source.top) * dipSize.height) / pixelSize.height);
+	FLOAT right = (static_cast<FLOAT>(source.right) * dipSize.width) / pixelSize.width;
+	FLOAT bottom = dipSize.height - ((static_cast<FLOAT>(source.bottom) * dipSize.height) / pixelSize.height);
+	return { left, top, right, bottom };
+}
\ No newline at end of file
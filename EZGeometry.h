@@ -0,0 +1,71 @@
+// EZGeometry holds the rect helpers and the pixel to DIP math EZ::Renderer uses so they can be used and measured
+// without Direct2D. On Windows the rect, size and color types come from D2D1.h. On every other platform they are declared
+// here with the same layouts so code written against them compiles unchanged.
+
+#pragma once
+#include "EZPlatform.h"
+#ifdef _WIN32
+#include <D2D1.h>
+#else
+typedef int32_t LONG;
+
+struct D2D_RECT_F {
+	FLOAT left;
+	FLOAT top;
+	FLOAT right;
+	FLOAT bottom;
+};
+struct D2D_RECT_L {
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+};
+struct D2D_RECT_U {
+	UINT32 left;
+	UINT32 top;
+	UINT32 right;
+	UINT32 bottom;
+};
+struct D2D_SIZE_F {
+	FLOAT width;
+	FLOAT height;
+};
+struct D2D_SIZE_U {
+	UINT32 width;
+	UINT32 height;
+};
+struct D2D_POINT_2L {
+	LONG x;
+	LONG y;
+};
+struct D2D_COLOR_F {
+	FLOAT r;
+	FLOAT g;
+	FLOAT b;
+	FLOAT a;
+};
+typedef D2D_RECT_F D2D1_RECT_F;
+typedef D2D_RECT_L D2D1_RECT_L;
+typedef D2D_RECT_U D2D1_RECT_U;
+typedef D2D_SIZE_F D2D1_SIZE_F;
+typedef D2D_SIZE_U D2D1_SIZE_U;
+typedef D2D_POINT_2L D2D1_POINT_2L;
+typedef D2D_COLOR_F D2D1_COLOR_F;
+#endif
+
+namespace EZ {
+	// The size EZ::Renderer and EZ::SoftwareRenderer give their buffers unless told otherwise.
+	constexpr UINT32 DefaultRendererWidth = 256;
+	constexpr UINT32 DefaultRendererHeight = 144;
+	// These methods allow users to create rects with x, y, width, and height instead of left, top, right, and bottom.
+	// Like the rest of EZ, y counts up from the bottom so top is y + height and bottom is y.
+	D2D1_RECT_F RectF(FLOAT x, FLOAT y, FLOAT width, FLOAT height);
+	D2D1_RECT_L RectL(INT32 x, INT32 y, INT32 width, INT32 height);
+	D2D1_RECT_U RectU(UINT32 x, UINT32 y, UINT32 width, UINT32 height);
+	// Converts a rectangle which is in pixel space and defines a 2d rectangular area on a texture or render target
+	// into a rectangle that is in dip space and represents the same area but with DPI accounted for.
+	// Additionally accounts for the spacial shift in y axis between game engines and text/renderring engines.
+	// Finally uses the size of the texture/render target in both pixels and DIPs to preform scaling.
+	D2D1_RECT_F TransformRect(D2D1_RECT_L source, D2D1_SIZE_F dipSize, D2D1_SIZE_U pixelSize);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "EZLifecycle.h"
+
+constexpr UINT64 ResizePendingBit = 1ull << 63;
+
+EZ::Lifecycle::Lifecycle() {
+	_stage.store(static_cast<BYTE>(EZ::LifecycleStage::Created));
+}
+EZ::LifecycleStage EZ::Lifecycle::Advance(EZ::LifecycleStage stage) {
+	// Changing the stage under the lock means a waiter can't check the stage, miss the change and then sleep forever.
+	std::lock_guard<std::mutex> lock(_mutex);
+	BYTE previous = _stage.load(std::memory_order_relaxed);
+	if (static_cast<BYTE>(stage) > previous) {
+		_stage.store(static_cast<BYTE>(stage), std::memory_order_release);
+		_changed.notify_all();
+	}
+	return static_cast<EZ::LifecycleStage>(previous);
+}
+EZ::LifecycleStage EZ::Lifecycle::WaitFor(EZ::LifecycleStage stage) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [this, stage]() { return _stage.load(std::memory_order_relaxed) >= static_cast<BYTE>(stage); });
+	return static_cast<EZ::LifecycleStage>(_stage.load(std::memory_order_relaxed));
+}
+EZ::Lifecycle::~Lifecycle() {
+	_stage.store(static_cast<BYTE>(EZ::LifecycleStage::Destroyed));
+}
+
+EZ::LifecycleStage EZ::Lifecycle::GetStage() const {
+	return static_cast<EZ::LifecycleStage>(_stage.load(std::memory_order_acquire));
+}
+
+EZ::ResizeMailbox::ResizeMailbox() {
+	_slot.store(0);
+}
+void EZ::ResizeMailbox::Post(UINT32 width, UINT32 height) {
+	_slot.store(ResizePendingBit | (static_cast<UINT64>(width & 0x7FFFFFFF) << 32) | height, std::memory_order_release);
+}
+BOOL EZ::ResizeMailbox::Take(UINT32* width, UINT32* height) {
+	// Cheap check first so an empty mailbox costs a plain load rather than a locked exchange every frame.
+	if (_slot.load(std::memory_order_relaxed) == 0) {
+		return FALSE;
+	}
+	UINT64 slot = _slot.exchange(0, std::memory_order_acquire);
+	if (slot == 0) {
+		return FALSE;
+	}
+	*width = static_cast<UINT32>((slot & ~ResizePendingBit) >> 32);
+	*height = static_cast<UINT32>(slot);
+	return TRUE;
+}
+EZ::ResizeMailbox::~ResizeMailbox() {
+	_slot.store(0);
+}
+
+BOOL EZ::ResizeMailbox::IsPending() const {
+	return _slot.load(std::memory_order_relaxed) != 0;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include "EZPlatform.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace EZ {
+	// The stages an EZ::Program goes through, in order.
+	enum class LifecycleStage : BYTE {
+		// The program object exists but its window does not yet.
+		Created = 0,
+		// The window thread created the window and is waiting for Run.
+		WindowReady = 1,
+		// Run was called and the game loop is going.
+		Running = 2,
+		// The window was closed so the game loop stops.
+		Closed = 3,
+		// The program is being deleted so the window thread cleans up and exits.
+		Destroyed = 4,
+	};
+	// A stage which threads can read without locking and wait on without spinning.
+	// Stages only ever move forward so a late Advance to an earlier stage does nothing.
+	class Lifecycle {
+	public:
+		Lifecycle();
+		// Moves to stage if it is later than the current stage and wakes every thread waiting on it.
+		// Returns the stage from before the call.
+		EZ::LifecycleStage Advance(EZ::LifecycleStage stage);
+		// Blocks until the current stage is stage or later and returns the current stage.
+		EZ::LifecycleStage WaitFor(EZ::LifecycleStage stage);
+		~Lifecycle();
+
+		// Returns the current stage without locking. Cheap enough to check every frame.
+		EZ::LifecycleStage GetStage() const;
+
+	private:
+		std::atomic<BYTE> _stage;
+		std::mutex _mutex;
+		std::condition_variable _changed;
+	};
+	// Hands a window size from the thread receiving WM_SIZE to the thread that owns the renderer.
+	// Only the newest size is kept because resizing to a size the window already left is wasted work.
+	// Post and Take never lock or wait so the window thread keeps pumping messages while the render loop is busy.
+	class ResizeMailbox {
+	public:
+		ResizeMailbox();
+		// Replaces any size which has not been taken yet. width and height must fit in 31 bits.
+		void Post(UINT32 width, UINT32 height);
+		// Returns TRUE and empties the mailbox if a size was posted since the last Take. Else returns FALSE.
+		BOOL Take(UINT32* width, UINT32* height);
+		~ResizeMailbox();
+
+		BOOL IsPending() const;
+
+	private:
+		// 0 when empty. Else bit 63 is set, bits 32 to 62 hold the width and bits 0 to 31 hold the height.
+		// Packing both into one word means a reader can never see the width of one resize with the height of another.
+		std::atomic<UINT64> _slot;
+	};
+}
\ No newline at end of file
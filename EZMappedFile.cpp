@@ -0,0 +1,113 @@
+#include "EZMappedFile.h"
+#include "EZError.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+EZ::MappedFile::MappedFile(LPCSTR filePath) {
+	_data = nullptr;
+	_size = 0;
+#ifdef _WIN32
+	_file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (_file == INVALID_HANDLE_VALUE) {
+		EZ::Error::ThrowFromLastError();
+	}
+	LARGE_INTEGER size = { };
+	if (!GetFileSizeEx(_file, &size)) {
+		CloseHandle(_file);
+		EZ::Error::ThrowFromLastError();
+	}
+	_size = static_cast<UINT64>(size.QuadPart);
+	_mapping = NULL;
+	if (_size == 0) {
+		// Windows refuses to map an empty file.
+		return;
+	}
+	_mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (_mapping == NULL) {
+		CloseHandle(_file);
+		EZ::Error::ThrowFromLastError();
+	}
+	_data = reinterpret_cast<const BYTE*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr) {
+		CloseHandle(_mapping);
+		CloseHandle(_file);
+		EZ::Error::ThrowFromLastError();
+	}
+#else
+	_file = open(filePath, O_RDONLY);
+	if (_file < 0) {
+		throw EZ::Error("Failed to open the file to map.");
+	}
+	struct stat status = { };
+	if (fstat(_file, &status) != 0) {
+		close(_file);
+		throw EZ::Error("Failed to read the size of the file to map.");
+	}
+	_size = static_cast<UINT64>(status.st_size);
+	if (_size == 0) {
+		return;
+	}
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED) {
+		close(_file);
+		throw EZ::Error("Failed to map the file.");
+	}
+	_data = reinterpret_cast<const BYTE*>(data);
+#endif
+}
+BYTE* EZ::MappedFile::MapCopyOnWrite(UINT64 offset, UINT64 size) const {
+	if (size == 0 || offset % MappingAlignment != 0 || offset > _size || size > _size - offset) {
+		throw EZ::Error("The copy on write view must be a non empty aligned range of the file.");
+	}
+#ifdef _WIN32
+	// FILE_MAP_COPY views of a PAGE_READONLY mapping are exactly copy on write.
+	void* view = MapViewOfFile(_mapping, FILE_MAP_COPY, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), static_cast<SIZE_T>(size));
+	if (view == nullptr) {
+		EZ::Error::ThrowFromLastError();
+	}
+#else
+	// A private writable mapping of a file opened read only is copy on write.
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _file, static_cast<off_t>(offset));
+	if (view == MAP_FAILED) {
+		throw EZ::Error("Failed to map a copy on write view of the file.");
+	}
+#endif
+	return reinterpret_cast<BYTE*>(view);
+}
+void EZ::MappedFile::UnmapCopyOnWrite(BYTE* view, UINT64 size) {
+#ifdef _WIN32
+	(void)size;
+	UnmapViewOfFile(view);
+#else
+	munmap(view, size);
+#endif
+}
+EZ::MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping != NULL) {
+		CloseHandle(_mapping);
+	}
+	CloseHandle(_file);
+#else
+	if (_data != nullptr) {
+		munmap(const_cast<BYTE*>(_data), _size);
+	}
+	close(_file);
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+
+const BYTE* EZ::MappedFile::GetData() const {
+	return _data;
+}
+UINT64 EZ::MappedFile::GetSize() const {
+	return _size;
+}
\ No newline at end of file
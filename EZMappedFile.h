@@ -0,0 +1,39 @@
+#pragma once
+#include "EZPlatform.h"
+
+namespace EZ {
+	// Views are placed at offsets which are a multiple of this. It is the Windows allocation granularity, which is
+	// also a multiple of the page size everywhere else.
+	constexpr UINT64 MappingAlignment = 0x10000;
+	// Maps a whole file into memory read only. Pages are read from disk the first time they are touched
+	// and are shared by every process mapping the same file, so opening a large file costs almost nothing.
+	class MappedFile {
+	public:
+		// Throws an EZ::Error if the file can't be opened or mapped.
+		MappedFile(LPCSTR filePath);
+
+		// Maps size bytes of the file starting at offset a second time, writable. Pages of the view stay shared with every
+		// other mapping of the file until they are first written, at which point the writer gets a private copy of that
+		// page. Writes never reach the file. offset must be a multiple of MappingAlignment.
+		// Every call returns a separate view which must be given back to UnmapCopyOnWrite with the same size.
+		// Throws an EZ::Error if the range is outside the file or can't be mapped.
+		BYTE* MapCopyOnWrite(UINT64 offset, UINT64 size) const;
+		static void UnmapCopyOnWrite(BYTE* view, UINT64 size);
+		~MappedFile();
+
+		// Returns nullptr if the file is empty.
+		const BYTE* GetData() const;
+		UINT64 GetSize() const;
+
+	private:
+		const BYTE* _data;
+		UINT64 _size;
+#ifdef _WIN32
+		HANDLE _file;
+		HANDLE _mapping;
+#else
+		// Kept open so MapCopyOnWrite can map the file again.
+		int _file;
+#endif
+	};
+}
\ No newline at end of file
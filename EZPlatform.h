@@ -0,0 +1,39 @@
+// EZPlatform lets the portable parts of EZ and Tiny compile without the Windows SDK.
+// On Windows it simply includes Windows.h. On every other platform it declares the handful of
+// Win32 types those files use with the same sizes and meanings Windows gives them.
+// NOTE: Windows.h defines min and max as macros so portable code should write (std::min)(a, b).
+
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstddef>
+#include <cstdint>
+
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int BOOL;
+typedef float FLOAT;
+typedef int8_t INT8;
+typedef int16_t INT16;
+typedef uint16_t UINT16;
+typedef int32_t INT32;
+typedef uint32_t UINT32;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef int64_t LONGLONG;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef const char* LPCSTR;
+typedef char* LPSTR;
+typedef const wchar_t* LPCWSTR;
+typedef wchar_t* LPWSTR;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+#endif
\ No newline at end of file
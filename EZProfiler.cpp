@@ -1,27 +1,318 @@
 #include "EZProfiler.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+
+// Each thread can hold this many uncollected scopes. At 60 FPS that is far more than any thread records per frame.
+constexpr UINT32 ScopeRingCapacity = 4096;
+// Tracing stops keeping scopes past this many so a forgotten trace can't use up all memory.
+constexpr size_t MaxTraceEvents = 1 << 20;
+
+namespace {
+	struct ScopeRecord {
+		const char* Name;
+		UINT64 Start;
+		UINT64 End;
+	};
+	// Scopes recorded by one thread. The thread is the only producer and whoever calls Collect is the only consumer
+	// so Head and Tail are enough to hand records over without a lock.
+	struct ScopeRing {
+		UINT32 ThreadIndex;
+		std::atomic<UINT64> Head;
+		std::atomic<UINT64> Tail;
+		std::atomic<UINT64> Dropped;
+		ScopeRecord Records[ScopeRingCapacity];
+	};
+	// Every thread which ever recorded a scope. Rings are never freed because a thread may exit at any moment
+	// and the records it left behind still need collecting. Threads are few so this is a handful of kilobytes.
+	struct ScopeRegistry {
+		std::mutex Mutex;
+		std::vector<ScopeRing*> Rings;
+		std::atomic<UINT32> ActiveProfilers;
+	};
+	ScopeRegistry& GetRegistry() {
+		static ScopeRegistry registry;
+		return registry;
+	}
+	ScopeRing* GetThreadRing() {
+		thread_local ScopeRing* ring = nullptr;
+		if (ring == nullptr) {
+			ScopeRing* newRing = new ScopeRing();
+			newRing->Head.store(0);
+			newRing->Tail.store(0);
+			newRing->Dropped.store(0);
+			ScopeRegistry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.Mutex);
+			newRing->ThreadIndex = static_cast<UINT32>(registry.Rings.size()) + 1;
+			registry.Rings.push_back(newRing);
+			ring = newRing;
+		}
+		return ring;
+	}
+	UINT32 HighestBit(UINT64 value) {
+		UINT32 bit = 0;
+		for (UINT32 shift = 32; shift > 0; shift >>= 1) {
+			if (value >> shift) {
+				value >>= shift;
+				bit += shift;
+			}
+		}
+		return bit;
+	}
+}
+
+EZ::Histogram::Histogram() {
+	Reset();
+}
+UINT32 EZ::Histogram::IndexOf(UINT64 value) {
+	// Values below 2 * HistogramSubBuckets get a bucket each. Above that each power of 2 is split into
+	// HistogramSubBuckets buckets using the bits just below the highest one.
+	if (value < 2 * HistogramSubBuckets) {
+		return static_cast<UINT32>(value);
+	}
+	UINT32 shift = HighestBit(value) - 6;
+	return ((shift + 1) * HistogramSubBuckets) + static_cast<UINT32>((value >> shift) - HistogramSubBuckets);
+}
+UINT64 EZ::Histogram::HighestValueAt(UINT32 index) {
+	if (index < 2 * HistogramSubBuckets) {
+		return index;
+	}
+	UINT32 shift = (index / HistogramSubBuckets) - 1;
+	UINT64 subBucket = index % HistogramSubBuckets;
+	return ((HistogramSubBuckets + subBucket + 1) << shift) - 1;
+}
+void EZ::Histogram::Record(UINT64 value) {
+	_counts[IndexOf(value)]++;
+	_count++;
+	_sum += static_cast<double>(value);
+	if (value < _min) {
+		_min = value;
+	}
+	if (value > _max) {
+		_max = value;
+	}
+}
+void EZ::Histogram::Merge(const EZ::Histogram& other) {
+	for (UINT32 i = 0; i < HistogramBucketCount; i++) {
+		_counts[i] += other._counts[i];
+	}
+	_count += other._count;
+	_sum += other._sum;
+	if (other._min < _min) {
+		_min = other._min;
+	}
+	if (other._max > _max) {
+		_max = other._max;
+	}
+}
+void EZ::Histogram::Reset() {
+	memset(_counts, 0, sizeof(_counts));
+	_count = 0;
+	_sum = 0.0;
+	_min = ~0ull;
+	_max = 0;
+}
+EZ::Histogram::~Histogram() {
+	_count = 0;
+}
+
+UINT64 EZ::Histogram::GetPercentile(double percentile) const {
+	if (_count == 0) {
+		return 0;
+	}
+	UINT64 target = static_cast<UINT64>((percentile / 100.0) * _count + 0.5);
+	if (target < 1) {
+		target = 1;
+	}
+	UINT64 seen = 0;
+	for (UINT32 i = 0; i < HistogramBucketCount; i++) {
+		seen += _counts[i];
+		if (seen >= target) {
+			UINT64 value = HighestValueAt(i);
+			return value < _max ? value : _max;
+		}
+	}
+	return _max;
+}
+UINT64 EZ::Histogram::GetCount() const {
+	return _count;
+}
+UINT64 EZ::Histogram::GetMin() const {
+	return _count == 0 ? 0 : _min;
+}
+UINT64 EZ::Histogram::GetMax() const {
+	return _max;
+}
+UINT64 EZ::Histogram::GetMean() const {
+	return _count == 0 ? 0 : static_cast<UINT64>(_sum / _count);
+}
+
+EZ::ProfileScope::ProfileScope(const char* name) {
+	_name = name;
+	_start = 0;
+	if (GetRegistry().ActiveProfilers.load(std::memory_order_relaxed) != 0) {
+		_start = EZ::GetNanoseconds();
+	}
+}
+EZ::ProfileScope::~ProfileScope() {
+	if (_start == 0) {
+		return;
+	}
+	UINT64 end = EZ::GetNanoseconds();
+	ScopeRing* ring = GetThreadRing();
+	UINT64 head = ring->Head.load(std::memory_order_relaxed);
+	if (head - ring->Tail.load(std::memory_order_acquire) >= ScopeRingCapacity) {
+		ring->Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	ring->Records[head % ScopeRingCapacity] = { _name, _start, end };
+	ring->Head.store(head + 1, std::memory_order_release);
+}
 
 EZ::Profiler::Profiler(LONGLONG interval) {
 	_interval = interval;
 	_frameCount = 0;
-	_lastLogTicks = 0;
-	QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&_lastLogTicks));
+	_startNanoseconds = EZ::GetNanoseconds();
+	_lastTickNanoseconds = _startNanoseconds;
+	_lastLogNanoseconds = _startNanoseconds;
+
+	_frameTotal = new EZ::Histogram();
+	_frameInterval = new EZ::Histogram();
+
+	_tracing = FALSE;
+	_droppedScopes = 0;
+
+	GetRegistry().ActiveProfilers.fetch_add(1);
 }
 void EZ::Profiler::Tick() {
+	UINT64 now = EZ::GetNanoseconds();
+	_frameTotal->Record(now - _lastTickNanoseconds);
+	_frameInterval->Record(now - _lastTickNanoseconds);
+	_lastTickNanoseconds = now;
+	Collect();
+
 	_frameCount++;
-	if (_frameCount > _interval) {
-		LONGLONG _ticksNow;
-		QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&_ticksNow));
-		LONGLONG elapsedTicks = _ticksNow - _lastLogTicks;
-		LONGLONG TPF = elapsedTicks / _frameCount;
-		LONGLONG FPS = (10000000 * _frameCount) / elapsedTicks;
-		std::cout << "FPS: " << FPS << " TPF: " << TPF << std::endl;
-		_lastLogTicks = _ticksNow;
+	if (_interval > 0 && _frameCount >= _interval) {
+		UINT64 elapsed = now - _lastLogNanoseconds;
+		std::cout << "FPS: " << ((1000000000.0 * _frameCount) / elapsed) << std::endl;
+		PrintHistogram("Frame", *_frameInterval);
+		for (ScopeStats& scope : _scopes) {
+			PrintHistogram(scope.Name, *scope.Interval);
+			scope.Interval->Reset();
+		}
+		_frameInterval->Reset();
+		_lastLogNanoseconds = now;
 		_frameCount = 0;
 	}
 }
+void EZ::Profiler::Collect() {
+	ScopeRegistry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	for (ScopeRing* ring : registry.Rings) {
+		UINT64 tail = ring->Tail.load(std::memory_order_relaxed);
+		UINT64 head = ring->Head.load(std::memory_order_acquire);
+		for (UINT64 i = tail; i < head; i++) {
+			const ScopeRecord& record = ring->Records[i % ScopeRingCapacity];
+			ScopeStats& scope = FindScope(record.Name);
+			scope.Total->Record(record.End - record.Start);
+			scope.Interval->Record(record.End - record.Start);
+			if (_tracing && _trace.size() < MaxTraceEvents) {
+				_trace.push_back({ record.Name, record.Start, record.End, ring->ThreadIndex });
+			}
+		}
+		ring->Tail.store(head, std::memory_order_release);
+		_droppedScopes += ring->Dropped.exchange(0, std::memory_order_relaxed);
+	}
+}
+EZ::Profiler::ScopeStats& EZ::Profiler::FindScope(const char* name) {
+	// Scopes are nearly always string literals so comparing pointers finds them without touching the strings.
+	for (ScopeStats& scope : _scopes) {
+		if (scope.Name == name) {
+			return scope;
+		}
+	}
+	for (ScopeStats& scope : _scopes) {
+		if (strcmp(scope.Name, name) == 0) {
+			return scope;
+		}
+	}
+	_scopes.push_back({ name, new EZ::Histogram(), new EZ::Histogram() });
+	return _scopes.back();
+}
+void EZ::Profiler::StartTrace() {
+	Collect();
+	_trace.clear();
+	_tracing = TRUE;
+}
+void EZ::Profiler::StopTrace() {
+	Collect();
+	_tracing = FALSE;
+}
+BOOL EZ::Profiler::WriteChromeTrace(LPCSTR filePath) const {
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file) {
+		return FALSE;
+	}
+	// Complete events ("ph":"X") carry their own start and duration in microseconds.
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < _trace.size(); i++) {
+		const TraceEvent& event = _trace[i];
+		file << "{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.ThreadIndex
+			<< ",\"ts\":" << ((event.Start - _startNanoseconds) / 1000.0) << ",\"dur\":" << ((event.End - event.Start) / 1000.0) << "}"
+			<< (i + 1 < _trace.size() ? ",\n" : "\n");
+	}
+	file << "],\"displayTimeUnit\":\"ms\"}\n";
+	file.close();
+	return !file.fail();
+}
+void EZ::Profiler::PrintReport() const {
+	PrintHistogram("Frame", *_frameTotal);
+	for (const ScopeStats& scope : _scopes) {
+		PrintHistogram(scope.Name, *scope.Total);
+	}
+	if (_droppedScopes != 0) {
+		std::cout << "Dropped scopes: " << _droppedScopes << std::endl;
+	}
+}
+void EZ::Profiler::PrintHistogram(const char* name, const EZ::Histogram& histogram) {
+	if (histogram.GetCount() == 0) {
+		return;
+	}
+	std::cout << name << " (us) count: " << histogram.GetCount()
+		<< " p50: " << (histogram.GetPercentile(50.0) / 1000.0)
+		<< " p99: " << (histogram.GetPercentile(99.0) / 1000.0)
+		<< " p99.9: " << (histogram.GetPercentile(99.9) / 1000.0)
+		<< " max: " << (histogram.GetMax() / 1000.0) << std::endl;
+}
 EZ::Profiler::~Profiler() {
+	GetRegistry().ActiveProfilers.fetch_sub(1);
+
+	delete _frameTotal;
+	delete _frameInterval;
+	for (ScopeStats& scope : _scopes) {
+		delete scope.Total;
+		delete scope.Interval;
+	}
+	_scopes.clear();
 	_interval = 0;
 	_frameCount = 0;
-	_lastLogTicks = 0;
+}
+
+const EZ::Histogram& EZ::Profiler::GetFrameHistogram() const {
+	return *_frameTotal;
+}
+const EZ::Histogram* EZ::Profiler::GetScopeHistogram(const char* name) const {
+	for (const ScopeStats& scope : _scopes) {
+		if (scope.Name == name || strcmp(scope.Name, name) == 0) {
+			return scope.Total;
+		}
+	}
+	return nullptr;
+}
+UINT64 EZ::Profiler::GetDroppedScopeCount() const {
+	return _droppedScopes;
 }
\ No newline at end of file
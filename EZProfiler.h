@@ -1,16 +1,117 @@
 #pragma once
-#include <Windows.h>
+#include "EZPlatform.h"
+#include "EZClock.h"
+#include <vector>
 
 namespace EZ {
+	// Values are grouped by their highest bit and then split into this many equal sub buckets,
+	// so every value is stored to within 1/64 of itself no matter how large it is.
+	constexpr UINT32 HistogramSubBuckets = 64;
+	// Enough buckets to hold any UINT64.
+	constexpr UINT32 HistogramBucketCount = HistogramSubBuckets * 59;
+	// Counts how often each value was recorded with a fixed relative precision like an HDR histogram.
+	// Recording is a few instructions and the memory used does not grow with the number of values.
+	class Histogram {
+	public:
+		Histogram();
+		void Record(UINT64 value);
+		// Adds every value recorded in other to this histogram.
+		void Merge(const EZ::Histogram& other);
+		void Reset();
+		~Histogram();
+
+		// Returns the smallest value which at least percentile percent of the recorded values are at or below.
+		// The result is rounded up to the top of its sub bucket but never above GetMax().
+		// Returns 0 if nothing was recorded.
+		UINT64 GetPercentile(double percentile) const;
+		UINT64 GetCount() const;
+		UINT64 GetMin() const;
+		UINT64 GetMax() const;
+		UINT64 GetMean() const;
+
+	private:
+		static UINT32 IndexOf(UINT64 value);
+		static UINT64 HighestValueAt(UINT32 index);
+
+		UINT64 _counts[HistogramBucketCount];
+		UINT64 _count;
+		double _sum;
+		UINT64 _min;
+		UINT64 _max;
+	};
+
+	// Times the enclosing block and records it under name for whichever Profiler exists.
+	// For example { EZ::ProfileScope scope("Upload"); ... } shows up as Upload in the log and in traces.
+	// name is stored as a pointer so it must be a string literal or otherwise live as long as the program.
+	// Each thread records into its own lock free buffer so scopes on different threads never contend.
+	// If no Profiler exists a scope does nothing beyond one relaxed atomic load.
+	class ProfileScope {
+	public:
+		ProfileScope(const char* name);
+		~ProfileScope();
+
+	private:
+		const char* _name;
+		UINT64 _start;
+	};
+
+	// Measures frame times and the time spent in every ProfileScope.
+	// Only one Profiler should exist at a time because all Profilers share the per thread scope buffers.
 	class Profiler {
 	public:
+		// Every interval frames Tick prints the FPS along with the median, 99th, 99.9th percentile and worst
+		// time of frames and of every scope over those frames. If interval == 0 Tick never prints.
 		Profiler(LONGLONG interval = 120);
+		// Marks the end of a frame. Records the time since the last Tick and collects scopes from every thread.
 		void Tick();
+		// Collects the scopes every thread recorded since the last Collect. Tick calls this.
+		// Call it directly when measuring work which isn't split into frames.
+		void Collect();
+		// While tracing every collected scope is also kept so it can be written out with WriteChromeTrace.
+		void StartTrace();
+		void StopTrace();
+		// Writes the scopes kept while tracing as Chrome trace event JSON which chrome://tracing and Perfetto open.
+		// Returns FALSE if the file couldn't be written.
+		BOOL WriteChromeTrace(LPCSTR filePath) const;
+		// Prints percentiles of every frame and scope since this Profiler was created.
+		void PrintReport() const;
 		~Profiler();
 
+		// Frame times in nanoseconds since this Profiler was created.
+		const EZ::Histogram& GetFrameHistogram() const;
+		// Times in nanoseconds of the scope called name since this Profiler was created or nullptr if none were collected.
+		const EZ::Histogram* GetScopeHistogram(const char* name) const;
+		// Number of scopes thrown away because a thread filled its buffer before they were collected.
+		UINT64 GetDroppedScopeCount() const;
+
 	private:
+		struct ScopeStats {
+			const char* Name;
+			EZ::Histogram* Total;
+			EZ::Histogram* Interval;
+		};
+		struct TraceEvent {
+			const char* Name;
+			UINT64 Start;
+			UINT64 End;
+			UINT32 ThreadIndex;
+		};
+		ScopeStats& FindScope(const char* name);
+		// Prints one line of FPS or percentiles in microseconds.
+		static void PrintHistogram(const char* name, const EZ::Histogram& histogram);
+
 		LONGLONG _interval;
 		LONGLONG _frameCount;
-		LONGLONG _lastLogTicks;
+		UINT64 _startNanoseconds;
+		UINT64 _lastTickNanoseconds;
+		UINT64 _lastLogNanoseconds;
+
+		EZ::Histogram* _frameTotal;
+		EZ::Histogram* _frameInterval;
+		std::vector<ScopeStats> _scopes;
+
+		BOOL _tracing;
+		std::vector<TraceEvent> _trace;
+		UINT64 _droppedScopes;
 	};
 }
\ No newline at end of file
@@ -9,18 +9,18 @@ LRESULT CALLBACK EZ::Program::CustomWndProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 		return DefWindowProc(hwnd, uMsg, wParam, lParam);
 	}
 
-	if (uMsg == WM_CLOSE && program->_programSettings.IgnoreWMClose) {
+	EZ::LifecycleStage stage = program->_lifecycle.GetStage();
+	// Once the program is being deleted the window has to be allowed to close.
+	if (uMsg == WM_CLOSE && program->_programSettings.IgnoreWMClose && stage != EZ::LifecycleStage::Destroyed) {
 		return 0; // We do not care
 	}
 	if (uMsg == WM_SIZE && !program->_programSettings.DontResizeBuffer) {
 		UINT32 newWidth = static_cast<UINT32>(LOWORD(lParam));
 		UINT32 newHeight = static_cast<UINT32>(HIWORD(lParam));
-		program->_newSize = D2D1::SizeU(newWidth, newHeight);
-		program->_resizeRequested = TRUE;
-		while (program->_resizeRequested) {}
+		program->_resizeMailbox.Post(newWidth, newHeight);
 	}
 
-	if (program->_programSettings.WndProcCallback != nullptr && program->_state == EZ::Program::State::Running) {
+	if (program->_programSettings.WndProcCallback != nullptr && stage == EZ::LifecycleStage::Running) {
 		return program->_programSettings.WndProcCallback(program, hwnd, uMsg, wParam, lParam);
 	}
 	else {
@@ -43,11 +43,13 @@ EZ::Program::Program(EZ::ProgramSettings programSettings, EZ::ClassSettings clas
 	}
 	classSettings.WndProc = CustomWndProc;
 
-	_state = EZ::Program::State::Created;
-	_newSize = D2D1::SizeU(0, 0);
-	_resizeRequested = FALSE;
+	_needsFullRedraw = TRUE;
+	_pipeline = nullptr;
+	_pipelineStats = { };
+	_frontFrame = nullptr;
 
 	_profiler = nullptr;
+	_scheduler = nullptr;
 	_renderer = nullptr;
 	_window = nullptr;
 
@@ -60,93 +62,170 @@ EZ::Program::Program(EZ::ProgramSettings programSettings, EZ::ClassSettings clas
 		_profiler = new EZ::Profiler(_programSettings.PreformanceLogInterval);
 	}
 
-	std::thread windowThread([this, classSettings, windowSettings]() {
-		EZ::ClassSettings classSettingsCopy = classSettings;
-		EZ::WindowSettings windowSettingsCopy = windowSettings;
+	EZ::FrameSchedulerSettings schedulerSettings = { };
+	schedulerSettings.MaximumFramerate = _programSettings.MaximumFramerate;
+	schedulerSettings.StepRate = _programSettings.StepRate;
+	_scheduler = new EZ::FrameScheduler(schedulerSettings);
 
-		WCHAR* generatedClassName = NULL;
-		if (classSettingsCopy.Name == NULL) {
-			GUID guid;
-			CoCreateGuid(&guid);
+	_windowThread = std::thread(&EZ::Program::WindowMain, this, classSettings, windowSettings);
+	_lifecycle.WaitFor(EZ::LifecycleStage::WindowReady);
 
-			WCHAR guidString[39];
-			StringFromGUID2(guid, guidString, 39);
+	_renderer = new EZ::Renderer(_window->GetHandle(), rendererSettings);
 
-			generatedClassName = new WCHAR[57];
+	if (!_programSettings.DontResizeBuffer) {
+		RECT windowSize = {};
+		GetWindowRect(_window->GetHandle(), &windowSize);
+		D2D1_SIZE_U newSize = D2D1::SizeU(windowSize.right - windowSize.left, windowSize.bottom - windowSize.top);
+		_renderer->Resize(newSize);
+	}
+}
+void EZ::Program::WindowMain(EZ::ClassSettings classSettings, EZ::WindowSettings windowSettings) {
+	EZ::ClassSettings classSettingsCopy = classSettings;
+	EZ::WindowSettings windowSettingsCopy = windowSettings;
 
-			lstrcpy(generatedClassName, L"EZProgramAutoClass");
-			lstrcpy(&generatedClassName[18], guidString);
+	WCHAR* generatedClassName = NULL;
+	if (classSettingsCopy.Name == NULL) {
+		GUID guid;
+		CoCreateGuid(&guid);
 
-			classSettingsCopy.Name = generatedClassName;
-			windowSettingsCopy.ClassName = generatedClassName;
-		}
+		WCHAR guidString[39];
+		StringFromGUID2(guid, guidString, 39);
 
-		EZ::RegisterClass(classSettingsCopy);
+		generatedClassName = new WCHAR[57];
 
-		_window = new EZ::Window(windowSettingsCopy);
+		lstrcpy(generatedClassName, L"EZProgramAutoClass");
+		lstrcpy(&generatedClassName[18], guidString);
 
-		if (generatedClassName != NULL) {
-			delete[] generatedClassName;
-		}
+		classSettingsCopy.Name = generatedClassName;
+		windowSettingsCopy.ClassName = generatedClassName;
+	}
 
-		SetLastError(0);
-		SetWindowLongPtr(_window->GetHandle(), GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
-		if (GetLastError() != 0) {
-			EZ::Error::ThrowFromLastError();
-		}
+	EZ::RegisterClass(classSettingsCopy);
 
-		while (_state != EZ::Program::State::Running) {}
+	_window = new EZ::Window(windowSettingsCopy);
 
-		_window->Show();
-		_window->Run();
-
-		_state = EZ::Program::State::Closed;
+	if (generatedClassName != NULL) {
+		delete[] generatedClassName;
+	}
 
-		while (_state != EZ::Program::State::Destroyed) {}
+	SetLastError(0);
+	SetWindowLongPtr(_window->GetHandle(), GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+	if (GetLastError() != 0) {
+		EZ::Error::ThrowFromLastError();
+	}
 
-		delete _window;
-		});
-	windowThread.detach();
+	_lifecycle.Advance(EZ::LifecycleStage::WindowReady);
 
-	while (_window == nullptr) {}
+	// The program may be deleted without ever calling Run. Then the window is never shown.
+	if (_lifecycle.WaitFor(EZ::LifecycleStage::Running) == EZ::LifecycleStage::Running) {
+		_window->Show();
+		_window->Run();
+	}
 
-	_renderer = new EZ::Renderer(_window->GetHandle(), rendererSettings);
+	_lifecycle.Advance(EZ::LifecycleStage::Closed);
 
-	if (!_programSettings.DontResizeBuffer) {
-		RECT windowSize = {};
-		GetWindowRect(_window->GetHandle(), &windowSize);
-		D2D1_SIZE_U newSize = D2D1::SizeU(windowSize.right - windowSize.left, windowSize.bottom - windowSize.top);
-		_renderer->Resize(newSize);
-	}
+	// The window has to be deleted on the thread that created it but only once nothing else uses it.
+	_lifecycle.WaitFor(EZ::LifecycleStage::Destroyed);
+	delete _window;
 }
 void EZ::Program::Run() {
-	if (_state != EZ::Program::State::Created) {
+	if (_lifecycle.Advance(EZ::LifecycleStage::Running) != EZ::LifecycleStage::WindowReady) {
 		throw new Error("Program can only be ran once.");
 	}
 
-	_state = EZ::Program::State::Running;
+	if (_programSettings.PipelineFrameBytes != 0) {
+		EZ::FramePipelineSettings pipelineSettings = { };
+		pipelineSettings.FrameBytes = _programSettings.PipelineFrameBytes;
+		pipelineSettings.Context = this;
+		pipelineSettings.Present = PresentFrame;
+		_pipeline = new EZ::FramePipeline(pipelineSettings);
+	}
 
-	while (_state == EZ::Program::State::Running) {
-		if (_resizeRequested) {
-			_renderer->Resize(_newSize);
-			_resizeRequested = FALSE;
+	while (_lifecycle.GetStage() == EZ::LifecycleStage::Running) {
+		UINT32 steps = _scheduler->BeginFrame();
+		BOOL draw = TRUE;
+		if (_programSettings.StepCallback != nullptr) {
+			draw = FALSE;
+			for (UINT32 i = 0; i < steps; i++) {
+				if (_programSettings.StepCallback(this)) {
+					draw = TRUE;
+				}
+			}
 		}
 
-		_renderer->BeginDraw();
-		if (_programSettings.UpdateCallback != nullptr) {
-			_programSettings.UpdateCallback(this);
+		if (_pipeline != nullptr) {
+			// The presenter thread draws and presents while the next frame is stepped. A resize is taken there too
+			// since only that thread uses the renderer.
+			if (draw) {
+				_pipeline->Publish();
+			}
+			if (_resizeMailbox.IsPending()) {
+				_pipeline->Redraw();
+			}
+		}
+		else {
+			TakeResize();
+			if (draw || _needsFullRedraw) {
+				Draw();
+			}
 		}
-		_renderer->EndDraw();
 
 		if (!_programSettings.DontLogPreformace) {
 			_profiler->Tick();
 		}
+
+		EZ::ProfileScope scope("Wait");
+		_scheduler->EndFrame();
+	}
+
+	// Stop the presenter thread before anything it uses goes away.
+	if (_pipeline != nullptr) {
+		_pipelineStats = _pipeline->GetStats();
+		delete _pipeline;
+		_pipeline = nullptr;
+	}
+}
+void EZ::Program::PresentFrame(void* context, const BYTE* frame, UINT32 size) {
+	EZ::Program* program = reinterpret_cast<EZ::Program*>(context);
+	// Once the window closed there is nothing left to present to.
+	if (program->_lifecycle.GetStage() != EZ::LifecycleStage::Running) {
+		return;
+	}
+	program->_frontFrame = frame;
+	program->TakeResize();
+	program->Draw();
+}
+void EZ::Program::TakeResize() {
+	UINT32 newWidth = 0;
+	UINT32 newHeight = 0;
+	if (_resizeMailbox.Take(&newWidth, &newHeight)) {
+		_renderer->Resize(D2D1::SizeU(newWidth, newHeight));
+		_needsFullRedraw = TRUE;
+	}
+}
+void EZ::Program::Draw() {
+	_renderer->BeginDraw();
+	if (_programSettings.UpdateCallback != nullptr) {
+		_programSettings.UpdateCallback(this);
 	}
+	EZ::ProfileScope scope("Present");
+	_renderer->EndDraw();
+	_needsFullRedraw = FALSE;
 }
 EZ::Program::~Program() {
-	_state = EZ::Program::State::Destroyed;
-
+	// Release the renderer while its window still exists.
 	delete _renderer;
+
+	// If the window is still open ask it to close. Then wait for the window thread to delete it and exit
+	// so it never touches this Program after it is gone.
+	// The handle is read first because the window thread may delete _window as soon as the stage changes.
+	HWND windowHandle = _window->GetHandle();
+	if (_lifecycle.Advance(EZ::LifecycleStage::Destroyed) < EZ::LifecycleStage::Closed) {
+		PostMessage(windowHandle, WM_CLOSE, 0, 0);
+	}
+	_windowThread.join();
+
+	delete _scheduler;
 	if (!_programSettings.DontLogPreformace) {
 		delete _profiler;
 	}
@@ -169,4 +248,25 @@ EZ::WindowSettings EZ::Program::GetWindowSettings() const {
 }
 EZ::RendererSettings EZ::Program::GetRendererSettings() const {
 	return _rendererSettings;
+}
+BOOL EZ::Program::NeedsFullRedraw() const {
+	return _needsFullRedraw;
+}
+EZ::FrameStats EZ::Program::GetFrameStats() const {
+	return _scheduler->GetStats();
+}
+BYTE* EZ::Program::GetBackFrame() const {
+	return _pipeline != nullptr ? _pipeline->GetBackBuffer() : nullptr;
+}
+const BYTE* EZ::Program::GetFrontFrame() const {
+	return _frontFrame;
+}
+UINT64 EZ::Program::GetPresentedSequence() const {
+	return _pipeline != nullptr ? _pipeline->GetPresentedSequence() : 0;
+}
+EZ::FramePipelineStats EZ::Program::GetPipelineStats() const {
+	if (_pipeline == nullptr) {
+		return _pipelineStats;
+	}
+	return _pipeline->GetStats();
 }
\ No newline at end of file
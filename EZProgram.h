@@ -3,12 +3,16 @@
 #include "EZWindow.h"
 #include "EZProfiler.h"
 #include "EZError.h"
+#include "EZFrameScheduler.h"
+#include "EZLifecycle.h"
+#include "EZFramePipeline.h"
 #include <thread>
 
 namespace EZ {
 	class Program; // Forward declaration of Program because C++ is stupid.
 	typedef LRESULT(*WindowCallback)(EZ::Program* program, HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 	typedef void (*UpdateCallback)(EZ::Program* program);
+	typedef BOOL (*StepCallback)(EZ::Program* program);
 	constexpr UINT64 DefaultPreformanceLogInterval = 60;
 	struct ProgramSettings {
 		// This is a user defined pointer which can point to anything.
@@ -29,10 +33,17 @@ namespace EZ {
 		// PreformanceLogInterval stores the number of frames between each print.
 		// If PreformanceLogInterval < 0 the default of 60 is used.
 		UINT64 PreformanceLogInterval = DefaultPreformanceLogInterval;
-		// MaximumFramerate is the maximum FPS allowed before the game loop busy waits to artificially lower FPS.
+		// MaximumFramerate is the maximum FPS allowed before the game loop waits to artificially lower FPS.
+		// The wait sleeps for most of the frame and only busy waits for the last moment so a capped program
+		// does not keep a core busy.
 		// Note that a MaximumFramerate of 0 means uncapped FPS.
 		// If MaximumFramerate == 0 then the framerate is only limited by hardware speed.
 		UINT32 MaximumFramerate = 0;
+		// StepRate is the number of times per second StepCallback is called no matter how fast frames are drawn.
+		// If frames are slow StepCallback is called several times before a frame and if they are fast some frames
+		// call it 0 times. The loop never draws faster than StepRate because there would be nothing new to draw.
+		// If StepRate == 0 then StepCallback is called exactly once per frame.
+		UINT32 StepRate = 0;
 		// This callback is ran whenever there is a message for the window to handle.
 		// It is equivalent to WndProc in normal Win32 programming.
 		// This callback will not be called for messages which are ignored.
@@ -40,6 +51,19 @@ namespace EZ {
 		// This callback is called once per frame to render the graphics and preform updates.
 		// It is called between BeginDraw and EndDraw.
 		UpdateCallback UpdateCallback;
+		// This callback is called once per frame before BeginDraw to preform updates which do not draw anything.
+		// It returns TRUE if the frame needs to be drawn. If it returns FALSE then BeginDraw, UpdateCallback and
+		// EndDraw are all skipped and the last frame stays on screen, unless the window was resized.
+		// If StepCallback is nullptr every frame is drawn.
+		// See StepRate for how often it is called.
+		StepCallback StepCallback;
+		// If PipelineFrameBytes != 0 then frames are drawn and presented on a thread of their own through an
+		// EZ::FramePipeline so a slow present never holds up StepCallback. StepCallback writes the whole frame into
+		// GetBackFrame() and when it returns TRUE the frame is published. UpdateCallback then runs on the presenter
+		// thread with the newest published frame in GetFrontFrame() and frames it was too slow for are skipped.
+		// While Run is going only UpdateCallback may use the renderer.
+		// If PipelineFrameBytes == 0 then steps, drawing and presenting all happen one after another on Run's thread.
+		UINT32 PipelineFrameBytes;
 	};
 	class Program {
 	public:
@@ -53,23 +77,53 @@ namespace EZ {
 		EZ::ClassSettings GetClassSettings() const;
 		EZ::WindowSettings GetWindowSettings() const;
 		EZ::RendererSettings GetRendererSettings() const;
+		// Returns TRUE if the contents of the renderer buffer were lost since the last frame, for example because the
+		// window was resized, so the UpdateCallback must redraw everything rather than just what changed.
+		BOOL NeedsFullRedraw() const;
+		// Returns frame time and jitter measurements for every frame since Run started.
+		EZ::FrameStats GetFrameStats() const;
+		// Only with PipelineFrameBytes != 0 and only in StepCallback. Returns the buffer of PipelineFrameBytes to
+		// write the next frame into. It holds an older frame, not the last one, so the whole frame must be written.
+		BYTE* GetBackFrame() const;
+		// Only with PipelineFrameBytes != 0 and only in UpdateCallback. Returns the frame to draw.
+		const BYTE* GetFrontFrame() const;
+		// Only with PipelineFrameBytes != 0 and only while Run is going. Returns the sequence number of the last frame
+		// UpdateCallback drew, counting published frames from 1, or 0 before the first. See
+		// EZ::FramePipeline::GetPresentedSequence.
+		UINT64 GetPresentedSequence() const;
+		// Only with PipelineFrameBytes != 0. Returns how many frames were published, presented and skipped so far,
+		// or in the whole of Run once it returned.
+		EZ::FramePipelineStats GetPipelineStats() const;
 
 		template <typename T> T* GetUserDataAs() const;
 
 	private:
 		static LRESULT CALLBACK CustomWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+		// The EZ::FramePipeline Present callback. Runs on the presenter thread.
+		static void PresentFrame(void* context, const BYTE* frame, UINT32 size);
 
-		enum class State : BYTE {
-			Created = 0,
-			Running = 1,
-			Closed = 2,
-			Destroyed = 3
-		};
-		EZ::Program::State _state;
-		D2D1_SIZE_U _newSize;
-		BOOL _resizeRequested;
+		// Resizes the renderer if WM_SIZE posted a new size.
+		void TakeResize();
+		// Calls UpdateCallback between BeginDraw and EndDraw.
+		void Draw();
+
+		// Runs on the window thread. Creates the window, pumps its messages until it closes and then deletes it.
+		void WindowMain(EZ::ClassSettings classSettings, EZ::WindowSettings windowSettings);
+
+		// The window thread and the thread calling Run hand off to each other through _lifecycle.
+		EZ::Lifecycle _lifecycle;
+		std::thread _windowThread;
+		// WM_SIZE posts the new size here and the game loop resizes the renderer at the start of the next frame.
+		EZ::ResizeMailbox _resizeMailbox;
+		BOOL _needsFullRedraw;
+		// Only while Run is going with PipelineFrameBytes != 0.
+		EZ::FramePipeline* _pipeline;
+		const BYTE* _frontFrame;
+		// The pipeline's stats from when Run returned.
+		EZ::FramePipelineStats _pipelineStats;
 
 		EZ::Profiler* _profiler;
+		EZ::FrameScheduler* _scheduler;
 		EZ::Renderer* _renderer;
 		EZ::Window* _window;
 
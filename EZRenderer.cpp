@@ -5,28 +5,6 @@
 
 #pragma comment(lib, "windowscodecs.lib")
 
-// Converts a rectangle which is in pixel space and defines a 2d rectangular area on a texture or render target
-// into a rectangle that is in dip space and represents the same area but with DPI accounted for.
-// Additionally accounts for the spacial shift in y axis between game engines and text/renderring engines.
-// Finally uses the size of the texture/render target in both pixels and DIPs to preform scaling.
-D2D1_RECT_F TransformRect(D2D1_RECT_L source, D2D1_SIZE_F dipSize, D2D1_SIZE_U pixelSize) {
-	FLOAT left = (static_cast<FLOAT>(source.left) * dipSize.width) / pixelSize.width;
-	FLOAT top = dipSize.height - ((static_cast<FLOAT>(source.top) * dipSize.height) / pixelSize.height);
-	FLOAT right = (static_cast<FLOAT>(source.right) * dipSize.width) / pixelSize.width;
-	FLOAT bottom = dipSize.height - ((static_cast<FLOAT>(source.bottom) * dipSize.height) / pixelSize.height);
-	return D2D1::RectF(left, top, right, bottom);
-}
-
-D2D1_RECT_F EZ::RectF(FLOAT x, FLOAT y, FLOAT width, FLOAT height) {
-	return D2D1::RectF(x, y + height, x + width, y);
-}
-D2D1_RECT_L EZ::RectL(INT32 x, INT32 y, INT32 width, INT32 height) {
-	return D2D1::RectL(x, y + height, x + width, y);
-}
-D2D1_RECT_U EZ::RectU(UINT32 x, UINT32 y, UINT32 width, UINT32 height) {
-	return D2D1::RectU(x, y + height, x + width, y);
-}
-
 EZ::Renderer::Renderer(HWND windowHandle, EZ::RendererSettings settings) {
 	if (!IsWindow(windowHandle)) {
 		throw Error("windowHandle must be a valid HWND. (Window may be destroyed)");
@@ -79,6 +57,7 @@ EZ::Renderer::Renderer(HWND windowHandle, EZ::RendererSettings settings) {
 	}
 
 	EZ::Error::ThrowFromHR(_factory->CreateHwndRenderTarget(renderTargetProperties, windowRenderTargetProperties, &_windowRenderTarget));
+	EZ::Error::ThrowFromHR(_windowRenderTarget->CreateSolidColorBrush(D2D1::ColorF(0.0f, 0.0f, 0.0f, 1.0f), &_brush));
 }
 void EZ::Renderer::BeginDraw() {
 	_windowRenderTarget->BeginDraw();
@@ -87,11 +66,9 @@ void EZ::Renderer::Clear(D2D1_COLOR_F color) {
 	_windowRenderTarget->Clear(color);
 }
 void EZ::Renderer::FillRect(D2D1_RECT_L rect, D2D1_COLOR_F color) {
-	ID2D1SolidColorBrush* brush;
-	EZ::Error::ThrowFromHR(_windowRenderTarget->CreateSolidColorBrush(color, &brush));
-	D2D1_RECT_F transRect = TransformRect(rect, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
-	_windowRenderTarget->FillRectangle(&transRect, brush);
-	brush->Release();
+	_brush->SetColor(color);
+	D2D1_RECT_F transRect = EZ::TransformRect(rect, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
+	_windowRenderTarget->FillRectangle(&transRect, _brush);
 }
 void EZ::Renderer::Resize(D2D1_SIZE_U newSize) {
 	EZ::Error::ThrowFromHR(_windowRenderTarget->Resize(newSize));
@@ -99,16 +76,16 @@ void EZ::Renderer::Resize(D2D1_SIZE_U newSize) {
 void EZ::Renderer::DrawBitmap(ID2D1Bitmap* bitmap, D2D1_POINT_2L position) {
 	D2D1_SIZE_U bitmapSize = bitmap->GetPixelSize();
 	D2D1_RECT_L rect = EZ::RectL(position.x, position.y, bitmapSize.width, bitmapSize.height);
-	D2D1_RECT_F transRect = TransformRect(rect, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
+	D2D1_RECT_F transRect = EZ::TransformRect(rect, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
 	_windowRenderTarget->DrawBitmap(bitmap, transRect, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, NULL);
 }
 void EZ::Renderer::DrawBitmap(ID2D1Bitmap* bitmap, D2D1_RECT_L destination) {
-	D2D1_RECT_F transDestination = TransformRect(destination, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
+	D2D1_RECT_F transDestination = EZ::TransformRect(destination, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
 	_windowRenderTarget->DrawBitmap(bitmap, transDestination, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, NULL);
 }
 void EZ::Renderer::DrawBitmap(ID2D1Bitmap* bitmap, D2D1_RECT_L source, D2D1_RECT_L destination) {
-	D2D1_RECT_F transSource = TransformRect(source, bitmap->GetSize(), bitmap->GetPixelSize());
-	D2D1_RECT_F transDestination = TransformRect(destination, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
+	D2D1_RECT_F transSource = EZ::TransformRect(source, bitmap->GetSize(), bitmap->GetPixelSize());
+	D2D1_RECT_F transDestination = EZ::TransformRect(destination, _windowRenderTarget->GetSize(), _windowRenderTarget->GetPixelSize());
 	_windowRenderTarget->DrawBitmap(bitmap, transDestination, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, transSource);
 }
 ID2D1Bitmap* EZ::Renderer::LoadBitmap(LPCWSTR filePath) {
@@ -177,12 +154,49 @@ ID2D1Bitmap* EZ::Renderer::LoadBitmap(EZ::BitmapAsset asset) {
 	EZ::Error::ThrowFromHR(_windowRenderTarget->CreateBitmap(bitmapSize, asset.Buffer, asset.Width * 4, &bitmapProperties, &output));
 	return output;
 }
+void EZ::Renderer::Submit(const EZ::DrawList& list) {
+	const EZ::DrawCommand* commands = list.GetCommands();
+	const EZ::BitmapRef* bitmaps = list.GetBitmaps();
+	// Premultiplied colors never have more blue than alpha so no command matches this and the first FillRect sets the brush.
+	UINT32 brushColor = 1;
+	for (UINT32 i = list.GetFirstVisibleCommand(); i < list.GetCommandCount(); i++) {
+		const EZ::DrawCommand& command = commands[i];
+		if (command.Type == EZ::DrawCommandType::DrawBitmap) {
+			ID2D1Bitmap* bitmap = reinterpret_cast<ID2D1Bitmap*>(const_cast<void*>(bitmaps[command.Bitmap].Handle));
+			_windowRenderTarget->DrawBitmap(bitmap, command.Destination, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, command.Source);
+			continue;
+		}
+		// Direct2D takes straight alpha colors so the packed premultiplied color is divided back out.
+		FLOAT alpha = static_cast<FLOAT>(command.Color >> 24) / 255.0f;
+		FLOAT scale = alpha > 0.0f ? 1.0f / (alpha * 255.0f) : 0.0f;
+		D2D1_COLOR_F color = D2D1::ColorF(((command.Color >> 16) & 0xFF) * scale, ((command.Color >> 8) & 0xFF) * scale, (command.Color & 0xFF) * scale, alpha);
+		if (command.Type == EZ::DrawCommandType::Clear) {
+			_windowRenderTarget->Clear(color);
+			continue;
+		}
+		if (command.Color != brushColor) {
+			_brush->SetColor(color);
+			brushColor = command.Color;
+		}
+		_windowRenderTarget->FillRectangle(&command.Destination, _brush);
+	}
+}
+EZ::BitmapRef EZ::Renderer::GetBitmapRef(ID2D1Bitmap* bitmap) {
+	EZ::BitmapRef bitmapRef = { };
+	bitmapRef.Handle = bitmap;
+	bitmapRef.DipSize = bitmap->GetSize();
+	bitmapRef.PixelSize = bitmap->GetPixelSize();
+	return bitmapRef;
+}
 void EZ::Renderer::EndDraw() {
 	EZ::Error::ThrowFromHR(_windowRenderTarget->EndDraw());
 }
 D2D1_SIZE_U EZ::Renderer::GetSize() {
 	return _windowRenderTarget->GetPixelSize();
 }
+D2D1_SIZE_F EZ::Renderer::GetDipSize() {
+	return _windowRenderTarget->GetSize();
+}
 D2D1_VECTOR_2F EZ::Renderer::GetDpi() {
 	D2D1_VECTOR_2F dpi = { };
 	_windowRenderTarget->GetDpi(&dpi.x, &dpi.y);
@@ -192,6 +206,7 @@ ID2D1HwndRenderTarget* EZ::Renderer::GiveMePlz() {
 	return _windowRenderTarget;
 }
 EZ::Renderer::~Renderer() {
+	_brush->Release();
 	_windowRenderTarget->Release();
 	_factory->Release();
 }
@@ -2,20 +2,12 @@
 #include <Windows.h>
 #include <D2D1.h>
 #include <D2D1_1Helper.h>
+#include "EZGeometry.h"
+#include "EZBitmap.h"
+#include "EZDrawList.h"
 #pragma comment(lib, "D2D1.lib")
 
 namespace EZ {
-	struct BitmapAsset {
-		UINT32 Width;
-		UINT32 Height;
-		const BYTE* Buffer;
-	};
-	// These methods allow users to create rects with x, y, width, and height instead of left, top, right, and bottom.
-	D2D1_RECT_F RectF(FLOAT x, FLOAT y, FLOAT width, FLOAT height);
-	D2D1_RECT_L RectL(INT32 x, INT32 y, INT32 width, INT32 height);
-	D2D1_RECT_U RectU(UINT32 x, UINT32 y, UINT32 width, UINT32 height);
-	constexpr UINT32 DefaultRendererWidth = 256;
-	constexpr UINT32 DefaultRendererHeight = 144;
 	enum class RendererMode : BYTE {
 		// Allows DirectX to choose the renderer mode automatically.
 		DontCare = 0,
@@ -71,8 +63,16 @@ namespace EZ {
 		ID2D1Bitmap* LoadBitmap(LPCWSTR filePath);
 		ID2D1Bitmap* LoadBitmap(IStream* stream);
 		ID2D1Bitmap* LoadBitmap(BitmapAsset asset);
+		// Draws every visible command of list in order. Call it between BeginDraw and EndDraw like the draw calls above.
+		// Runs of FillRects share one brush whose color only changes when theirs does.
+		// Bitmap handles must be ID2D1Bitmap pointers.
+		void Submit(const EZ::DrawList& list);
+		// Returns a reference a draw list can record draws of bitmap with. bitmap must outlive every Submit using it.
+		static EZ::BitmapRef GetBitmapRef(ID2D1Bitmap* bitmap);
 		void EndDraw();
 		D2D1_SIZE_U GetSize();
+		// Returns the size of the render target in DIPs. Pass it to DrawList::Reset along with GetSize.
+		D2D1_SIZE_F GetDipSize();
 		D2D1_VECTOR_2F GetDpi();
 		ID2D1HwndRenderTarget* GiveMePlz();
 		~Renderer();
@@ -84,6 +84,8 @@ namespace EZ {
 		HWND _windowHandle;
 		ID2D1Factory* _factory;
 		ID2D1HwndRenderTarget* _windowRenderTarget;
+		// Shared by every FillRect. Creating a brush per call costs more than the fill itself for small rects.
+		ID2D1SolidColorBrush* _brush;
 		EZ::RendererSettings _settings;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "EZSoftwareRenderer.h"
+#include "EZCpu.h"
+#include "EZError.h"
+#include "EZProfiler.h"
+#include <algorithm>
+#include <cmath>
+#ifdef EZ_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+	// Blends a premultiplied B8G8R8A8 pixel over another.
+	// Each channel becomes source + destination * (255 - source alpha) / 255, rounded to nearest without a division.
+	UINT32 BlendOver(UINT32 source, UINT32 destination) {
+		UINT32 inverseAlpha = 255 - (source >> 24);
+		UINT32 result = 0;
+		for (UINT32 shift = 0; shift < 32; shift += 8) {
+			UINT32 scaled = (((destination >> shift) & 0xFF) * inverseAlpha) + 128;
+			scaled = (scaled + (scaled >> 8)) >> 8;
+			result |= (((source >> shift) & 0xFF) + scaled) << shift;
+		}
+		return result;
+	}
+	// Returns the first pixel whose center is at or past edge, clamped to 0 - size.
+	UINT32 PixelEdge(FLOAT edge, UINT32 size) {
+		FLOAT pixel = std::ceil(edge - 0.5f);
+		if (!(pixel > 0.0f)) {
+			return 0;
+		}
+		if (pixel >= static_cast<FLOAT>(size)) {
+			return size;
+		}
+		return static_cast<UINT32>(pixel);
+	}
+
+	// The scalar spans are the reference. Pixels with an alpha of 255 are copied and pixels with an alpha of 0 are
+	// skipped, which for premultiplied pixels is what blending them would give anyway.
+	void BlendPixel(UINT32 source, UINT32* destination) {
+		UINT32 alpha = source >> 24;
+		if (alpha == 255) {
+			*destination = source;
+		}
+		else if (alpha != 0) {
+			*destination = BlendOver(source, *destination);
+		}
+	}
+	void FillScalar(UINT32 color, UINT32* destination, UINT32 count) {
+		std::fill(destination, destination + count, color);
+	}
+	void BlendColorScalar(UINT32 color, UINT32* destination, UINT32 count) {
+		for (UINT32 i = 0; i < count; i++) {
+			destination[i] = BlendOver(color, destination[i]);
+		}
+	}
+	void BlendScalar(const UINT32* source, UINT32* destination, UINT32 count) {
+		for (UINT32 i = 0; i < count; i++) {
+			BlendPixel(source[i], destination + i);
+		}
+	}
+	void BlendColumnsScalar(const UINT32* sourceRow, const UINT32* columns, UINT32* destination, UINT32 count) {
+		for (UINT32 i = 0; i < count; i++) {
+			BlendPixel(sourceRow[columns[i]], destination + i);
+		}
+	}
+
+#ifdef EZ_X86
+	// The same math as BlendOver on 4 pixels at once. Channels are widened to 16 bits, where d * (255 - a) + 128 plus
+	// itself shifted right by 8 still fits, so the result is bit exact with the scalar span.
+	EZ_TARGET("sse2") __m128i BlendOverSSE2(__m128i source, __m128i destination) {
+		__m128i zero = _mm_setzero_si128();
+		__m128i max = _mm_set1_epi16(255);
+		__m128i half = _mm_set1_epi16(128);
+		__m128i sourceLow = _mm_unpacklo_epi8(source, zero);
+		__m128i sourceHigh = _mm_unpackhi_epi8(source, zero);
+		__m128i inverseLow = _mm_sub_epi16(max, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourceLow, 0xFF), 0xFF));
+		__m128i inverseHigh = _mm_sub_epi16(max, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourceHigh, 0xFF), 0xFF));
+		__m128i scaledLow = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(destination, zero), inverseLow), half);
+		__m128i scaledHigh = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(destination, zero), inverseHigh), half);
+		scaledLow = _mm_srli_epi16(_mm_add_epi16(scaledLow, _mm_srli_epi16(scaledLow, 8)), 8);
+		scaledHigh = _mm_srli_epi16(_mm_add_epi16(scaledHigh, _mm_srli_epi16(scaledHigh, 8)), 8);
+		return _mm_add_epi8(source, _mm_packus_epi16(scaledLow, scaledHigh));
+	}
+	// Blends 4 source pixels over destination, storing them unblended if all are opaque and skipping them if none are visible.
+	EZ_TARGET("sse2") void BlendVectorSSE2(__m128i source, UINT32* destination) {
+		const int alphaBytes = 0x8888;
+		int opaque = _mm_movemask_epi8(_mm_cmpeq_epi8(source, _mm_set1_epi8(-1))) & alphaBytes;
+		if (opaque == alphaBytes) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), source);
+			return;
+		}
+		int transparent = _mm_movemask_epi8(_mm_cmpeq_epi8(source, _mm_setzero_si128())) & alphaBytes;
+		if (transparent != alphaBytes) {
+			__m128i blended = BlendOverSSE2(source, _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), blended);
+		}
+	}
+	EZ_TARGET("sse2") void FillSSE2(UINT32 color, UINT32* destination, UINT32 count) {
+		__m128i colors = _mm_set1_epi32(static_cast<int>(color));
+		UINT32 i = 0;
+		for (; i + 4 <= count; i += 4) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), colors);
+		}
+		FillScalar(color, destination + i, count - i);
+	}
+	EZ_TARGET("sse2") void BlendColorSSE2(UINT32 color, UINT32* destination, UINT32 count) {
+		__m128i colors = _mm_set1_epi32(static_cast<int>(color));
+		UINT32 i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i* pixels = reinterpret_cast<__m128i*>(destination + i);
+			_mm_storeu_si128(pixels, BlendOverSSE2(colors, _mm_loadu_si128(pixels)));
+		}
+		BlendColorScalar(color, destination + i, count - i);
+	}
+	EZ_TARGET("sse2") void BlendSSE2(const UINT32* source, UINT32* destination, UINT32 count) {
+		UINT32 i = 0;
+		for (; i + 4 <= count; i += 4) {
+			BlendVectorSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)), destination + i);
+		}
+		BlendScalar(source + i, destination + i, count - i);
+	}
+	EZ_TARGET("sse2") void BlendColumnsSSE2(const UINT32* sourceRow, const UINT32* columns, UINT32* destination, UINT32 count) {
+		UINT32 i = 0;
+		for (; i + 4 <= count; i += 4) {
+			// SSE2 has no gather so the 4 source pixels are read one at a time.
+			__m128i source = _mm_setr_epi32(static_cast<int>(sourceRow[columns[i]]), static_cast<int>(sourceRow[columns[i + 1]]),
+				static_cast<int>(sourceRow[columns[i + 2]]), static_cast<int>(sourceRow[columns[i + 3]]));
+			BlendVectorSSE2(source, destination + i);
+		}
+		BlendColumnsScalar(sourceRow, columns + i, destination + i, count - i);
+	}
+
+	// BlendOverSSE2 on 8 pixels. The unpacks and packs work inside each 128 bit lane so pixels come back where they started.
+	EZ_TARGET("avx2") __m256i BlendOverAVX2(__m256i source, __m256i destination) {
+		__m256i zero = _mm256_setzero_si256();
+		__m256i max = _mm256_set1_epi16(255);
+		__m256i half = _mm256_set1_epi16(128);
+		__m256i sourceLow = _mm256_unpacklo_epi8(source, zero);
+		__m256i sourceHigh = _mm256_unpackhi_epi8(source, zero);
+		__m256i inverseLow = _mm256_sub_epi16(max, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sourceLow, 0xFF), 0xFF));
+		__m256i inverseHigh = _mm256_sub_epi16(max, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sourceHigh, 0xFF), 0xFF));
+		__m256i scaledLow = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(destination, zero), inverseLow), half);
+		__m256i scaledHigh = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(destination, zero), inverseHigh), half);
+		scaledLow = _mm256_srli_epi16(_mm256_add_epi16(scaledLow, _mm256_srli_epi16(scaledLow, 8)), 8);
+		scaledHigh = _mm256_srli_epi16(_mm256_add_epi16(scaledHigh, _mm256_srli_epi16(scaledHigh, 8)), 8);
+		return _mm256_add_epi8(source, _mm256_packus_epi16(scaledLow, scaledHigh));
+	}
+	EZ_TARGET("avx2") void BlendVectorAVX2(__m256i source, UINT32* destination) {
+		const UINT32 alphaBytes = 0x88888888;
+		UINT32 opaque = static_cast<UINT32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(source, _mm256_set1_epi8(-1)))) & alphaBytes;
+		if (opaque == alphaBytes) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), source);
+			return;
+		}
+		UINT32 transparent = static_cast<UINT32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(source, _mm256_setzero_si256()))) & alphaBytes;
+		if (transparent != alphaBytes) {
+			__m256i blended = BlendOverAVX2(source, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), blended);
+		}
+	}
+	EZ_TARGET("avx2") void FillAVX2(UINT32 color, UINT32* destination, UINT32 count) {
+		__m256i colors = _mm256_set1_epi32(static_cast<int>(color));
+		UINT32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), colors);
+		}
+		FillScalar(color, destination + i, count - i);
+	}
+	EZ_TARGET("avx2") void BlendColorAVX2(UINT32 color, UINT32* destination, UINT32 count) {
+		__m256i colors = _mm256_set1_epi32(static_cast<int>(color));
+		UINT32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i* pixels = reinterpret_cast<__m256i*>(destination + i);
+			_mm256_storeu_si256(pixels, BlendOverAVX2(colors, _mm256_loadu_si256(pixels)));
+		}
+		BlendColorScalar(color, destination + i, count - i);
+	}
+	EZ_TARGET("avx2") void BlendAVX2(const UINT32* source, UINT32* destination, UINT32 count) {
+		UINT32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			BlendVectorAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)), destination + i);
+		}
+		BlendScalar(source + i, destination + i, count - i);
+	}
+	EZ_TARGET("avx2") void BlendColumnsAVX2(const UINT32* sourceRow, const UINT32* columns, UINT32* destination, UINT32 count) {
+		UINT32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns + i));
+			BlendVectorAVX2(_mm256_i32gather_epi32(reinterpret_cast<const int*>(sourceRow), indices, 4), destination + i);
+		}
+		BlendColumnsScalar(sourceRow, columns + i, destination + i, count - i);
+	}
+#endif
+}
+
+EZ::SoftwareRenderer::SoftwareRenderer(EZ::SoftwareRendererSettings settings) {
+	_settings = settings;
+	if (_settings.BufferWidth == 0) {
+		_settings.BufferWidth = DefaultRendererWidth;
+	}
+	if (_settings.BufferHeight == 0) {
+		_settings.BufferHeight = DefaultRendererHeight;
+	}
+	_pixels = new BYTE[static_cast<size_t>(_settings.BufferWidth) * _settings.BufferHeight * 4]();
+
+	_kernels = { FillScalar, BlendColorScalar, BlendScalar, BlendColumnsScalar };
+#ifdef EZ_X86
+	const EZ::CpuFeatures& features = EZ::GetCpuFeatures();
+	if (!_settings.DisableSimd && features.AVX2) {
+		_kernels = { FillAVX2, BlendColorAVX2, BlendAVX2, BlendColumnsAVX2 };
+	}
+	else if (!_settings.DisableSimd && features.SSE2) {
+		_kernels = { FillSSE2, BlendColorSSE2, BlendSSE2, BlendColumnsSSE2 };
+	}
+#endif
+}
+void EZ::SoftwareRenderer::BeginDraw() {
+	_drawList.Reset(GetDipSize(), GetSize());
+}
+void EZ::SoftwareRenderer::Clear(D2D1_COLOR_F color) {
+	_drawList.Clear(color);
+}
+void EZ::SoftwareRenderer::FillRect(D2D1_RECT_L rect, D2D1_COLOR_F color) {
+	_drawList.FillRect(rect, color);
+}
+void EZ::SoftwareRenderer::DrawBitmap(const EZ::BitmapAsset* bitmap, D2D1_POINT_2L position) {
+	_drawList.DrawBitmap(GetBitmapRef(bitmap), position);
+}
+void EZ::SoftwareRenderer::DrawBitmap(const EZ::BitmapAsset* bitmap, D2D1_RECT_L destination) {
+	_drawList.DrawBitmap(GetBitmapRef(bitmap), destination);
+}
+void EZ::SoftwareRenderer::DrawBitmap(const EZ::BitmapAsset* bitmap, D2D1_RECT_L source, D2D1_RECT_L destination) {
+	_drawList.DrawBitmap(GetBitmapRef(bitmap), source, destination);
+}
+void EZ::SoftwareRenderer::EndDraw() {
+	Submit(_drawList);
+}
+void EZ::SoftwareRenderer::Submit(const EZ::DrawList& list) {
+	D2D1_SIZE_U listSize = list.GetPixelSize();
+	if (listSize.width != _settings.BufferWidth || listSize.height != _settings.BufferHeight) {
+		throw EZ::Error("The draw list was recorded for a different size of target.");
+	}
+	D2D1_SIZE_F dipSize = list.GetDipSize();
+	FLOAT scaleX = static_cast<FLOAT>(listSize.width) / dipSize.width;
+	FLOAT scaleY = static_cast<FLOAT>(listSize.height) / dipSize.height;
+	const EZ::DrawCommand* commands = list.GetCommands();
+	const EZ::BitmapRef* bitmaps = list.GetBitmaps();
+	_prepared.clear();
+	_columns.clear();
+	for (UINT32 i = list.GetFirstVisibleCommand(); i < list.GetCommandCount(); i++) {
+		const EZ::DrawCommand& command = commands[i];
+		PreparedCommand prepared = { };
+		prepared.Type = command.Type;
+		prepared.Color = command.Color;
+		BOOL visible = TRUE;
+		switch (command.Type) {
+		case EZ::DrawCommandType::Clear:
+			prepared.Rect = { 0, 0, _settings.BufferWidth, _settings.BufferHeight };
+			break;
+		case EZ::DrawCommandType::FillRect:
+			prepared.Rect = ToPixelRect(command.Destination, scaleX, scaleY);
+			// Premultiplied colors with no alpha are all zeros and blending them changes nothing.
+			visible = (command.Color >> 24) != 0 && prepared.Rect.Left != prepared.Rect.Right && prepared.Rect.Top != prepared.Rect.Bottom;
+			break;
+		case EZ::DrawCommandType::DrawBitmap: {
+			D2D1_RECT_F destination = { command.Destination.left * scaleX, command.Destination.top * scaleY,
+				command.Destination.right * scaleX, command.Destination.bottom * scaleY };
+			prepared.Bitmap = reinterpret_cast<const EZ::BitmapAsset*>(bitmaps[command.Bitmap].Handle);
+			prepared.Rect = ToPixelRect(command.Destination, scaleX, scaleY);
+			visible = PrepareBitmap(prepared, command.Source, destination);
+			break;
+		}
+		}
+		if (visible) {
+			_prepared.push_back(prepared);
+		}
+	}
+
+	UINT32 bandCount = (_settings.BufferHeight + SoftwareBandHeight - 1) / SoftwareBandHeight;
+	if (_settings.ThreadPool != nullptr && bandCount > 1) {
+		_settings.ThreadPool->ParallelFor(bandCount, DrawBandTask, this);
+	}
+	else {
+		for (UINT32 bandIndex = 0; bandIndex < bandCount; bandIndex++) {
+			DrawBand(bandIndex);
+		}
+	}
+}
+EZ::SoftwareRenderer::PixelRect EZ::SoftwareRenderer::ToPixelRect(D2D1_RECT_F rect, FLOAT scaleX, FLOAT scaleY) const {
+	// Rects recorded upside down still cover the same pixels.
+	FLOAT left = (std::min)(rect.left, rect.right) * scaleX;
+	FLOAT right = (std::max)(rect.left, rect.right) * scaleX;
+	FLOAT top = (std::min)(rect.top, rect.bottom) * scaleY;
+	FLOAT bottom = (std::max)(rect.top, rect.bottom) * scaleY;
+	PixelRect pixels = { };
+	pixels.Left = PixelEdge(left, _settings.BufferWidth);
+	pixels.Right = (std::max)(pixels.Left, PixelEdge(right, _settings.BufferWidth));
+	pixels.Top = PixelEdge(top, _settings.BufferHeight);
+	pixels.Bottom = (std::max)(pixels.Top, PixelEdge(bottom, _settings.BufferHeight));
+	return pixels;
+}
+BOOL EZ::SoftwareRenderer::PrepareBitmap(PreparedCommand& prepared, D2D1_RECT_F source, D2D1_RECT_F destination) {
+	PixelRect rect = prepared.Rect;
+	const EZ::BitmapAsset* bitmap = prepared.Bitmap;
+	if (rect.Left == rect.Right || rect.Top == rect.Bottom || bitmap->Width == 0 || bitmap->Height == 0) {
+		return FALSE;
+	}
+	// Every destination pixel center is mapped back into the source rect and the source pixel it lands in is drawn.
+	// Source pixels are looked up per column once so the bands only read the table and blend.
+	FLOAT destinationLeft = (std::min)(destination.left, destination.right);
+	prepared.DestinationTop = (std::min)(destination.top, destination.bottom);
+	FLOAT stepX = ((std::max)(source.left, source.right) - (std::min)(source.left, source.right))
+		/ ((std::max)(destination.left, destination.right) - destinationLeft);
+	prepared.StepY = ((std::max)(source.top, source.bottom) - (std::min)(source.top, source.bottom))
+		/ ((std::max)(destination.top, destination.bottom) - prepared.DestinationTop);
+	FLOAT sourceLeft = (std::min)(source.left, source.right);
+	prepared.SourceTop = (std::min)(source.top, source.bottom);
+	prepared.Columns = static_cast<UINT32>(_columns.size());
+	prepared.Contiguous = TRUE;
+	for (UINT32 x = rect.Left; x < rect.Right; x++) {
+		FLOAT u = std::floor(sourceLeft + (((static_cast<FLOAT>(x) + 0.5f) - destinationLeft) * stepX));
+		UINT32 column = static_cast<UINT32>((std::min)((std::max)(u, 0.0f), static_cast<FLOAT>(bitmap->Width - 1)));
+		if (x != rect.Left && column != _columns.back() + 1) {
+			prepared.Contiguous = FALSE;
+		}
+		_columns.push_back(column);
+	}
+	prepared.FirstColumn = _columns[prepared.Columns];
+	if (prepared.Contiguous) {
+		_columns.resize(prepared.Columns);
+	}
+	return TRUE;
+}
+void EZ::SoftwareRenderer::DrawBandTask(void* context, UINT32 bandIndex) {
+	reinterpret_cast<EZ::SoftwareRenderer*>(context)->DrawBand(bandIndex);
+}
+void EZ::SoftwareRenderer::DrawBand(UINT32 bandIndex) {
+	EZ::ProfileScope scope("SoftwareBand");
+	UINT32 bandTop = bandIndex * SoftwareBandHeight;
+	UINT32 bandBottom = (std::min)(bandTop + SoftwareBandHeight, _settings.BufferHeight);
+	UINT32* pixels = reinterpret_cast<UINT32*>(_pixels);
+	for (const PreparedCommand& prepared : _prepared) {
+		UINT32 top = (std::max)(prepared.Rect.Top, bandTop);
+		UINT32 bottom = (std::min)(prepared.Rect.Bottom, bandBottom);
+		if (top >= bottom) {
+			continue;
+		}
+		UINT32 width = prepared.Rect.Right - prepared.Rect.Left;
+		UINT32* row = pixels + (static_cast<size_t>(top) * _settings.BufferWidth) + prepared.Rect.Left;
+		if (prepared.Type == EZ::DrawCommandType::DrawBitmap) {
+			DrawBitmapRows(prepared, top, bottom);
+		}
+		else if (prepared.Type == EZ::DrawCommandType::Clear || (prepared.Color >> 24) == 255) {
+			if (width == _settings.BufferWidth) {
+				// Full width rows are back to back so they are filled as one span.
+				_kernels.Fill(prepared.Color, row, width * (bottom - top));
+			}
+			else {
+				for (UINT32 y = top; y < bottom; y++) {
+					_kernels.Fill(prepared.Color, row, width);
+					row += _settings.BufferWidth;
+				}
+			}
+		}
+		else {
+			for (UINT32 y = top; y < bottom; y++) {
+				_kernels.BlendColor(prepared.Color, row, width);
+				row += _settings.BufferWidth;
+			}
+		}
+	}
+}
+void EZ::SoftwareRenderer::DrawBitmapRows(const PreparedCommand& prepared, UINT32 top, UINT32 bottom) {
+	const EZ::BitmapAsset* bitmap = prepared.Bitmap;
+	UINT32 width = prepared.Rect.Right - prepared.Rect.Left;
+	const UINT32* columns = _columns.data() + prepared.Columns;
+	for (UINT32 y = top; y < bottom; y++) {
+		FLOAT v = std::floor(prepared.SourceTop + (((static_cast<FLOAT>(y) + 0.5f) - prepared.DestinationTop) * prepared.StepY));
+		UINT32 sourceY = static_cast<UINT32>((std::min)((std::max)(v, 0.0f), static_cast<FLOAT>(bitmap->Height - 1)));
+		const UINT32* sourceRow = reinterpret_cast<const UINT32*>(bitmap->Buffer) + (static_cast<size_t>(sourceY) * bitmap->Width);
+		UINT32* row = reinterpret_cast<UINT32*>(_pixels) + (static_cast<size_t>(y) * _settings.BufferWidth) + prepared.Rect.Left;
+		if (prepared.Contiguous) {
+			_kernels.Blend(sourceRow + prepared.FirstColumn, row, width);
+		}
+		else {
+			_kernels.BlendColumns(sourceRow, columns, row, width);
+		}
+	}
+}
+void EZ::SoftwareRenderer::Resize(D2D1_SIZE_U newSize) {
+	delete[] _pixels;
+	_settings.BufferWidth = newSize.width == 0 ? DefaultRendererWidth : newSize.width;
+	_settings.BufferHeight = newSize.height == 0 ? DefaultRendererHeight : newSize.height;
+	_pixels = new BYTE[static_cast<size_t>(_settings.BufferWidth) * _settings.BufferHeight * 4]();
+}
+EZ::BitmapRef EZ::SoftwareRenderer::GetBitmapRef(const EZ::BitmapAsset* bitmap) {
+	EZ::BitmapRef bitmapRef = { };
+	bitmapRef.Handle = bitmap;
+	bitmapRef.PixelSize = { bitmap->Width, bitmap->Height };
+	bitmapRef.DipSize = { static_cast<FLOAT>(bitmap->Width), static_cast<FLOAT>(bitmap->Height) };
+	return bitmapRef;
+}
+EZ::SoftwareRenderer::~SoftwareRenderer() {
+	delete[] _pixels;
+	_pixels = nullptr;
+}
+
+D2D1_SIZE_U EZ::SoftwareRenderer::GetSize() const {
+	return { _settings.BufferWidth, _settings.BufferHeight };
+}
+D2D1_SIZE_F EZ::SoftwareRenderer::GetDipSize() const {
+	return { static_cast<FLOAT>(_settings.BufferWidth), static_cast<FLOAT>(_settings.BufferHeight) };
+}
+const BYTE* EZ::SoftwareRenderer::GetPixels() const {
+	return _pixels;
+}
+UINT32 EZ::SoftwareRenderer::GetStride() const {
+	return _settings.BufferWidth * 4;
+}
+EZ::SoftwareRendererSettings EZ::SoftwareRenderer::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZGeometry.h"
+#include "EZBitmap.h"
+#include "EZDrawList.h"
+#include "EZThreadPool.h"
+#include <vector>
+
+namespace EZ {
+	// Height in rows of the horizontal bands EZ::SoftwareRenderer splits the frame buffer into.
+	constexpr UINT32 SoftwareBandHeight = 32;
+	struct SoftwareRendererSettings {
+		// Stores the width of the frame buffer in pixels.
+		// If BufferWidth == 0 then DefaultRendererWidth is used.
+		UINT32 BufferWidth;
+		// Stores the height of the frame buffer in pixels.
+		// If BufferHeight == 0 then DefaultRendererHeight is used.
+		UINT32 BufferHeight;
+		// If ThreadPool != nullptr the bands are split across its threads. Else they are all drawn on the calling thread.
+		// The pool must outlive the renderer.
+		EZ::ThreadPool* ThreadPool;
+		// If DisableSimd is TRUE every span is drawn by the plain C++ loops even when the CPU has SSE2 or AVX2.
+		// The output is the same either way so this is only useful for checking and benchmarking the SIMD spans.
+		BOOL DisableSimd;
+	};
+	// Draws EZ::DrawLists into a frame buffer in memory on the CPU. It needs no window, GPU or Windows SDK so it runs
+	// headless anywhere and is the reference the Direct2D backend can be checked against.
+	// The frame buffer holds premultiplied B8G8R8A8 pixels, top row first. There is no DPI so a DIP is a pixel.
+	// Submit works out the pixels and source columns of every command once, then draws the frame buffer in bands of
+	// SoftwareBandHeight rows. Each band walks every command clipped to its rows, so bands never share pixels and can be
+	// drawn on different threads while still giving the same result as one thread.
+	class SoftwareRenderer {
+	public:
+		SoftwareRenderer(EZ::SoftwareRendererSettings settings);
+		// The same draw calls as EZ::Renderer, recorded into a DrawList owned by the renderer which EndDraw submits.
+		// Bitmaps are EZ::BitmapAssets holding premultiplied B8G8R8A8 pixels and must stay valid until EndDraw.
+		void BeginDraw();
+		void Clear(D2D1_COLOR_F color);
+		void FillRect(D2D1_RECT_L rect, D2D1_COLOR_F color);
+		void DrawBitmap(const EZ::BitmapAsset* bitmap, D2D1_POINT_2L position);
+		void DrawBitmap(const EZ::BitmapAsset* bitmap, D2D1_RECT_L destination);
+		void DrawBitmap(const EZ::BitmapAsset* bitmap, D2D1_RECT_L source, D2D1_RECT_L destination);
+		void EndDraw();
+		// Draws every visible command of list in order. Pixels are covered when their centers are inside a rect,
+		// rects are blended source over and bitmaps are scaled with nearest neighbour sampling, matching what
+		// EZ::Renderer asks Direct2D for. Bitmap handles must be EZ::BitmapAsset pointers.
+		// Throws an EZ::Error if list was Reset with a different pixel size than this renderer.
+		void Submit(const EZ::DrawList& list);
+		// Reallocates the frame buffer. Its contents are lost.
+		void Resize(D2D1_SIZE_U newSize);
+		// Returns a reference the draw list can record draws of bitmap with. bitmap must outlive every Submit using it.
+		static EZ::BitmapRef GetBitmapRef(const EZ::BitmapAsset* bitmap);
+		~SoftwareRenderer();
+
+		D2D1_SIZE_U GetSize() const;
+		// The same as GetSize since the software renderer has no DPI. Pass both to DrawList::Reset.
+		D2D1_SIZE_F GetDipSize() const;
+		const BYTE* GetPixels() const;
+		// Bytes from the start of one row of GetPixels() to the next.
+		UINT32 GetStride() const;
+		EZ::SoftwareRendererSettings GetSettings() const;
+
+	private:
+		// The loops every band is drawn with, picked once in the constructor from the CPU features.
+		struct SpanKernels {
+			// Sets count pixels of destination to color.
+			void (*Fill)(UINT32 color, UINT32* destination, UINT32 count);
+			// Blends color over count pixels of destination.
+			void (*BlendColor)(UINT32 color, UINT32* destination, UINT32 count);
+			// Blends count pixels of source over destination.
+			void (*Blend)(const UINT32* source, UINT32* destination, UINT32 count);
+			// Blends sourceRow[columns[i]] over destination[i] for count pixels.
+			void (*BlendColumns)(const UINT32* sourceRow, const UINT32* columns, UINT32* destination, UINT32 count);
+		};
+		// A rect converted to the pixels whose centers it covers, clipped to the frame buffer.
+		// Right and bottom are exclusive and left == right or top == bottom means no pixels.
+		struct PixelRect {
+			UINT32 Left;
+			UINT32 Top;
+			UINT32 Right;
+			UINT32 Bottom;
+		};
+		// A visible command with everything a band needs worked out.
+		struct PreparedCommand {
+			EZ::DrawCommandType Type;
+			UINT32 Color;
+			PixelRect Rect;
+			const EZ::BitmapAsset* Bitmap;
+			// Index into _columns of the source column for Rect.Left. Only used if Contiguous is FALSE.
+			UINT32 Columns;
+			// The source column for Rect.Left when every column after it reads the next source column, which is the
+			// case whenever a bitmap is drawn unscaled. Rows are then blended straight from the bitmap without the table.
+			UINT32 FirstColumn;
+			BOOL Contiguous;
+			FLOAT SourceTop;
+			FLOAT DestinationTop;
+			FLOAT StepY;
+		};
+		PixelRect ToPixelRect(D2D1_RECT_F rect, FLOAT scaleX, FLOAT scaleY) const;
+		// Works out the source columns of a DrawBitmap. Returns FALSE if it covers no pixels.
+		BOOL PrepareBitmap(PreparedCommand& prepared, D2D1_RECT_F source, D2D1_RECT_F destination);
+		static void DrawBandTask(void* context, UINT32 bandIndex);
+		void DrawBand(UINT32 bandIndex);
+		void DrawBitmapRows(const PreparedCommand& prepared, UINT32 top, UINT32 bottom);
+
+		BYTE* _pixels;
+		SpanKernels _kernels;
+		// The commands of the list being submitted, only valid during Submit so DrawBand can reach them from the workers.
+		// Both are kept between calls so they are only allocated when a frame grows.
+		std::vector<PreparedCommand> _prepared;
+		// Source column of every destination column of every scaled DrawBitmap in _prepared.
+		std::vector<UINT32> _columns;
+		EZ::DrawList _drawList;
+		EZ::SoftwareRendererSettings _settings;
+	};
+}
\ No newline at end of file
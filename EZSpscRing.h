@@ -0,0 +1,98 @@
+#pragma once
+#include "EZPlatform.h"
+#include <atomic>
+#include <cstring>
+
+namespace EZ {
+	// A fixed size queue between exactly one producer thread and one consumer thread which never locks or waits.
+	// Push and Pop each move a whole batch with at most two memcpys and one atomic store, so a thread handing over
+	// hundreds of items a frame pays the same as for one. When the ring is full Push takes what fits and returns how
+	// many that was, leaving the producer to decide whether to drop the rest. T must be safe to copy with memcpy.
+	template <typename T> class SpscRing {
+	public:
+		// capacity is rounded up to a power of 2.
+		SpscRing(UINT32 capacity);
+		// Producer only. Copies up to count items into the ring and returns how many fit.
+		UINT32 Push(const T* items, UINT32 count);
+		// Consumer only. Copies up to count of the oldest items out of the ring and returns how many there were.
+		UINT32 Pop(T* items, UINT32 count);
+		~SpscRing();
+
+		// Number of items waiting. Exact on the producer or consumer thread, a snapshot anywhere else.
+		UINT32 GetSize() const;
+		UINT32 GetCapacity() const;
+
+	private:
+		// Copies count items starting at index of the ring to or from items, wrapping around the end.
+		void CopyIn(UINT64 index, const T* items, UINT32 count);
+		void CopyOut(UINT64 index, T* items, UINT32 count) const;
+
+		T* _items;
+		UINT32 _capacity;
+		// Head is only written by the consumer and Tail only by the producer. They count items ever popped and pushed
+		// so they never wrap in practice and Tail - Head is the size. Each sits on its own cache line so the two
+		// threads only share a line when one actually reads the other's position.
+		alignas(64) std::atomic<UINT64> _head;
+		alignas(64) std::atomic<UINT64> _tail;
+	};
+}
+
+// Since SpscRing is a template it is defined here in the header.
+template <typename T> EZ::SpscRing<T>::SpscRing(UINT32 capacity) {
+	_capacity = 1;
+	while (_capacity < capacity) {
+		_capacity <<= 1;
+	}
+	_items = new T[_capacity];
+	_head.store(0);
+	_tail.store(0);
+}
+template <typename T> UINT32 EZ::SpscRing<T>::Push(const T* items, UINT32 count) {
+	UINT64 tail = _tail.load(std::memory_order_relaxed);
+	UINT64 head = _head.load(std::memory_order_acquire);
+	UINT32 space = _capacity - static_cast<UINT32>(tail - head);
+	if (count > space) {
+		count = space;
+	}
+	CopyIn(tail, items, count);
+	// Release so the consumer sees the items before it sees the new tail.
+	_tail.store(tail + count, std::memory_order_release);
+	return count;
+}
+template <typename T> UINT32 EZ::SpscRing<T>::Pop(T* items, UINT32 count) {
+	UINT64 head = _head.load(std::memory_order_relaxed);
+	UINT64 tail = _tail.load(std::memory_order_acquire);
+	UINT32 size = static_cast<UINT32>(tail - head);
+	if (count > size) {
+		count = size;
+	}
+	CopyOut(head, items, count);
+	// Release so the producer can't overwrite the items until they were copied out.
+	_head.store(head + count, std::memory_order_release);
+	return count;
+}
+template <typename T> void EZ::SpscRing<T>::CopyIn(UINT64 index, const T* items, UINT32 count) {
+	UINT32 start = static_cast<UINT32>(index & (_capacity - 1));
+	UINT32 first = count < _capacity - start ? count : _capacity - start;
+	memcpy(_items + start, items, first * sizeof(T));
+	memcpy(_items, items + first, (count - first) * sizeof(T));
+}
+template <typename T> void EZ::SpscRing<T>::CopyOut(UINT64 index, T* items, UINT32 count) const {
+	UINT32 start = static_cast<UINT32>(index & (_capacity - 1));
+	UINT32 first = count < _capacity - start ? count : _capacity - start;
+	memcpy(items, _items + start, first * sizeof(T));
+	memcpy(items + first, _items, (count - first) * sizeof(T));
+}
+template <typename T> EZ::SpscRing<T>::~SpscRing() {
+	delete[] _items;
+	_items = nullptr;
+}
+template <typename T> UINT32 EZ::SpscRing<T>::GetSize() const {
+	// Head first since it can only catch up to a tail read after it, never pass it.
+	UINT64 head = _head.load(std::memory_order_acquire);
+	UINT64 tail = _tail.load(std::memory_order_acquire);
+	return static_cast<UINT32>(tail - head);
+}
+template <typename T> UINT32 EZ::SpscRing<T>::GetCapacity() const {
+	return _capacity;
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "EZThreadPool.h"
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+	// Keeps the calling thread on hardwareThread. Failing to pin only costs locality so errors are ignored.
+	void PinCurrentThread(UINT32 hardwareThread) {
+#ifdef _WIN32
+		if (hardwareThread < 64) {
+			SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << hardwareThread);
+		}
+#else
+		if (hardwareThread < CPU_SETSIZE) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(hardwareThread, &set);
+			pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		}
+#endif
+	}
+	UINT64 PackRange(UINT32 begin, UINT32 end) {
+		return (static_cast<UINT64>(end) << 32) | begin;
+	}
+	// The first task of the range thread threadIndex starts with. The range ends where the next thread's starts.
+	UINT32 GetRangeStart(UINT32 taskCount, UINT32 threadIndex, UINT32 threadCount) {
+		return static_cast<UINT32>((static_cast<UINT64>(taskCount) * threadIndex) / threadCount);
+	}
+}
+
+EZ::ThreadPool::ThreadPool(UINT32 workerCount, BOOL pinThreads) {
+	UINT32 hardwareThreads = std::thread::hardware_concurrency();
+	if (workerCount == 0) {
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+	_ranges = new TaskRange[workerCount + 1];
+	for (UINT32 i = 0; i <= workerCount; i++) {
+		_ranges[i].Range.store(0);
+	}
+	_generation = 0;
+	_stopping = FALSE;
+	_busyWorkers = 0;
+	_callback = nullptr;
+	_context = nullptr;
+	_taskCount = 0;
+	_finishedTasks = 0;
+	_stolenTasks = 0;
+
+	for (UINT32 i = 0; i < workerCount; i++) {
+		// The calling thread usually sits on hardware thread 0 so workers start from 1.
+		BOOL pin = pinThreads && hardwareThreads > 1;
+		_workers.emplace_back([this, i, pin]() { WorkerMain(i + 1, pin); });
+	}
+}
+void EZ::ThreadPool::ParallelFor(UINT32 taskCount, EZ::TaskCallback callback, void* context) {
+	if (taskCount == 0) {
+		return;
+	}
+	std::lock_guard<std::mutex> dispatchLock(_dispatchMutex);
+	if (_workers.empty() || taskCount == 1) {
+		for (UINT32 i = 0; i < taskCount; i++) {
+			callback(context, i);
+		}
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done.wait(lock, [this]() { return _busyWorkers == 0; });
+		UINT32 threadCount = GetThreadCount();
+		for (UINT32 i = 0; i < threadCount; i++) {
+			_ranges[i].Range.store(PackRange(GetRangeStart(taskCount, i, threadCount), GetRangeStart(taskCount, i + 1, threadCount)), std::memory_order_relaxed);
+		}
+		_generation++;
+		_callback = callback;
+		_context = context;
+		_taskCount = taskCount;
+		_finishedTasks = 0;
+	}
+	_wake.notify_all();
+
+	RunTasks(0, callback, context);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [this]() { return _finishedTasks.load() == _taskCount; });
+}
+void EZ::ThreadPool::WorkerMain(UINT32 threadIndex, BOOL pin) {
+	if (pin) {
+		PinCurrentThread(threadIndex % std::thread::hardware_concurrency());
+	}
+	UINT32 seenGeneration = 0;
+	while (true) {
+		EZ::TaskCallback callback;
+		void* context;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this, seenGeneration]() { return _stopping || _generation != seenGeneration; });
+			if (_stopping) {
+				return;
+			}
+			seenGeneration = _generation;
+			callback = _callback;
+			context = _context;
+			_busyWorkers++;
+		}
+		RunTasks(threadIndex, callback, context);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_busyWorkers--;
+		}
+		_done.notify_all();
+	}
+}
+void EZ::ThreadPool::RunTasks(UINT32 threadIndex, EZ::TaskCallback callback, void* context) {
+	std::atomic<UINT64>& range = _ranges[threadIndex].Range;
+	// A range can be stolen again after it was stolen, so tasks are counted as stolen where they run rather than
+	// where they are stolen. That counts each task once however many times it moved.
+	UINT32 threadCount = GetThreadCount();
+	UINT32 ownStart = GetRangeStart(_taskCount, threadIndex, threadCount);
+	UINT32 ownEnd = GetRangeStart(_taskCount, threadIndex + 1, threadCount);
+	UINT32 finished = 0;
+	UINT32 stolen = 0;
+	UINT64 current = range.load(std::memory_order_acquire);
+	while (true) {
+		UINT32 begin = static_cast<UINT32>(current);
+		UINT32 end = static_cast<UINT32>(current >> 32);
+		if (begin >= end) {
+			if (!Steal(threadIndex)) {
+				break;
+			}
+			current = range.load(std::memory_order_acquire);
+			continue;
+		}
+		if (!range.compare_exchange_weak(current, PackRange(begin + 1, end), std::memory_order_acq_rel)) {
+			continue;
+		}
+		callback(context, begin);
+		finished++;
+		if (begin < ownStart || begin >= ownEnd) {
+			stolen++;
+		}
+		current = range.load(std::memory_order_acquire);
+	}
+	if (stolen != 0) {
+		_stolenTasks.fetch_add(stolen, std::memory_order_relaxed);
+	}
+	if (finished != 0 && _finishedTasks.fetch_add(finished) + finished == _taskCount) {
+		// Take the lock so the notify can't slip in between the caller checking and going to sleep.
+		std::lock_guard<std::mutex> lock(_mutex);
+		_done.notify_all();
+	}
+}
+BOOL EZ::ThreadPool::Steal(UINT32 threadIndex) {
+	UINT32 threadCount = GetThreadCount();
+	// Start from the next thread so thieves spread out over victims instead of all hitting thread 0.
+	for (UINT32 i = 1; i < threadCount; i++) {
+		std::atomic<UINT64>& victim = _ranges[(threadIndex + i) % threadCount].Range;
+		UINT64 current = victim.load(std::memory_order_acquire);
+		while (true) {
+			UINT32 begin = static_cast<UINT32>(current);
+			UINT32 end = static_cast<UINT32>(current >> 32);
+			if (begin >= end) {
+				break;
+			}
+			UINT32 middle = end - ((end - begin + 1) / 2);
+			if (victim.compare_exchange_weak(current, PackRange(begin, middle), std::memory_order_acq_rel)) {
+				// Only this thread and thieves finding it empty touch its own range while it is empty.
+				_ranges[threadIndex].Range.store(PackRange(middle, end), std::memory_order_release);
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+EZ::ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = TRUE;
+	}
+	_wake.notify_all();
+	for (std::thread& worker : _workers) {
+		worker.join();
+	}
+	delete[] _ranges;
+}
+
+UINT32 EZ::ThreadPool::GetThreadCount() const {
+	return static_cast<UINT32>(_workers.size()) + 1;
+}
+UINT64 EZ::ThreadPool::GetStolenTaskCount() const {
+	return _stolenTasks.load(std::memory_order_relaxed);
+}
\ No newline at end of file
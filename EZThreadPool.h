@@ -0,0 +1,66 @@
+#pragma once
+#include "EZPlatform.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace EZ {
+	typedef void (*TaskCallback)(void* context, UINT32 taskIndex);
+	// A fixed set of worker threads which split up loops of independent tasks.
+	// Workers sleep on a condition variable between loops so an idle pool costs nothing.
+	class ThreadPool {
+	public:
+		// If workerCount == 0 then one worker is created for every hardware thread except the calling one.
+		// If pinThreads is TRUE worker i only ever runs on hardware thread i. Together with ParallelFor giving every
+		// thread the same tasks each loop this keeps the data a task touches in the caches and on the NUMA node
+		// of the thread which first touched it.
+		ThreadPool(UINT32 workerCount = 0, BOOL pinThreads = FALSE);
+		// Calls callback(context, taskIndex) once for every taskIndex from 0 to taskCount - 1 and returns when all of them are done.
+		// The tasks are split into one contiguous range per thread, with the thread calling ParallelFor taking the first
+		// range. The same taskCount always gives each thread the same range so data a task touched last loop is likely still
+		// close by. A thread which runs out steals the back half of another thread's range, so any task may run on any thread.
+		// Only one ParallelFor runs at a time. Calls from other threads wait their turn.
+		void ParallelFor(UINT32 taskCount, EZ::TaskCallback callback, void* context);
+		~ThreadPool();
+
+		// Number of threads which run tasks including the thread calling ParallelFor.
+		UINT32 GetThreadCount() const;
+		// Number of tasks which ran on a thread other than the one whose range they started in.
+		UINT64 GetStolenTaskCount() const;
+
+	private:
+		// The tasks one thread has left. Each range is aligned to its own 64 byte cache line, which new honours for
+		// over-aligned types since C++17, so threads taking tasks from their own range never slow each other down.
+		struct alignas(64) TaskRange {
+			// The low 32 bits hold the next task and the high 32 bits the end of the range. Packing both into one word
+			// lets the owner take from the front while thieves take from the back with a single compare exchange each.
+			std::atomic<UINT64> Range;
+		};
+		void WorkerMain(UINT32 threadIndex, BOOL pin);
+		// Runs tasks from the range of threadIndex and then steals from the others until every range is empty.
+		void RunTasks(UINT32 threadIndex, EZ::TaskCallback callback, void* context);
+		// Moves the back half of another thread's range into the range of threadIndex.
+		// Returns FALSE if every other range is empty.
+		BOOL Steal(UINT32 threadIndex);
+
+		std::vector<std::thread> _workers;
+		TaskRange* _ranges;
+		std::mutex _dispatchMutex;
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		std::condition_variable _done;
+		UINT32 _generation;
+		BOOL _stopping;
+		// Number of workers inside RunTasks. A new loop only starts once this is 0 so a worker which is late
+		// for one loop can never run tasks of the next one with the old callback.
+		UINT32 _busyWorkers;
+
+		EZ::TaskCallback _callback;
+		void* _context;
+		UINT32 _taskCount;
+		std::atomic<UINT32> _finishedTasks;
+		std::atomic<UINT64> _stolenTasks;
+	};
+}
\ No newline at end of file
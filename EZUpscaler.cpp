@@ -0,0 +1,350 @@
+#include "EZUpscaler.h"
+#include "EZCpu.h"
+#include "EZProfiler.h"
+#include <algorithm>
+#include <cstring>
+#ifdef EZ_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+	// Returns the row or column of a source size pixel i of a destination size lands in when the centers are lined up.
+	UINT32 NearestIndex(UINT32 i, UINT32 sourceSize, UINT32 destinationSize) {
+		return static_cast<UINT32>(((static_cast<UINT64>(i) * 2 + 1) * sourceSize) / (static_cast<UINT64>(destinationSize) * 2));
+	}
+
+	void CopyRow(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount) {
+		memcpy(destination, source, static_cast<size_t>(destinationCount) * 4);
+	}
+	void ScaleRowScalar(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount) {
+		for (UINT32 i = 0; i < count; i++) {
+			std::fill(destination, destination + runs[i], source[i]);
+			destination += runs[i];
+		}
+	}
+	// Scale2x of row pixels begin to end. Pixels past the left and right edges repeat the edge pixel.
+	void Scale2xPixels(const UINT32* above, const UINT32* row, const UINT32* below, UINT32 count, UINT32 begin, UINT32 end, UINT32* top, UINT32* bottom) {
+		for (UINT32 x = begin; x < end; x++) {
+			UINT32 a = above[x];
+			UINT32 b = row[x + 1 < count ? x + 1 : x];
+			UINT32 c = row[x > 0 ? x - 1 : x];
+			UINT32 d = below[x];
+			UINT32 p = row[x];
+			top[x * 2] = c == a && c != d && a != b ? a : p;
+			top[x * 2 + 1] = a == b && a != c && b != d ? b : p;
+			bottom[x * 2] = d == c && d != b && c != a ? c : p;
+			bottom[x * 2 + 1] = b == d && b != a && d != c ? d : p;
+		}
+	}
+	void Scale2xRowScalar(const UINT32* above, const UINT32* row, const UINT32* below, UINT32 count, UINT32* top, UINT32* bottom) {
+		Scale2xPixels(above, row, below, count, 0, count, top, bottom);
+	}
+	// Scale3x of a whole row. It has no SIMD version since each pixel has nine outputs with different rules,
+	// so it relies on the bands being spread across threads.
+	void Scale3xRow(const UINT32* above, const UINT32* row, const UINT32* below, UINT32 count, UINT32* outputs[3]) {
+		for (UINT32 x = 0; x < count; x++) {
+			UINT32 left = x > 0 ? x - 1 : x;
+			UINT32 right = x + 1 < count ? x + 1 : x;
+			UINT32 a = above[left], b = above[x], c = above[right];
+			UINT32 d = row[left], e = row[x], f = row[right];
+			UINT32 g = below[left], h = below[x], i = below[right];
+			UINT32* top = outputs[0] + (x * 3);
+			UINT32* middle = outputs[1] + (x * 3);
+			UINT32* bottom = outputs[2] + (x * 3);
+			if (b != h && d != f) {
+				top[0] = d == b ? d : e;
+				top[1] = (d == b && e != c) || (b == f && e != a) ? b : e;
+				top[2] = b == f ? f : e;
+				middle[0] = (d == b && e != g) || (d == h && e != a) ? d : e;
+				middle[1] = e;
+				middle[2] = (b == f && e != i) || (h == f && e != c) ? f : e;
+				bottom[0] = d == h ? d : e;
+				bottom[1] = (d == h && e != i) || (h == f && e != g) ? h : e;
+				bottom[2] = h == f ? f : e;
+			}
+			else {
+				std::fill(top, top + 3, e);
+				std::fill(middle, middle + 3, e);
+				std::fill(bottom, bottom + 3, e);
+			}
+		}
+	}
+
+#ifdef EZ_X86
+	// Every run is one broadcast store, or more for runs longer than a vector. Stores run past the end of the run into
+	// pixels the following runs overwrite, so only runs too close to the end of the row to do that are left to the scalar loop.
+	EZ_TARGET("sse2") void ScaleRowSSE2(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount) {
+		UINT32* end = destination + destinationCount;
+		UINT32 i = 0;
+		for (; i < count; i++) {
+			UINT32 run = runs[i];
+			if (static_cast<size_t>(end - destination) < ((run + 3) & ~3u)) {
+				break;
+			}
+			__m128i pixel = _mm_set1_epi32(static_cast<int>(source[i]));
+			for (UINT32 written = 0; written < run; written += 4) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + written), pixel);
+			}
+			destination += run;
+		}
+		ScaleRowScalar(source + i, runs + i, count - i, destination, static_cast<UINT32>(end - destination));
+	}
+	EZ_TARGET("sse2") void DoubleRowSSE2(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount) {
+		UINT32 i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + (i * 2)), _mm_unpacklo_epi32(pixels, pixels));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + (i * 2) + 4), _mm_unpackhi_epi32(pixels, pixels));
+		}
+		ScaleRowScalar(source + i, runs + i, count - i, destination + (i * 2), destinationCount - (i * 2));
+	}
+	// Scale2x on 4 pixels at once. The four rules only need four comparisons between the neighbours.
+	EZ_TARGET("sse2") void Scale2xRowSSE2(const UINT32* above, const UINT32* row, const UINT32* below, UINT32 count, UINT32* top, UINT32* bottom) {
+		Scale2xPixels(above, row, below, count, 0, count < 1 ? count : 1, top, bottom);
+		UINT32 x = 1;
+		for (; x + 5 <= count; x += 4) {
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + x));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 1));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 1));
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + x));
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+			__m128i ca = _mm_cmpeq_epi32(c, a);
+			__m128i cd = _mm_cmpeq_epi32(c, d);
+			__m128i ab = _mm_cmpeq_epi32(a, b);
+			__m128i bd = _mm_cmpeq_epi32(b, d);
+			__m128i useA = _mm_andnot_si128(_mm_or_si128(cd, ab), ca);
+			__m128i useB = _mm_andnot_si128(_mm_or_si128(ca, bd), ab);
+			__m128i useC = _mm_andnot_si128(_mm_or_si128(bd, ca), cd);
+			__m128i useD = _mm_andnot_si128(_mm_or_si128(ab, cd), bd);
+			__m128i e0 = _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, p));
+			__m128i e1 = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, p));
+			__m128i e2 = _mm_or_si128(_mm_and_si128(useC, c), _mm_andnot_si128(useC, p));
+			__m128i e3 = _mm_or_si128(_mm_and_si128(useD, d), _mm_andnot_si128(useD, p));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(top + (x * 2)), _mm_unpacklo_epi32(e0, e1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(top + (x * 2) + 4), _mm_unpackhi_epi32(e0, e1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + (x * 2)), _mm_unpacklo_epi32(e2, e3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + (x * 2) + 4), _mm_unpackhi_epi32(e2, e3));
+		}
+		Scale2xPixels(above, row, below, count, x < count ? x : count, count, top, bottom);
+	}
+
+	EZ_TARGET("avx2") void ScaleRowAVX2(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount) {
+		UINT32* end = destination + destinationCount;
+		UINT32 i = 0;
+		for (; i < count; i++) {
+			UINT32 run = runs[i];
+			if (static_cast<size_t>(end - destination) < ((run + 7) & ~7u)) {
+				break;
+			}
+			__m256i pixel = _mm256_set1_epi32(static_cast<int>(source[i]));
+			for (UINT32 written = 0; written < run; written += 8) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + written), pixel);
+			}
+			destination += run;
+		}
+		ScaleRowScalar(source + i, runs + i, count - i, destination, static_cast<UINT32>(end - destination));
+	}
+	// The unpacks work inside each 128 bit lane so the lanes are swapped back into order before storing.
+	EZ_TARGET("avx2") void DoubleRowAVX2(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount) {
+		UINT32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			__m256i low = _mm256_unpacklo_epi32(pixels, pixels);
+			__m256i high = _mm256_unpackhi_epi32(pixels, pixels);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + (i * 2)), _mm256_permute2x128_si256(low, high, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + (i * 2) + 8), _mm256_permute2x128_si256(low, high, 0x31));
+		}
+		ScaleRowScalar(source + i, runs + i, count - i, destination + (i * 2), destinationCount - (i * 2));
+	}
+	EZ_TARGET("avx2") void Scale2xRowAVX2(const UINT32* above, const UINT32* row, const UINT32* below, UINT32 count, UINT32* top, UINT32* bottom) {
+		Scale2xPixels(above, row, below, count, 0, count < 1 ? count : 1, top, bottom);
+		UINT32 x = 1;
+		for (; x + 9 <= count; x += 8) {
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 1));
+			__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x - 1));
+			__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + x));
+			__m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+			__m256i ca = _mm256_cmpeq_epi32(c, a);
+			__m256i cd = _mm256_cmpeq_epi32(c, d);
+			__m256i ab = _mm256_cmpeq_epi32(a, b);
+			__m256i bd = _mm256_cmpeq_epi32(b, d);
+			__m256i e0 = _mm256_blendv_epi8(p, a, _mm256_andnot_si256(_mm256_or_si256(cd, ab), ca));
+			__m256i e1 = _mm256_blendv_epi8(p, b, _mm256_andnot_si256(_mm256_or_si256(ca, bd), ab));
+			__m256i e2 = _mm256_blendv_epi8(p, c, _mm256_andnot_si256(_mm256_or_si256(bd, ca), cd));
+			__m256i e3 = _mm256_blendv_epi8(p, d, _mm256_andnot_si256(_mm256_or_si256(ab, cd), bd));
+			__m256i topLow = _mm256_unpacklo_epi32(e0, e1);
+			__m256i topHigh = _mm256_unpackhi_epi32(e0, e1);
+			__m256i bottomLow = _mm256_unpacklo_epi32(e2, e3);
+			__m256i bottomHigh = _mm256_unpackhi_epi32(e2, e3);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(top + (x * 2)), _mm256_permute2x128_si256(topLow, topHigh, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(top + (x * 2) + 8), _mm256_permute2x128_si256(topLow, topHigh, 0x31));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(bottom + (x * 2)), _mm256_permute2x128_si256(bottomLow, bottomHigh, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(bottom + (x * 2) + 8), _mm256_permute2x128_si256(bottomLow, bottomHigh, 0x31));
+		}
+		Scale2xPixels(above, row, below, count, x < count ? x : count, count, top, bottom);
+	}
+#endif
+}
+
+EZ::Upscaler::Upscaler(EZ::UpscalerSettings settings) {
+	_settings = settings;
+	if (_settings.SourceWidth == 0) {
+		_settings.SourceWidth = DefaultRendererWidth;
+	}
+	if (_settings.SourceHeight == 0) {
+		_settings.SourceHeight = DefaultRendererHeight;
+	}
+
+	_kernels = { ScaleRowScalar, ScaleRowScalar, Scale2xRowScalar };
+#ifdef EZ_X86
+	const EZ::CpuFeatures& features = EZ::GetCpuFeatures();
+	if (!_settings.DisableSimd && features.AVX2) {
+		_kernels = { ScaleRowAVX2, DoubleRowAVX2, Scale2xRowAVX2 };
+	}
+	else if (!_settings.DisableSimd && features.SSE2) {
+		_kernels = { ScaleRowSSE2, DoubleRowSSE2, Scale2xRowSSE2 };
+	}
+#endif
+	_source = nullptr;
+	_sourceStride = 0;
+	_destination = nullptr;
+	_destinationStride = 0;
+	Resize({ _settings.DestinationWidth, _settings.DestinationHeight });
+}
+void EZ::Upscaler::Upscale(const BYTE* source, UINT32 sourceStride, BYTE* destination, UINT32 destinationStride) {
+	_source = source;
+	_sourceStride = sourceStride;
+	_destination = destination;
+	_destinationStride = destinationStride;
+
+	if (_filterScale > 1) {
+		UINT32 bandCount = (_settings.SourceHeight + FilterBandHeight - 1) / FilterBandHeight;
+		if (_settings.ThreadPool != nullptr && bandCount > 1) {
+			_settings.ThreadPool->ParallelFor(bandCount, FilterBandTask, this);
+		}
+		else {
+			for (UINT32 bandIndex = 0; bandIndex < bandCount; bandIndex++) {
+				FilterBand(bandIndex);
+			}
+		}
+	}
+	// The filter wrote straight into the destination when it came out at exactly the right size.
+	if (_filterScale == 1 || !_filtered.empty()) {
+		UINT32 bandCount = (_settings.DestinationHeight + UpscaleBandHeight - 1) / UpscaleBandHeight;
+		if (_settings.ThreadPool != nullptr && bandCount > 1) {
+			_settings.ThreadPool->ParallelFor(bandCount, ScaleBandTask, this);
+		}
+		else {
+			for (UINT32 bandIndex = 0; bandIndex < bandCount; bandIndex++) {
+				ScaleBand(bandIndex);
+			}
+		}
+	}
+
+	_source = nullptr;
+	_destination = nullptr;
+}
+void EZ::Upscaler::Resize(D2D1_SIZE_U destinationSize) {
+	_settings.DestinationWidth = destinationSize.width == 0 ? _settings.SourceWidth : destinationSize.width;
+	_settings.DestinationHeight = destinationSize.height == 0 ? _settings.SourceHeight : destinationSize.height;
+	BuildTables();
+}
+void EZ::Upscaler::BuildTables() {
+	switch (_settings.Filter) {
+	case EZ::UpscaleFilter::Scale2x:
+		_filterScale = 2;
+		break;
+	case EZ::UpscaleFilter::Scale3x:
+		_filterScale = 3;
+		break;
+	default:
+		_filterScale = 1;
+		break;
+	}
+	UINT32 width = _settings.SourceWidth * _filterScale;
+	UINT32 height = _settings.SourceHeight * _filterScale;
+	_filtered.clear();
+	if (_filterScale > 1 && (width != _settings.DestinationWidth || height != _settings.DestinationHeight)) {
+		_filtered.resize(static_cast<size_t>(width) * height);
+	}
+	_filtered.shrink_to_fit();
+
+	_runs.assign(width, 0);
+	for (UINT32 x = 0; x < _settings.DestinationWidth; x++) {
+		_runs[NearestIndex(x, width, _settings.DestinationWidth)]++;
+	}
+	_rows.resize(_settings.DestinationHeight);
+	for (UINT32 y = 0; y < _settings.DestinationHeight; y++) {
+		_rows[y] = NearestIndex(y, height, _settings.DestinationHeight);
+	}
+
+	BOOL allOnes = TRUE;
+	BOOL allTwos = TRUE;
+	for (UINT32 run : _runs) {
+		allOnes = allOnes && run == 1;
+		allTwos = allTwos && run == 2;
+	}
+	_scaleRow = allOnes ? CopyRow : (allTwos ? _kernels.DoubleRow : _kernels.ScaleRow);
+}
+void EZ::Upscaler::FilterBandTask(void* context, UINT32 bandIndex) {
+	reinterpret_cast<EZ::Upscaler*>(context)->FilterBand(bandIndex);
+}
+void EZ::Upscaler::FilterBand(UINT32 bandIndex) {
+	EZ::ProfileScope scope("FilterBand");
+	UINT32 bandTop = bandIndex * FilterBandHeight;
+	UINT32 bandBottom = (std::min)(bandTop + FilterBandHeight, _settings.SourceHeight);
+	BYTE* output = _filtered.empty() ? _destination : reinterpret_cast<BYTE*>(_filtered.data());
+	size_t outputStride = _filtered.empty() ? _destinationStride : static_cast<size_t>(_settings.SourceWidth) * _filterScale * 4;
+	for (UINT32 y = bandTop; y < bandBottom; y++) {
+		// Rows past the top and bottom edges repeat the edge row.
+		const UINT32* above = reinterpret_cast<const UINT32*>(_source + (static_cast<size_t>(y > 0 ? y - 1 : y) * _sourceStride));
+		const UINT32* row = reinterpret_cast<const UINT32*>(_source + (static_cast<size_t>(y) * _sourceStride));
+		const UINT32* below = reinterpret_cast<const UINT32*>(_source + (static_cast<size_t>(y + 1 < _settings.SourceHeight ? y + 1 : y) * _sourceStride));
+		UINT32* outputs[3] = { };
+		for (UINT32 i = 0; i < _filterScale; i++) {
+			outputs[i] = reinterpret_cast<UINT32*>(output + ((static_cast<size_t>(y) * _filterScale + i) * outputStride));
+		}
+		if (_filterScale == 2) {
+			_kernels.Scale2xRow(above, row, below, _settings.SourceWidth, outputs[0], outputs[1]);
+		}
+		else {
+			Scale3xRow(above, row, below, _settings.SourceWidth, outputs);
+		}
+	}
+}
+void EZ::Upscaler::ScaleBandTask(void* context, UINT32 bandIndex) {
+	reinterpret_cast<EZ::Upscaler*>(context)->ScaleBand(bandIndex);
+}
+void EZ::Upscaler::ScaleBand(UINT32 bandIndex) {
+	EZ::ProfileScope scope("UpscaleBand");
+	UINT32 bandTop = bandIndex * UpscaleBandHeight;
+	UINT32 bandBottom = (std::min)(bandTop + UpscaleBandHeight, _settings.DestinationHeight);
+	const BYTE* frame = _filtered.empty() ? _source : reinterpret_cast<const BYTE*>(_filtered.data());
+	size_t frameStride = _filtered.empty() ? _sourceStride : static_cast<size_t>(_settings.SourceWidth) * _filterScale * 4;
+	UINT32 frameWidth = static_cast<UINT32>(_runs.size());
+	size_t rowBytes = static_cast<size_t>(_settings.DestinationWidth) * 4;
+	for (UINT32 y = bandTop; y < bandBottom; y++) {
+		BYTE* row = _destination + (static_cast<size_t>(y) * _destinationStride);
+		if (y > bandTop && _rows[y] == _rows[y - 1]) {
+			// Scaling up repeats each row so it is copied from the one above, which is still in the cache.
+			memcpy(row, row - _destinationStride, rowBytes);
+		}
+		else {
+			const UINT32* frameRow = reinterpret_cast<const UINT32*>(frame + (_rows[y] * frameStride));
+			_scaleRow(frameRow, _runs.data(), frameWidth, reinterpret_cast<UINT32*>(row), _settings.DestinationWidth);
+		}
+	}
+}
+EZ::Upscaler::~Upscaler() {
+	_filtered.clear();
+	_runs.clear();
+	_rows.clear();
+}
+
+D2D1_SIZE_U EZ::Upscaler::GetDestinationSize() const {
+	return { _settings.DestinationWidth, _settings.DestinationHeight };
+}
+EZ::UpscalerSettings EZ::Upscaler::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZGeometry.h"
+#include "EZThreadPool.h"
+#include <vector>
+
+namespace EZ {
+	// Height in rows of the horizontal bands of the destination EZ::Upscaler splits its work into.
+	constexpr UINT32 UpscaleBandHeight = 64;
+	// Height in source rows of the bands Scale2x and Scale3x are run in.
+	constexpr UINT32 FilterBandHeight = 16;
+	enum class UpscaleFilter : BYTE {
+		// Every destination pixel is the source pixel its center lands in, like D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR.
+		Nearest = 0,
+		// Scale2x, also known as AdvMAME2x, doubles the frame rounding off diagonal staircases without adding new colors.
+		// The doubled frame is then scaled to the destination with Nearest.
+		Scale2x = 1,
+		// Scale3x, also known as AdvMAME3x, the same idea at three times the size.
+		Scale3x = 2,
+	};
+	struct UpscalerSettings {
+		// Stores the size of the frames passed to Upscale in pixels.
+		// If SourceWidth == 0 then DefaultRendererWidth is used.
+		UINT32 SourceWidth;
+		// If SourceHeight == 0 then DefaultRendererHeight is used.
+		UINT32 SourceHeight;
+		// Stores the size of the frames Upscale writes in pixels. Smaller than the source also works but skips pixels.
+		// If DestinationWidth == 0 then SourceWidth is used.
+		UINT32 DestinationWidth;
+		// If DestinationHeight == 0 then SourceHeight is used.
+		UINT32 DestinationHeight;
+		EZ::UpscaleFilter Filter;
+		// If ThreadPool != nullptr the bands are split across its threads. Else they are all drawn on the calling thread.
+		// The pool must outlive the upscaler.
+		EZ::ThreadPool* ThreadPool;
+		// If DisableSimd is TRUE every row is scaled by the plain C++ loops even when the CPU has SSE2 or AVX2.
+		// The output is the same either way so this is only useful for checking and benchmarking the SIMD rows.
+		BOOL DisableSimd;
+	};
+	// Scales B8G8R8A8 frames to a fixed destination size on the CPU for outputs which can't ask Direct2D to stretch
+	// the frame, such as the software renderer, captures and frame exports.
+	// The source pixel of every destination column is worked out once in the constructor and stored as a table of
+	// how many destination pixels each source column covers, so a row is one broadcast store per run whether the
+	// factor is a whole number or not, and exact doubling is done with unpacks. Destination rows landing in the same
+	// source row as the row above are copied from it instead of being scaled again. Both stages run in bands of rows
+	// which never share pixels, so they can be drawn on different threads and still give the same result as one thread.
+	class Upscaler {
+	public:
+		Upscaler(EZ::UpscalerSettings settings);
+		// Scales the source frame into destination. Strides are the bytes from the start of one row to the next.
+		// source must not overlap destination.
+		void Upscale(const BYTE* source, UINT32 sourceStride, BYTE* destination, UINT32 destinationStride);
+		// Changes the destination size, for example when the window is resized. 0 uses the source size like the settings.
+		void Resize(D2D1_SIZE_U destinationSize);
+		~Upscaler();
+
+		D2D1_SIZE_U GetDestinationSize() const;
+		EZ::UpscalerSettings GetSettings() const;
+
+	private:
+		// The loops every band is drawn with, picked once in the constructor from the CPU features.
+		struct RowKernels {
+			// Writes runs[i] copies of source[i] for each of count source pixels into the destinationCount pixels of destination.
+			void (*ScaleRow)(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount);
+			// ScaleRow for when every run is 2.
+			void (*DoubleRow)(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount);
+			// Applies Scale2x to row using the rows above and below, writing two rows of count * 2 pixels.
+			void (*Scale2xRow)(const UINT32* above, const UINT32* row, const UINT32* below, UINT32 count, UINT32* top, UINT32* bottom);
+		};
+		// Works out the filter size, the run table and the row table for the current settings.
+		void BuildTables();
+		static void FilterBandTask(void* context, UINT32 bandIndex);
+		void FilterBand(UINT32 bandIndex);
+		static void ScaleBandTask(void* context, UINT32 bandIndex);
+		void ScaleBand(UINT32 bandIndex);
+
+		RowKernels _kernels;
+		// 1 for Nearest, else how many times larger the filtered frame is than the source.
+		UINT32 _filterScale;
+		// The filtered frame Nearest scales from. Empty if there is no filter or the filtered frame is the destination.
+		std::vector<UINT32> _filtered;
+		// How many destination pixels each column of the frame being scaled covers. Columns skipped when
+		// scaling down have runs of 0.
+		std::vector<UINT32> _runs;
+		// Row of the frame being scaled each destination row comes from.
+		std::vector<UINT32> _rows;
+		// Which of the row kernels scales a row, picked from the runs.
+		void (*_scaleRow)(const UINT32* source, const UINT32* runs, UINT32 count, UINT32* destination, UINT32 destinationCount);
+		EZ::UpscalerSettings _settings;
+
+		// Only valid during Upscale so the bands can reach them from the worker threads.
+		const BYTE* _source;
+		UINT32 _sourceStride;
+		BYTE* _destination;
+		UINT32 _destinationStride;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "TinyAudio.h"
+#include "EZCpu.h"
+#include "EZProfiler.h"
+#include <cstring>
+#ifdef EZ_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+	// Mixes the samples from start up to count, which is also how the SIMD mixers finish their last partial vector.
+	void MixScalarRange(const INT16* const* channels, const INT16* volumes, INT16* output, UINT32 start, UINT32 count) {
+		for (UINT32 i = start; i < count; i++) {
+			INT32 sum = 0;
+			for (UINT32 channel = 0; channel < Tiny::AudioChannelCount; channel++) {
+				sum += channels[channel][i] * volumes[channel];
+			}
+			// Shift then saturate exactly like the SIMD mixers' srai and packs so all of them give the same samples.
+			sum >>= 8;
+			output[i] = static_cast<INT16>(sum < -32768 ? -32768 : (sum > 32767 ? 32767 : sum));
+		}
+	}
+	void MixScalar(const INT16* const* channels, const INT16* volumes, INT16* output, UINT32 count) {
+		MixScalarRange(channels, volumes, output, 0, count);
+	}
+
+#ifdef EZ_X86
+	// Interleaving two channels lets one madd multiply both by their volumes and add them, so four channels take
+	// two madds per half of a vector. Unpack and packs both work within 128 bit lanes so the order comes back out right.
+	EZ_TARGET("sse2") void MixSSE2(const INT16* const* channels, const INT16* volumes, INT16* output, UINT32 count) {
+		__m128i volumes01 = _mm_set1_epi32((static_cast<UINT16>(volumes[1]) << 16) | static_cast<UINT16>(volumes[0]));
+		__m128i volumes23 = _mm_set1_epi32((static_cast<UINT16>(volumes[3]) << 16) | static_cast<UINT16>(volumes[2]));
+		UINT32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i channel0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(channels[0] + i));
+			__m128i channel1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(channels[1] + i));
+			__m128i channel2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(channels[2] + i));
+			__m128i channel3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(channels[3] + i));
+			__m128i low = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(channel0, channel1), volumes01), _mm_madd_epi16(_mm_unpacklo_epi16(channel2, channel3), volumes23));
+			__m128i high = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(channel0, channel1), volumes01), _mm_madd_epi16(_mm_unpackhi_epi16(channel2, channel3), volumes23));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(_mm_srai_epi32(low, 8), _mm_srai_epi32(high, 8)));
+		}
+		MixScalarRange(channels, volumes, output, i, count);
+	}
+	EZ_TARGET("avx2") void MixAVX2(const INT16* const* channels, const INT16* volumes, INT16* output, UINT32 count) {
+		__m256i volumes01 = _mm256_set1_epi32((static_cast<UINT16>(volumes[1]) << 16) | static_cast<UINT16>(volumes[0]));
+		__m256i volumes23 = _mm256_set1_epi32((static_cast<UINT16>(volumes[3]) << 16) | static_cast<UINT16>(volumes[2]));
+		UINT32 i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m256i channel0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(channels[0] + i));
+			__m256i channel1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(channels[1] + i));
+			__m256i channel2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(channels[2] + i));
+			__m256i channel3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(channels[3] + i));
+			__m256i low = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(channel0, channel1), volumes01), _mm256_madd_epi16(_mm256_unpacklo_epi16(channel2, channel3), volumes23));
+			__m256i high = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(channel0, channel1), volumes01), _mm256_madd_epi16(_mm256_unpackhi_epi16(channel2, channel3), volumes23));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_packs_epi32(_mm256_srai_epi32(low, 8), _mm256_srai_epi32(high, 8)));
+		}
+		MixScalarRange(channels, volumes, output, i, count);
+	}
+#endif
+}
+
+Tiny::AudioUnit::AudioUnit(Tiny::MemoryBus* bus, Tiny::AudioUnitSettings settings) {
+	_settings = settings;
+	if (_settings.SampleRate == 0) {
+		_settings.SampleRate = DefaultAudioSampleRate;
+	}
+	_mix = MixScalar;
+#ifdef EZ_X86
+	const EZ::CpuFeatures& features = EZ::GetCpuFeatures();
+	if (!_settings.DisableSimd && features.AVX2) {
+		_mix = MixAVX2;
+	}
+	else if (!_settings.DisableSimd && features.SSE2) {
+		_mix = MixSSE2;
+	}
+#endif
+	_bus = bus;
+	for (UINT32 channel = 0; channel < AudioChannelCount; channel++) {
+		_channels[channel] = { 0, 0, 0x7FFF };
+		_channelSamples[channel] = new INT16[GetMaxFrameSamples()];
+	}
+	_frame = new INT16[GetMaxFrameSamples()];
+	_sampleRemainder = 0;
+	_bus->WatchWrites(AudioChannelsAddress, AudioChannelCount * AudioChannelBytes, WatchRegisters, this);
+}
+UINT32 Tiny::AudioUnit::Step() {
+	EZ::ProfileScope scope("Audio");
+	UINT32 count = RenderFrame(_frame);
+	if (_settings.Stream != nullptr) {
+		_settings.Stream->Write(_frame, count);
+	}
+	return count;
+}
+UINT32 Tiny::AudioUnit::RenderFrame(INT16* samples) {
+	UINT32 count = _settings.SampleRate / AudioFrameRate;
+	_sampleRemainder += _settings.SampleRate % AudioFrameRate;
+	if (_sampleRemainder >= AudioFrameRate) {
+		_sampleRemainder -= AudioFrameRate;
+		count++;
+	}
+	INT16 volumes[AudioChannelCount];
+	for (UINT32 channel = 0; channel < AudioChannelCount; channel++) {
+		RenderChannel(channel, count);
+		volumes[channel] = static_cast<INT16>(_channels[channel].Volume);
+	}
+	_mix(_channelSamples, volumes, samples, count);
+
+	// Envelopes move once a frame, after the frame so a triggered note is first heard at its starting volume.
+	const BYTE* registers = _bus->GetMemory() + AudioChannelsAddress;
+	for (UINT32 channel = 0; channel < AudioChannelCount; channel++) {
+		INT32 volume = _channels[channel].Volume + static_cast<INT8>(registers[(channel * AudioChannelBytes) + AudioRegister::Envelope]);
+		_channels[channel].Volume = volume < 0 ? 0 : (volume > 255 ? 255 : volume);
+	}
+	return count;
+}
+void Tiny::AudioUnit::RenderChannel(UINT32 channel, UINT32 count) {
+	// The register page can't be remapped so the registers are always in the bus's own memory.
+	const BYTE* memory = _bus->GetMemory();
+	const BYTE* registers = memory + AudioChannelsAddress + (channel * AudioChannelBytes);
+	UINT32 frequency = registers[AudioRegister::Frequency] | (registers[AudioRegister::Frequency + 1] << 8);
+	Channel& state = _channels[channel];
+	INT16* samples = _channelSamples[channel];
+	if (frequency == 0 || state.Volume == 0) {
+		memset(samples, 0, count * sizeof(INT16));
+		return;
+	}
+	UINT64 step = (static_cast<UINT64>(frequency) << 32) / _settings.SampleRate;
+	UINT32 phase = state.Phase;
+	switch (channel) {
+	case 0:
+	case 1: {
+		// Duty is the part of each period out of 256 the wave is high. 0 means half.
+		UINT32 duty = registers[AudioRegister::Duty] != 0 ? registers[AudioRegister::Duty] : 128;
+		for (UINT32 i = 0; i < count; i++) {
+			samples[i] = (phase >> 24) < duty ? AudioChannelAmplitude : -AudioChannelAmplitude;
+			phase += static_cast<UINT32>(step);
+		}
+		break;
+	}
+	case 2: {
+		const BYTE* wave = memory + AudioWaveAddress;
+		for (UINT32 i = 0; i < count; i++) {
+			samples[i] = static_cast<INT16>((static_cast<INT8>(wave[phase >> 27]) * AudioChannelAmplitude) / 128);
+			phase += static_cast<UINT32>(step);
+		}
+		break;
+	}
+	default: {
+		// The shift register is clocked Frequency times a second, which may be more than once a sample.
+		UINT32 noise = state.Noise;
+		UINT64 position = phase;
+		for (UINT32 i = 0; i < count; i++) {
+			position += step;
+			for (UINT64 clocks = position >> 32; clocks > 0; clocks--) {
+				UINT32 bit = (noise ^ (noise >> 1)) & 1;
+				noise = (noise >> 1) | (bit << 14);
+			}
+			position &= 0xFFFFFFFFull;
+			samples[i] = (noise & 1) != 0 ? -AudioChannelAmplitude : AudioChannelAmplitude;
+		}
+		phase = static_cast<UINT32>(position);
+		state.Noise = noise;
+		break;
+	}
+	}
+	state.Phase = phase;
+}
+void Tiny::AudioUnit::WatchRegisters(void* context, UINT16 address, BYTE oldValue, BYTE newValue) {
+	Tiny::AudioUnit* unit = reinterpret_cast<Tiny::AudioUnit*>(context);
+	UINT32 channel = (address - AudioChannelsAddress) / AudioChannelBytes;
+	UINT32 offset = (address - AudioChannelsAddress) % AudioChannelBytes;
+	if (offset != AudioRegister::Control || (newValue & AudioControl::Trigger) == 0) {
+		return;
+	}
+	BYTE* registers = unit->_bus->GetMemory() + AudioChannelsAddress + (channel * AudioChannelBytes);
+	unit->_channels[channel] = { 0, registers[AudioRegister::Volume], 0x7FFF };
+	// Trigger reads back 0 once the note started so writing it again always changes the byte and is seen.
+	registers[AudioRegister::Control] = static_cast<BYTE>(newValue & ~AudioControl::Trigger);
+}
+Tiny::AudioUnit::~AudioUnit() {
+	_bus->UnwatchWrites(WatchRegisters, this);
+	for (UINT32 channel = 0; channel < AudioChannelCount; channel++) {
+		delete[] _channelSamples[channel];
+		_channelSamples[channel] = nullptr;
+	}
+	delete[] _frame;
+	_frame = nullptr;
+	_bus = nullptr;
+}
+
+UINT32 Tiny::AudioUnit::GetMaxFrameSamples() const {
+	return (_settings.SampleRate / AudioFrameRate) + 1;
+}
+BYTE Tiny::AudioUnit::GetChannelVolume(UINT32 channel) const {
+	return static_cast<BYTE>(_channels[channel].Volume);
+}
+Tiny::AudioUnitSettings Tiny::AudioUnit::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZAudio.h"
+#include "TinyMemoryBus.h"
+
+namespace Tiny {
+	// Channels 0 and 1 play square waves, channel 2 plays AudioWave and channel 3 plays noise.
+	// See the MemSpec in TinyEmulator.txt for the registers.
+	constexpr UINT32 AudioChannelCount = 4;
+	constexpr UINT16 AudioChannelsAddress = 0x0010;
+	constexpr UINT32 AudioChannelBytes = 8;
+	constexpr UINT16 AudioWaveAddress = 0x0030;
+	constexpr UINT32 AudioWaveBytes = 32;
+	constexpr UINT32 DefaultAudioSampleRate = 48000;
+	// The machine steps 60 times a second so every Step renders a sixtieth of a second of audio.
+	constexpr UINT32 AudioFrameRate = 60;
+	// The most any channel's raw wave swings either side of 0. Four channels at full volume just fit in 16 bits.
+	constexpr INT16 AudioChannelAmplitude = 8000;
+	// Offsets of the registers inside each channel's AudioChannelBytes.
+	namespace AudioRegister {
+		constexpr UINT32 Frequency = 0;
+		constexpr UINT32 Volume = 2;
+		constexpr UINT32 Envelope = 3;
+		constexpr UINT32 Duty = 4;
+		constexpr UINT32 Control = 5;
+	}
+	// Bits of the Control register of every channel.
+	namespace AudioControl {
+		constexpr BYTE Trigger = 1 << 0;
+	}
+	struct AudioUnitSettings {
+		// If SampleRate == 0 then DefaultAudioSampleRate is used.
+		UINT32 SampleRate;
+		// If Stream != nullptr then Step writes every frame of samples into it. The stream must outlive the unit.
+		EZ::AudioStream* Stream;
+		// If DisableSimd is TRUE the channels are mixed by the plain C++ loop even when the CPU has SSE2 or AVX2.
+		// The output is the same either way so this is only useful for checking and benchmarking the SIMD mixer.
+		BOOL DisableSimd;
+	};
+	// The sound hardware. The guest plays notes by writing the audio registers in the register page, which are plain
+	// memory so save states keep them, and a write watch catches Trigger the moment it is written.
+	// Each Step renders a whole frame of samples at once: every channel fills its own buffer with its raw wave and the
+	// channels are then mixed at their envelope volumes with SIMD. The frame goes into an EZ::AudioStream whose own
+	// thread feeds the sink, so the frame loop never waits on audio output.
+	// Where each wave is and the envelope volumes are not in memory, so a restored save state keeps the notes
+	// already playing until they are triggered again.
+	class AudioUnit {
+	public:
+		// Watches the audio registers on bus. bus must outlive the unit.
+		AudioUnit(Tiny::MemoryBus* bus, Tiny::AudioUnitSettings settings);
+		// Renders the next frame of samples and writes it to AudioUnitSettings::Stream. Call it once after every
+		// Tiny::Machine::Step. Returns the number of samples rendered.
+		UINT32 Step();
+		// Renders the next frame into samples, which must hold GetMaxFrameSamples(), and moves every envelope on by a
+		// frame. Returns the number of samples rendered. Frames are SampleRate / AudioFrameRate samples long with the
+		// remainder spread over the frames so a second of frames is exactly a second of samples.
+		UINT32 RenderFrame(INT16* samples);
+		// Stops watching the audio registers.
+		~AudioUnit();
+
+		UINT32 GetMaxFrameSamples() const;
+		// Returns the envelope volume channel is playing at, 0 - 255.
+		BYTE GetChannelVolume(UINT32 channel) const;
+		Tiny::AudioUnitSettings GetSettings() const;
+
+	private:
+		// Mixes count samples of the AudioChannelCount channel buffers into output, each scaled by its volume out of 256.
+		typedef void (*MixKernel)(const INT16* const* channels, const INT16* volumes, INT16* output, UINT32 count);
+		struct Channel {
+			// Position in the wave period as a fraction of 2^32.
+			UINT32 Phase;
+			INT32 Volume;
+			// 15 bit linear feedback shift register the noise channel plays the low bit of.
+			UINT32 Noise;
+		};
+		static void WatchRegisters(void* context, UINT16 address, BYTE oldValue, BYTE newValue);
+		// Fills count samples of _channelSamples[channel] with the raw wave of channel.
+		void RenderChannel(UINT32 channel, UINT32 count);
+
+		Tiny::MemoryBus* _bus;
+		MixKernel _mix;
+		Channel _channels[AudioChannelCount];
+		INT16* _channelSamples[AudioChannelCount];
+		INT16* _frame;
+		// Samples owed to the next frames from SampleRate not dividing evenly by AudioFrameRate, in 1 / AudioFrameRate.
+		UINT32 _sampleRemainder;
+		Tiny::AudioUnitSettings _settings;
+	};
+}
\ No newline at end of file
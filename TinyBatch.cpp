@@ -0,0 +1,107 @@
+#include "TinyBatch.h"
+#include "EZClock.h"
+#include "EZError.h"
+#include <algorithm>
+
+Tiny::Batch::Batch(Tiny::BatchSettings settings) {
+	_settings = settings;
+	if (_settings.CreateMachine == nullptr) {
+		throw EZ::Error("BatchSettings::CreateMachine must not be nullptr.");
+	}
+	if (_settings.FramesPerTask == 0) {
+		_settings.FramesPerTask = DefaultFramesPerTask;
+	}
+	_ownsThreadPool = _settings.ThreadPool == nullptr;
+	_threadPool = _ownsThreadPool ? new EZ::ThreadPool(0, TRUE) : _settings.ThreadPool;
+	_framesThisTask = 0;
+	_stats = { };
+
+	_instances.resize(_settings.InstanceCount, { nullptr, nullptr });
+	_threadPool->ParallelFor(_settings.InstanceCount, CreateInstance, this);
+	for (const Instance& instance : _instances) {
+		if (instance.Machine == nullptr) {
+			// Exceptions can't cross from the workers back to here so a failed instance is only noticed now.
+			for (Instance& created : _instances) {
+				delete created.Machine;
+				delete[] created.FrameBuffer;
+			}
+			if (_ownsThreadPool) {
+				delete _threadPool;
+			}
+			throw EZ::Error("BatchSettings::CreateMachine returned nullptr.");
+		}
+	}
+}
+void Tiny::Batch::CreateInstance(void* context, UINT32 instanceIndex) {
+	Tiny::Batch* batch = reinterpret_cast<Tiny::Batch*>(context);
+	Instance& instance = batch->_instances[instanceIndex];
+	instance.Machine = batch->_settings.CreateMachine(batch->_settings.Context, instanceIndex);
+	if (batch->_settings.Render) {
+		// Zeroing the frame buffer here rather than on first Render touches it from this thread too.
+		instance.FrameBuffer = new BYTE[FrameBufferSize]();
+	}
+}
+void Tiny::Batch::Run(UINT32 frameCount) {
+	UINT64 start = EZ::GetNanoseconds();
+	UINT64 stolenBefore = _threadPool->GetStolenTaskCount();
+	UINT32 remaining = frameCount;
+	while (remaining > 0) {
+		_framesThisTask = (std::min)(remaining, _settings.FramesPerTask);
+		_threadPool->ParallelFor(static_cast<UINT32>(_instances.size()), StepInstance, this);
+		remaining -= _framesThisTask;
+	}
+	_stats.Frames += static_cast<UINT64>(frameCount) * _instances.size();
+	_stats.Nanoseconds += EZ::GetNanoseconds() - start;
+	_stats.StolenTasks += _threadPool->GetStolenTaskCount() - stolenBefore;
+}
+void Tiny::Batch::StepInstance(void* context, UINT32 instanceIndex) {
+	Tiny::Batch* batch = reinterpret_cast<Tiny::Batch*>(context);
+	const Instance& instance = batch->_instances[instanceIndex];
+	for (UINT32 i = 0; i < batch->_framesThisTask; i++) {
+		instance.Machine->Step();
+		if (instance.FrameBuffer != nullptr) {
+			instance.Machine->Render(instance.FrameBuffer, ScreenWidth * 4);
+		}
+	}
+}
+UINT64 Tiny::Batch::GetStateHash() const {
+	_instanceHashes.resize(_instances.size());
+	_threadPool->ParallelFor(static_cast<UINT32>(_instances.size()), HashInstance, const_cast<Tiny::Batch*>(this));
+	UINT64 hash = 14695981039346656037ull;
+	for (UINT64 instanceHash : _instanceHashes) {
+		for (UINT32 i = 0; i < 8; i++) {
+			hash = (hash ^ static_cast<BYTE>(instanceHash >> (i * 8))) * 1099511628211ull;
+		}
+	}
+	return hash;
+}
+void Tiny::Batch::HashInstance(void* context, UINT32 instanceIndex) {
+	Tiny::Batch* batch = reinterpret_cast<Tiny::Batch*>(context);
+	batch->_instanceHashes[instanceIndex] = batch->_instances[instanceIndex].Machine->GetStateHash();
+}
+Tiny::Batch::~Batch() {
+	for (Instance& instance : _instances) {
+		delete instance.Machine;
+		delete[] instance.FrameBuffer;
+	}
+	_instances.clear();
+	if (_ownsThreadPool) {
+		delete _threadPool;
+	}
+}
+
+UINT32 Tiny::Batch::GetInstanceCount() const {
+	return static_cast<UINT32>(_instances.size());
+}
+Tiny::Machine* Tiny::Batch::GetInstance(UINT32 instanceIndex) const {
+	return _instances[instanceIndex].Machine;
+}
+const BYTE* Tiny::Batch::GetFrameBuffer(UINT32 instanceIndex) const {
+	return _instances[instanceIndex].FrameBuffer;
+}
+Tiny::BatchStats Tiny::Batch::GetStats() const {
+	return _stats;
+}
+Tiny::BatchSettings Tiny::Batch::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMachine.h"
+#include "EZThreadPool.h"
+#include <vector>
+
+namespace Tiny {
+	// Creates instance number instanceIndex of a batch. context is BatchSettings::Context.
+	// The returned machine is owned by the batch and deleted with it.
+	typedef Tiny::Machine* (*CreateMachineCallback)(void* context, UINT32 instanceIndex);
+	// One frame per task keeps every instance on the same frame between ParallelFor calls.
+	constexpr UINT32 DefaultFramesPerTask = 1;
+	struct BatchSettings {
+		// Number of independent machines in the batch.
+		UINT32 InstanceCount;
+		// Called once for every instance. Calls are spread over the thread pool the same way Run spreads steps, so each
+		// machine is allocated and first touched by the thread which usually steps it and its memory ends up on that
+		// thread's NUMA node. It must not be nullptr and must not return nullptr.
+		Tiny::CreateMachineCallback CreateMachine;
+		// This is a user defined pointer which is passed to CreateMachine.
+		void* Context;
+		// If ThreadPool == nullptr the batch creates its own pool with a worker pinned to every hardware thread.
+		// Instances must not use this pool as their MachineSettings::ThreadPool because a task can't wait on the pool running it.
+		EZ::ThreadPool* ThreadPool;
+		// Frames a task steps one instance before moving on to the next. Stepping an instance several frames in a row
+		// keeps its memory in cache and makes fewer trips through the pool but lets instances drift apart by that many frames.
+		// If FramesPerTask == 0 then DefaultFramesPerTask is used.
+		UINT32 FramesPerTask;
+		// If Render is TRUE every instance gets its own frame buffer and is rendered after every step.
+		BOOL Render;
+	};
+	struct BatchStats {
+		// Frames stepped across every instance.
+		UINT64 Frames;
+		// Time spent in Run.
+		UINT64 Nanoseconds;
+		// Instance steps which ran on a thread other than the one their instance belongs to.
+		UINT64 StolenTasks;
+	};
+	// Hosts many independent Tiny::Machines in one process and steps them across every core with the work stealing
+	// EZ::ThreadPool. Each instance has its own memory and renderers so nothing is shared between instances, and the
+	// pool gives every thread the same instances every frame unless it runs out of work and steals.
+	class Batch {
+	public:
+		// Creates every instance. Throws an EZ::Error if CreateMachine is nullptr or returns nullptr.
+		Batch(Tiny::BatchSettings settings);
+		// Steps every instance frameCount frames, and renders them if BatchSettings::Render is TRUE.
+		void Run(UINT32 frameCount);
+		// Returns a hash of the state of every instance in order. It only depends on what the instances did, not on
+		// how many threads ran them or which thread stepped which instance, so it proves a batch is deterministic.
+		UINT64 GetStateHash() const;
+		~Batch();
+
+		UINT32 GetInstanceCount() const;
+		Tiny::Machine* GetInstance(UINT32 instanceIndex) const;
+		// Returns the last frame rendered by instanceIndex or nullptr if BatchSettings::Render is FALSE.
+		const BYTE* GetFrameBuffer(UINT32 instanceIndex) const;
+		Tiny::BatchStats GetStats() const;
+		Tiny::BatchSettings GetSettings() const;
+
+	private:
+		struct Instance {
+			Tiny::Machine* Machine;
+			BYTE* FrameBuffer;
+		};
+		static void CreateInstance(void* context, UINT32 instanceIndex);
+		static void StepInstance(void* context, UINT32 instanceIndex);
+		static void HashInstance(void* context, UINT32 instanceIndex);
+
+		Tiny::BatchSettings _settings;
+		EZ::ThreadPool* _threadPool;
+		BOOL _ownsThreadPool;
+		std::vector<Instance> _instances;
+		// Frames StepInstance steps each instance in the current ParallelFor.
+		UINT32 _framesThisTask;
+		// Filled by HashInstance.
+		mutable std::vector<UINT64> _instanceHashes;
+		Tiny::BatchStats _stats;
+	};
+}
\ No newline at end of file
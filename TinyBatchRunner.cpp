@@ -0,0 +1,139 @@
+// TinyBatchRunner steps thousands of independent Tiny::Machines in one process across every core and reports the
+// aggregate frames per second. It only depends on the portable files so it also builds on Linux, for example:
+// g++ -O2 -std=c++17 -pthread TinyBatchRunner.cpp TinyBatch.cpp TinyWorkload.cpp TinyMachine.cpp TinyCartridge.cpp TinyPalletRenderer.cpp TinyTileRenderer.cpp TinySpriteRenderer.cpp TinyCpu.cpp TinyMemoryBus.cpp EZThreadPool.cpp TinyKernels.cpp EZCpu.cpp EZClock.cpp EZProfiler.cpp EZMappedFile.cpp EZError.cpp -o TinyBatchRunner
+// Usage: TinyBatchRunner [instances] [frames] [threads] [render] [cartridge]
+//        TinyBatchRunner --save-cartridge cartridge
+// Every instance runs Tiny::LoadWorkload with its own scripted inputs for frames frames.
+// threads is the number of threads to step instances on, 0 meaning every hardware thread.
+// If render is 1 every instance also converts every frame into its own frame buffer.
+// If cartridge is given every instance starts from that cartridge file instead, sharing every page it doesn't write
+// with the others. --save-cartridge writes the workload as a cartridge file.
+// The batch state hash printed at the end must be the same for any number of threads.
+
+#include "TinyBatch.h"
+#include "TinyWorkload.h"
+#include "TinyCartridge.h"
+#include "EZClock.h"
+#include "EZError.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+constexpr UINT32 DefaultInstanceCount = 1024;
+constexpr UINT32 DefaultFrameCount = 600;
+
+// Feeds every instance a different but deterministic input byte each frame.
+// The input only depends on the instance and the frame so it is the same whichever thread steps the instance.
+BYTE ScriptedInput(Tiny::Machine* machine) {
+	UINT64 seed = (static_cast<UINT64>(*machine->GetUserDataAs<UINT32>()) << 32) | static_cast<UINT32>(machine->GetFrameCount());
+	seed *= 0x9E3779B97F4A7C15ull;
+	return static_cast<BYTE>(seed >> 56);
+}
+
+struct Instances {
+	std::vector<UINT32> Ids;
+	// nullptr unless a cartridge was given on the command line.
+	const Tiny::Cartridge* Cartridge;
+};
+
+Tiny::Machine* CreateWorkloadMachine(void* context, UINT32 instanceIndex) {
+	Instances* instances = reinterpret_cast<Instances*>(context);
+	Tiny::MachineSettings machineSettings = { };
+	machineSettings.UserData = &instances->Ids[instanceIndex];
+	machineSettings.InputCallback = ScriptedInput;
+	machineSettings.Cartridge = instances->Cartridge;
+	Tiny::Machine* machine = new Tiny::Machine(machineSettings);
+	if (instances->Cartridge != nullptr) {
+		machine->Reset();
+	}
+	else {
+		Tiny::LoadWorkload(machine);
+	}
+	return machine;
+}
+
+// Writes the memory LoadWorkload sets up as a cartridge. The workload patches its own code so none of it is ROM.
+void SaveWorkloadCartridge(LPCSTR filePath) {
+	Tiny::Machine* machine = new Tiny::Machine({ });
+	Tiny::LoadWorkload(machine);
+	std::vector<BYTE> image(machine->GetMemory(), machine->GetMemory() + Tiny::MemorySize);
+	delete machine;
+	Tiny::Cartridge::Save(filePath, image.data(), 0, 0);
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1 && strcmp(argv[1], "--save-cartridge") == 0) {
+		if (argc < 3) {
+			EZ::Error("--save-cartridge needs a cartridge file.").PrintAndFree();
+			return 1;
+		}
+		try {
+			SaveWorkloadCartridge(argv[2]);
+		}
+		catch (EZ::Error& error) {
+			error.PrintAndFree();
+			return 1;
+		}
+		return 0;
+	}
+	UINT32 instanceCount = argc > 1 ? static_cast<UINT32>(strtoul(argv[1], nullptr, 10)) : DefaultInstanceCount;
+	UINT32 frameCount = argc > 2 ? static_cast<UINT32>(strtoul(argv[2], nullptr, 10)) : DefaultFrameCount;
+	UINT32 threadCount = argc > 3 ? static_cast<UINT32>(strtoul(argv[3], nullptr, 10)) : 0;
+	BOOL render = argc > 4 && strtoul(argv[4], nullptr, 10) != 0;
+	if (instanceCount == 0 || frameCount == 0) {
+		EZ::Error("instances and frames must be positive integers.").PrintAndFree();
+		return 1;
+	}
+
+	Instances instances = { };
+	instances.Ids.resize(instanceCount);
+	for (UINT32 i = 0; i < instanceCount; i++) {
+		instances.Ids[i] = i + 1;
+	}
+	Tiny::Cartridge* cartridge = nullptr;
+	if (argc > 5) {
+		try {
+			cartridge = new Tiny::Cartridge(argv[5]);
+		}
+		catch (EZ::Error& error) {
+			error.PrintAndFree();
+			return 1;
+		}
+		instances.Cartridge = cartridge;
+	}
+	EZ::ThreadPool* threadPool = new EZ::ThreadPool(threadCount == 0 ? 0 : threadCount - 1, TRUE);
+	Tiny::BatchSettings batchSettings = { };
+	batchSettings.InstanceCount = instanceCount;
+	batchSettings.CreateMachine = CreateWorkloadMachine;
+	batchSettings.Context = &instances;
+	batchSettings.ThreadPool = threadPool;
+	batchSettings.Render = render;
+
+	Tiny::Batch* batch = nullptr;
+	UINT64 startupStart = EZ::GetNanoseconds();
+	try {
+		batch = new Tiny::Batch(batchSettings);
+	}
+	catch (EZ::Error& error) {
+		error.PrintAndFree();
+		delete threadPool;
+		delete cartridge;
+		return 1;
+	}
+	double startupSeconds = (EZ::GetNanoseconds() - startupStart) / 1000000000.0;
+	batch->Run(frameCount);
+
+	Tiny::BatchStats stats = batch->GetStats();
+	double seconds = stats.Nanoseconds / 1000000000.0;
+	std::cout << "Instances: " << instanceCount << " Threads: " << threadPool->GetThreadCount() << " Frames per instance: " << frameCount << std::endl;
+	std::cout << "Frames: " << stats.Frames << " Seconds: " << seconds << " Aggregate FPS: " << (stats.Frames / seconds)
+		<< " FPS per instance: " << (frameCount / seconds) << std::endl;
+	std::cout << "Startup seconds: " << startupSeconds << (cartridge != nullptr ? " from a shared cartridge" : " loading the workload") << std::endl;
+	std::cout << "Stolen steps: " << stats.StolenTasks << std::endl;
+	std::cout << "Batch state hash: " << std::hex << batch->GetStateHash() << std::dec << std::endl;
+
+	delete batch;
+	delete threadPool;
+	delete cartridge;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,1842 @@
+// TinyBench checks every pixel kernel level against the scalar reference and then measures every stage a frame goes
+// through on its own: the pixel kernels, converting each video mode, latching inputs, the TransformRect math
+// behind EZ::Renderer, recording and drawing draw lists, upscaling frames, the memory bus, bank switching, mixing audio, the guest CPU, whole frames
+// of stepping and rendering, overlapping frames with presenting them and capturing and restoring save states.
+// It only depends on the portable files so it also builds on Linux, for example:
+// g++ -O2 -std=c++17 -pthread TinyBench.cpp TinyMachine.cpp TinyCartridge.cpp TinyPalletRenderer.cpp TinyTileRenderer.cpp TinySpriteRenderer.cpp TinyKernels.cpp TinyCpu.cpp TinyMemoryBus.cpp TinyMapper.cpp TinyAudio.cpp TinyInput.cpp EZThreadPool.cpp EZAudio.cpp EZCpu.cpp EZClock.cpp EZProfiler.cpp EZGeometry.cpp EZDrawList.cpp EZSoftwareRenderer.cpp EZUpscaler.cpp EZFramePipeline.cpp EZLifecycle.cpp TinySaveState.cpp TinyRewind.cpp EZCompression.cpp EZMappedFile.cpp EZError.cpp -o TinyBench
+// To also catch data races in the threaded checks build it with ThreadSanitizer:
+// g++ -O1 -g -fsanitize=thread -std=c++17 -pthread TinyBench.cpp TinyMachine.cpp TinyCartridge.cpp TinyPalletRenderer.cpp TinyTileRenderer.cpp TinySpriteRenderer.cpp TinyKernels.cpp TinyCpu.cpp TinyMemoryBus.cpp TinyMapper.cpp TinyAudio.cpp TinyInput.cpp EZThreadPool.cpp EZAudio.cpp EZCpu.cpp EZClock.cpp EZProfiler.cpp EZGeometry.cpp EZDrawList.cpp EZSoftwareRenderer.cpp EZUpscaler.cpp EZFramePipeline.cpp EZLifecycle.cpp TinySaveState.cpp TinyRewind.cpp EZCompression.cpp EZMappedFile.cpp EZError.cpp -o TinyBench
+// Usage: TinyBench [--json file] [--filter text] [--quick]
+// Every benchmark is warmed up, then timed over repeated samples until the samples agree with each other.
+// The median time per iteration is reported along with how much the samples spread around it.
+// --json also writes every result to file so runs from different commits can be compared by a script.
+// --filter only runs benchmarks whose name contains text. --quick takes far fewer and shorter samples for a smoke test.
+// Returns 1 if any kernel, the SIMD software renderer or the SIMD upscaler produced different output than the scalar
+// code or the compression, memory bus, mapper, cartridge ROM, input, audio, frame pipeline, lifecycle or CPU check failed.
+
+#include "TinyKernels.h"
+#include "TinySpriteRenderer.h"
+#include "TinyCpu.h"
+#include "TinyMemoryBus.h"
+#include "TinyMapper.h"
+#include "TinyAudio.h"
+#include "TinyInput.h"
+#include "TinyMachine.h"
+#include "TinyCartridge.h"
+#include "TinySaveState.h"
+#include "TinyRewind.h"
+#include "EZCpu.h"
+#include "EZClock.h"
+#include "EZCompression.h"
+#include "EZGeometry.h"
+#include "EZDrawList.h"
+#include "EZSoftwareRenderer.h"
+#include "EZUpscaler.h"
+#include "EZError.h"
+#include "EZAudio.h"
+#include "EZFramePipeline.h"
+#include "EZLifecycle.h"
+#include "EZThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchmarkSettings {
+	// Every benchmark runs untimed for this long first so caches, branch predictors and CPU clocks settle.
+	UINT64 WarmupNanoseconds;
+	// Each sample runs enough iterations to take about this long so timer resolution doesn't matter.
+	UINT64 SampleNanoseconds;
+	// Samples are taken until there are at least MinSamples and they are stable or until there are MaxSamples.
+	UINT32 MinSamples;
+	UINT32 MaxSamples;
+	// Samples are stable once their median absolute deviation is at most this percent of their median.
+	double StablePercent;
+};
+constexpr BenchmarkSettings DefaultBenchmarkSettings = { 100000000, 10000000, 15, 75, 2.0 };
+constexpr BenchmarkSettings QuickBenchmarkSettings = { 5000000, 1000000, 5, 5, 100.0 };
+
+struct BenchmarkResult {
+	std::string Name;
+	// What the benchmark counts, for example bytes or frames, and how many of them one iteration handles.
+	const char* Unit;
+	double UnitsPerIteration;
+	UINT64 IterationsPerSample;
+	UINT32 Samples;
+	// Nanoseconds per iteration across the samples.
+	double Median;
+	double Min;
+	double Max;
+	double Mean;
+	double StandardDeviation;
+	// Median absolute deviation as a percent of the median. Unlike the standard deviation one
+	// sample interrupted by the OS barely moves it.
+	double DeviationPercent;
+	BOOL Stable;
+};
+
+// Everything a benchmark computes is folded in here so the compiler can't throw the work away.
+volatile UINT64 benchmarkSink = 0;
+
+static double Median(std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+	size_t middle = values.size() / 2;
+	return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+// Returns rate scaled by an SI prefix, for example 1.5e9 becomes "1.500 G".
+static std::string FormatRate(double rate) {
+	const char* prefixes[] = { "", "k", "M", "G", "T" };
+	UINT32 prefix = 0;
+	while (rate >= 1000.0 && prefix < 4) {
+		rate /= 1000.0;
+		prefix++;
+	}
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(3) << rate << " " << prefixes[prefix];
+	return text.str();
+}
+
+// Runs benchmarks and keeps their results.
+class BenchmarkRunner {
+public:
+	BenchmarkRunner(BenchmarkSettings settings, const std::string& filter) {
+		_settings = settings;
+		_filter = filter;
+	}
+	// Returns TRUE if name passes the filter. Use this to skip expensive setup for benchmarks that won't run.
+	BOOL Wants(const std::string& name) const {
+		return _filter.empty() || name.find(_filter) != std::string::npos;
+	}
+	// Measures how long iteration takes and prints the result. iteration must do the same work every call.
+	template <typename T> void Run(const std::string& name, const char* unit, double unitsPerIteration, T iteration) {
+		if (!Wants(name)) {
+			return;
+		}
+		// Warm up while doubling the iteration count until one batch takes long enough to time well.
+		UINT64 iterations = 1;
+		UINT64 batchNanoseconds = 0;
+		UINT64 warmupStart = EZ::GetNanoseconds();
+		while (TRUE) {
+			UINT64 start = EZ::GetNanoseconds();
+			for (UINT64 i = 0; i < iterations; i++) {
+				iteration();
+			}
+			UINT64 end = EZ::GetNanoseconds();
+			batchNanoseconds = end - start;
+			if (end - warmupStart >= _settings.WarmupNanoseconds && batchNanoseconds >= _settings.SampleNanoseconds / 4) {
+				break;
+			}
+			if (batchNanoseconds < _settings.SampleNanoseconds) {
+				iterations *= 2;
+			}
+		}
+		UINT64 iterationsPerSample = static_cast<UINT64>((static_cast<double>(iterations) * _settings.SampleNanoseconds) / (batchNanoseconds + 1));
+		if (iterationsPerSample == 0) {
+			iterationsPerSample = 1;
+		}
+
+		std::vector<double> samples;
+		double median = 0.0;
+		double deviationPercent = 0.0;
+		while (samples.size() < _settings.MaxSamples) {
+			UINT64 start = EZ::GetNanoseconds();
+			for (UINT64 i = 0; i < iterationsPerSample; i++) {
+				iteration();
+			}
+			UINT64 end = EZ::GetNanoseconds();
+			samples.push_back(static_cast<double>(end - start) / iterationsPerSample);
+			if (samples.size() < _settings.MinSamples) {
+				continue;
+			}
+			median = Median(samples);
+			std::vector<double> deviations(samples.size());
+			for (size_t i = 0; i < samples.size(); i++) {
+				deviations[i] = std::fabs(samples[i] - median);
+			}
+			deviationPercent = median > 0.0 ? (Median(deviations) * 100.0) / median : 0.0;
+			if (deviationPercent <= _settings.StablePercent) {
+				break;
+			}
+		}
+
+		BenchmarkResult result = { };
+		result.Name = name;
+		result.Unit = unit;
+		result.UnitsPerIteration = unitsPerIteration;
+		result.IterationsPerSample = iterationsPerSample;
+		result.Samples = static_cast<UINT32>(samples.size());
+		result.Median = median;
+		result.Min = *std::min_element(samples.begin(), samples.end());
+		result.Max = *std::max_element(samples.begin(), samples.end());
+		double sum = 0.0;
+		for (double sample : samples) {
+			sum += sample;
+		}
+		result.Mean = sum / samples.size();
+		double squareSum = 0.0;
+		for (double sample : samples) {
+			squareSum += (sample - result.Mean) * (sample - result.Mean);
+		}
+		result.StandardDeviation = std::sqrt(squareSum / samples.size());
+		result.DeviationPercent = deviationPercent;
+		result.Stable = deviationPercent <= _settings.StablePercent;
+		_results.push_back(result);
+
+		std::cout << "  " << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << median << " ns" << " +-" << std::setprecision(2) << deviationPercent << "%  "
+			<< std::setprecision(3) << FormatRate((unitsPerIteration * 1e9) / median) << unit << "/s"
+			<< (result.Stable ? "" : "  (unstable)") << std::defaultfloat << std::endl;
+	}
+	// Writes every result so far as JSON. Times are nanoseconds per iteration and throughput is units per second.
+	BOOL WriteJson(const char* filePath, UINT32 threadCount, BOOL checksPassed) const {
+		std::ofstream file(filePath, std::ios::binary);
+		if (!file) {
+			return FALSE;
+		}
+		file << std::setprecision(6);
+		file << "{\n\"version\":1,\n";
+		file << "\"kernelLevel\":" << static_cast<UINT32>(Tiny::GetBestKernelLevel()) << ",\n";
+		file << "\"threadCount\":" << threadCount << ",\n";
+		file << "\"checksPassed\":" << (checksPassed ? "true" : "false") << ",\n";
+		file << "\"settings\":{\"warmupNanoseconds\":" << _settings.WarmupNanoseconds << ",\"sampleNanoseconds\":" << _settings.SampleNanoseconds
+			<< ",\"minSamples\":" << _settings.MinSamples << ",\"maxSamples\":" << _settings.MaxSamples << ",\"stablePercent\":" << _settings.StablePercent << "},\n";
+		file << "\"benchmarks\":[\n";
+		for (size_t i = 0; i < _results.size(); i++) {
+			const BenchmarkResult& result = _results[i];
+			file << "{\"name\":\"" << result.Name << "\",\"unit\":\"" << result.Unit << "\",\"unitsPerIteration\":" << result.UnitsPerIteration
+				<< ",\"iterationsPerSample\":" << result.IterationsPerSample << ",\"samples\":" << result.Samples
+				<< ",\"medianNanoseconds\":" << result.Median << ",\"minNanoseconds\":" << result.Min << ",\"maxNanoseconds\":" << result.Max
+				<< ",\"meanNanoseconds\":" << result.Mean << ",\"standardDeviationNanoseconds\":" << result.StandardDeviation
+				<< ",\"deviationPercent\":" << result.DeviationPercent << ",\"stable\":" << (result.Stable ? "true" : "false")
+				<< ",\"unitsPerSecond\":" << ((result.UnitsPerIteration * 1e9) / result.Median) << "}"
+				<< (i + 1 < _results.size() ? ",\n" : "\n");
+		}
+		file << "]\n}\n";
+		file.close();
+		return !file.fail();
+	}
+
+private:
+	BenchmarkSettings _settings;
+	std::string _filter;
+	std::vector<BenchmarkResult> _results;
+};
+
+static const char* KernelLevelName(Tiny::KernelLevel level) {
+	switch (level) {
+	case Tiny::KernelLevel::Scalar: return "Scalar";
+	case Tiny::KernelLevel::SSE2: return "SSE2";
+	case Tiny::KernelLevel::AVX2: return "AVX2";
+	case Tiny::KernelLevel::AVX512: return "AVX512";
+	default: return "Unknown";
+	}
+}
+
+static void FillRandom(std::vector<BYTE>& buffer, UINT32 seed) {
+	for (size_t i = 0; i < buffer.size(); i++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		buffer[i] = static_cast<BYTE>(seed);
+	}
+}
+
+// Runs kernel over every length from 0 to 300 pixels at every source and destination misalignment
+// and compares the output byte for byte with the scalar kernel, including the bytes just past the end.
+static BOOL CheckExpandGrayscale(Tiny::ExpandGrayscaleKernel kernel) {
+	Tiny::ExpandGrayscaleKernel reference = Tiny::GetExpandGrayscaleKernel(Tiny::KernelLevel::Scalar);
+	std::vector<BYTE> source(300 + 64);
+	FillRandom(source, 0xC0FFEE);
+	std::vector<BYTE> expected((300 + 64) * 4);
+	std::vector<BYTE> actual((300 + 64) * 4);
+	for (UINT32 length = 0; length <= 300; length++) {
+		for (UINT32 sourceOffset = 0; sourceOffset < 4; sourceOffset++) {
+			for (UINT32 destinationOffset = 0; destinationOffset < 4; destinationOffset++) {
+				memset(expected.data(), 0xAB, expected.size());
+				memset(actual.data(), 0xAB, actual.size());
+				reference(source.data() + sourceOffset, expected.data() + destinationOffset, length);
+				kernel(source.data() + sourceOffset, actual.data() + destinationOffset, length);
+				if (memcmp(expected.data(), actual.data(), expected.size()) != 0) {
+					std::cout << "  mismatch at length " << length << " source offset " << sourceOffset << " destination offset " << destinationOffset << std::endl;
+					return FALSE;
+				}
+			}
+		}
+	}
+	return TRUE;
+}
+
+// Same as CheckExpandGrayscale but for the pallet kernels which work in groups of 4 pixels.
+static BOOL CheckUnpackPallet(Tiny::UnpackPalletKernel kernel) {
+	Tiny::UnpackPalletKernel reference = Tiny::GetUnpackPalletKernel(Tiny::KernelLevel::Scalar);
+	std::vector<BYTE> palletBytes(Tiny::PalletBytes);
+	FillRandom(palletBytes, 0xFACADE);
+	UINT32 pallet[Tiny::PalletColorCount];
+	Tiny::ExpandPallet(palletBytes.data(), pallet);
+	std::vector<BYTE> source(((300 / 4) * 3) + 64);
+	FillRandom(source, 0xC0FFEE);
+	std::vector<BYTE> expected((300 + 64) * 4);
+	std::vector<BYTE> actual((300 + 64) * 4);
+	for (UINT32 length = 0; length <= 300; length += 4) {
+		for (UINT32 sourceOffset = 0; sourceOffset < 4; sourceOffset++) {
+			for (UINT32 destinationOffset = 0; destinationOffset < 4; destinationOffset++) {
+				memset(expected.data(), 0xAB, expected.size());
+				memset(actual.data(), 0xAB, actual.size());
+				reference(source.data() + sourceOffset, pallet, expected.data() + destinationOffset, length);
+				kernel(source.data() + sourceOffset, pallet, actual.data() + destinationOffset, length);
+				if (memcmp(expected.data(), actual.data(), expected.size()) != 0) {
+					std::cout << "  mismatch at length " << length << " source offset " << sourceOffset << " destination offset " << destinationOffset << std::endl;
+					return FALSE;
+				}
+			}
+		}
+	}
+	return TRUE;
+}
+
+// Loads program at address, points the reset vector at it and resets cpu.
+static void LoadProgram(Tiny::Cpu* cpu, Tiny::MemoryBus* bus, UINT16 address, const BYTE* program, UINT32 size) {
+	BYTE* memory = bus->GetMemory();
+	memcpy(memory + address, program, size);
+	memory[Tiny::ResetVectorAddress] = static_cast<BYTE>(address);
+	memory[Tiny::ResetVectorAddress + 1] = static_cast<BYTE>(address >> 8);
+	cpu->Invalidate(*bus, 0, Tiny::MemorySize);
+	cpu->Reset(*bus);
+}
+
+// Runs a program which rewrites the immediate of its own first instruction and only halts once
+// the rewritten value is seen. A stale decoded instruction makes it loop forever instead.
+static BOOL CheckSelfModifyingCode() {
+	const BYTE program[] = {
+		0x03, 0x01, // 0x9000 LDA #1
+		0x0A, 0x00, 0x80, // 0x9002 STA 0x8000
+		0x03, 0x05, // 0x9005 LDA #5
+		0x0A, 0x01, 0x90, // 0x9007 STA 0x9001
+		0x2A, 0x20, 0x90, // 0x900A JSR 0x9020
+		0x1B, 0x06, // 0x900D CMP #6
+		0x26, 0x15, 0x90, // 0x900F JZ 0x9015
+		0x25, 0x00, 0x90, // 0x9012 JMP 0x9000
+		0x01, // 0x9015 HALT
+	};
+	const BYTE subroutine[] = {
+		0x04, 0x00, 0x80, // 0x9020 LDA 0x8000
+		0x12, 0x01, // 0x9023 ADD #1
+		0x2B, // 0x9025 RTS
+	};
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	UINT64 dirtyPages[Tiny::PageCount / 64] = { };
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	Tiny::Cpu* cpu = new Tiny::Cpu();
+	memcpy(memory.data() + 0x9020, subroutine, sizeof(subroutine));
+	LoadProgram(cpu, bus, 0x9000, program, sizeof(program));
+	cpu->Run(*bus, dirtyPages, 10000);
+
+	BOOL passed = !cpu->IsRunning() && memory[0x8000] == 5 && cpu->GetRegisters().A == 6 && cpu->GetStats().Invalidations > 0 && ((dirtyPages[0x80 / 64] >> (0x80 % 64)) & 1);
+	delete cpu;
+	delete bus;
+	return passed;
+}
+
+// Records what the MMIO and watch callbacks of CheckMemoryBus were called with.
+struct BusLog {
+	UINT32 Reads;
+	UINT32 Writes;
+	UINT16 WriteAddress;
+	BYTE WriteValue;
+	UINT32 Watches;
+	UINT16 WatchAddress;
+	BYTE WatchOld;
+	BYTE WatchNew;
+};
+static BYTE BusLogRead(void* context, UINT16 address) {
+	reinterpret_cast<BusLog*>(context)->Reads++;
+	return 0x5A;
+}
+static void BusLogWrite(void* context, UINT16 address, BYTE value) {
+	BusLog* log = reinterpret_cast<BusLog*>(context);
+	log->Writes++;
+	log->WriteAddress = address;
+	log->WriteValue = value;
+}
+static void BusLogWatch(void* context, UINT16 address, BYTE oldValue, BYTE newValue) {
+	BusLog* log = reinterpret_cast<BusLog*>(context);
+	log->Watches++;
+	log->WatchAddress = address;
+	log->WatchOld = oldValue;
+	log->WatchNew = newValue;
+}
+
+// Maps the Inputs and SysFlags registers as MMIO and watches a byte, then runs a program which reads and writes them
+// and uses the stack, which shares the now hooked register page but must still behave like plain memory.
+static BOOL CheckMemoryBus() {
+	const BYTE program[] = {
+		0x04, 0x00, 0x00, // 0x9000 LDA 0x0000
+		0x0A, 0x00, 0x80, // 0x9003 STA 0x8000
+		0x0A, 0x01, 0x00, // 0x9006 STA 0x0001
+		0x2C, // 0x9009 PHA
+		0x03, 0x00, // 0x900A LDA #0
+		0x2D, // 0x900C PLA
+		0x0A, 0x01, 0x80, // 0x900D STA 0x8001
+		0x01, // 0x9010 HALT
+	};
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	UINT64 dirtyPages[Tiny::PageCount / 64] = { };
+	BusLog log = { };
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	Tiny::Cpu* cpu = new Tiny::Cpu();
+	bus->MapMmio(Tiny::InputsAddress, 2, BusLogRead, BusLogWrite, &log);
+	bus->WatchWrites(0x8000, 1, BusLogWatch, &log);
+	LoadProgram(cpu, bus, 0x9000, program, sizeof(program));
+	cpu->Run(*bus, dirtyPages, 10000);
+
+	BOOL passed = !cpu->IsRunning() && memory[0x8000] == 0x5A && memory[0x8001] == 0x5A && memory[Tiny::SysFlagsAddress] == 0
+		&& log.Reads == 1 && log.Writes == 1 && log.WriteAddress == Tiny::SysFlagsAddress && log.WriteValue == 0x5A
+		&& log.Watches == 1 && log.WatchAddress == 0x8000 && log.WatchOld == 0 && log.WatchNew == 0x5A
+		&& bus->IsPageHooked(0) && bus->IsPageHooked(0x80) && !bus->IsPageHooked(0x81);
+	bus->UnmapMmio(Tiny::InputsAddress);
+	bus->UnwatchWrites(BusLogWatch, &log);
+	passed = passed && !bus->IsPageHooked(0) && !bus->IsPageHooked(0x80) && bus->Read(Tiny::InputsAddress) == 0;
+	delete cpu;
+	delete bus;
+	return passed;
+}
+
+// Runs a program which calls the same address in different ROM banks and moves between two RAM banks through the bank
+// select registers. Each ROM bank's subroutine starts with an instruction running into the next page, which must never
+// be kept, and goes on with one which is kept per bank. Stale decoded code from the bank switched out returns the
+// wrong value.
+static BOOL CheckMapper() {
+	const BYTE program[] = {
+		0x03, 0x01, // 0x9000 LDA #1
+		0x0A, 0x04, 0x00, // 0x9002 STA 0x0004
+		0x2A, 0xFF, 0xA0, // 0x9005 JSR 0xA0FF
+		0x0A, 0x00, 0x80, // 0x9008 STA 0x8000
+		0x03, 0x02, // 0x900B LDA #2
+		0x0A, 0x04, 0x00, // 0x900D STA 0x0004
+		0x2A, 0xFF, 0xA0, // 0x9010 JSR 0xA0FF
+		0x0A, 0x01, 0x80, // 0x9013 STA 0x8001
+		0x03, 0x05, // 0x9016 LDA #5, which wraps around to bank 1
+		0x0A, 0x04, 0x00, // 0x9018 STA 0x0004
+		0x2A, 0xFF, 0xA0, // 0x901B JSR 0xA0FF
+		0x0A, 0x02, 0x80, // 0x901E STA 0x8002
+		0x03, 0x77, // 0x9021 LDA #0x77
+		0x0A, 0x00, 0xB0, // 0x9023 STA 0xB000
+		0x03, 0x01, // 0x9026 LDA #1
+		0x0A, 0x05, 0x00, // 0x9028 STA 0x0005
+		0x04, 0x00, 0xB0, // 0x902B LDA 0xB000
+		0x0A, 0x03, 0x80, // 0x902E STA 0x8003
+		0x03, 0x55, // 0x9031 LDA #0x55
+		0x0A, 0x00, 0xB0, // 0x9033 STA 0xB000
+		0x03, 0x00, // 0x9036 LDA #0
+		0x0A, 0x05, 0x00, // 0x9038 STA 0x0005
+		0x04, 0x00, 0xB0, // 0x903B LDA 0xB000
+		0x0A, 0x04, 0x80, // 0x903E STA 0x8004
+		0x0A, 0x00, 0xA0, // 0x9041 STA 0xA000, which is ROM and dropped
+		0x04, 0x04, 0x00, // 0x9044 LDA 0x0004
+		0x0A, 0x05, 0x80, // 0x9047 STA 0x8005
+		0x01, // 0x904A HALT
+	};
+	// Bank n of the ROM window holds LDA #(n * 11), ADD #n, RTS at 0xA0FF so calling it returns n * 12.
+	std::vector<BYTE> rom(4 * 0x1000, 0);
+	for (UINT32 bank = 0; bank < 4; bank++) {
+		const BYTE subroutine[] = { 0x03, static_cast<BYTE>(bank * 11), 0x12, static_cast<BYTE>(bank), 0x2B };
+		memcpy(rom.data() + (bank * 0x1000) + 0xFF, subroutine, sizeof(subroutine));
+	}
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	UINT64 dirtyPages[Tiny::PageCount / 64] = { };
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	// The ROM window sits over pages mapped read only the way a cartridge's ROM is, which must stay read only afterwards.
+	std::vector<BYTE> cartridgeRom(0x1000, 0xEE);
+	bus->MapRom(0xA000, 0x1000, cartridgeRom.data());
+	Tiny::Cpu* cpu = new Tiny::Cpu();
+	Tiny::MapperSettings settings = { };
+	settings.Windows[0] = { 0xA000, 0x1000, FALSE };
+	settings.Windows[1] = { 0xB000, 0x100, TRUE };
+	settings.WindowCount = 2;
+	settings.Rom = rom.data();
+	settings.RomSize = static_cast<UINT32>(rom.size());
+	settings.RamSize = 0x200;
+	Tiny::Mapper* mapper = new Tiny::Mapper(bus, settings);
+	LoadProgram(cpu, bus, 0x9000, program, sizeof(program));
+	cpu->Run(*bus, dirtyPages, 10000);
+
+	const BYTE* ram = mapper->GetRam();
+	BOOL passed = !cpu->IsRunning() && memory[0x8000] == 12 && memory[0x8001] == 24 && memory[0x8002] == 12
+		&& memory[0x8003] == 0 && memory[0x8004] == 0x77 && memory[0x8005] == 1 && ram[0] == 0x77 && ram[0x100] == 0x55
+		&& memory[0xA000] == 0 && memory[0xB000] == 0 && rom[0x1000] == 0 && mapper->GetBank(0) == 1 && mapper->GetBank(1) == 0;
+	delete mapper;
+	passed = passed && bus->Read(0xA100) == 0xEE && !bus->Write(0xA100, 0x11) && cartridgeRom[0x100] == 0xEE
+		&& bus->GetPageMemory(0xA1) == cartridgeRom.data() + 0x100 && bus->Write(0xB000, 0x33) && memory[0xB000] == 0x33
+		&& bus->Read(Tiny::BankSelectAddress) == 0 && !bus->IsPageHooked(0);
+	delete cpu;
+	delete bus;
+	return passed;
+}
+
+// Starts a machine from a cartridge whose ROM doesn't start or end on a page boundary and runs a program which stores
+// into the whole ROM page it runs from and into the partial page before it. The store into ROM must be dropped with
+// the page still read straight from the cartridge, so it never got a private copy, while the partial page is writable.
+static BOOL CheckCartridgeRom() {
+	const BYTE program[] = {
+		0x03, 0x77, // 0x9000 LDA #0x77
+		0x0A, 0x80, 0x90, // 0x9002 STA 0x9080
+		0x0A, 0x00, 0x80, // 0x9005 STA 0x8000
+		0x0A, 0x90, 0x8F, // 0x9008 STA 0x8F90
+		0x01, // 0x900B HALT
+	};
+	LPCSTR filePath = "TinyBenchCheck.tinycart";
+	std::vector<BYTE> image(Tiny::MemorySize, 0);
+	memcpy(image.data() + 0x9000, program, sizeof(program));
+	image[0x9080] = 0x11;
+	image[Tiny::ResetVectorAddress] = 0x00;
+	image[Tiny::ResetVectorAddress + 1] = 0x90;
+	Tiny::Cartridge::Save(filePath, image.data(), 0x8F80, 0x200);
+	Tiny::Cartridge* cartridge = new Tiny::Cartridge(filePath);
+	Tiny::MachineSettings settings = { };
+	settings.Cartridge = cartridge;
+	Tiny::Machine* machine = new Tiny::Machine(settings);
+	machine->Reset();
+	machine->Step();
+	machine->Write(0x9081, 0x22);
+
+	const BYTE* memory = machine->GetMemory();
+	BOOL passed = machine->Read(0x9080) == 0x11 && memory[0x9080] == 0x11 && machine->Read(0x9081) == 0
+		&& machine->GetBus()->GetPageMemory(0x90) == cartridge->GetImage() + 0x9000 && machine->Read(0x8000) == 0x77
+		&& machine->Read(0x8F90) == 0x77 && machine->GetBus()->GetPageMemory(0x8F) == memory + 0x8F00;
+	delete machine;
+	delete cartridge;
+	std::remove(filePath);
+	return passed;
+}
+
+// Plays a script with a tap shorter than a frame, overlapping holds and a release of everything through an
+// InputQueue into a machine's Inputs register, checks latency is measured with the queue's clock and then has
+// another thread push presses and releases as fast as it can while this one latches until all of them arrived.
+static BYTE LatchInputQueue(Tiny::Machine* machine) {
+	return machine->GetUserDataAs<Tiny::InputQueue>()->Latch();
+}
+static UINT64 ReadInputCheckClock(void* context) {
+	return *reinterpret_cast<UINT64*>(context);
+}
+static BOOL CheckInput() {
+	const Tiny::InputScriptEvent events[] = {
+		{ 1, Tiny::Input::Jump, TRUE },
+		{ 3, Tiny::Input::Action, TRUE },
+		{ 3, Tiny::Input::Action, FALSE },
+		{ 4, Tiny::Input::Jump, FALSE },
+		{ 5, Tiny::Input::Up | Tiny::Input::Left, TRUE },
+		{ 6, Tiny::Input::Left, FALSE },
+		{ 8, 0xFF, FALSE },
+	};
+	const BYTE expected[] = { 0, Tiny::Input::Jump, Tiny::Input::Jump, Tiny::Input::Jump | Tiny::Input::Action, 0,
+		Tiny::Input::Up | Tiny::Input::Left, Tiny::Input::Up, Tiny::Input::Up, 0, 0 };
+	UINT64 time = 0;
+	Tiny::InputQueueSettings queueSettings = { };
+	queueSettings.Clock = { &time, ReadInputCheckClock, nullptr };
+	queueSettings.Capacity = 4;
+	Tiny::InputQueue* queue = new Tiny::InputQueue(queueSettings);
+	Tiny::InputScript* script = new Tiny::InputScript(events, sizeof(events) / sizeof(events[0]));
+	Tiny::MachineSettings machineSettings = { };
+	machineSettings.UserData = queue;
+	machineSettings.InputCallback = LatchInputQueue;
+	Tiny::Machine* machine = new Tiny::Machine(machineSettings);
+	BOOL passed = TRUE;
+	for (UINT64 frame = 0; frame < sizeof(expected); frame++) {
+		time = frame * 1000;
+		script->Feed(queue, frame);
+		time += 250;
+		machine->Step();
+		passed = passed && machine->Read(Tiny::InputsAddress) == expected[frame];
+	}
+	Tiny::InputStats stats = queue->GetStats();
+	passed = passed && script->IsFinished() && stats.EventsLatched == 7 && stats.EventsDropped == 0
+		&& stats.TotalLatencyNanoseconds == 7 * 250 && stats.MaxLatencyNanoseconds == 250;
+	// The fifth event doesn't fit until the queue is latched and waits for the next Feed instead of being lost.
+	const Tiny::InputScriptEvent burst[] = {
+		{ 0, Tiny::Input::Up, TRUE }, { 0, Tiny::Input::Up, FALSE }, { 0, Tiny::Input::Up, TRUE },
+		{ 0, Tiny::Input::Up, FALSE }, { 0, Tiny::Input::Down, TRUE },
+	};
+	Tiny::InputScript* burstScript = new Tiny::InputScript(burst, 5);
+	passed = passed && burstScript->Feed(queue, 0) == 4 && queue->Latch() == Tiny::Input::Up && burstScript->Feed(queue, 0) == 1
+		&& queue->Latch() == Tiny::Input::Down && burstScript->IsFinished();
+	delete burstScript;
+	delete machine;
+	delete script;
+	delete queue;
+
+	const Tiny::InputScriptEvent unordered[] = { { 2, Tiny::Input::Up, TRUE }, { 1, Tiny::Input::Up, FALSE } };
+	try {
+		Tiny::InputScript rejected(unordered, 2);
+		passed = FALSE;
+	}
+	catch (EZ::Error&) {
+	}
+
+	constexpr UINT32 EventCount = 100000;
+	queue = new Tiny::InputQueue({ });
+	std::thread producer([queue]() {
+		for (UINT32 i = 0; i < EventCount; i++) {
+			while (!queue->Push(static_cast<BYTE>(1 << ((i / 2) % 8)), (i & 1) == 0)) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	UINT64 latched = 0;
+	while (latched < EventCount) {
+		queue->Latch();
+		stats = queue->GetStats();
+		latched = stats.EventsLatched;
+	}
+	producer.join();
+	stats = queue->GetStats();
+	passed = passed && queue->GetHeld() == 0 && stats.EventsLatched == EventCount && stats.EventsPushed == EventCount + stats.EventsDropped;
+	delete queue;
+	return passed;
+}
+
+// Plays the same notes on every channel through an AudioUnit mixing with SIMD and one mixing with the plain C++ loop
+// at a sample rate whose frames leave partial vectors and compares every sample. Then checks a lone square wave has
+// the period, duty and volume its registers ask for, that Trigger reads back 0 and the envelope moves once a frame,
+// that SpscRing keeps items in order across its wrap and that AudioStream hands the sink every sample from another thread.
+static void WriteAudioChannel(Tiny::MemoryBus* bus, UINT32 channel, UINT16 frequency, BYTE volume, INT8 envelope, BYTE duty) {
+	UINT16 address = static_cast<UINT16>(Tiny::AudioChannelsAddress + (channel * Tiny::AudioChannelBytes));
+	bus->Write(address + Tiny::AudioRegister::Frequency, static_cast<BYTE>(frequency));
+	bus->Write(address + Tiny::AudioRegister::Frequency + 1, static_cast<BYTE>(frequency >> 8));
+	bus->Write(address + Tiny::AudioRegister::Volume, volume);
+	bus->Write(address + Tiny::AudioRegister::Envelope, static_cast<BYTE>(envelope));
+	bus->Write(address + Tiny::AudioRegister::Duty, duty);
+	bus->Write(address + Tiny::AudioRegister::Control, Tiny::AudioControl::Trigger);
+}
+static void WriteAudioTune(Tiny::MemoryBus* bus) {
+	for (UINT32 i = 0; i < Tiny::AudioWaveBytes; i++) {
+		bus->Write(static_cast<UINT16>(Tiny::AudioWaveAddress + i), static_cast<BYTE>((i * 8) - 128));
+	}
+	WriteAudioChannel(bus, 0, 1000, 255, 0, 0);
+	WriteAudioChannel(bus, 1, 333, 200, -3, 64);
+	WriteAudioChannel(bus, 2, 440, 255, 0, 0);
+	WriteAudioChannel(bus, 3, 12000, 10, 5, 0);
+}
+struct AudioCheckSink {
+	UINT64 SampleCount;
+	BOOL InOrder;
+};
+static void WriteAudioCheckSink(void* context, const INT16* samples, UINT32 sampleCount) {
+	AudioCheckSink* sink = reinterpret_cast<AudioCheckSink*>(context);
+	for (UINT32 i = 0; i < sampleCount; i++) {
+		sink->InOrder = sink->InOrder && samples[i] == static_cast<INT16>(sink->SampleCount + i);
+	}
+	sink->SampleCount += sampleCount;
+}
+static BOOL CheckAudio() {
+	std::vector<BYTE> simdMemory(Tiny::MemorySize, 0);
+	std::vector<BYTE> scalarMemory(Tiny::MemorySize, 0);
+	Tiny::MemoryBus* simdBus = new Tiny::MemoryBus(simdMemory.data());
+	Tiny::MemoryBus* scalarBus = new Tiny::MemoryBus(scalarMemory.data());
+	Tiny::AudioUnitSettings settings = { };
+	settings.SampleRate = 44100;
+	Tiny::AudioUnit* simd = new Tiny::AudioUnit(simdBus, settings);
+	settings.DisableSimd = TRUE;
+	Tiny::AudioUnit* scalar = new Tiny::AudioUnit(scalarBus, settings);
+	WriteAudioTune(simdBus);
+	WriteAudioTune(scalarBus);
+	std::vector<INT16> simdSamples(simd->GetMaxFrameSamples());
+	std::vector<INT16> scalarSamples(scalar->GetMaxFrameSamples());
+	BOOL passed = simdBus->Read(Tiny::AudioChannelsAddress + Tiny::AudioRegister::Control) == 0;
+	UINT64 sampleCount = 0;
+	for (UINT32 frame = 0; frame < 60; frame++) {
+		UINT32 simdCount = simd->RenderFrame(simdSamples.data());
+		UINT32 scalarCount = scalar->RenderFrame(scalarSamples.data());
+		passed = passed && simdCount == scalarCount && memcmp(simdSamples.data(), scalarSamples.data(), simdCount * sizeof(INT16)) == 0;
+		sampleCount += simdCount;
+	}
+	passed = passed && sampleCount == 44100 && simd->GetChannelVolume(0) == 255 && simd->GetChannelVolume(1) == 20
+		&& simd->GetChannelVolume(3) == 255;
+	delete simd;
+	delete scalar;
+	delete simdBus;
+	delete scalarBus;
+
+	// 750 Hz at 48000 Hz is exactly 64 samples a period, half of them high.
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	Tiny::AudioUnit* unit = new Tiny::AudioUnit(bus, { });
+	WriteAudioChannel(bus, 0, 750, 255, -1, 0);
+	std::vector<INT16> samples(unit->GetMaxFrameSamples());
+	UINT32 count = unit->RenderFrame(samples.data());
+	const INT16 high = static_cast<INT16>((Tiny::AudioChannelAmplitude * 255) >> 8);
+	const INT16 low = static_cast<INT16>((-Tiny::AudioChannelAmplitude * 255) >> 8);
+	passed = passed && count == 800;
+	for (UINT32 i = 0; i < count; i++) {
+		passed = passed && samples[i] == ((i % 64) < 32 ? high : low);
+	}
+	passed = passed && unit->GetChannelVolume(0) == 254;
+	delete unit;
+	delete bus;
+
+	EZ::SpscRing<UINT32> ring(6);
+	UINT32 items[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	UINT32 popped[8] = { };
+	passed = passed && ring.GetCapacity() == 8 && ring.Push(items, 8) == 8 && ring.Push(items, 1) == 0 && ring.Pop(popped, 5) == 5
+		&& ring.Push(items, 5) == 5 && ring.GetSize() == 8 && ring.Pop(popped, 8) == 8 && popped[0] == 5 && popped[2] == 7
+		&& popped[3] == 0 && popped[7] == 4 && ring.GetSize() == 0;
+
+	// Every frame is flushed so nothing is dropped however the two threads are scheduled.
+	AudioCheckSink sink = { 0, TRUE };
+	EZ::AudioStreamSettings streamSettings = { };
+	streamSettings.Sink = { &sink, WriteAudioCheckSink };
+	streamSettings.RingSamples = 1000;
+	EZ::AudioStream* stream = new EZ::AudioStream(streamSettings);
+	std::vector<INT16> frame(800);
+	for (UINT32 i = 0; i < 100; i++) {
+		for (UINT32 j = 0; j < 800; j++) {
+			frame[j] = static_cast<INT16>((i * 800) + j);
+		}
+		passed = passed && stream->Write(frame.data(), 800) == 800;
+		stream->Flush();
+	}
+	EZ::AudioStreamStats stats = stream->GetStats();
+	delete stream;
+	passed = passed && sink.InOrder && sink.SampleCount == 80000 && stats.SamplesWritten == 80000 && stats.SamplesDropped == 0
+		&& stats.SamplesDelivered == 80000;
+	return passed;
+}
+
+// Publishes frames whose every byte and leading sequence number say which frame they are through an EZ::FramePipeline
+// whose presenter sometimes sleeps so frames get skipped, and checks the presenter never sees a torn or older frame,
+// that it ends on the newest one, that the producer sees the presented frame only move forward and that Redraw
+// presents it again. Also checks a lone TripleBuffer hands over only the newest of several frames.
+struct PipelineCheckPresenter {
+	UINT64 LastSequence;
+	UINT64 Presents;
+	BOOL Passed;
+};
+static void PresentPipelineCheckFrame(void* context, const BYTE* frame, UINT32 size) {
+	PipelineCheckPresenter* presenter = reinterpret_cast<PipelineCheckPresenter*>(context);
+	UINT64 sequence = 0;
+	memcpy(&sequence, frame, sizeof(sequence));
+	for (UINT32 i = sizeof(sequence); i < size; i++) {
+		presenter->Passed = presenter->Passed && frame[i] == static_cast<BYTE>(sequence);
+	}
+	// Only a redraw presents the same frame twice.
+	presenter->Passed = presenter->Passed && sequence >= presenter->LastSequence;
+	presenter->LastSequence = sequence;
+	presenter->Presents++;
+	if ((sequence % 7) == 0) {
+		EZ::SleepNanoseconds(20000);
+	}
+}
+static BOOL CheckFramePipeline() {
+	EZ::TripleBuffer* buffer = new EZ::TripleBuffer(16);
+	for (UINT32 i = 1; i <= 3; i++) {
+		memset(buffer->GetBackBuffer(), static_cast<int>(i), 16);
+		buffer->Publish();
+	}
+	BOOL passed = buffer->HasNewFrame() && buffer->Acquire() && buffer->GetFrontSequence() == 3 && buffer->GetFrontBuffer()[15] == 3
+		&& !buffer->Acquire() && !buffer->HasNewFrame() && buffer->GetBackBuffer() != buffer->GetFrontBuffer();
+	delete buffer;
+
+	constexpr UINT64 FrameCount = 5000;
+	constexpr UINT32 FrameBytes = 4096;
+	PipelineCheckPresenter presenter = { 0, 0, TRUE };
+	EZ::FramePipelineSettings settings = { };
+	settings.FrameBytes = FrameBytes;
+	settings.Context = &presenter;
+	settings.Present = PresentPipelineCheckFrame;
+	EZ::FramePipeline* pipeline = new EZ::FramePipeline(settings);
+	UINT64 lastPresented = 0;
+	for (UINT64 sequence = 1; sequence <= FrameCount; sequence++) {
+		// The presented frame only moves forward and never past the newest one published.
+		UINT64 presented = pipeline->GetPresentedSequence();
+		passed = passed && presented >= lastPresented && presented < sequence;
+		lastPresented = presented;
+		BYTE* frame = pipeline->GetBackBuffer();
+		memset(frame, static_cast<int>(sequence & 0xFF), FrameBytes);
+		memcpy(frame, &sequence, sizeof(sequence));
+		pipeline->Publish();
+	}
+	pipeline->Flush();
+	EZ::FramePipelineStats stats = pipeline->GetStats();
+	passed = passed && pipeline->GetPresentedSequence() == FrameCount && presenter.LastSequence == FrameCount && stats.FramesPublished == FrameCount
+		&& stats.FramesPresented + stats.FramesSkipped == FrameCount && stats.FramesPresented == presenter.Presents;
+	pipeline->Redraw();
+	while (pipeline->GetStats().FramesPresented == stats.FramesPresented) {
+		std::this_thread::yield();
+	}
+	delete pipeline;
+	passed = passed && presenter.Passed && presenter.LastSequence == FrameCount && presenter.Presents == stats.FramesPresented + 1;
+	return passed;
+}
+
+// Races the lifecycle and the resize mailbox the way EZ::Program's window thread and game loop do. Waiters block on
+// every stage while two threads advance through them and another polls, so a lost wake hangs the check and a stage
+// seen going backwards fails it. Then one thread posts sizes whose height is derived from their width as fast as it
+// can while another takes them, so a width paired with the height of another resize or an older size taken after a
+// newer one fails it. Build with -fsanitize=thread as shown at the top of the file to also catch data races.
+static BOOL CheckLifecycle() {
+	constexpr UINT32 LifecycleRounds = 200;
+	constexpr BYTE LastStage = static_cast<BYTE>(EZ::LifecycleStage::Destroyed);
+	std::atomic<BOOL> passed(TRUE);
+	for (UINT32 round = 0; round < LifecycleRounds; round++) {
+		EZ::Lifecycle* lifecycle = new EZ::Lifecycle();
+		std::vector<std::thread> threads;
+		for (BYTE stage = 1; stage <= LastStage; stage++) {
+			threads.emplace_back([lifecycle, stage, &passed]() {
+				EZ::LifecycleStage reached = lifecycle->WaitFor(static_cast<EZ::LifecycleStage>(stage));
+				if (static_cast<BYTE>(reached) < stage || lifecycle->GetStage() < reached) {
+					passed.store(FALSE);
+				}
+			});
+		}
+		threads.emplace_back([lifecycle, &passed]() {
+			BYTE last = 0;
+			while (last != LastStage) {
+				BYTE stage = static_cast<BYTE>(lifecycle->GetStage());
+				if (stage < last) {
+					passed.store(FALSE);
+				}
+				last = stage;
+				std::this_thread::yield();
+			}
+		});
+		// One thread walks every stage like the program does, the other repeats the middle ones like a late close.
+		for (BYTE first = 1; first <= 2; first++) {
+			threads.emplace_back([lifecycle, first, &passed]() {
+				BYTE lastPrevious = 0;
+				for (BYTE stage = first; stage <= (first == 1 ? LastStage : LastStage - 1); stage++) {
+					BYTE previous = static_cast<BYTE>(lifecycle->Advance(static_cast<EZ::LifecycleStage>(stage)));
+					if (previous < lastPrevious || static_cast<BYTE>(lifecycle->GetStage()) < stage) {
+						passed.store(FALSE);
+					}
+					lastPrevious = previous;
+				}
+			});
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		if (lifecycle->GetStage() != EZ::LifecycleStage::Destroyed || lifecycle->Advance(EZ::LifecycleStage::Running) != EZ::LifecycleStage::Destroyed
+			|| lifecycle->GetStage() != EZ::LifecycleStage::Destroyed) {
+			passed.store(FALSE);
+		}
+		delete lifecycle;
+	}
+
+	EZ::ResizeMailbox* mailbox = new EZ::ResizeMailbox();
+	UINT32 width = 0;
+	UINT32 height = 0;
+	mailbox->Post(0x7FFFFFFF, 0xFFFFFFFF);
+	if (!mailbox->IsPending() || !mailbox->Take(&width, &height) || width != 0x7FFFFFFF || height != 0xFFFFFFFF
+		|| mailbox->IsPending() || mailbox->Take(&width, &height)) {
+		passed.store(FALSE);
+	}
+	constexpr UINT32 PostCount = 100000;
+	constexpr UINT32 HeightKey = 0x9E3779B9;
+	std::atomic<BOOL> posting(TRUE);
+	std::thread poster([mailbox, &posting]() {
+		for (UINT32 i = 1; i <= PostCount; i++) {
+			mailbox->Post(i, i * HeightKey);
+		}
+		posting.store(FALSE);
+	});
+	UINT32 lastWidth = 0;
+	UINT32 takes = 0;
+	while (TRUE) {
+		BOOL done = !posting.load();
+		if (mailbox->Take(&width, &height)) {
+			if (height != width * HeightKey || width <= lastWidth) {
+				passed.store(FALSE);
+			}
+			lastWidth = width;
+			takes++;
+		}
+		else if (done) {
+			break;
+		}
+	}
+	poster.join();
+	BOOL result = passed.load() && takes > 0 && lastWidth == PostCount && !mailbox->IsPending();
+	delete mailbox;
+	return result;
+}
+
+// Draws a scene of clears, opaque and translucent rects and scaled, flipped and unscaled bitmaps with mixed alpha
+// into a target whose width and height leave partial vectors and a partial band, once with the scalar spans on one
+// thread and once with the SIMD spans on a thread pool, and compares the frame buffers byte for byte.
+static BOOL CheckSoftwareRenderer() {
+	std::vector<BYTE> random(4096 * 4);
+	FillRandom(random, 0x50F7);
+	std::vector<BYTE> pixels(61 * 37 * 4);
+	FillRandom(pixels, 0xB17B);
+	for (size_t i = 0; i < pixels.size(); i += 4) {
+		// Keep the pixels premultiplied, with a share of them fully opaque and fully transparent.
+		BYTE alpha = pixels[i + 3] < 64 ? 0 : (pixels[i + 3] > 192 ? 255 : pixels[i + 3]);
+		pixels[i + 3] = alpha;
+		for (UINT32 channel = 0; channel < 3; channel++) {
+			pixels[i + channel] = static_cast<BYTE>((pixels[i + channel] * alpha) / 255);
+		}
+	}
+	EZ::BitmapAsset bitmap = { 61, 37, pixels.data() };
+	EZ::ThreadPool* threadPool = new EZ::ThreadPool(3);
+	EZ::SoftwareRenderer* reference = new EZ::SoftwareRenderer({ 333, 197, nullptr, TRUE });
+	EZ::SoftwareRenderer* renderer = new EZ::SoftwareRenderer({ 333, 197, threadPool, FALSE });
+	for (EZ::SoftwareRenderer* target : { reference, renderer }) {
+		target->BeginDraw();
+		target->Clear({ 0.2f, 0.4f, 0.6f, 1.0f });
+		for (UINT32 i = 0; i < 1024; i++) {
+			const BYTE* r = random.data() + (i * 16);
+			D2D1_RECT_L rect = EZ::RectL(static_cast<LONG>(r[0] + r[1]) - 40, static_cast<LONG>(r[2] % 230) - 20, r[3] % 90, r[4] % 90);
+			switch (r[5] % 5) {
+			case 0:
+				target->FillRect(rect, { r[6] / 255.0f, r[7] / 255.0f, r[8] / 255.0f, (r[9] & 1) ? 1.0f : r[9] / 255.0f });
+				break;
+			case 1:
+				target->DrawBitmap(&bitmap, D2D1_POINT_2L{ rect.left, rect.top });
+				break;
+			case 2:
+				target->DrawBitmap(&bitmap, rect);
+				break;
+			case 3:
+				target->DrawBitmap(&bitmap, EZ::RectL(r[10] % 40, r[11] % 20, (r[12] % 21) + 1, (r[13] % 17) + 1), rect);
+				break;
+			default:
+				// Destinations given right to left still cover the same pixels.
+				target->DrawBitmap(&bitmap, D2D1_RECT_L{ rect.right, rect.top, rect.left, rect.bottom });
+				break;
+			}
+		}
+		target->EndDraw();
+	}
+	BOOL passed = memcmp(reference->GetPixels(), renderer->GetPixels(), static_cast<size_t>(reference->GetStride()) * 197) == 0;
+	delete renderer;
+	delete reference;
+	delete threadPool;
+	return passed;
+}
+
+// Upscales a frame of a few colors, so Scale2x and Scale3x find edges, to whole, fractional, doubled, unchanged and
+// smaller sizes with every filter. Each is run once with the scalar rows on one thread and once with the SIMD rows
+// on a thread pool, and both are compared byte for byte. Nearest is also checked against sampling every pixel directly.
+static BOOL CheckUpscaler() {
+	constexpr UINT32 SourceStride = (Tiny::ScreenWidth + 3) * 4;
+	std::vector<BYTE> random(SourceStride * Tiny::ScreenHeight);
+	FillRandom(random, 0x0B5C);
+	std::vector<BYTE> source(random.size());
+	const UINT32 colors[3] = { 0xFF000000, 0xFF30A0F0, 0xFFFFFFFF };
+	for (size_t i = 0; i < source.size(); i += 4) {
+		memcpy(source.data() + i, &colors[random[i] % 3], 4);
+	}
+	const D2D1_SIZE_U sizes[] = { { 1280, 720 }, { 1920, 1080 }, { 512, 288 }, { 768, 432 }, { 1003, 611 }, { 256, 144 }, { 100, 57 } };
+	const EZ::UpscaleFilter filters[] = { EZ::UpscaleFilter::Nearest, EZ::UpscaleFilter::Scale2x, EZ::UpscaleFilter::Scale3x };
+	EZ::ThreadPool* threadPool = new EZ::ThreadPool(3);
+	BOOL passed = TRUE;
+	for (D2D1_SIZE_U size : sizes) {
+		for (EZ::UpscaleFilter filter : filters) {
+			EZ::Upscaler* reference = new EZ::Upscaler({ Tiny::ScreenWidth, Tiny::ScreenHeight, size.width, size.height, filter, nullptr, TRUE });
+			EZ::Upscaler* upscaler = new EZ::Upscaler({ Tiny::ScreenWidth, Tiny::ScreenHeight, size.width, size.height, filter, threadPool, FALSE });
+			UINT32 stride = (size.width + 1) * 4;
+			std::vector<BYTE> expected(static_cast<size_t>(stride) * size.height);
+			std::vector<BYTE> actual(expected.size());
+			reference->Upscale(source.data(), SourceStride, expected.data(), stride);
+			upscaler->Upscale(source.data(), SourceStride, actual.data(), stride);
+			passed = passed && expected == actual;
+			for (UINT32 y = 0; y < size.height && filter == EZ::UpscaleFilter::Nearest; y++) {
+				UINT32 sourceY = static_cast<UINT32>(((y * 2 + 1) * static_cast<UINT64>(Tiny::ScreenHeight)) / (size.height * 2));
+				for (UINT32 x = 0; x < size.width; x++) {
+					UINT32 sourceX = static_cast<UINT32>(((x * 2 + 1) * static_cast<UINT64>(Tiny::ScreenWidth)) / (size.width * 2));
+					passed = passed && memcmp(&actual[(y * stride) + (x * 4)], &source[(sourceY * SourceStride) + (sourceX * 4)], 4) == 0;
+				}
+			}
+			delete upscaler;
+			delete reference;
+		}
+	}
+	delete threadPool;
+	return passed;
+}
+
+// Round trips zeros, noise, short repeats and sparse bytes at sizes around the format's edge cases through
+// Compress and Decompress, then feeds Decompress damaged copies which must be refused without crashing.
+static BOOL CheckCompression() {
+	std::vector<BYTE> noise(70000);
+	FillRandom(noise, 0xC0DEC);
+	std::vector<BYTE> source(noise.size());
+	std::vector<BYTE> decompressed(noise.size());
+	const UINT32 sizes[] = { 0, 1, 3, 4, 5, 19, 300, 65536, 70000 };
+	for (UINT32 kind = 0; kind < 4; kind++) {
+		for (size_t i = 0; i < source.size(); i++) {
+			switch (kind) {
+			case 0: source[i] = 0; break;
+			case 1: source[i] = noise[i]; break;
+			case 2: source[i] = static_cast<BYTE>(i % 7); break;
+			default: source[i] = noise[i] < 16 ? noise[i] : 0; break;
+			}
+		}
+		for (UINT32 size : sizes) {
+			std::vector<BYTE> compressed(EZ::GetCompressBound(size));
+			UINT32 compressedSize = EZ::Compress(source.data(), size, compressed.data());
+			if (compressedSize > compressed.size() || !EZ::Decompress(compressed.data(), compressedSize, decompressed.data(), size)
+				|| memcmp(source.data(), decompressed.data(), size) != 0) {
+				std::cout << "  mismatch for data kind " << kind << " size " << size << std::endl;
+				return FALSE;
+			}
+			for (UINT32 i = 0; i < 64 && compressedSize > 0; i++) {
+				std::vector<BYTE> damaged(compressed.begin(), compressed.begin() + compressedSize);
+				damaged[noise[i * 2] % compressedSize] ^= static_cast<BYTE>(noise[i * 2 + 1] | 1);
+				EZ::Decompress(damaged.data(), compressedSize - (compressedSize > i % 3 ? i % 3 : 0), decompressed.data(), size);
+			}
+		}
+	}
+	return TRUE;
+}
+
+static void BenchmarkExpandGrayscale(BenchmarkRunner& runner, const std::string& name, Tiny::ExpandGrayscaleKernel kernel, UINT32 pixelCount) {
+	if (!runner.Wants(name)) {
+		return;
+	}
+	std::vector<BYTE> source(pixelCount);
+	FillRandom(source, 0xBEEF);
+	std::vector<BYTE> destination(static_cast<size_t>(pixelCount) * 4);
+	runner.Run(name, "bytes", static_cast<double>(destination.size()), [&]() {
+		kernel(source.data(), destination.data(), pixelCount);
+		benchmarkSink += destination[pixelCount / 2];
+	});
+}
+
+static void BenchmarkUnpackPallet(BenchmarkRunner& runner, const std::string& name, Tiny::UnpackPalletKernel kernel, UINT32 pixelCount) {
+	if (!runner.Wants(name)) {
+		return;
+	}
+	std::vector<BYTE> source((pixelCount / 4) * 3);
+	FillRandom(source, 0xBEEF);
+	std::vector<BYTE> palletBytes(Tiny::PalletBytes);
+	FillRandom(palletBytes, 0xFACADE);
+	UINT32 pallet[Tiny::PalletColorCount];
+	Tiny::ExpandPallet(palletBytes.data(), pallet);
+	std::vector<BYTE> destination(static_cast<size_t>(pixelCount) * 4);
+	runner.Run(name, "bytes", static_cast<double>(destination.size()), [&]() {
+		kernel(source.data(), pallet, destination.data(), pixelCount);
+		benchmarkSink += destination[pixelCount / 2];
+	});
+}
+
+// memcpy of a finished B8G8R8A8 frame is the bar the kernels aim for.
+static void BenchmarkMemcpy(BenchmarkRunner& runner, const std::string& name, UINT32 pixelCount) {
+	if (!runner.Wants(name)) {
+		return;
+	}
+	std::vector<BYTE> source(static_cast<size_t>(pixelCount) * 4);
+	FillRandom(source, 0xBEEF);
+	std::vector<BYTE> destination(source.size());
+	UINT32 counter = 0;
+	runner.Run(name, "bytes", static_cast<double>(destination.size()), [&]() {
+		memcpy(destination.data(), source.data(), source.size());
+		// Stops the compiler from hoisting the copy out of the loop.
+		source[counter % source.size()] ^= destination[(counter * 7) % destination.size()];
+		counter++;
+	});
+	benchmarkSink += destination[pixelCount / 2];
+}
+
+static const char* VideoModeName(Tiny::VideoMode mode) {
+	switch (mode) {
+	case Tiny::VideoMode::Grayscale: return "Grayscale";
+	case Tiny::VideoMode::BitmapWithPallet: return "BitmapWithPallet";
+	case Tiny::VideoMode::Tiles: return "Tiles";
+	case Tiny::VideoMode::ShaderGraph: return "ShaderGraph";
+	default: return "Unknown";
+	}
+}
+
+// Returns the first byte and the number of bytes of video memory mode reads.
+static void GetVideoModeBytes(Tiny::VideoMode mode, UINT16* address, UINT32* size) {
+	switch (mode) {
+	case Tiny::VideoMode::BitmapWithPallet:
+		*address = Tiny::PalletPixelAddress;
+		*size = Tiny::PalletModeBytes;
+		break;
+	case Tiny::VideoMode::Tiles:
+		*address = Tiny::TileGridAddress;
+		*size = Tiny::TileModeBytes;
+		break;
+	case Tiny::VideoMode::ShaderGraph:
+		*address = Tiny::BackgroundColorAddress;
+		*size = Tiny::ShaderGraphModeBytes;
+		break;
+	case Tiny::VideoMode::Grayscale:
+	default:
+		*address = Tiny::VideoAddress;
+		*size = Tiny::GrayscaleBytes;
+		break;
+	}
+}
+
+// Creates a machine in mode with the same pattern in video memory as TinyRunner so every video mode has something to draw.
+static Tiny::Machine* CreatePatternMachine(Tiny::VideoMode mode, Tiny::MachineSettings settings) {
+	Tiny::Machine* machine = new Tiny::Machine(settings);
+	BYTE* memory = machine->GetMemory();
+	memory[Tiny::SysFlagsAddress] = static_cast<BYTE>(mode);
+	for (UINT32 i = Tiny::VideoAddress; i < Tiny::MemorySize; i++) {
+		memory[i] = static_cast<BYTE>((i * 31) ^ (i >> 8));
+	}
+	machine->MarkDirty(0, Tiny::MemorySize);
+	return machine;
+}
+
+// Measures Machine::Render in mode when every row must be converted, when one byte of video memory changed
+// and when nothing changed. These are the conversions from emulator memory to the B8G8R8A8 pixels Update uploads.
+static void BenchmarkRender(BenchmarkRunner& runner, Tiny::VideoMode mode) {
+	std::string prefix = std::string("Render/") + VideoModeName(mode);
+	Tiny::Machine* machine = CreatePatternMachine(mode, { });
+	std::vector<BYTE> frameBuffers[2] = { std::vector<BYTE>(Tiny::FrameBufferSize), std::vector<BYTE>(Tiny::FrameBufferSize) };
+	UINT32 counter = 0;
+	// Switching frame buffers every call makes Render convert every row.
+	runner.Run(prefix + "/Full", "frames", 1.0, [&]() {
+		Tiny::DirtyRows rows = machine->Render(frameBuffers[counter & 1].data(), Tiny::ScreenWidth * 4);
+		benchmarkSink += rows.Bottom;
+		counter++;
+	});
+
+	UINT16 address = 0;
+	UINT32 size = 0;
+	GetVideoModeBytes(mode, &address, &size);
+	machine->Render(frameBuffers[0].data(), Tiny::ScreenWidth * 4);
+	runner.Run(prefix + "/OneByte", "frames", 1.0, [&]() {
+		UINT16 changed = static_cast<UINT16>(address + ((counter * 257) % size));
+		machine->Write(changed, static_cast<BYTE>(machine->Read(changed) + 1));
+		Tiny::DirtyRows rows = machine->Render(frameBuffers[0].data(), Tiny::ScreenWidth * 4);
+		benchmarkSink += rows.Bottom;
+		counter++;
+	});
+
+	machine->Render(frameBuffers[0].data(), Tiny::ScreenWidth * 4);
+	runner.Run(prefix + "/Unchanged", "frames", 1.0, [&]() {
+		Tiny::DirtyRows rows = machine->Render(frameBuffers[0].data(), Tiny::ScreenWidth * 4);
+		benchmarkSink += rows.Bottom;
+	});
+	delete machine;
+}
+
+// Stands in for a player by returning Input bits held in a pattern which changes every frame.
+// The frame number the pattern comes from is the machine's user data.
+static BYTE ReadScriptedKeyboard(Tiny::Machine* machine) {
+	UINT32* frame = machine->GetUserDataAs<UINT32>();
+	(*frame)++;
+	UINT32 keys = (*frame * 0x9E3779B9u) >> 24;
+	BYTE inputs = 0;
+	if (keys & (1 << 0)) { inputs |= Tiny::Input::Up; }
+	if (keys & (1 << 1)) { inputs |= Tiny::Input::Down; }
+	if (keys & (1 << 2)) { inputs |= Tiny::Input::Left; }
+	if (keys & (1 << 3)) { inputs |= Tiny::Input::Right; }
+	if (keys & (1 << 4)) { inputs |= Tiny::Input::Jump; }
+	if (keys & (1 << 5)) { inputs |= Tiny::Input::Action; }
+	if (keys & (1 << 6)) { inputs |= Tiny::Input::SpecialA; }
+	if (keys & (1 << 7)) { inputs |= Tiny::Input::SpecialB; }
+	return inputs;
+}
+
+// Measures a Step of a machine whose CPU was never reset, which does nothing but latch the Inputs register.
+// Input/Latch latches a pattern and Input/Queue an InputQueue which a press and a release went into since the last
+// frame, the way the window thread feeds it.
+static void BenchmarkInput(BenchmarkRunner& runner) {
+	if (!runner.Wants("Input")) {
+		return;
+	}
+	UINT32 frame = 0;
+	Tiny::MachineSettings settings = { };
+	settings.UserData = &frame;
+	settings.InputCallback = ReadScriptedKeyboard;
+	Tiny::Machine* machine = new Tiny::Machine(settings);
+	runner.Run("Input/Latch", "frames", 1.0, [&]() {
+		machine->Step();
+	});
+	benchmarkSink += machine->Read(Tiny::InputsAddress);
+	delete machine;
+
+	Tiny::InputQueue* queue = new Tiny::InputQueue({ });
+	settings.UserData = queue;
+	settings.InputCallback = LatchInputQueue;
+	machine = new Tiny::Machine(settings);
+	runner.Run("Input/Queue", "frames", 1.0, [&]() {
+		queue->Push(Tiny::Input::Jump, TRUE);
+		queue->Push(Tiny::Input::Jump, FALSE);
+		machine->Step();
+	});
+	benchmarkSink += machine->Read(Tiny::InputsAddress);
+	delete machine;
+	delete queue;
+}
+
+// Measures the pixel to DIP conversion EZ::Renderer does for every DrawBitmap and FillRect
+// on a window at 125% scaling, which needs real divisions rather than ones the compiler can fold away.
+static void BenchmarkTransformRect(BenchmarkRunner& runner) {
+	if (!runner.Wants("TransformRect")) {
+		return;
+	}
+	constexpr UINT32 RectCount = 1024;
+	std::vector<BYTE> random(RectCount * 4);
+	FillRandom(random, 0x7EC7);
+	std::vector<D2D1_RECT_L> rects(RectCount);
+	for (UINT32 i = 0; i < RectCount; i++) {
+		rects[i] = EZ::RectL(random[i * 4] * 7, random[i * 4 + 1] * 4, random[i * 4 + 2] + 1, random[i * 4 + 3] + 1);
+	}
+	D2D1_SIZE_U pixelSize = { 1920, 1080 };
+	D2D1_SIZE_F dipSize = { 1920.0f / 1.25f, 1080.0f / 1.25f };
+	runner.Run("TransformRect", "rects", RectCount, [&]() {
+		FLOAT sum = 0.0f;
+		for (const D2D1_RECT_L& rect : rects) {
+			D2D1_RECT_F transformed = EZ::TransformRect(rect, dipSize, pixelSize);
+			sum += transformed.left + transformed.top + transformed.right + transformed.bottom;
+		}
+		benchmarkSink += static_cast<UINT64>(sum);
+	});
+}
+
+// Measures recording a frame of UI into an EZ::DrawList and drawing it with EZ::SoftwareRenderer:
+// RectCount small translucent rects and a 256x144 bitmap stretched over a 1280x720 target.
+static void BenchmarkDrawList(BenchmarkRunner& runner, EZ::ThreadPool* threadPool) {
+	if (!runner.Wants("DrawList")) {
+		return;
+	}
+	constexpr UINT32 RectCount = 1024;
+	std::vector<BYTE> random(RectCount * 4);
+	FillRandom(random, 0xD4A7);
+	std::vector<D2D1_RECT_L> rects(RectCount);
+	for (UINT32 i = 0; i < RectCount; i++) {
+		rects[i] = EZ::RectL(random[i * 4] * 5, random[i * 4 + 1] * 2, (random[i * 4 + 2] & 31) + 1, (random[i * 4 + 3] & 31) + 1);
+	}
+	std::vector<BYTE> pixels(Tiny::FrameBufferSize);
+	FillRandom(pixels, 0xB17A);
+	EZ::BitmapAsset bitmap = { Tiny::ScreenWidth, Tiny::ScreenHeight, pixels.data() };
+	EZ::DrawList* list = new EZ::DrawList();
+	EZ::BitmapRef bitmapRef = EZ::SoftwareRenderer::GetBitmapRef(&bitmap);
+	auto record = [&]() {
+		list->Reset({ 1280.0f, 720.0f }, { 1280, 720 });
+		list->Clear({ 0.0f, 0.0f, 0.0f, 1.0f });
+		list->DrawBitmap(bitmapRef, EZ::RectL(0, 0, 1280, 720));
+		for (UINT32 i = 0; i < RectCount; i++) {
+			list->FillRect(rects[i], { (i & 1) * 1.0f, (i & 2) * 0.5f, 1.0f, 0.5f });
+		}
+	};
+	runner.Run("DrawList/Record", "commands", RectCount + 2, record);
+	record();
+	const EZ::SoftwareRendererSettings settings[] = { { 1280, 720, nullptr, TRUE }, { 1280, 720, nullptr, FALSE }, { 1280, 720, threadPool, FALSE } };
+	const char* names[] = { "DrawList/SoftwareRenderer/Scalar", "DrawList/SoftwareRenderer/SingleThread", "DrawList/SoftwareRenderer/ThreadPool" };
+	for (UINT32 i = 0; i < 3; i++) {
+		EZ::SoftwareRenderer* renderer = new EZ::SoftwareRenderer(settings[i]);
+		runner.Run(names[i], "commands", RectCount + 2, [&]() {
+			renderer->Submit(*list);
+		});
+		benchmarkSink += renderer->GetPixels()[0];
+		delete renderer;
+	}
+	delete list;
+}
+
+// Upscales one emulator frame to window and 4K sizes. 4K is the 60x blow-up which has to stay a small part of a frame.
+static void BenchmarkUpscale(BenchmarkRunner& runner, const std::string& name, D2D1_SIZE_U size, EZ::UpscaleFilter filter, EZ::ThreadPool* threadPool) {
+	if (!runner.Wants(name)) {
+		return;
+	}
+	std::vector<BYTE> frame(Tiny::FrameBufferSize);
+	FillRandom(frame, 0xF4A3);
+	std::vector<BYTE> destination(static_cast<size_t>(size.width) * size.height * 4);
+	EZ::Upscaler* upscaler = new EZ::Upscaler({ Tiny::ScreenWidth, Tiny::ScreenHeight, size.width, size.height, filter, threadPool, FALSE });
+	runner.Run(name, "frames", 1.0, [&]() {
+		upscaler->Upscale(frame.data(), Tiny::ScreenWidth * 4, destination.data(), size.width * 4);
+		benchmarkSink += destination[destination.size() / 2];
+	});
+	delete upscaler;
+}
+
+// Fills Shader Graph memory with random sprites and 1024 instances. If overlapping == TRUE every instance sits on the
+// same spot straddling two bands, which is the worst case for overdraw and for balancing bands across threads.
+static void BenchmarkShaderGraph(BenchmarkRunner& runner, const std::string& name, BOOL overlapping, EZ::ThreadPool* threadPool) {
+	if (!runner.Wants(name)) {
+		return;
+	}
+	std::vector<BYTE> memory(Tiny::MemorySize);
+	FillRandom(memory, 0x5EED);
+	if (overlapping) {
+		for (UINT32 instance = 0; instance < Tiny::InstanceCount; instance++) {
+			memory[Tiny::InstancePositionAddress + (instance * 2)] = 100;
+			memory[Tiny::InstancePositionAddress + (instance * 2) + 1] = Tiny::SpriteBandHeight * 4 - 2;
+		}
+	}
+	std::vector<BYTE> frameBuffer(Tiny::FrameBufferSize);
+	Tiny::SpriteRenderer* renderer = new Tiny::SpriteRenderer();
+	runner.Run(name, "frames", 1.0, [&]() {
+		renderer->Render(memory.data(), frameBuffer.data(), Tiny::ScreenWidth * 4, threadPool);
+		benchmarkSink += frameBuffer[Tiny::FrameBufferSize / 2];
+	});
+	delete renderer;
+}
+
+// A loop of loads, adds, indexed stores into the first page of video memory and branches.
+const BYTE BenchmarkProgram[] = {
+	0x06, 0x00, // 0x9200 LDX #0
+	0x0F, // 0x9202 TXA
+	0x12, 0x03, // 0x9203 ADD #3
+	0x0B, 0x00, 0x01, // 0x9205 STA 0x0100,X
+	0x1F, // 0x9208 INX
+	0x27, 0x02, 0x92, // 0x9209 JNZ 0x9202
+	0x23, 0x00, 0x80, // 0x920C INC 0x8000
+	0x25, 0x00, 0x92, // 0x920F JMP 0x9200
+};
+constexpr UINT16 BenchmarkProgramAddress = 0x9200;
+
+// Measures the guest CPU running BenchmarkProgram for one frame's worth of cycles per iteration.
+static void BenchmarkCpu(BenchmarkRunner& runner) {
+	if (!runner.Wants("Cpu/Run")) {
+		return;
+	}
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	UINT64 dirtyPages[Tiny::PageCount / 64] = { };
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	Tiny::Cpu* cpu = new Tiny::Cpu();
+	LoadProgram(cpu, bus, BenchmarkProgramAddress, BenchmarkProgram, sizeof(BenchmarkProgram));
+
+	// The loop is the same every frame so one frame tells how many instructions each iteration runs.
+	cpu->Run(*bus, dirtyPages, Tiny::DefaultCyclesPerFrame);
+	UINT64 startInstructions = cpu->GetStats().Instructions;
+	cpu->Run(*bus, dirtyPages, Tiny::DefaultCyclesPerFrame);
+	double instructionsPerFrame = static_cast<double>(cpu->GetStats().Instructions - startInstructions);
+	runner.Run("Cpu/Run", "instructions", instructionsPerFrame, [&]() {
+		cpu->Run(*bus, dirtyPages, Tiny::DefaultCyclesPerFrame);
+	});
+	delete cpu;
+	delete bus;
+}
+
+static BYTE BenchmarkMmioRead(void* context, UINT16 address) {
+	return static_cast<BYTE>(address);
+}
+static void BenchmarkMmioWrite(void* context, UINT16 address, BYTE value) {
+	benchmarkSink += value;
+}
+
+// Increments bytes at random addresses straight in the array, through the bus where every page is plain memory and
+// through the bus where every address is MMIO. The bus adds a page table load and a null check to each plain access,
+// which Cpu/Run shows is lost in the cost of dispatching instructions.
+static void BenchmarkMemoryBus(BenchmarkRunner& runner) {
+	if (!runner.Wants("MemoryBus")) {
+		return;
+	}
+	constexpr UINT32 AccessCount = 4096;
+	std::vector<BYTE> random(AccessCount * 2);
+	FillRandom(random, 0xB05);
+	std::vector<UINT16> addresses(AccessCount);
+	for (UINT32 i = 0; i < AccessCount; i++) {
+		addresses[i] = static_cast<UINT16>(random[i * 2] | (random[i * 2 + 1] << 8));
+	}
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	runner.Run("MemoryBus/RawArray", "accesses", AccessCount * 2, [&]() {
+		// Stores compare first like the CPU did before the bus since it needs to know whether memory changed.
+		BYTE* raw = memory.data();
+		for (UINT16 address : addresses) {
+			BYTE value = static_cast<BYTE>(raw[address] + 1);
+			if (raw[address] != value) {
+				raw[address] = value;
+			}
+		}
+	});
+	runner.Run("MemoryBus/PageTable", "accesses", AccessCount * 2, [&]() {
+		// Held in a local like Cpu::Run holds it, else every byte stored could alias the lambda's captures.
+		Tiny::MemoryBus& pages = *bus;
+		for (UINT16 address : addresses) {
+			pages.Write(address, static_cast<BYTE>(pages.Read(address) + 1));
+		}
+	});
+	bus->MapMmio(0, Tiny::MemorySize, BenchmarkMmioRead, BenchmarkMmioWrite, nullptr);
+	runner.Run("MemoryBus/Mmio", "accesses", AccessCount * 2, [&]() {
+		for (UINT16 address : addresses) {
+			bus->Write(address, static_cast<BYTE>(bus->Read(address) + 1));
+		}
+	});
+	benchmarkSink += memory[addresses[0]];
+	delete bus;
+}
+
+// Switches between 8 banks of 16 KB behind a window with Tiny::Mapper and by copying each bank over the window the
+// way banking without a page table would, then lets the CPU call into the bank so both pay for what the CPU has to
+// throw away. A switch repoints 64 pages whatever the bank size while a copy moves the whole bank.
+static void BenchmarkMapper(BenchmarkRunner& runner) {
+	if (!runner.Wants("Mapper")) {
+		return;
+	}
+	constexpr UINT32 BankSize = 0x4000;
+	constexpr UINT32 BankCount = 8;
+	const BYTE program[] = {
+		0x2A, 0x00, 0x80, // 0x9000 JSR 0x8000
+		0x02, // 0x9003 WAIT
+		0x25, 0x00, 0x90, // 0x9004 JMP 0x9000
+	};
+	std::vector<BYTE> rom(BankSize * BankCount);
+	FillRandom(rom, 0xBA4C);
+	for (UINT32 bank = 0; bank < BankCount; bank++) {
+		rom[bank * BankSize] = 0x2B; // RTS
+	}
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	UINT64 dirtyPages[Tiny::PageCount / 64] = { };
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	Tiny::Cpu* cpu = new Tiny::Cpu();
+	LoadProgram(cpu, bus, 0x9000, program, sizeof(program));
+	UINT32 bank = 0;
+	runner.Run("Mapper/CopyBank/16KB", "switches", 1, [&]() {
+		bank = (bank + 1) % BankCount;
+		memcpy(memory.data() + 0x8000, rom.data() + (bank * BankSize), BankSize);
+		cpu->Invalidate(*bus, 0x8000, BankSize);
+		cpu->Run(*bus, dirtyPages, Tiny::DefaultCyclesPerFrame);
+	});
+	Tiny::MapperSettings settings = { };
+	settings.Windows[0] = { 0x8000, BankSize, FALSE };
+	settings.WindowCount = 1;
+	settings.Rom = rom.data();
+	settings.RomSize = static_cast<UINT32>(rom.size());
+	Tiny::Mapper* mapper = new Tiny::Mapper(bus, settings);
+	runner.Run("Mapper/SwitchBank/16KB", "switches", 1, [&]() {
+		bank = (bank + 1) % BankCount;
+		mapper->SelectBank(0, static_cast<BYTE>(bank));
+		cpu->Run(*bus, dirtyPages, Tiny::DefaultCyclesPerFrame);
+	});
+	delete mapper;
+	delete cpu;
+	delete bus;
+}
+
+// Renders a frame of all four channels playing, mixed by the plain C++ loop and by the SIMD mixer, then a whole
+// AudioUnit::Step which also hands the frame to an AudioStream whose thread throws it away.
+static void BenchmarkAudio(BenchmarkRunner& runner) {
+	if (!runner.Wants("Audio")) {
+		return;
+	}
+	std::vector<BYTE> memory(Tiny::MemorySize, 0);
+	Tiny::MemoryBus* bus = new Tiny::MemoryBus(memory.data());
+	std::vector<INT16> samples(Tiny::DefaultAudioSampleRate / Tiny::AudioFrameRate);
+	Tiny::AudioUnitSettings settings = { };
+	for (BOOL disableSimd : { TRUE, FALSE }) {
+		settings.DisableSimd = disableSimd;
+		Tiny::AudioUnit* unit = new Tiny::AudioUnit(bus, settings);
+		WriteAudioTune(bus);
+		runner.Run(disableSimd ? "Audio/RenderFrame/Scalar" : "Audio/RenderFrame/SIMD", "frames", 1, [&]() {
+			unit->RenderFrame(samples.data());
+			WriteAudioTune(bus);
+		});
+		benchmarkSink += samples[0];
+		delete unit;
+	}
+	EZ::AudioStreamSettings streamSettings = { };
+	EZ::AudioStream* stream = new EZ::AudioStream(streamSettings);
+	settings.DisableSimd = FALSE;
+	settings.Stream = stream;
+	Tiny::AudioUnit* unit = new Tiny::AudioUnit(bus, settings);
+	runner.Run("Audio/Step/NullSink", "frames", 1, [&]() {
+		unit->Step();
+		WriteAudioTune(bus);
+	});
+	delete unit;
+	delete stream;
+	delete bus;
+}
+
+// Creates a pattern machine which runs BenchmarkProgram from reset.
+static Tiny::Machine* CreateBenchmarkProgramMachine(Tiny::VideoMode mode, Tiny::MachineSettings settings) {
+	Tiny::Machine* machine = CreatePatternMachine(mode, settings);
+	machine->WriteRange(BenchmarkProgramAddress, BenchmarkProgram, sizeof(BenchmarkProgram));
+	machine->Write(Tiny::ResetVectorAddress, static_cast<BYTE>(BenchmarkProgramAddress));
+	machine->Write(Tiny::ResetVectorAddress + 1, static_cast<BYTE>(BenchmarkProgramAddress >> 8));
+	machine->Reset();
+	return machine;
+}
+
+// Measures whole frames the way TinyEmulator runs them: latch inputs, run the CPU for a frame and convert what changed.
+static void BenchmarkFrame(BenchmarkRunner& runner, Tiny::VideoMode mode, EZ::ThreadPool* threadPool) {
+	std::string name = std::string("Frame/") + VideoModeName(mode);
+	if (!runner.Wants(name)) {
+		return;
+	}
+	UINT32 frame = 0;
+	Tiny::MachineSettings settings = { };
+	settings.UserData = &frame;
+	settings.InputCallback = ReadScriptedKeyboard;
+	settings.ThreadPool = threadPool;
+	Tiny::Machine* machine = CreateBenchmarkProgramMachine(mode, settings);
+	std::vector<BYTE> frameBuffer(Tiny::FrameBufferSize);
+	runner.Run(name, "frames", 1.0, [&]() {
+		machine->Step();
+		Tiny::DirtyRows rows = machine->Render(frameBuffer.data(), Tiny::ScreenWidth * 4);
+		benchmarkSink += rows.Bottom;
+	});
+	delete machine;
+}
+
+// Runs whole frames of BenchmarkProgram and hands each one to a fake presenter which sleeps for half as long as a
+// frame takes, the way a present blocks on the GPU, first one after the other on this thread and then through an
+// EZ::FramePipeline whose presenter thread sleeps while the next frame is produced.
+static void SleepingPresent(void* context, const BYTE* frame, UINT32 size) {
+	EZ::SleepNanoseconds(*reinterpret_cast<UINT64*>(context));
+	benchmarkSink += frame[size / 2];
+}
+static void BenchmarkFramePipeline(BenchmarkRunner& runner) {
+	if (!runner.Wants("Pipeline")) {
+		return;
+	}
+	Tiny::Machine* machine = CreateBenchmarkProgramMachine(Tiny::VideoMode::Grayscale, { });
+	std::vector<BYTE> screen(Tiny::FrameBufferSize);
+	constexpr UINT32 MeasuredFrames = 50;
+	UINT64 start = EZ::GetNanoseconds();
+	for (UINT32 i = 0; i < MeasuredFrames; i++) {
+		machine->Step();
+		machine->Render(screen.data(), Tiny::ScreenWidth * 4);
+	}
+	UINT64 presentNanoseconds = (EZ::GetNanoseconds() - start) / (MeasuredFrames * 2);
+	std::vector<BYTE> presented(Tiny::FrameBufferSize);
+	runner.Run("Pipeline/Serial", "frames", 1.0, [&]() {
+		machine->Step();
+		machine->Render(screen.data(), Tiny::ScreenWidth * 4);
+		memcpy(presented.data(), screen.data(), Tiny::FrameBufferSize);
+		SleepingPresent(&presentNanoseconds, presented.data(), Tiny::FrameBufferSize);
+	});
+	EZ::FramePipelineSettings settings = { };
+	settings.FrameBytes = Tiny::FrameBufferSize;
+	settings.Context = &presentNanoseconds;
+	settings.Present = SleepingPresent;
+	EZ::FramePipeline* pipeline = new EZ::FramePipeline(settings);
+	runner.Run("Pipeline/TripleBuffer", "frames", 1.0, [&]() {
+		machine->Step();
+		machine->Render(screen.data(), Tiny::ScreenWidth * 4);
+		memcpy(pipeline->GetBackBuffer(), screen.data(), Tiny::FrameBufferSize);
+		pipeline->Publish();
+	});
+	delete pipeline;
+	delete machine;
+}
+
+// Measures capturing a machine which runs BenchmarkProgram, whose frames write 2 pages, while sharing every other page
+// with the last capture, capturing every page, restoring and converting to and from the save state file format.
+static void BenchmarkSaveState(BenchmarkRunner& runner) {
+	Tiny::Machine* machine = CreateBenchmarkProgramMachine(Tiny::VideoMode::Grayscale, { });
+	Tiny::SaveState* states[2] = { new Tiny::SaveState(), new Tiny::SaveState() };
+	states[0]->Capture(machine);
+	// The writes a frame of BenchmarkProgram makes, without the cost of running the CPU for a frame.
+	UINT32 counter = 0;
+	runner.Run("SaveState/CaptureChanged", "captures", 1.0, [&]() {
+		machine->Write(static_cast<UINT16>(0x0100 + (counter & 0xFF)), static_cast<BYTE>(counter));
+		machine->Write(0x8000, static_cast<BYTE>(counter >> 8));
+		states[0]->Capture(machine, states[0]);
+		counter++;
+	});
+	runner.Run("SaveState/CaptureAll", "captures", 1.0, [&]() {
+		states[0]->Capture(machine);
+	});
+
+	machine->Step();
+	states[1]->Capture(machine, states[0]);
+	runner.Run("SaveState/Restore", "restores", 1.0, [&]() {
+		states[counter & 1]->Restore(machine);
+		counter++;
+	});
+
+	std::vector<BYTE> data = states[0]->Serialize();
+	runner.Run("SaveState/Serialize", "states", 1.0, [&]() {
+		benchmarkSink += states[0]->Serialize().size();
+	});
+	runner.Run("SaveState/Deserialize", "states", 1.0, [&]() {
+		states[1]->Deserialize(data.data(), data.size());
+	});
+	delete states[0];
+	delete states[1];
+	delete machine;
+}
+
+// Pushes frames of BenchmarkProgram plus scattered host writes into a rewind buffer small enough to evict,
+// then pops back one state and several states at a time and checks every restored state is exactly what was pushed.
+static BOOL CheckRewind() {
+	Tiny::Machine* machine = CreateBenchmarkProgramMachine(Tiny::VideoMode::Grayscale, { });
+	Tiny::RewindBuffer* rewind = new Tiny::RewindBuffer({ 1, 7 });
+	std::vector<BYTE> noise(4096);
+	FillRandom(noise, 0x5EED);
+	std::vector<std::vector<BYTE>> memories;
+	std::vector<UINT64> frameCounts;
+	BOOL passed = TRUE;
+	for (UINT32 frame = 0; frame < 400 && passed; frame++) {
+		machine->Step();
+		for (UINT32 i = 0; i < (frame % 50 == 0 ? 1000u : 4u); i++) {
+			UINT32 index = (frame * 4 + i) * 2 % noise.size();
+			machine->Write(static_cast<UINT16>(0x1000 + noise[index] * 160 + noise[index + 1] % 160), noise[(index + 2) % noise.size()]);
+		}
+		rewind->Push(machine);
+		memories.emplace_back(machine->GetMemory(), machine->GetMemory() + Tiny::MemorySize);
+		frameCounts.push_back(machine->GetFrameCount());
+		if (frame % 90 == 89) {
+			// Back 1 state, then 40 at once, then carry on from there.
+			for (UINT32 count : { 1u, 40u }) {
+				UINT32 held = rewind->GetStats().EntryCount;
+				count = (std::min)(count, held);
+				if (count == 0 || !rewind->Pop(machine, count)) {
+					continue;
+				}
+				memories.resize(memories.size() - count + 1);
+				frameCounts.resize(frameCounts.size() - count + 1);
+				passed = passed && memcmp(machine->GetMemory(), memories.back().data(), Tiny::MemorySize) == 0 && machine->GetFrameCount() == frameCounts.back();
+				memories.pop_back();
+				frameCounts.pop_back();
+			}
+		}
+	}
+	passed = passed && rewind->GetStats().Evictions > 0;
+	while (passed && rewind->Pop(machine)) {
+		passed = memcmp(machine->GetMemory(), memories.back().data(), Tiny::MemorySize) == 0 && machine->GetFrameCount() == frameCounts.back();
+		memories.pop_back();
+		frameCounts.pop_back();
+	}
+	delete rewind;
+	delete machine;
+	return passed;
+}
+
+// Measures pushing the writes a frame of BenchmarkProgram makes into a rewind buffer, and popping a state then pushing
+// it again so there is always history to pop. Prints the compression ratio and the times the buffer measured itself.
+static void BenchmarkRewind(BenchmarkRunner& runner) {
+	if (!runner.Wants("Rewind/Push") && !runner.Wants("Rewind/PopAndPush")) {
+		return;
+	}
+	Tiny::Machine* machine = CreateBenchmarkProgramMachine(Tiny::VideoMode::Grayscale, { });
+	Tiny::RewindBuffer* rewind = new Tiny::RewindBuffer({ });
+	UINT32 counter = 0;
+	runner.Run("Rewind/Push", "pushes", 1.0, [&]() {
+		machine->Write(static_cast<UINT16>(0x0100 + (counter & 0xFF)), static_cast<BYTE>(counter));
+		machine->Write(0x8000, static_cast<BYTE>(counter >> 8));
+		rewind->Push(machine);
+		counter++;
+	});
+	runner.Run("Rewind/PopAndPush", "states", 1.0, [&]() {
+		rewind->Pop(machine);
+		rewind->Push(machine);
+	});
+	Tiny::RewindStats stats = rewind->GetStats();
+	if (stats.Pushes != 0 && stats.Pops != 0 && stats.CompressedBytes != 0) {
+		std::cout << "  Rewind history: " << stats.EntryCount << " states in " << stats.BytesUsed << " bytes, "
+			<< (static_cast<double>(stats.UncompressedBytes) / stats.CompressedBytes) << "x compression, push "
+			<< (stats.PushNanoseconds / 1000.0 / stats.Pushes) << "us average " << (stats.MaxPushNanoseconds / 1000.0) << "us max, pop "
+			<< (stats.PopNanoseconds / 1000.0 / stats.Pops) << "us average " << (stats.MaxPopNanoseconds / 1000.0) << "us max" << std::endl;
+	}
+	delete rewind;
+	delete machine;
+}
+
+int main(int argc, char** argv) {
+	BenchmarkSettings settings = DefaultBenchmarkSettings;
+	const char* jsonPath = nullptr;
+	std::string filter;
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "--json" && i + 1 < argc) {
+			jsonPath = argv[++i];
+		}
+		else if (argument == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else if (argument == "--quick") {
+			settings = QuickBenchmarkSettings;
+		}
+		else {
+			std::cout << "Usage: TinyBench [--json file] [--filter text] [--quick]" << std::endl;
+			return 1;
+		}
+	}
+
+	const Tiny::KernelLevel levels[] = { Tiny::KernelLevel::Scalar, Tiny::KernelLevel::SSE2, Tiny::KernelLevel::AVX2, Tiny::KernelLevel::AVX512 };
+	BOOL allPassed = TRUE;
+
+	std::cout << "Best kernel level: " << KernelLevelName(Tiny::GetBestKernelLevel()) << std::endl;
+	std::cout << "Checks:" << std::endl;
+	BOOL expandGrayscalePassed[4] = { };
+	BOOL unpackPalletPassed[4] = { };
+	for (UINT32 i = 0; i < 4; i++) {
+		// The two kernel families are checked on their own since a level can have one without the other.
+		Tiny::ExpandGrayscaleKernel expandGrayscale = Tiny::GetExpandGrayscaleKernel(levels[i]);
+		Tiny::UnpackPalletKernel unpackPallet = Tiny::GetUnpackPalletKernel(levels[i]);
+		if (expandGrayscale == nullptr && unpackPallet == nullptr) {
+			std::cout << "  " << KernelLevelName(levels[i]) << ": not supported" << std::endl;
+			continue;
+		}
+		std::cout << "  " << KernelLevelName(levels[i]) << ": ExpandGrayscale ";
+		if (expandGrayscale == nullptr) {
+			std::cout << "not supported";
+		}
+		else {
+			expandGrayscalePassed[i] = CheckExpandGrayscale(expandGrayscale);
+			std::cout << (expandGrayscalePassed[i] ? "ok" : "FAILED bit exact check");
+			allPassed = allPassed && expandGrayscalePassed[i];
+		}
+		std::cout << ", UnpackPallet ";
+		if (unpackPallet == nullptr) {
+			// There is no SSE2 pallet kernel by design. Any other level without one is one this CPU can't run.
+			std::cout << (levels[i] == Tiny::KernelLevel::SSE2 ? "no SSE2 pallet kernel" : "not supported");
+		}
+		else {
+			unpackPalletPassed[i] = CheckUnpackPallet(unpackPallet);
+			std::cout << (unpackPalletPassed[i] ? "ok" : "FAILED bit exact check");
+			allPassed = allPassed && unpackPalletPassed[i];
+		}
+		std::cout << std::endl;
+	}
+	if (CheckCompression()) {
+		std::cout << "  Compression: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Compression: FAILED round trip check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckSoftwareRenderer()) {
+		std::cout << "  SoftwareRenderer: ok" << std::endl;
+	}
+	else {
+		std::cout << "  SoftwareRenderer: FAILED bit exact check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckUpscaler()) {
+		std::cout << "  Upscaler: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Upscaler: FAILED bit exact check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckRewind()) {
+		std::cout << "  Rewind: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Rewind: FAILED round trip check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckMemoryBus()) {
+		std::cout << "  MemoryBus: ok" << std::endl;
+	}
+	else {
+		std::cout << "  MemoryBus: FAILED MMIO and write watch check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckMapper()) {
+		std::cout << "  Mapper: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Mapper: FAILED bank switching check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckCartridgeRom()) {
+		std::cout << "  CartridgeRom: ok" << std::endl;
+	}
+	else {
+		std::cout << "  CartridgeRom: FAILED read only ROM check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckAudio()) {
+		std::cout << "  Audio: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Audio: FAILED bit exact mix and stream check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckInput()) {
+		std::cout << "  Input: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Input: FAILED input queue check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckFramePipeline()) {
+		std::cout << "  FramePipeline: ok" << std::endl;
+	}
+	else {
+		std::cout << "  FramePipeline: FAILED newest frame handoff check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckLifecycle()) {
+		std::cout << "  Lifecycle: ok" << std::endl;
+	}
+	else {
+		std::cout << "  Lifecycle: FAILED stage and resize mailbox race check" << std::endl;
+		allPassed = FALSE;
+	}
+	if (CheckSelfModifyingCode()) {
+		std::cout << "  CPU: ok" << std::endl;
+	}
+	else {
+		std::cout << "  CPU: FAILED self modifying code check" << std::endl;
+		allPassed = FALSE;
+	}
+
+	BenchmarkRunner runner(settings, filter);
+	EZ::ThreadPool* threadPool = new EZ::ThreadPool();
+	UINT32 threadCount = threadPool->GetThreadCount();
+	std::cout << "Thread pool: " << threadCount << " threads" << std::endl;
+	// One emulator frame and a frame 16 times larger to show how the kernels scale past the L2 cache.
+	const UINT32 pixelCounts[] = { Tiny::ScreenWidth * Tiny::ScreenHeight, Tiny::ScreenWidth * Tiny::ScreenHeight * 16 };
+
+	std::cout << "Kernels:" << std::endl;
+	for (UINT32 pixelCount : pixelCounts) {
+		std::string suffix = "/" + std::to_string(pixelCount) + "px";
+		for (UINT32 i = 0; i < 4; i++) {
+			if (expandGrayscalePassed[i]) {
+				BenchmarkExpandGrayscale(runner, std::string("ExpandGrayscale/") + KernelLevelName(levels[i]) + suffix, Tiny::GetExpandGrayscaleKernel(levels[i]), pixelCount);
+			}
+		}
+		for (UINT32 i = 0; i < 4; i++) {
+			if (unpackPalletPassed[i]) {
+				BenchmarkUnpackPallet(runner, std::string("UnpackPallet/") + KernelLevelName(levels[i]) + suffix, Tiny::GetUnpackPalletKernel(levels[i]), pixelCount);
+			}
+		}
+		BenchmarkMemcpy(runner, "memcpy" + suffix, pixelCount);
+	}
+
+	std::cout << "Video modes:" << std::endl;
+	const Tiny::VideoMode modes[] = { Tiny::VideoMode::Grayscale, Tiny::VideoMode::BitmapWithPallet, Tiny::VideoMode::Tiles, Tiny::VideoMode::ShaderGraph };
+	for (Tiny::VideoMode mode : modes) {
+		BenchmarkRender(runner, mode);
+	}
+	BenchmarkShaderGraph(runner, "ShaderGraph/Spread/SingleThread", FALSE, nullptr);
+	BenchmarkShaderGraph(runner, "ShaderGraph/Spread/ThreadPool", FALSE, threadPool);
+	BenchmarkShaderGraph(runner, "ShaderGraph/Overlapping/SingleThread", TRUE, nullptr);
+	BenchmarkShaderGraph(runner, "ShaderGraph/Overlapping/ThreadPool", TRUE, threadPool);
+
+	std::cout << "Frame stages:" << std::endl;
+	BenchmarkInput(runner);
+	BenchmarkTransformRect(runner);
+	BenchmarkDrawList(runner, threadPool);
+	BenchmarkUpscale(runner, "Upscale/Nearest/1280x720", { 1280, 720 }, EZ::UpscaleFilter::Nearest, nullptr);
+	BenchmarkUpscale(runner, "Upscale/Nearest/1920x1080", { 1920, 1080 }, EZ::UpscaleFilter::Nearest, nullptr);
+	BenchmarkUpscale(runner, "Upscale/Nearest/3840x2160/SingleThread", { 3840, 2160 }, EZ::UpscaleFilter::Nearest, nullptr);
+	BenchmarkUpscale(runner, "Upscale/Nearest/3840x2160/ThreadPool", { 3840, 2160 }, EZ::UpscaleFilter::Nearest, threadPool);
+	BenchmarkUpscale(runner, "Upscale/Scale2x/3840x2160/SingleThread", { 3840, 2160 }, EZ::UpscaleFilter::Scale2x, nullptr);
+	BenchmarkUpscale(runner, "Upscale/Scale2x/3840x2160/ThreadPool", { 3840, 2160 }, EZ::UpscaleFilter::Scale2x, threadPool);
+	BenchmarkUpscale(runner, "Upscale/Scale3x/3840x2160/SingleThread", { 3840, 2160 }, EZ::UpscaleFilter::Scale3x, nullptr);
+	BenchmarkUpscale(runner, "Upscale/Scale3x/3840x2160/ThreadPool", { 3840, 2160 }, EZ::UpscaleFilter::Scale3x, threadPool);
+	BenchmarkMemoryBus(runner);
+	BenchmarkMapper(runner);
+	BenchmarkAudio(runner);
+	BenchmarkCpu(runner);
+	for (Tiny::VideoMode mode : modes) {
+		BenchmarkFrame(runner, mode, threadPool);
+	}
+	BenchmarkFramePipeline(runner);
+	delete threadPool;
+
+	std::cout << "Save states:" << std::endl;
+	BenchmarkSaveState(runner);
+	BenchmarkRewind(runner);
+
+	if (jsonPath != nullptr && !runner.WriteJson(jsonPath, threadCount, allPassed)) {
+		std::cout << "Failed to write " << jsonPath << std::endl;
+		return 1;
+	}
+	return allPassed ? 0 : 1;
+}
\ No newline at end of file
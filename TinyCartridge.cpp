@@ -0,0 +1,130 @@
+#include "TinyCartridge.h"
+#include "EZError.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// Cartridge files start with this header. Every field is little endian.
+// Offset Size
+//  0      8   Magic "TinyCart"
+//  8      4   CartridgeVersion
+// 12      4   Header size in bytes
+// 16      8   Image offset, always CartridgeImageOffset
+// 24      4   Image size, always MemorySize
+// 28      2   ROM address
+// 30      2   Reserved, always 0
+// 32      4   ROM size
+// 36      4   Bank size in bytes
+// 40      8   FNV-1a hash of the image followed by the banks
+// The header is padded with zeros up to the image offset. The banks follow straight after the image.
+constexpr BYTE CartridgeMagic[8] = { 'T', 'i', 'n', 'y', 'C', 'a', 'r', 't' };
+constexpr UINT32 CartridgeHeaderSize = 48;
+
+namespace {
+	constexpr UINT64 FnvOffsetBasis = 14695981039346656037ull;
+	// Continues hash over size more bytes, so hashing the image and then the banks equals hashing them back to back.
+	UINT64 HashImage(const BYTE* image, UINT32 size, UINT64 hash = FnvOffsetBasis) {
+		for (UINT32 i = 0; i < size; i++) {
+			hash = (hash ^ image[i]) * 1099511628211ull;
+		}
+		return hash;
+	}
+	void WriteLittleEndian(BYTE* destination, UINT64 value, UINT32 size) {
+		for (UINT32 i = 0; i < size; i++) {
+			destination[i] = static_cast<BYTE>(value >> (i * 8));
+		}
+	}
+	UINT64 ReadLittleEndian(const BYTE* source, UINT32 size) {
+		UINT64 value = 0;
+		for (UINT32 i = 0; i < size; i++) {
+			value |= static_cast<UINT64>(source[i]) << (i * 8);
+		}
+		return value;
+	}
+}
+
+Tiny::Cartridge::Cartridge(LPCSTR filePath) {
+	_file = new EZ::MappedFile(filePath);
+	const BYTE* header = _file->GetData();
+	UINT64 size = _file->GetSize();
+	if (header == nullptr || size < CartridgeHeaderSize || memcmp(header, CartridgeMagic, sizeof(CartridgeMagic)) != 0) {
+		delete _file;
+		throw EZ::Error("The file is not a Tiny cartridge.");
+	}
+	if (ReadLittleEndian(header + 8, 4) != CartridgeVersion) {
+		delete _file;
+		throw EZ::Error("The cartridge is from a different version of Tiny.");
+	}
+	UINT64 headerSize = ReadLittleEndian(header + 12, 4);
+	UINT64 imageOffset = ReadLittleEndian(header + 16, 8);
+	UINT64 imageSize = ReadLittleEndian(header + 24, 4);
+	_romAddress = static_cast<UINT16>(ReadLittleEndian(header + 28, 2));
+	_romSize = static_cast<UINT32>(ReadLittleEndian(header + 32, 4));
+	_bankSize = static_cast<UINT32>(ReadLittleEndian(header + 36, 4));
+	_contentHash = ReadLittleEndian(header + 40, 8);
+	if (headerSize < CartridgeHeaderSize || imageOffset != CartridgeImageOffset || imageSize != MemorySize || size < imageOffset + imageSize + _bankSize
+		|| _romAddress + static_cast<UINT64>(_romSize) > MemorySize) {
+		delete _file;
+		throw EZ::Error("The cartridge header is corrupt.");
+	}
+	// Hashing reads the image through the shared read only mapping so it doesn't cost any memory of its own.
+	if (HashImage(GetBanks(), _bankSize, HashImage(GetImage(), MemorySize)) != _contentHash) {
+		delete _file;
+		throw EZ::Error("The cartridge image is corrupt.");
+	}
+}
+BYTE* Tiny::Cartridge::MapMemory() const {
+	return _file->MapCopyOnWrite(CartridgeImageOffset, MemorySize);
+}
+void Tiny::Cartridge::UnmapMemory(BYTE* memory) {
+	EZ::MappedFile::UnmapCopyOnWrite(memory, MemorySize);
+}
+void Tiny::Cartridge::Save(LPCSTR filePath, const BYTE* image, UINT16 romAddress, UINT32 romSize, const BYTE* banks, UINT32 bankSize) {
+	if (romAddress + static_cast<UINT64>(romSize) > MemorySize) {
+		throw EZ::Error("The cartridge ROM must be inside memory.");
+	}
+	std::vector<BYTE> header(static_cast<size_t>(CartridgeImageOffset), 0);
+	memcpy(header.data(), CartridgeMagic, sizeof(CartridgeMagic));
+	WriteLittleEndian(header.data() + 8, CartridgeVersion, 4);
+	WriteLittleEndian(header.data() + 12, CartridgeHeaderSize, 4);
+	WriteLittleEndian(header.data() + 16, CartridgeImageOffset, 8);
+	WriteLittleEndian(header.data() + 24, MemorySize, 4);
+	WriteLittleEndian(header.data() + 28, romAddress, 2);
+	WriteLittleEndian(header.data() + 32, romSize, 4);
+	WriteLittleEndian(header.data() + 36, bankSize, 4);
+	WriteLittleEndian(header.data() + 40, HashImage(banks, bankSize, HashImage(image, MemorySize)), 8);
+
+	std::ofstream file(filePath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+	file.write(reinterpret_cast<const char*>(image), MemorySize);
+	if (bankSize != 0) {
+		file.write(reinterpret_cast<const char*>(banks), bankSize);
+	}
+	file.close();
+	if (file.fail()) {
+		throw EZ::Error("Failed to write the cartridge file.");
+	}
+}
+Tiny::Cartridge::~Cartridge() {
+	delete _file;
+	_file = nullptr;
+}
+
+const BYTE* Tiny::Cartridge::GetImage() const {
+	return _file->GetData() + CartridgeImageOffset;
+}
+UINT16 Tiny::Cartridge::GetRomAddress() const {
+	return _romAddress;
+}
+UINT32 Tiny::Cartridge::GetRomSize() const {
+	return _romSize;
+}
+const BYTE* Tiny::Cartridge::GetBanks() const {
+	return _bankSize != 0 ? GetImage() + MemorySize : nullptr;
+}
+UINT32 Tiny::Cartridge::GetBankSize() const {
+	return _bankSize;
+}
+UINT64 Tiny::Cartridge::GetContentHash() const {
+	return _contentHash;
+}
\ No newline at end of file
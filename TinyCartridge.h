@@ -0,0 +1,53 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZMappedFile.h"
+#include "TinyMachine.h"
+
+namespace Tiny {
+	// Written into every cartridge file. Bump it whenever the layout or meaning of anything in the file changes
+	// so old files are refused instead of being run wrong.
+	constexpr UINT32 CartridgeVersion = 2;
+	// The image is the whole MemorySize address space as it is when the machine is reset. It starts this far into the
+	// file so it can be mapped on its own on every platform.
+	constexpr UINT64 CartridgeImageOffset = EZ::MappingAlignment;
+	// A program and its data packaged as the initial contents of memory. The file is mapped read only once and every
+	// machine created with it gets its memory as a copy on write view of the image, so nothing is copied at startup
+	// and pages a machine never writes stay shared with the file cache and every other machine running the cartridge.
+	// Only the pages a machine writes cost it memory of its own.
+	// Programs bigger than memory put the rest in banks after the image, which a Tiny::Mapper switches in straight
+	// from the read only mapping so they never cost any machine memory either.
+	class Cartridge {
+	public:
+		// Maps filePath and checks its header and content hash. Throws an EZ::Error if the file is from a different
+		// CartridgeVersion or is corrupt.
+		Cartridge(LPCSTR filePath);
+		// Returns a new copy on write view of the image, MemorySize bytes long. Writes to it only change this view.
+		// Tiny::Machine calls this when MachineSettings::Cartridge is set so there is rarely a reason to call it directly.
+		BYTE* MapMemory() const;
+		// Gives back memory returned by MapMemory.
+		static void UnmapMemory(BYTE* memory);
+		// Writes a cartridge file whose image is MemorySize bytes copied from image. romAddress and romSize mark the
+		// code and constant data, which must stay the same for every machine running the cartridge.
+		// bankSize bytes of banks are stored after the image for a Tiny::Mapper to switch in.
+		// Throws an EZ::Error if the ROM region is outside memory or the file can't be written.
+		static void Save(LPCSTR filePath, const BYTE* image, UINT16 romAddress, UINT32 romSize, const BYTE* banks = nullptr, UINT32 bankSize = 0);
+		~Cartridge();
+
+		const BYTE* GetImage() const;
+		UINT16 GetRomAddress() const;
+		UINT32 GetRomSize() const;
+		// Returns the banks stored after the image, read only, or nullptr if there are none.
+		// Pass them to MapperSettings::Rom. They stay valid until the cartridge is destroyed.
+		const BYTE* GetBanks() const;
+		UINT32 GetBankSize() const;
+		// Returns the 64 bit FNV-1a hash of the image followed by the banks. Machines started from cartridges with equal hashes start equal.
+		UINT64 GetContentHash() const;
+
+	private:
+		EZ::MappedFile* _file;
+		UINT16 _romAddress;
+		UINT32 _romSize;
+		UINT32 _bankSize;
+		UINT64 _contentHash;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,607 @@
+#include "TinyCpu.h"
+#include <algorithm>
+
+// GCC and Clang support taking the address of a label which lets every handler jump straight to the next handler.
+// That gives the branch predictor one indirect jump per handler to learn instead of one shared jump for the switch.
+// MSVC has no equivalent so it falls back to a switch in a loop.
+#if defined(__GNUC__)
+#define TINY_THREADED_DISPATCH 1
+#endif
+
+namespace {
+	struct OpcodeInfo {
+		// Size of the instruction in bytes including the opcode.
+		BYTE Length;
+		// One cycle per byte fetched plus one per byte of memory read or written.
+		BYTE Cycles;
+	};
+	// Indexed by Opcode. The last two entries are for UndecodedOp and IllegalOp.
+	constexpr OpcodeInfo OpcodeInfos[Tiny::OpcodeCount + 2] = {
+		{ 1, 1 }, { 1, 1 }, { 1, 1 }, // NOP, HALT, WAIT
+		{ 2, 2 }, { 3, 4 }, { 3, 4 }, // LDA #imm, abs, abs,X
+		{ 2, 2 }, { 3, 4 }, // LDX #imm, abs
+		{ 2, 2 }, { 3, 4 }, // LDY #imm, abs
+		{ 3, 4 }, { 3, 4 }, { 3, 4 }, { 3, 4 }, // STA abs, STA abs,X, STX abs, STY abs
+		{ 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, // TAX, TXA, TAY, TYA
+		{ 2, 2 }, { 3, 4 }, { 2, 2 }, { 3, 4 }, // ADD #imm, abs, SUB #imm, abs
+		{ 2, 2 }, { 2, 2 }, { 2, 2 }, // AND, OR, XOR
+		{ 1, 1 }, { 1, 1 }, // SHL, SHR
+		{ 2, 2 }, { 3, 4 }, { 2, 2 }, { 2, 2 }, // CMP #imm, abs, CPX, CPY
+		{ 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 }, // INX, DEX, INY, DEY
+		{ 3, 5 }, { 3, 5 }, // INC abs, DEC abs
+		{ 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, { 3, 3 }, // JMP, JZ, JNZ, JC, JNC
+		{ 3, 5 }, { 1, 3 }, { 1, 2 }, { 1, 2 }, // JSR, RTS, PHA, PLA
+		{ 3, 4 }, { 3, 4 }, // LDA abs,Y, STA abs,Y
+		{ 1, 0 }, { 1, 1 }, // Undecoded, Illegal
+	};
+}
+
+Tiny::Cpu::Cpu() {
+	for (UINT32 page = 0; page < BusPageCount; page++) {
+		_cachePages[page] = GetUndecodedPage();
+		_cacheMemory[page] = nullptr;
+	}
+	_uncached = { 0, UndecodedOp, 0 };
+	_syncedBus = nullptr;
+	_syncedGeneration = 0;
+	_registers = { };
+	_registers.SP = StackTop;
+	_running = FALSE;
+	_cycleDebt = 0;
+	_stats = { };
+}
+void Tiny::Cpu::Reset(const Tiny::MemoryBus& bus) {
+	_registers = { };
+	_registers.PC = static_cast<UINT16>(bus.Read(ResetVectorAddress) | (bus.Read(ResetVectorAddress + 1) << 8));
+	_registers.SP = StackTop;
+	_running = TRUE;
+	_cycleDebt = 0;
+}
+Tiny::Cpu::DecodedInstruction* Tiny::Cpu::Decode(const Tiny::MemoryBus& bus, UINT16 address) {
+	BYTE op = bus.Read(address);
+	if (op >= OpcodeCount) {
+		op = IllegalOp;
+	}
+	UINT16 operand = 0;
+	if (OpcodeInfos[op].Length == 2) {
+		operand = bus.Read(static_cast<UINT16>(address + 1));
+	}
+	else if (OpcodeInfos[op].Length == 3) {
+		operand = static_cast<UINT16>(bus.Read(static_cast<UINT16>(address + 1)) | (bus.Read(static_cast<UINT16>(address + 2)) << 8));
+	}
+	_stats.Decodes++;
+	UINT32 offset = address % BusPageSize;
+	if (offset + OpcodeInfos[op].Length > BusPageSize) {
+		_uncached = { operand, op, OpcodeInfos[op].Cycles };
+		return &_uncached;
+	}
+	DecodedInstruction*& page = _cachePages[address / BusPageSize];
+	if (page == GetUndecodedPage()) {
+		page = new DecodedInstruction[BusPageSize];
+		for (UINT32 i = 0; i < BusPageSize; i++) {
+			page[i] = { 0, UndecodedOp, 0 };
+		}
+		_decodedPages[_cacheMemory[address / BusPageSize]] = page;
+	}
+	page[offset] = { operand, op, OpcodeInfos[op].Cycles };
+	return &page[offset];
+}
+void Tiny::Cpu::SyncPages(const Tiny::MemoryBus& bus) {
+	for (UINT32 page = 0; page < BusPageCount; page++) {
+		const BYTE* memory = bus.GetPageMemory(page);
+		if (memory != _cacheMemory[page]) {
+			std::unordered_map<const BYTE*, DecodedInstruction*>::iterator found = _decodedPages.find(memory);
+			_cachePages[page] = found != _decodedPages.end() ? found->second : GetUndecodedPage();
+			_cacheMemory[page] = memory;
+		}
+	}
+	_syncedBus = &bus;
+	_syncedGeneration = bus.GetMappingGeneration();
+}
+void Tiny::Cpu::InvalidateBytes(DecodedInstruction* page, UINT32 first, UINT32 end) {
+	// Instructions are at most 3 bytes and never run across pages so only records of this page starting at most
+	// 2 bytes before first can cover it.
+	for (UINT32 offset = first < 2 ? 0 : first - 2; offset < end; offset++) {
+		DecodedInstruction& entry = page[offset];
+		if (entry.Op != UndecodedOp && offset + OpcodeInfos[entry.Op].Length > first) {
+			entry = { 0, UndecodedOp, 0 };
+			_stats.Invalidations++;
+		}
+	}
+}
+Tiny::Cpu::DecodedInstruction* Tiny::Cpu::GetUndecodedPage() {
+	static DecodedInstruction* undecodedPage = []() {
+		DecodedInstruction* page = new DecodedInstruction[BusPageSize];
+		for (UINT32 i = 0; i < BusPageSize; i++) {
+			page[i] = { 0, UndecodedOp, 0 };
+		}
+		return page;
+	}();
+	return undecodedPage;
+}
+UINT32 Tiny::Cpu::Run(Tiny::MemoryBus& bus, UINT64* dirtyPages, UINT32 cycleBudget) {
+	if (!_running) {
+		return 0;
+	}
+	if (_cycleDebt >= cycleBudget) {
+		_cycleDebt -= cycleBudget;
+		return 0;
+	}
+	if (&bus != _syncedBus || bus.GetMappingGeneration() != _syncedGeneration) {
+		SyncPages(bus);
+	}
+	UINT32 budget = cycleBudget - _cycleDebt;
+	UINT32 cycles = 0;
+	UINT64 instructions = 0;
+
+	// Keep the registers in locals so the compiler can hold them in host registers.
+	UINT16 pc = _registers.PC;
+	BYTE a = _registers.A;
+	BYTE x = _registers.X;
+	BYTE y = _registers.Y;
+	BYTE sp = _registers.SP;
+	BOOL zero = _registers.Zero;
+	BOOL carry = _registers.Carry;
+	const DecodedInstruction* instruction = nullptr;
+	BYTE value = 0;
+
+	// A changed byte marks its page dirty for the renderers and throws away any decoded instruction covering it.
+	// Instructions are at most 3 bytes and never run across pages so only the entries starting at address and the
+	// 2 bytes before it on the same page can cover it. Writes to MMIO addresses never change memory so they skip both.
+	// Any store can be to a bank select register, so the pages are synced again whenever the bus mapping changed.
+#define TINY_INVALIDATE(target) \
+	{ \
+		dirtyPages[(target) >> 14] |= 1ull << (((target) >> 8) & 63); \
+		DecodedInstruction* page = _cachePages[(target) / BusPageSize]; \
+		UINT32 offset = (target) % BusPageSize; \
+		for (UINT32 back = 0; back < 3 && back <= offset; back++) { \
+			DecodedInstruction& entry = page[offset - back]; \
+			if (entry.Op != UndecodedOp && OpcodeInfos[entry.Op].Length > back) { \
+				entry = { 0, UndecodedOp, 0 }; \
+				_stats.Invalidations++; \
+			} \
+		} \
+	}
+#define TINY_STORE(storeAddress, storeValue) \
+	{ \
+		UINT16 target = (storeAddress); \
+		if (bus.Write(target, (storeValue))) { \
+			TINY_INVALIDATE(target); \
+		} \
+		if (bus.GetMappingGeneration() != _syncedGeneration) { \
+			SyncPages(bus); \
+		} \
+	}
+	// The stack is always plain memory in the register page, which can't be remapped, so it skips the bus.
+#define TINY_PUSH(pushValue) \
+	{ \
+		BYTE pushed = (pushValue); \
+		BYTE* stack = bus.GetMemory(); \
+		if (stack[sp] != pushed) { \
+			stack[sp] = pushed; \
+			TINY_INVALIDATE(sp); \
+		} \
+	} \
+	sp = static_cast<BYTE>(StackBottomAddress | ((sp - 1) & 0x7F));
+#define TINY_POP(popTarget) \
+	sp = static_cast<BYTE>(StackBottomAddress | ((sp + 1) & 0x7F)); \
+	popTarget = bus.GetMemory()[sp];
+#define TINY_FETCH() \
+	if (cycles >= budget) { \
+		goto OutOfCycles; \
+	} \
+	instruction = &_cachePages[pc / BusPageSize][pc % BusPageSize]; \
+	cycles += instruction->Cycles; \
+	instructions++;
+#define TINY_OPERAND instruction->Operand
+
+#ifdef TINY_THREADED_DISPATCH
+	// Must list a label for every Opcode in order followed by UndecodedOp and IllegalOp.
+	static const void* const dispatchTable[OpcodeCount + 2] = {
+		&&Op_NOP, &&Op_HALT, &&Op_WAIT,
+		&&Op_LDA_IMM, &&Op_LDA_ABS, &&Op_LDA_ABSX,
+		&&Op_LDX_IMM, &&Op_LDX_ABS,
+		&&Op_LDY_IMM, &&Op_LDY_ABS,
+		&&Op_STA_ABS, &&Op_STA_ABSX, &&Op_STX_ABS, &&Op_STY_ABS,
+		&&Op_TAX, &&Op_TXA, &&Op_TAY, &&Op_TYA,
+		&&Op_ADD_IMM, &&Op_ADD_ABS, &&Op_SUB_IMM, &&Op_SUB_ABS,
+		&&Op_AND_IMM, &&Op_OR_IMM, &&Op_XOR_IMM,
+		&&Op_SHL, &&Op_SHR,
+		&&Op_CMP_IMM, &&Op_CMP_ABS, &&Op_CPX_IMM, &&Op_CPY_IMM,
+		&&Op_INX, &&Op_DEX, &&Op_INY, &&Op_DEY,
+		&&Op_INC_ABS, &&Op_DEC_ABS,
+		&&Op_JMP, &&Op_JZ, &&Op_JNZ, &&Op_JC, &&Op_JNC,
+		&&Op_JSR, &&Op_RTS, &&Op_PHA, &&Op_PLA,
+		&&Op_LDA_ABSY, &&Op_STA_ABSY,
+		&&Op_Undecoded, &&Op_Illegal,
+	};
+#define TINY_DISPATCH() goto *dispatchTable[instruction->Op]
+#define TINY_OP(name) Op_##name:
+#define TINY_UNDECODED_OP() Op_Undecoded:
+#define TINY_ILLEGAL_OP() Op_Illegal:
+#else
+#define TINY_DISPATCH() goto Dispatch
+#define TINY_OP(name) case static_cast<BYTE>(Tiny::Opcode::name):
+#define TINY_UNDECODED_OP() case UndecodedOp:
+#define TINY_ILLEGAL_OP() default:
+#endif
+#define TINY_NEXT(length) \
+	pc = static_cast<UINT16>(pc + (length)); \
+	TINY_FETCH(); \
+	TINY_DISPATCH();
+
+	TINY_FETCH();
+#ifdef TINY_THREADED_DISPATCH
+	TINY_DISPATCH();
+	{
+#else
+Dispatch:
+	switch (instruction->Op) {
+#endif
+	TINY_UNDECODED_OP() {
+		// First time running this address since it was last written. Decode it and run it for real.
+		// The fetch already counted the instruction but charged 0 cycles for it.
+		instruction = Decode(bus, pc);
+		cycles += instruction->Cycles;
+		TINY_DISPATCH();
+	}
+	TINY_ILLEGAL_OP() {
+		_running = FALSE;
+		goto Stopped;
+	}
+	TINY_OP(HALT) {
+		_running = FALSE;
+		goto Stopped;
+	}
+	TINY_OP(WAIT) {
+		pc = static_cast<UINT16>(pc + 1);
+		goto Stopped;
+	}
+	TINY_OP(NOP) {
+		TINY_NEXT(1);
+	}
+	TINY_OP(LDA_IMM) {
+		a = static_cast<BYTE>(TINY_OPERAND);
+		zero = a == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(LDA_ABS) {
+		a = bus.Read(TINY_OPERAND);
+		zero = a == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(LDA_ABSX) {
+		a = bus.Read(static_cast<UINT16>(TINY_OPERAND + x));
+		zero = a == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(LDA_ABSY) {
+		a = bus.Read(static_cast<UINT16>(TINY_OPERAND + y));
+		zero = a == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(LDX_IMM) {
+		x = static_cast<BYTE>(TINY_OPERAND);
+		zero = x == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(LDX_ABS) {
+		x = bus.Read(TINY_OPERAND);
+		zero = x == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(LDY_IMM) {
+		y = static_cast<BYTE>(TINY_OPERAND);
+		zero = y == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(LDY_ABS) {
+		y = bus.Read(TINY_OPERAND);
+		zero = y == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(STA_ABS) {
+		TINY_STORE(TINY_OPERAND, a);
+		TINY_NEXT(3);
+	}
+	TINY_OP(STA_ABSX) {
+		TINY_STORE(static_cast<UINT16>(TINY_OPERAND + x), a);
+		TINY_NEXT(3);
+	}
+	TINY_OP(STA_ABSY) {
+		TINY_STORE(static_cast<UINT16>(TINY_OPERAND + y), a);
+		TINY_NEXT(3);
+	}
+	TINY_OP(STX_ABS) {
+		TINY_STORE(TINY_OPERAND, x);
+		TINY_NEXT(3);
+	}
+	TINY_OP(STY_ABS) {
+		TINY_STORE(TINY_OPERAND, y);
+		TINY_NEXT(3);
+	}
+	TINY_OP(TAX) {
+		x = a;
+		zero = x == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(TXA) {
+		a = x;
+		zero = a == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(TAY) {
+		y = a;
+		zero = y == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(TYA) {
+		a = y;
+		zero = a == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(ADD_IMM) {
+		value = static_cast<BYTE>(TINY_OPERAND);
+		carry = (a + value) > 0xFF;
+		a = static_cast<BYTE>(a + value);
+		zero = a == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(ADD_ABS) {
+		value = bus.Read(TINY_OPERAND);
+		carry = (a + value) > 0xFF;
+		a = static_cast<BYTE>(a + value);
+		zero = a == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(SUB_IMM) {
+		value = static_cast<BYTE>(TINY_OPERAND);
+		carry = a >= value;
+		a = static_cast<BYTE>(a - value);
+		zero = a == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(SUB_ABS) {
+		value = bus.Read(TINY_OPERAND);
+		carry = a >= value;
+		a = static_cast<BYTE>(a - value);
+		zero = a == 0;
+		TINY_NEXT(3);
+	}
+	TINY_OP(AND_IMM) {
+		a = static_cast<BYTE>(a & TINY_OPERAND);
+		zero = a == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(OR_IMM) {
+		a = static_cast<BYTE>(a | TINY_OPERAND);
+		zero = a == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(XOR_IMM) {
+		a = static_cast<BYTE>(a ^ TINY_OPERAND);
+		zero = a == 0;
+		TINY_NEXT(2);
+	}
+	TINY_OP(SHL) {
+		carry = a >> 7;
+		a = static_cast<BYTE>(a << 1);
+		zero = a == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(SHR) {
+		carry = a & 1;
+		a = static_cast<BYTE>(a >> 1);
+		zero = a == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(CMP_IMM) {
+		value = static_cast<BYTE>(TINY_OPERAND);
+		zero = a == value;
+		carry = a >= value;
+		TINY_NEXT(2);
+	}
+	TINY_OP(CMP_ABS) {
+		value = bus.Read(TINY_OPERAND);
+		zero = a == value;
+		carry = a >= value;
+		TINY_NEXT(3);
+	}
+	TINY_OP(CPX_IMM) {
+		value = static_cast<BYTE>(TINY_OPERAND);
+		zero = x == value;
+		carry = x >= value;
+		TINY_NEXT(2);
+	}
+	TINY_OP(CPY_IMM) {
+		value = static_cast<BYTE>(TINY_OPERAND);
+		zero = y == value;
+		carry = y >= value;
+		TINY_NEXT(2);
+	}
+	TINY_OP(INX) {
+		x++;
+		zero = x == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(DEX) {
+		x--;
+		zero = x == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(INY) {
+		y++;
+		zero = y == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(DEY) {
+		y--;
+		zero = y == 0;
+		TINY_NEXT(1);
+	}
+	TINY_OP(INC_ABS) {
+		value = static_cast<BYTE>(bus.Read(TINY_OPERAND) + 1);
+		zero = value == 0;
+		TINY_STORE(TINY_OPERAND, value);
+		TINY_NEXT(3);
+	}
+	TINY_OP(DEC_ABS) {
+		value = static_cast<BYTE>(bus.Read(TINY_OPERAND) - 1);
+		zero = value == 0;
+		TINY_STORE(TINY_OPERAND, value);
+		TINY_NEXT(3);
+	}
+	TINY_OP(JMP) {
+		pc = TINY_OPERAND;
+		TINY_NEXT(0);
+	}
+	TINY_OP(JZ) {
+		if (zero) {
+			pc = TINY_OPERAND;
+			TINY_NEXT(0);
+		}
+		TINY_NEXT(3);
+	}
+	TINY_OP(JNZ) {
+		if (!zero) {
+			pc = TINY_OPERAND;
+			TINY_NEXT(0);
+		}
+		TINY_NEXT(3);
+	}
+	TINY_OP(JC) {
+		if (carry) {
+			pc = TINY_OPERAND;
+			TINY_NEXT(0);
+		}
+		TINY_NEXT(3);
+	}
+	TINY_OP(JNC) {
+		if (!carry) {
+			pc = TINY_OPERAND;
+			TINY_NEXT(0);
+		}
+		TINY_NEXT(3);
+	}
+	TINY_OP(JSR) {
+		// Read the target first because the pushes could overwrite this very instruction.
+		// Push the return address high byte first so RTS pops it low byte first.
+		UINT16 jumpTarget = TINY_OPERAND;
+		UINT16 returnAddress = static_cast<UINT16>(pc + 3);
+		TINY_PUSH(static_cast<BYTE>(returnAddress >> 8));
+		TINY_PUSH(static_cast<BYTE>(returnAddress));
+		pc = jumpTarget;
+		TINY_NEXT(0);
+	}
+	TINY_OP(RTS) {
+		BYTE low;
+		BYTE high;
+		TINY_POP(low);
+		TINY_POP(high);
+		pc = static_cast<UINT16>(low | (high << 8));
+		TINY_NEXT(0);
+	}
+	TINY_OP(PHA) {
+		TINY_PUSH(a);
+		TINY_NEXT(1);
+	}
+	TINY_OP(PLA) {
+		TINY_POP(a);
+		zero = a == 0;
+		TINY_NEXT(1);
+	}
+	}
+
+#undef TINY_INVALIDATE
+#undef TINY_STORE
+#undef TINY_PUSH
+#undef TINY_POP
+#undef TINY_FETCH
+#undef TINY_OPERAND
+#undef TINY_DISPATCH
+#undef TINY_OP
+#undef TINY_UNDECODED_OP
+#undef TINY_ILLEGAL_OP
+#undef TINY_NEXT
+
+OutOfCycles:
+	// The last instruction may have run past the budget. Charge the overrun to the next frame.
+	_cycleDebt = cycles - budget;
+	goto Save;
+Stopped:
+	// The CPU is idle for the rest of the frame so there is nothing to carry over.
+	_cycleDebt = 0;
+Save:
+	_registers.PC = pc;
+	_registers.A = a;
+	_registers.X = x;
+	_registers.Y = y;
+	_registers.SP = sp;
+	_registers.Zero = zero;
+	_registers.Carry = carry;
+	_stats.Instructions += instructions;
+	_stats.Cycles += cycles;
+	return cycles;
+}
+void Tiny::Cpu::Invalidate(const Tiny::MemoryBus& bus, UINT16 address, UINT32 size) {
+	if (size == 0) {
+		return;
+	}
+	if (size >= 0x10000) {
+		for (const std::pair<const BYTE* const, DecodedInstruction*>& decodedPage : _decodedPages) {
+			for (UINT32 i = 0; i < BusPageSize; i++) {
+				decodedPage.second[i] = { 0, UndecodedOp, 0 };
+			}
+		}
+		return;
+	}
+	if (&bus != _syncedBus || bus.GetMappingGeneration() != _syncedGeneration) {
+		SyncPages(bus);
+	}
+	// A page of the bus's own memory with a bank over it keeps its records for when the bank is switched out again.
+	UINT32 current = address;
+	UINT32 remaining = size;
+	while (remaining > 0) {
+		UINT32 page = (current / BusPageSize) % BusPageCount;
+		UINT32 first = current % BusPageSize;
+		UINT32 count = (std::min)(BusPageSize - first, remaining);
+		InvalidateBytes(_cachePages[page], first, first + count);
+		const BYTE* ownMemory = bus.GetMemory() + (page * BusPageSize);
+		if (_cacheMemory[page] != ownMemory) {
+			std::unordered_map<const BYTE*, DecodedInstruction*>::iterator found = _decodedPages.find(ownMemory);
+			if (found != _decodedPages.end()) {
+				InvalidateBytes(found->second, first, first + count);
+			}
+		}
+		current += count;
+		remaining -= count;
+	}
+}
+void Tiny::Cpu::Halt() {
+	_running = FALSE;
+}
+void Tiny::Cpu::SetState(const Tiny::CpuState& state) {
+	_registers = state.Registers;
+	_running = state.Running;
+	_cycleDebt = state.CycleDebt;
+}
+Tiny::Cpu::~Cpu() {
+	for (const std::pair<const BYTE* const, DecodedInstruction*>& decodedPage : _decodedPages) {
+		delete[] decodedPage.second;
+	}
+	_decodedPages.clear();
+	_running = FALSE;
+}
+
+BOOL Tiny::Cpu::IsRunning() const {
+	return _running;
+}
+Tiny::CpuRegisters Tiny::Cpu::GetRegisters() const {
+	return _registers;
+}
+Tiny::CpuStats Tiny::Cpu::GetStats() const {
+	return _stats;
+}
+Tiny::CpuState Tiny::Cpu::GetState() const {
+	return { _registers, _running, _cycleDebt };
+}
\ No newline at end of file
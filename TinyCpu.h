@@ -0,0 +1,171 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMemoryBus.h"
+#include <unordered_map>
+
+namespace Tiny {
+	// Opcodes of the guest CPU. See the CPU section of TinyEmulator.txt for what each one does.
+	// abs is a little endian 16 bit address following the opcode and #imm is a byte following the opcode.
+	// Opcodes are numbered densely so they double as indices into the dispatch table.
+	enum class Opcode : BYTE {
+		NOP = 0x00,
+		HALT = 0x01,
+		WAIT = 0x02,
+		LDA_IMM = 0x03,
+		LDA_ABS = 0x04,
+		LDA_ABSX = 0x05,
+		LDX_IMM = 0x06,
+		LDX_ABS = 0x07,
+		LDY_IMM = 0x08,
+		LDY_ABS = 0x09,
+		STA_ABS = 0x0A,
+		STA_ABSX = 0x0B,
+		STX_ABS = 0x0C,
+		STY_ABS = 0x0D,
+		TAX = 0x0E,
+		TXA = 0x0F,
+		TAY = 0x10,
+		TYA = 0x11,
+		ADD_IMM = 0x12,
+		ADD_ABS = 0x13,
+		SUB_IMM = 0x14,
+		SUB_ABS = 0x15,
+		AND_IMM = 0x16,
+		OR_IMM = 0x17,
+		XOR_IMM = 0x18,
+		SHL = 0x19,
+		SHR = 0x1A,
+		CMP_IMM = 0x1B,
+		CMP_ABS = 0x1C,
+		CPX_IMM = 0x1D,
+		CPY_IMM = 0x1E,
+		INX = 0x1F,
+		DEX = 0x20,
+		INY = 0x21,
+		DEY = 0x22,
+		INC_ABS = 0x23,
+		DEC_ABS = 0x24,
+		JMP = 0x25,
+		JZ = 0x26,
+		JNZ = 0x27,
+		JC = 0x28,
+		JNC = 0x29,
+		JSR = 0x2A,
+		RTS = 0x2B,
+		PHA = 0x2C,
+		PLA = 0x2D,
+		LDA_ABSY = 0x2E,
+		STA_ABSY = 0x2F,
+	};
+	constexpr UINT32 OpcodeCount = 0x30;
+	// Little endian address the CPU starts executing from after Reset.
+	constexpr UINT16 ResetVectorAddress = 0x0002;
+	// The stack grows down through the top half of the register page.
+	constexpr UINT16 StackBottomAddress = 0x0080;
+	constexpr BYTE StackTop = 0xFF;
+
+	struct CpuRegisters {
+		UINT16 PC;
+		BYTE A;
+		BYTE X;
+		BYTE Y;
+		// Always between StackBottomAddress and StackTop. Points at the next free byte.
+		BYTE SP;
+		// Set when the last result was 0.
+		BOOL Zero;
+		// Set on carry out of ADD or SHL, on no borrow from SUB and compares, and to the bit shifted out by SHR.
+		BOOL Carry;
+	};
+	// Everything a save state needs to resume the CPU exactly where it was.
+	// Decoded instructions aren't part of it because they are decoded again from memory.
+	struct CpuState {
+		Tiny::CpuRegisters Registers;
+		BOOL Running;
+		// Cycles the last Run spent past its budget which come out of the next Run's budget.
+		UINT32 CycleDebt;
+	};
+	struct CpuStats {
+		// Total instructions executed and cycles spent executing them.
+		UINT64 Instructions;
+		UINT64 Cycles;
+		// Number of instructions decoded. Anything above the size of the program is code which was overwritten and
+		// decoded again, or instructions running across a page boundary which are decoded every time they run.
+		UINT64 Decodes;
+		// Number of writes which landed on bytes of a decoded instruction and threw it away.
+		UINT64 Invalidations;
+	};
+	// Interprets the guest CPU described in TinyEmulator.txt.
+	// Each address is decoded once into a small fixed size record the first time it is executed and the records are
+	// dispatched with computed goto where the compiler supports it so no opcode is decoded twice in a hot loop.
+	// Every write, from the CPU or from the host through Invalidate, throws away any record covering that byte
+	// so self modifying code sees its own writes on the very next instruction.
+	// Records are kept per page of the memory the bus maps rather than per address, so when Tiny::Mapper switches a
+	// bank in the CPU only swaps which pages of records it uses and code decoded from a bank stays decoded while it
+	// is switched out. Instructions running into the next page are never kept since that page can be switched alone.
+	// The stack is read and written straight from the register page of the bus's own memory, not through the bus.
+	class Cpu {
+	public:
+		Cpu();
+		// Loads PC from ResetVectorAddress, clears the other registers and starts the CPU running.
+		void Reset(const Tiny::MemoryBus& bus);
+		// Executes instructions read through bus until at least cycleBudget cycles were spent, a WAIT instruction was
+		// executed or the CPU halted. Cycles spent past cycleBudget are taken out of the next call's budget.
+		// Every load and store goes through bus so MMIO and watched addresses behave. Every byte of memory the CPU
+		// changes is marked in dirtyPages, one bit per 256 byte page like Tiny::Machine tracks.
+		// Returns the number of cycles spent.
+		UINT32 Run(Tiny::MemoryBus& bus, UINT64* dirtyPages, UINT32 cycleBudget);
+		// Throws away every decoded instruction overlapping size bytes starting at address, both in the memory bus maps
+		// there and in the bus's own memory.
+		// This must be called whenever memory is changed by anything other than this CPU.
+		void Invalidate(const Tiny::MemoryBus& bus, UINT16 address, UINT32 size);
+		// Stops the CPU. It stays stopped until the next Reset.
+		void Halt();
+		// Puts the registers back the way GetState found them. Memory must be restored separately
+		// and anything it changed must go through Invalidate like any other write.
+		void SetState(const Tiny::CpuState& state);
+		~Cpu();
+
+		BOOL IsRunning() const;
+		Tiny::CpuRegisters GetRegisters() const;
+		Tiny::CpuStats GetStats() const;
+		Tiny::CpuState GetState() const;
+
+	private:
+		// One decoded instruction. Op is an Opcode or one of the extra values below.
+		struct DecodedInstruction {
+			UINT16 Operand;
+			BYTE Op;
+			BYTE Cycles;
+		};
+		// Marks a cache entry which must be decoded before it runs.
+		static constexpr BYTE UndecodedOp = OpcodeCount;
+		// Bytes which are not a valid opcode decode to this and halt the CPU.
+		static constexpr BYTE IllegalOp = OpcodeCount + 1;
+
+		// Decodes the instruction at address and returns where it was stored.
+		DecodedInstruction* Decode(const Tiny::MemoryBus& bus, UINT16 address);
+		// Points every page of _cachePages at the records of the memory bus maps there now.
+		void SyncPages(const Tiny::MemoryBus& bus);
+		// Throws away every record of page covering a byte from first up to end.
+		void InvalidateBytes(DecodedInstruction* page, UINT32 first, UINT32 end);
+		// Returns BusPageSize records which are all UndecodedOp, shared by every page nothing was decoded from yet.
+		// Nothing writes to it since only decoded records are ever thrown away.
+		static DecodedInstruction* GetUndecodedPage();
+
+		// The records of every page of the address space as the bus was mapped at the last SyncPages.
+		DecodedInstruction* _cachePages[BusPageCount];
+		// The memory each page of _cachePages was decoded from.
+		const BYTE* _cacheMemory[BusPageCount];
+		// Every page of records decoded so far, found by the first byte of the memory it was decoded from.
+		std::unordered_map<const BYTE*, DecodedInstruction*> _decodedPages;
+		// Where an instruction running into the next page is decoded to, since it isn't kept.
+		DecodedInstruction _uncached;
+		const Tiny::MemoryBus* _syncedBus;
+		UINT64 _syncedGeneration;
+		Tiny::CpuRegisters _registers;
+		BOOL _running;
+		// Cycles already spent from the next Run's budget.
+		UINT32 _cycleDebt;
+		Tiny::CpuStats _stats;
+	};
+}
\ No newline at end of file
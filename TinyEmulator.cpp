@@ -1,54 +1,278 @@
 #include "EZProgram.h"
 #include "EZError.h"
+#include "TinyMachine.h"
+#include "TinySaveState.h"
+#include "TinyRewind.h"
+#include "TinyMovie.h"
+#include "TinyCartridge.h"
+#include "TinyInput.h"
 #include <thread>
+#include <cstring>
 #include <iostream>
 #include <random>
+#include <algorithm>
 #include <winnt.h>
 
-BYTE emuMem[0xFFFF] = { };
+Tiny::Machine* emuMachine = NULL;
+// Set when a cartridge file is passed on the command line. The machine's memory is mapped from it.
+Tiny::Cartridge* emuCartridge = NULL;
 
-constexpr UINT32 emuScreenWidth = 256;
-constexpr UINT32 emuScreenHeight = 144;
+constexpr UINT32 emuScreenWidth = Tiny::ScreenWidth;
+constexpr UINT32 emuScreenHeight = Tiny::ScreenHeight;
 
 ID2D1Bitmap* emuScreenBitmap = NULL;
+// Render only converts the rows which changed so it needs a buffer which always holds the last frame. Frames are
+// copied from here into the program's frame pipeline, whose buffers take turns.
 BYTE emuScreenBuffer[emuScreenWidth * emuScreenHeight * 4] = { };
+// What Step publishes through the program's frame pipeline. The presenter skips frames when it falls behind, so Rows
+// holds every row changed since the last frame it drew rather than only the rows this frame changed.
+struct EmuFrame {
+	BYTE Pixels[emuScreenWidth * emuScreenHeight * 4];
+	Tiny::DirtyRows Rows;
+	UINT64 Sequence;
+};
+// The rows each of the last few published frames changed, by sequence number. Only touched by Step.
+struct EmuPublishedRows {
+	UINT64 Sequence;
+	Tiny::DirtyRows Rows;
+};
+constexpr UINT32 emuRowHistoryLength = 16;
+EmuPublishedRows emuRowHistory[emuRowHistoryLength] = { };
+// The sequence number of the frame in emuScreenBitmap. Only touched by Update on the presenter thread.
+UINT64 emuUploadedSequence = 0;
 
+// Recaptured after every step so the state from just before a crash or a quit is always at hand.
+// Only the pages a step wrote are copied so this costs a few microseconds per step.
+Tiny::SaveState* emuSaveState = NULL;
+constexpr LPCSTR emuSaveStatePath = "TinyEmulator.save";
+BOOL emuSaveKeyHeld = FALSE;
+BOOL emuLoadKeyHeld = FALSE;
+// Every step is pushed here and holding Backspace plays them back in reverse.
+Tiny::RewindBuffer* emuRewind = NULL;
+// F6 starts recording every input into emuMovie and pressing it again writes the movie to emuMoviePath.
+// TinyReplay plays the file back headless.
+Tiny::Movie* emuMovie = NULL;
+constexpr LPCSTR emuMoviePath = "TinyEmulator.movie";
+BOOL emuRecording = FALSE;
+BOOL emuRecordKeyHeld = FALSE;
+
+// Key presses and releases are pushed here on the window thread the moment they arrive and latched on the
+// thread stepping the machine, so a tap between two frames is never missed.
+Tiny::InputQueue* emuInputQueue = NULL;
+
+// Returns the Input bit key presses or 0 if it isn't one of the 8 keys.
+BYTE KeyToInput(WPARAM key) {
+	switch (key) {
+	case 'W': return Tiny::Input::Up;
+	case 'S': return Tiny::Input::Down;
+	case 'A': return Tiny::Input::Left;
+	case 'D': return Tiny::Input::Right;
+	case VK_SPACE: return Tiny::Input::Jump;
+	case 'J': return Tiny::Input::Action;
+	case 'K': return Tiny::Input::SpecialA;
+	case 'L': return Tiny::Input::SpecialB;
+	default: return 0;
+	}
+}
+
+// Runs on the window thread.
+LRESULT WndProc(EZ::Program* program, HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+	// Keys pressed or released while Alt is held come as WM_SYSKEYDOWN and WM_SYSKEYUP. They still go on to
+	// DefWindowProc so Alt shortcuts such as Alt+F4 keep working.
+	if (uMsg == WM_KEYDOWN || uMsg == WM_KEYUP || uMsg == WM_SYSKEYDOWN || uMsg == WM_SYSKEYUP) {
+		BYTE input = KeyToInput(wParam);
+		BOOL down = uMsg == WM_KEYDOWN || uMsg == WM_SYSKEYDOWN;
+		// Bit 30 of lParam is set on key downs repeated while the key is held, which change nothing.
+		BOOL repeat = down && (lParam & (1 << 30)) != 0;
+		if (input != 0 && !repeat) {
+			emuInputQueue->Push(input, down);
+		}
+	}
+	else if (uMsg == WM_KILLFOCUS) {
+		// Keys released while another window has focus are never seen.
+		emuInputQueue->ReleaseAll();
+	}
+	return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
+
+BYTE ReadKeyboard(Tiny::Machine* machine) {
+	BYTE inputs = emuInputQueue->Latch();
+	if (emuRecording) {
+		return emuMovie->RecordInput(machine, inputs);
+	}
+	return inputs;
+}
+
+void StopRecording() {
+	emuRecording = FALSE;
+	emuMovie->StopRecording(emuMachine);
+	emuMovie->Save(emuMoviePath);
+}
+// F6 starts and stops recording. Loading a save state jumps to frames the movie never saw so it ends the recording.
+// So does rewinding past where the recording started.
+void HandleMovieKeys() {
+	BOOL recordKeyDown = (GetKeyState(VK_F6) & 0x8000) != 0;
+	BOOL loadKeyDown = (GetKeyState(VK_F9) & 0x8000) != 0;
+	try {
+		if (recordKeyDown && !emuRecordKeyHeld) {
+			if (emuRecording) {
+				StopRecording();
+			}
+			else {
+				emuMovie->StartRecording(emuMachine);
+				emuRecording = TRUE;
+			}
+		}
+		if (emuRecording && loadKeyDown && !emuLoadKeyHeld) {
+			StopRecording();
+		}
+		if (emuRecording && emuMachine->GetFrameCount() < emuMovie->GetStartState().GetMachineState().FrameCount) {
+			emuRecording = FALSE;
+		}
+	}
+	catch (EZ::Error& error) {
+		error.PrintAndFree();
+	}
+	emuRecordKeyHeld = recordKeyDown;
+}
+
+// F5 writes the latest save state to emuSaveStatePath and F9 restores it from there.
+void HandleSaveStateKeys() {
+	BOOL saveKeyDown = (GetKeyState(VK_F5) & 0x8000) != 0;
+	BOOL loadKeyDown = (GetKeyState(VK_F9) & 0x8000) != 0;
+	try {
+		if (saveKeyDown && !emuSaveKeyHeld) {
+			emuSaveState->Save(emuSaveStatePath);
+		}
+		if (loadKeyDown && !emuLoadKeyHeld) {
+			emuSaveState->Load(emuSaveStatePath);
+			emuSaveState->Restore(emuMachine);
+		}
+	}
+	catch (EZ::Error& error) {
+		error.PrintAndFree();
+	}
+	emuSaveKeyHeld = saveKeyDown;
+	emuLoadKeyHeld = loadKeyDown;
+}
+
+// Returns the rows covering both a and b, where either may be empty.
+Tiny::DirtyRows UniteDirtyRows(Tiny::DirtyRows a, Tiny::DirtyRows b) {
+	if (a.Top == a.Bottom) {
+		return b;
+	}
+	if (b.Top == b.Bottom) {
+		return a;
+	}
+	return { (std::min)(a.Top, b.Top), (std::max)(a.Bottom, b.Bottom) };
+}
+
+BOOL Step(EZ::Program* program) {
+	HandleMovieKeys();
+	HandleSaveStateKeys();
+	if (GetKeyState(VK_BACK) & 0x8000) {
+		// Keep taking input while rewinding so the queue never fills and the held keys are right when it stops.
+		emuInputQueue->Latch();
+		try {
+			emuRewind->Pop(emuMachine);
+		}
+		catch (EZ::Error& error) {
+			error.PrintAndFree();
+			emuRewind->Clear();
+		}
+	}
+	else {
+		emuMachine->Step();
+		emuRewind->Push(emuMachine);
+	}
+	emuSaveState->Capture(emuMachine, emuSaveState);
+	Tiny::DirtyRows rows = emuMachine->Render(emuScreenBuffer, emuScreenWidth * 4);
+	if (rows.Top == rows.Bottom) {
+		// Nothing on screen changed so there is no need to draw or present this frame.
+		return FALSE;
+	}
+	EZ::ProfileScope scope("Publish");
+	// Several steps can run before a frame is published and they all write the same back frame, so collect every
+	// row any of them changed under the sequence number it will be published with.
+	UINT64 sequence = program->GetPipelineStats().FramesPublished + 1;
+	EmuPublishedRows& published = emuRowHistory[sequence % emuRowHistoryLength];
+	if (published.Sequence != sequence) {
+		published.Sequence = sequence;
+		published.Rows = Tiny::NoDirtyRows;
+	}
+	published.Rows = UniteDirtyRows(published.Rows, rows);
+
+	// Then merge in the rows of every frame after the one on screen, since the presenter may skip any of them.
+	// Reading the presented frame while the presenter moves on only sends more rows than needed, never fewer.
+	UINT64 presented = program->GetPresentedSequence();
+	EmuFrame* frame = reinterpret_cast<EmuFrame*>(program->GetBackFrame());
+	frame->Rows = Tiny::AllDirtyRows;
+	if (sequence - presented <= emuRowHistoryLength) {
+		frame->Rows = Tiny::NoDirtyRows;
+		for (UINT64 i = presented + 1; i <= sequence; i++) {
+			frame->Rows = UniteDirtyRows(frame->Rows, emuRowHistory[i % emuRowHistoryLength].Rows);
+		}
+	}
+	frame->Sequence = sequence;
+	memcpy(frame->Pixels, emuScreenBuffer, sizeof(emuScreenBuffer));
+	return TRUE;
+}
+
+// Runs on the program's presenter thread while the next frame is stepped.
 void Update(EZ::Program* program) {
-	// Set Inputs
-	emuMem[0] = 0;
-	if (GetKeyState('W') & 0x8000) { emuMem[0] |= 1 << 0; }
-	if (GetKeyState('S') & 0x8000) { emuMem[0] |= 1 << 1; }
-	if (GetKeyState('A') & 0x8000) { emuMem[0] |= 1 << 2; }
-	if (GetKeyState('D') & 0x8000) { emuMem[0] |= 1 << 3; }
-	if (GetKeyState(VK_SPACE) & 0x8000) { emuMem[0] |= 1 << 4; }
-	if (GetKeyState('J') & 0x8000) { emuMem[0] |= 1 << 5; }
-	if (GetKeyState('K') & 0x8000) { emuMem[0] |= 1 << 6; }
-	if (GetKeyState('L') & 0x8000) { emuMem[0] |= 1 << 7; }
-
-	// Copy and convert from R8G8B8 in emuMem to B8G8R8A8 in emuScreenBuffer
-	BYTE* emuMemPtr = emuMem;
-	BYTE* emuScreenBufferPtr = emuScreenBuffer;
-	for (UINT32 i = 0; i < emuScreenWidth * emuScreenHeight; i++) {
-		emuScreenBufferPtr[0] = emuMemPtr[0]; // Copy B
-		emuScreenBufferPtr[1] = emuMemPtr[0]; // Copy G
-		emuScreenBufferPtr[2] = emuMemPtr[0]; // Copy R
-		emuScreenBufferPtr[3] = 0xFF; // Set A to 0xFF
-		// Move Ptrs into position for next pixel.
-		emuMemPtr += 1;
-		emuScreenBufferPtr += 4;
-	}
-
-	// Send emuScreenBuffer to the GPU and draw to the screen with emuScreenBitmap.
-	D2D1_SIZE_U rendererSize = program->GetRenderer()->GetSize();
-	D2D1_RECT_L rendererRect = EZ::RectL(0, 0, rendererSize.width, rendererSize.height);
+	const EmuFrame* frame = reinterpret_cast<const EmuFrame*>(program->GetFrontFrame());
+	// Only send the rows which changed since the frame on screen unless the window lost its contents or the same frame
+	// is drawn again for a redraw.
+	Tiny::DirtyRows rows = frame->Rows;
+	if (program->NeedsFullRedraw() || frame->Sequence == emuUploadedSequence) {
+		rows = Tiny::AllDirtyRows;
+	}
+	emuUploadedSequence = frame->Sequence;
+	UINT32 rowCount = rows.Bottom - rows.Top;
+
+	// Send the changed rows of the frame to the GPU.
+	{
+		EZ::ProfileScope scope("Upload");
+		D2D1_RECT_U rect = D2D1::RectU(0, rows.Top, emuScreenWidth, rows.Bottom);
+		emuScreenBitmap->CopyFromMemory(&rect, frame->Pixels + (rows.Top * emuScreenWidth * 4), emuScreenWidth * 4);
+	}
 
-	D2D1_RECT_U rect = D2D1::RectU(0, 0, emuScreenWidth, emuScreenHeight);
-	emuScreenBitmap->CopyFromMemory(&rect, emuScreenBuffer, 256 * 4);
+	// Draw the same rows of emuScreenBitmap to the screen. EZ rects count y up from the bottom.
+	D2D1_SIZE_U rendererSize = program->GetRenderer()->GetSize();
+	INT32 destinationTop = static_cast<INT32>((rows.Top * rendererSize.height) / emuScreenHeight);
+	INT32 destinationBottom = static_cast<INT32>((rows.Bottom * rendererSize.height) / emuScreenHeight);
+	D2D1_RECT_L sourceRect = EZ::RectL(0, emuScreenHeight - rows.Bottom, emuScreenWidth, rowCount);
+	D2D1_RECT_L rendererRect = EZ::RectL(0, rendererSize.height - destinationBottom, rendererSize.width, destinationBottom - destinationTop);
 
-	program->GetRenderer()->DrawBitmap(emuScreenBitmap, rendererRect);
+	EZ::ProfileScope scope("Draw");
+	program->GetRenderer()->DrawBitmap(emuScreenBitmap, sourceRect, rendererRect);
 }
 
-int main() {
+// Usage: TinyEmulator [cartridge]
+int main(int argc, char** argv) {
+	Tiny::MachineSettings machineSettings = { };
+	machineSettings.InputCallback = ReadKeyboard;
+	if (argc > 1) {
+		try {
+			emuCartridge = new Tiny::Cartridge(argv[1]);
+		}
+		catch (EZ::Error& error) {
+			error.PrintAndFree();
+			return 1;
+		}
+		machineSettings.Cartridge = emuCartridge;
+	}
+
+	emuMachine = new Tiny::Machine(machineSettings);
+	if (emuCartridge != NULL) {
+		emuMachine->Reset();
+	}
+	emuSaveState = new Tiny::SaveState();
+	emuSaveState->Capture(emuMachine);
+	emuRewind = new Tiny::RewindBuffer({ });
+	emuMovie = new Tiny::Movie();
+	emuInputQueue = new Tiny::InputQueue({ });
+
 	EZ::ClassSettings classSettings = { };
 	classSettings.ThisThreadOnly = TRUE;
 
@@ -61,7 +285,14 @@ int main() {
 
 	EZ::ProgramSettings programSettings = { };
 	programSettings.PreformanceLogInterval = 1000;
+	// The machine runs at a steady 60 steps per second and frames are only drawn when a step changed something.
+	programSettings.MaximumFramerate = 60;
+	programSettings.StepRate = 60;
+	programSettings.StepCallback = Step;
 	programSettings.UpdateCallback = Update;
+	programSettings.WndProcCallback = WndProc;
+	// Frames are drawn and presented on a thread of their own so a present waiting for vsync never delays a step.
+	programSettings.PipelineFrameBytes = sizeof(EmuFrame);
 
 	EZ::Program* program = new EZ::Program(programSettings, classSettings, windowSettings, rendererSettings);
 
@@ -75,13 +306,28 @@ int main() {
 	bitmapProperties.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
 	bitmapProperties.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
 
-	D2D1_SIZE_U bitmapSize = D2D1::SizeU(256, 144);
+	D2D1_SIZE_U bitmapSize = D2D1::SizeU(emuScreenWidth, emuScreenHeight);
 
 	EZ::Error::ThrowFromHR(renderer->GiveMePlz()->CreateBitmap(bitmapSize, nullptr, 0, &bitmapProperties, &emuScreenBitmap));
 
 	program->Run();
 
+	EZ::FramePipelineStats pipelineStats = program->GetPipelineStats();
+	std::cout << "Frames published: " << pipelineStats.FramesPublished << " presented: " << pipelineStats.FramesPresented;
+	std::cout << " skipped: " << pipelineStats.FramesSkipped << std::endl;
+	Tiny::InputStats inputStats = emuInputQueue->GetStats();
+	if (inputStats.EventsLatched != 0) {
+		std::cout << "Input latency mean: " << ((inputStats.TotalLatencyNanoseconds / inputStats.EventsLatched) / 1000) << "us";
+		std::cout << " max: " << (inputStats.MaxLatencyNanoseconds / 1000) << "us events dropped: " << inputStats.EventsDropped << std::endl;
+	}
+
 	delete program;
+	delete emuInputQueue;
+	delete emuMovie;
+	delete emuRewind;
+	delete emuSaveState;
+	delete emuMachine;
+	delete emuCartridge;
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "TinyInput.h"
+#include "EZError.h"
+
+// Events Latch copies out of the ring at a time.
+constexpr UINT32 InputLatchBatch = 32;
+
+Tiny::InputQueue::InputQueue(Tiny::InputQueueSettings settings) {
+	_settings = settings;
+	if (_settings.Clock.Now == nullptr) {
+		_settings.Clock = EZ::GetSystemClock();
+	}
+	if (_settings.Capacity == 0) {
+		_settings.Capacity = DefaultInputQueueEvents;
+	}
+	_ring = new EZ::SpscRing<Tiny::InputEvent>(_settings.Capacity);
+	_held = 0;
+	_eventsPushed.store(0);
+	_eventsDropped.store(0);
+	_eventsLatched = 0;
+	_totalLatencyNanoseconds = 0;
+	_maxLatencyNanoseconds = 0;
+}
+BOOL Tiny::InputQueue::Push(BYTE buttons, BOOL down) {
+	Tiny::InputEvent event = { };
+	event.Timestamp = _settings.Clock.Now(_settings.Clock.Context);
+	event.Buttons = buttons;
+	event.Down = down;
+	_eventsPushed.store(_eventsPushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (_ring->Push(&event, 1) == 0) {
+		_eventsDropped.store(_eventsDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return FALSE;
+	}
+	return TRUE;
+}
+BYTE Tiny::InputQueue::Latch() {
+	UINT64 now = _settings.Clock.Now(_settings.Clock.Context);
+	BYTE pressed = 0;
+	Tiny::InputEvent events[InputLatchBatch];
+	while (TRUE) {
+		UINT32 count = _ring->Pop(events, InputLatchBatch);
+		for (UINT32 i = 0; i < count; i++) {
+			if (events[i].Down) {
+				_held |= events[i].Buttons;
+				pressed |= events[i].Buttons;
+			}
+			else {
+				_held &= ~events[i].Buttons;
+			}
+			// An event pushed after now was read is counted as not having waited at all.
+			UINT64 latency = now > events[i].Timestamp ? now - events[i].Timestamp : 0;
+			_totalLatencyNanoseconds += latency;
+			_maxLatencyNanoseconds = latency > _maxLatencyNanoseconds ? latency : _maxLatencyNanoseconds;
+		}
+		_eventsLatched += count;
+		if (count < InputLatchBatch) {
+			break;
+		}
+	}
+	return static_cast<BYTE>(_held | pressed);
+}
+BOOL Tiny::InputQueue::ReleaseAll() {
+	return Push(0xFF, FALSE);
+}
+Tiny::InputQueue::~InputQueue() {
+	delete _ring;
+	_ring = nullptr;
+}
+
+BYTE Tiny::InputQueue::GetHeld() const {
+	return _held;
+}
+Tiny::InputStats Tiny::InputQueue::GetStats() const {
+	return { _eventsPushed.load(), _eventsDropped.load(), _eventsLatched, _totalLatencyNanoseconds, _maxLatencyNanoseconds };
+}
+Tiny::InputQueueSettings Tiny::InputQueue::GetSettings() const {
+	return _settings;
+}
+
+Tiny::InputScript::InputScript(const Tiny::InputScriptEvent* events, UINT32 count) {
+	for (UINT32 i = 1; i < count; i++) {
+		if (events[i].Frame < events[i - 1].Frame) {
+			throw EZ::Error("InputScript events must be in order of Frame.");
+		}
+	}
+	_events.assign(events, events + count);
+	_next = 0;
+}
+UINT32 Tiny::InputScript::Feed(Tiny::InputQueue* queue, UINT64 frame) {
+	UINT32 pushed = 0;
+	while (_next < _events.size() && _events[_next].Frame <= frame) {
+		// A full queue keeps the rest for the next Feed rather than losing them.
+		if (!queue->Push(_events[_next].Buttons, _events[_next].Down)) {
+			break;
+		}
+		_next++;
+		pushed++;
+	}
+	return pushed;
+}
+void Tiny::InputScript::Rewind() {
+	_next = 0;
+}
+
+BOOL Tiny::InputScript::IsFinished() const {
+	return _next == _events.size();
+}
+UINT32 Tiny::InputScript::GetEventCount() const {
+	return static_cast<UINT32>(_events.size());
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZClock.h"
+#include "EZSpscRing.h"
+#include <atomic>
+#include <vector>
+
+namespace Tiny {
+	// Events each InputQueue holds by default. Far more than anyone can press in a frame so nothing is dropped
+	// unless the consumer stops latching.
+	constexpr UINT32 DefaultInputQueueEvents = 256;
+	// A change to some of the Input bits at the moment it happened.
+	struct InputEvent {
+		// When the event happened, from the queue's Clock.
+		UINT64 Timestamp;
+		// The Input bits which went down or up.
+		BYTE Buttons;
+		// TRUE if Buttons went down, FALSE if they went up.
+		BOOL Down;
+	};
+	struct InputQueueSettings {
+		// If Clock.Now == nullptr then EZ::GetSystemClock() is used. Push stamps events with it and Latch measures
+		// how long they waited with it.
+		EZ::Clock Clock;
+		// If Capacity == 0 then DefaultInputQueueEvents is used.
+		UINT32 Capacity;
+	};
+	struct InputStats {
+		UINT64 EventsPushed;
+		// Events Push had no room for.
+		UINT64 EventsDropped;
+		UINT64 EventsLatched;
+		// Time from each event happening to the Latch which took it, summed and at most.
+		UINT64 TotalLatencyNanoseconds;
+		UINT64 MaxLatencyNanoseconds;
+	};
+	// Carries input from the thread it arrives on, such as the window thread, to the thread stepping the machine.
+	// Each press and release is stamped the moment it arrives and waits in a lock free ring until the next Latch, so
+	// input is never sampled late and a press shorter than a frame still reaches the guest.
+	class InputQueue {
+	public:
+		InputQueue(Tiny::InputQueueSettings settings);
+		// Stamps buttons going down or up with the current time and queues it without locking or waiting.
+		// Only one thread may push. Returns FALSE if the queue was full and the event was dropped.
+		BOOL Push(BYTE buttons, BOOL down);
+		// Takes every queued event and returns the Input bits for the frame about to be stepped: the buttons held
+		// after the last event plus any pressed since the last Latch, so a tap released before the frame still
+		// shows up for one frame. Only one thread may latch. Call it from an InputCallback.
+		BYTE Latch();
+		// Forgets which buttons are held, for example when the window loses focus and won't see them go up.
+		// Only the pushing thread may call it since it is queued like any other event.
+		BOOL ReleaseAll();
+		~InputQueue();
+
+		// Returns the buttons held after the last Latch.
+		BYTE GetHeld() const;
+		// Only exact on the latching thread.
+		Tiny::InputStats GetStats() const;
+		Tiny::InputQueueSettings GetSettings() const;
+
+	private:
+		EZ::SpscRing<Tiny::InputEvent>* _ring;
+		BYTE _held;
+		// Only written by the pushing thread.
+		std::atomic<UINT64> _eventsPushed;
+		std::atomic<UINT64> _eventsDropped;
+		// Only written by the latching thread.
+		UINT64 _eventsLatched;
+		UINT64 _totalLatencyNanoseconds;
+		UINT64 _maxLatencyNanoseconds;
+		Tiny::InputQueueSettings _settings;
+	};
+
+	// One step of an InputScript.
+	struct InputScriptEvent {
+		// The frame the event is pushed before, counted by the frames passed to Feed.
+		UINT64 Frame;
+		BYTE Buttons;
+		BOOL Down;
+	};
+	// Plays a fixed list of presses and releases into an InputQueue so headless runs and tests drive the same input
+	// path the window does, deterministically. Several events may share a frame, so a press and release in the same
+	// frame is a tap shorter than a frame.
+	class InputScript {
+	public:
+		// Copies count events. Throws an EZ::Error if they are not in order of Frame.
+		InputScript(const Tiny::InputScriptEvent* events, UINT32 count);
+		// Pushes every event up to and including frame which wasn't pushed yet into queue and returns how many.
+		// Call it before each Step with the frame about to be stepped.
+		UINT32 Feed(Tiny::InputQueue* queue, UINT64 frame);
+		// Starts again from the first event.
+		void Rewind();
+
+		// Returns TRUE once every event was pushed.
+		BOOL IsFinished() const;
+		UINT32 GetEventCount() const;
+
+	private:
+		std::vector<Tiny::InputScriptEvent> _events;
+		UINT32 _next;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "TinyKernels.h"
+#include "TinyVideo.h"
+#include "EZCpu.h"
+#include <cstring>
+#ifdef EZ_X86
+#include <immintrin.h>
+#endif
+
+static void ExpandGrayscaleScalar(const BYTE* source, BYTE* destination, UINT32 pixelCount) {
+	for (UINT32 i = 0; i < pixelCount; i++) {
+		destination[0] = source[0]; // Copy B
+		destination[1] = source[0]; // Copy G
+		destination[2] = source[0]; // Copy R
+		destination[3] = 0xFF; // Set A to 0xFF
+		// Move Ptrs into position for next pixel.
+		source += 1;
+		destination += 4;
+	}
+}
+static void UnpackPalletScalar(const BYTE* source, const UINT32* pallet, BYTE* destination, UINT32 pixelCount) {
+	for (UINT32 i = 0; i < pixelCount; i += 4) {
+		UINT32 packed = source[0] | (source[1] << 8) | (source[2] << 16);
+		for (UINT32 pixel = 0; pixel < 4; pixel++) {
+			memcpy(destination, &pallet[(packed >> (pixel * 6)) & 0x3F], 4);
+			destination += 4;
+		}
+		source += 3;
+	}
+}
+
+#ifdef EZ_X86
+// Returns how many leading pixels must be handled one at a time before destination is aligned to alignment bytes.
+// Wide stores that straddle a cache line cost twice as much so the vector loops start on an aligned pixel.
+// If destination isn't even 4 byte aligned no pixel count can fix it and 0 is returned.
+static UINT32 PixelsUntilAligned(const BYTE* destination, UINT32 pixelCount, UINT32 alignment) {
+	UINT32 misalignment = static_cast<UINT32>(reinterpret_cast<size_t>(destination) & (alignment - 1));
+	if ((misalignment & 3) != 0) {
+		return 0;
+	}
+	UINT32 pixels = ((alignment - misalignment) & (alignment - 1)) / 4;
+	return pixels < pixelCount ? pixels : pixelCount;
+}
+
+// SSE2 has no byte shuffle so the pixels are built with unpacks instead.
+// Interleaving g with itself gives GG pairs and interleaving g with 0xFF gives GA pairs.
+// Interleaving those two at 16 bit granularity gives G G G A for every pixel.
+EZ_TARGET("sse2") static void ExpandGrayscaleSSE2(const BYTE* source, BYTE* destination, UINT32 pixelCount) {
+	const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+	UINT32 i = 0;
+	for (; i + 16 <= pixelCount; i += 16) {
+		__m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		__m128i grayGrayLow = _mm_unpacklo_epi8(gray, gray);
+		__m128i grayGrayHigh = _mm_unpackhi_epi8(gray, gray);
+		__m128i grayAlphaLow = _mm_unpacklo_epi8(gray, alpha);
+		__m128i grayAlphaHigh = _mm_unpackhi_epi8(gray, alpha);
+		__m128i* output = reinterpret_cast<__m128i*>(destination + (i * 4));
+		_mm_storeu_si128(output + 0, _mm_unpacklo_epi16(grayGrayLow, grayAlphaLow));
+		_mm_storeu_si128(output + 1, _mm_unpackhi_epi16(grayGrayLow, grayAlphaLow));
+		_mm_storeu_si128(output + 2, _mm_unpacklo_epi16(grayGrayHigh, grayAlphaHigh));
+		_mm_storeu_si128(output + 3, _mm_unpackhi_epi16(grayGrayHigh, grayAlphaHigh));
+	}
+	ExpandGrayscaleScalar(source + i, destination + (i * 4), pixelCount - i);
+}
+
+// The 16 source bytes are broadcast into both 128 bit lanes and then each lane picks out its 4 pixels with a shuffle.
+// Shuffle indices with the high bit set write zero which leaves room to OR the alpha in afterwards.
+EZ_TARGET("avx2") static void ExpandGrayscaleAVX2(const BYTE* source, BYTE* destination, UINT32 pixelCount) {
+	const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+	const __m256i firstMask = _mm256_setr_epi8(
+		0, 0, 0, -128, 1, 1, 1, -128, 2, 2, 2, -128, 3, 3, 3, -128,
+		4, 4, 4, -128, 5, 5, 5, -128, 6, 6, 6, -128, 7, 7, 7, -128);
+	// Adding 8 moves the mask on to the next 8 pixels. The -128 entries stay negative so they still write zero.
+	const __m256i secondMask = _mm256_add_epi8(firstMask, _mm256_set1_epi8(8));
+	UINT32 i = PixelsUntilAligned(destination, pixelCount, 32);
+	ExpandGrayscaleScalar(source, destination, i);
+	for (; i + 32 <= pixelCount; i += 32) {
+		__m256i grayLow = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+		__m256i grayHigh = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 16)));
+		__m256i* output = reinterpret_cast<__m256i*>(destination + (i * 4));
+		_mm256_storeu_si256(output + 0, _mm256_or_si256(_mm256_shuffle_epi8(grayLow, firstMask), alpha));
+		_mm256_storeu_si256(output + 1, _mm256_or_si256(_mm256_shuffle_epi8(grayLow, secondMask), alpha));
+		_mm256_storeu_si256(output + 2, _mm256_or_si256(_mm256_shuffle_epi8(grayHigh, firstMask), alpha));
+		_mm256_storeu_si256(output + 3, _mm256_or_si256(_mm256_shuffle_epi8(grayHigh, secondMask), alpha));
+	}
+	ExpandGrayscaleSSE2(source + i, destination + (i * 4), pixelCount - i);
+}
+
+// Same idea as the AVX2 kernel but with four 128 bit lanes one shuffle turns 16 source bytes into 64 output bytes.
+EZ_TARGET("avx512f,avx512bw") static void ExpandGrayscaleAVX512(const BYTE* source, BYTE* destination, UINT32 pixelCount) {
+	const __m512i alpha = _mm512_set1_epi32(static_cast<int>(0xFF000000));
+	const __m512i mask = _mm512_set_epi32(
+		static_cast<int>(0x800F0F0F), static_cast<int>(0x800E0E0E), static_cast<int>(0x800D0D0D), static_cast<int>(0x800C0C0C),
+		static_cast<int>(0x800B0B0B), static_cast<int>(0x800A0A0A), static_cast<int>(0x80090909), static_cast<int>(0x80080808),
+		static_cast<int>(0x80070707), static_cast<int>(0x80060606), static_cast<int>(0x80050505), static_cast<int>(0x80040404),
+		static_cast<int>(0x80030303), static_cast<int>(0x80020202), static_cast<int>(0x80010101), static_cast<int>(0x80000000));
+	UINT32 i = PixelsUntilAligned(destination, pixelCount, 64);
+	ExpandGrayscaleScalar(source, destination, i);
+	for (; i + 64 <= pixelCount; i += 64) {
+		__m512i* output = reinterpret_cast<__m512i*>(destination + (i * 4));
+		for (UINT32 block = 0; block < 4; block++) {
+			__m512i gray = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + (block * 16))));
+			_mm512_storeu_si512(output + block, _mm512_or_si512(_mm512_shuffle_epi8(gray, mask), alpha));
+		}
+	}
+	ExpandGrayscaleAVX2(source + i, destination + (i * 4), pixelCount - i);
+}
+
+// Each 128 bit lane handles one group of 4 pixels. The shuffle copies the lane's 3 packed bytes into all 4 of its
+// 32 bit elements, the variable shift moves each pixel's 6 bits to the bottom and the gather looks up the color.
+// 16 source bytes are loaded for every 12 that are used so the loop stops while a full load is still in bounds.
+EZ_TARGET("avx2") static void UnpackPalletAVX2(const BYTE* source, const UINT32* pallet, BYTE* destination, UINT32 pixelCount) {
+	const __m256i firstMask = _mm256_setr_epi8(
+		0, 1, 2, -128, 0, 1, 2, -128, 0, 1, 2, -128, 0, 1, 2, -128,
+		3, 4, 5, -128, 3, 4, 5, -128, 3, 4, 5, -128, 3, 4, 5, -128);
+	const __m256i secondMask = _mm256_add_epi8(firstMask, _mm256_set1_epi8(6));
+	const __m256i shifts = _mm256_setr_epi32(0, 6, 12, 18, 0, 6, 12, 18);
+	const __m256i sixBits = _mm256_set1_epi32(0x3F);
+	const UINT32 sourceBytes = (pixelCount / 4) * 3;
+	const int* palletInts = reinterpret_cast<const int*>(pallet);
+	UINT32 i = 0;
+	for (; ((i / 4) * 3) + 16 <= sourceBytes; i += 16) {
+		__m256i packed = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + ((i / 4) * 3))));
+		__m256i firstIndices = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(packed, firstMask), shifts), sixBits);
+		__m256i secondIndices = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(packed, secondMask), shifts), sixBits);
+		__m256i* output = reinterpret_cast<__m256i*>(destination + (i * 4));
+		_mm256_storeu_si256(output + 0, _mm256_i32gather_epi32(palletInts, firstIndices, 4));
+		_mm256_storeu_si256(output + 1, _mm256_i32gather_epi32(palletInts, secondIndices, 4));
+	}
+	UnpackPalletScalar(source + ((i / 4) * 3), pallet, destination + (i * 4), pixelCount - i);
+}
+
+// Same unpack as the AVX2 kernel but all four groups fit in one register. Instead of a gather the 64 colors are held
+// in four registers. Two two-table permutes look up the low 32 and high 32 colors and bit 5 of the index picks between them.
+EZ_TARGET("avx512f,avx512bw") static void UnpackPalletAVX512(const BYTE* source, const UINT32* pallet, BYTE* destination, UINT32 pixelCount) {
+	const __m512i mask = _mm512_set_epi32(
+		static_cast<int>(0x800B0A09), static_cast<int>(0x800B0A09), static_cast<int>(0x800B0A09), static_cast<int>(0x800B0A09),
+		static_cast<int>(0x80080706), static_cast<int>(0x80080706), static_cast<int>(0x80080706), static_cast<int>(0x80080706),
+		static_cast<int>(0x80050403), static_cast<int>(0x80050403), static_cast<int>(0x80050403), static_cast<int>(0x80050403),
+		static_cast<int>(0x80020100), static_cast<int>(0x80020100), static_cast<int>(0x80020100), static_cast<int>(0x80020100));
+	const __m512i shifts = _mm512_set_epi32(18, 12, 6, 0, 18, 12, 6, 0, 18, 12, 6, 0, 18, 12, 6, 0);
+	const __m512i sixBits = _mm512_set1_epi32(0x3F);
+	const __m512i highHalf = _mm512_set1_epi32(0x20);
+	const __m512i colors0 = _mm512_loadu_si512(pallet + 0);
+	const __m512i colors1 = _mm512_loadu_si512(pallet + 16);
+	const __m512i colors2 = _mm512_loadu_si512(pallet + 32);
+	const __m512i colors3 = _mm512_loadu_si512(pallet + 48);
+	const UINT32 sourceBytes = (pixelCount / 4) * 3;
+	UINT32 i = 0;
+	for (; ((i / 4) * 3) + 16 <= sourceBytes; i += 16) {
+		__m512i packed = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + ((i / 4) * 3))));
+		__m512i indices = _mm512_and_si512(_mm512_srlv_epi32(_mm512_shuffle_epi8(packed, mask), shifts), sixBits);
+		__m512i low = _mm512_permutex2var_epi32(colors0, indices, colors1);
+		__m512i high = _mm512_permutex2var_epi32(colors2, indices, colors3);
+		__mmask16 useHigh = _mm512_test_epi32_mask(indices, highHalf);
+		_mm512_storeu_si512(destination + (i * 4), _mm512_mask_blend_epi32(useHigh, low, high));
+	}
+	UnpackPalletScalar(source + ((i / 4) * 3), pallet, destination + (i * 4), pixelCount - i);
+}
+#endif
+
+// Returns the kernel for the fastest level at or below GetBestKernelLevel() that has one.
+template <typename Kernel> static Kernel PickBestKernel(Kernel(*getKernel)(Tiny::KernelLevel level)) {
+	for (int level = static_cast<int>(Tiny::GetBestKernelLevel()); level >= 0; level--) {
+		Kernel kernel = getKernel(static_cast<Tiny::KernelLevel>(level));
+		if (kernel != nullptr) {
+			return kernel;
+		}
+	}
+	return nullptr;
+}
+
+Tiny::KernelLevel Tiny::GetBestKernelLevel() {
+	const EZ::CpuFeatures& features = EZ::GetCpuFeatures();
+	if (features.AVX512F && features.AVX512BW) {
+		return Tiny::KernelLevel::AVX512;
+	}
+	if (features.AVX2) {
+		return Tiny::KernelLevel::AVX2;
+	}
+	if (features.SSE2) {
+		return Tiny::KernelLevel::SSE2;
+	}
+	return Tiny::KernelLevel::Scalar;
+}
+Tiny::ExpandGrayscaleKernel Tiny::GetExpandGrayscaleKernel(Tiny::KernelLevel level) {
+	if (level > GetBestKernelLevel()) {
+		return nullptr;
+	}
+	switch (level) {
+#ifdef EZ_X86
+	case Tiny::KernelLevel::SSE2:
+		return ExpandGrayscaleSSE2;
+	case Tiny::KernelLevel::AVX2:
+		return ExpandGrayscaleAVX2;
+	case Tiny::KernelLevel::AVX512:
+		return ExpandGrayscaleAVX512;
+#endif
+	case Tiny::KernelLevel::Scalar:
+		return ExpandGrayscaleScalar;
+	default:
+		return nullptr;
+	}
+}
+Tiny::UnpackPalletKernel Tiny::GetUnpackPalletKernel(Tiny::KernelLevel level) {
+	if (level > GetBestKernelLevel()) {
+		return nullptr;
+	}
+	switch (level) {
+#ifdef EZ_X86
+	case Tiny::KernelLevel::AVX2:
+		return UnpackPalletAVX2;
+	case Tiny::KernelLevel::AVX512:
+		return UnpackPalletAVX512;
+#endif
+	case Tiny::KernelLevel::Scalar:
+		return UnpackPalletScalar;
+	default:
+		return nullptr;
+	}
+}
+void Tiny::ExpandGrayscale(const BYTE* source, BYTE* destination, UINT32 pixelCount) {
+	static const Tiny::ExpandGrayscaleKernel kernel = PickBestKernel(GetExpandGrayscaleKernel);
+	kernel(source, destination, pixelCount);
+}
+void Tiny::UnpackPallet(const BYTE* source, const UINT32* pallet, BYTE* destination, UINT32 pixelCount) {
+	static const Tiny::UnpackPalletKernel kernel = PickBestKernel(GetUnpackPalletKernel);
+	kernel(source, pallet, destination, pixelCount);
+}
+void Tiny::ExpandPallet(const BYTE* source, UINT32* destination) {
+	for (UINT32 i = 0; i < PalletColorCount; i++) {
+		BYTE bgra[4] = { source[2], source[1], source[0], 0xFF };
+		memcpy(&destination[i], bgra, 4);
+		source += 3;
+	}
+}
\ No newline at end of file
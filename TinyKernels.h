@@ -0,0 +1,36 @@
+#pragma once
+#include "EZPlatform.h"
+
+namespace Tiny {
+	// Instruction set levels the pixel kernels are written for, from slowest to fastest.
+	enum class KernelLevel : BYTE {
+		Scalar = 0,
+		SSE2 = 1,
+		AVX2 = 2,
+		// Requires AVX512F and AVX512BW.
+		AVX512 = 3,
+	};
+	// Expands pixelCount 8 bit grayscale values from source into pixelCount B8G8R8A8 pixels in destination.
+	// B, G and R are all set to the grayscale value and A is set to 0xFF.
+	// source and destination need no particular alignment but must not overlap.
+	typedef void (*ExpandGrayscaleKernel)(const BYTE* source, BYTE* destination, UINT32 pixelCount);
+	// Unpacks pixelCount 6 bit pallet indices from source and writes pallet[index] for each one into destination.
+	// source is packed the way VideoMode::BitmapWithPallet describes so pixelCount must be a multiple of 4.
+	// pallet holds PalletColorCount colors already in B8G8R8A8 form. See ExpandPallet.
+	typedef void (*UnpackPalletKernel)(const BYTE* source, const UINT32* pallet, BYTE* destination, UINT32 pixelCount);
+
+	// Returns the fastest KernelLevel this CPU and OS support.
+	Tiny::KernelLevel GetBestKernelLevel();
+	// Returns the grayscale kernel written for level or nullptr if this CPU or build can't run it.
+	// This is mostly useful for testing and benchmarking one level against another.
+	Tiny::ExpandGrayscaleKernel GetExpandGrayscaleKernel(Tiny::KernelLevel level);
+	// Returns the pallet kernel written for level or nullptr if this CPU or build can't run it.
+	// There is no SSE2 pallet kernel because the unpack needs byte shuffles.
+	Tiny::UnpackPalletKernel GetUnpackPalletKernel(Tiny::KernelLevel level);
+	// Runs the grayscale kernel for GetBestKernelLevel(). The choice is made once on the first call.
+	void ExpandGrayscale(const BYTE* source, BYTE* destination, UINT32 pixelCount);
+	// Runs the fastest pallet kernel this CPU can run. The choice is made once on the first call.
+	void UnpackPallet(const BYTE* source, const UINT32* pallet, BYTE* destination, UINT32 pixelCount);
+	// Converts PalletColorCount R8G8B8 colors from source into B8G8R8A8 colors in destination with A set to 0xFF.
+	void ExpandPallet(const BYTE* source, UINT32* destination);
+}
\ No newline at end of file
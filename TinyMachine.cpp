@@ -0,0 +1,265 @@
+#include "TinyMachine.h"
+#include "TinyCartridge.h"
+#include "TinyKernels.h"
+#include "EZProfiler.h"
+#include <cstring>
+
+Tiny::Machine::Machine(Tiny::MachineSettings settings) {
+	_settings = settings;
+	_memory = _settings.Cartridge != nullptr ? _settings.Cartridge->MapMemory() : new BYTE[MemorySize]();
+	_bus = new Tiny::MemoryBus(_memory);
+	if (_settings.Cartridge != nullptr) {
+		// Reading the ROM straight from the cartridge's read only mapping drops guest writes to it, so a stray store
+		// can't give this machine a private copy of a page every machine shares. Only whole pages are mapped and never the
+		// register page, which holds the stack, so the ends of a ROM which doesn't start and end on page boundaries stay writable.
+		UINT32 romStart = (_settings.Cartridge->GetRomAddress() + PageSize - 1) & ~(PageSize - 1);
+		UINT32 romEnd = (_settings.Cartridge->GetRomAddress() + _settings.Cartridge->GetRomSize()) & ~(PageSize - 1);
+		romStart = romStart < PageSize ? PageSize : romStart;
+		if (romEnd > romStart) {
+			_bus->MapRom(static_cast<UINT16>(romStart), romEnd - romStart, _settings.Cartridge->GetImage() + romStart);
+		}
+	}
+	_frameCount = 0;
+	if (_settings.CyclesPerFrame == 0) {
+		_settings.CyclesPerFrame = DefaultCyclesPerFrame;
+	}
+
+	memset(_dirtyPages, 0, sizeof(_dirtyPages));
+	memset(_capturePages, 0, sizeof(_capturePages));
+	_captureId = 0;
+	_renderValid = FALSE;
+	_lastFrameBuffer = nullptr;
+	_lastStride = 0;
+	_renderStats = { };
+	_lastVideoMode = Tiny::VideoMode::Grayscale;
+}
+void Tiny::Machine::Reset() {
+	_cpu.Reset(*_bus);
+}
+void Tiny::Machine::Step() {
+	if (_settings.InputCallback != nullptr) {
+		EZ::ProfileScope scope("Input");
+		Write(InputsAddress, _settings.InputCallback(this));
+	}
+
+	{
+		EZ::ProfileScope scope("Emulate");
+		UINT64 writtenPages[PageCount / 64] = { };
+		_cpu.Run(*_bus, writtenPages, _settings.CyclesPerFrame);
+		for (UINT32 i = 0; i < PageCount / 64; i++) {
+			_dirtyPages[i] |= writtenPages[i];
+			_capturePages[i] |= writtenPages[i];
+		}
+	}
+
+	_frameCount++;
+}
+Tiny::DirtyRows Tiny::Machine::Render(BYTE* frameBuffer, UINT32 stride) {
+	EZ::ProfileScope scope("Convert");
+	Tiny::VideoMode videoMode = GetVideoMode();
+	// Anything which makes the old frame buffer contents useless forces every row to be redrawn.
+	BOOL redrawAll = !_renderValid || videoMode != _lastVideoMode || frameBuffer != _lastFrameBuffer || stride != _lastStride;
+	Tiny::DirtyRows rows = NoDirtyRows;
+
+	switch (videoMode) {
+	case Tiny::VideoMode::BitmapWithPallet:
+		rows = redrawAll ? AllDirtyRows : DirtyRowsFromPages(PalletPixelAddress, PalletPixelBytes, PalletRowBytes);
+		rows = _palletRenderer.Render(_memory, frameBuffer, stride, rows, redrawAll || AnyPageDirty(PalletAddress, PalletBytes));
+		break;
+	case Tiny::VideoMode::Tiles:
+		if (redrawAll) {
+			_tileRenderer.Invalidate();
+		}
+		if (redrawAll || AnyPageDirty(TileGridAddress, TileModeBytes)) {
+			rows = _tileRenderer.Render(_memory, frameBuffer, stride);
+		}
+		break;
+	case Tiny::VideoMode::ShaderGraph:
+		// Any change can move any sprite anywhere so there is no cheaper option than redrawing everything.
+		if (redrawAll || AnyPageDirty(BackgroundColorAddress, ShaderGraphModeBytes)) {
+			_spriteRenderer.Render(_memory, frameBuffer, stride, _settings.ThreadPool);
+			rows = AllDirtyRows;
+		}
+		break;
+	case Tiny::VideoMode::Grayscale:
+	default:
+		rows = redrawAll ? AllDirtyRows : DirtyRowsFromPages(VideoAddress, GrayscaleBytes, ScreenWidth);
+		// Copy and convert from 8 bit grayscale in memory to B8G8R8A8 in frameBuffer
+		if (stride == ScreenWidth * 4) {
+			Tiny::ExpandGrayscale(_memory + VideoAddress + (rows.Top * ScreenWidth), frameBuffer + (rows.Top * stride), ScreenWidth * (rows.Bottom - rows.Top));
+			break;
+		}
+		for (UINT32 y = rows.Top; y < rows.Bottom; y++) {
+			Tiny::ExpandGrayscale(_memory + VideoAddress + (y * ScreenWidth), frameBuffer + (y * stride), ScreenWidth);
+		}
+		break;
+	}
+
+	memset(_dirtyPages, 0, sizeof(_dirtyPages));
+	_renderValid = TRUE;
+	_lastVideoMode = videoMode;
+	_lastFrameBuffer = frameBuffer;
+	_lastStride = stride;
+
+	UINT32 rowCount = rows.Bottom - rows.Top;
+	if (rowCount == 0) {
+		_renderStats.FramesSkipped++;
+	}
+	else {
+		_renderStats.FramesRendered++;
+	}
+	_renderStats.RowsConverted += rowCount;
+	_renderStats.RowsSkipped += ScreenHeight - rowCount;
+	return rows;
+}
+BYTE Tiny::Machine::Read(UINT16 address) const {
+	return _bus->Read(address);
+}
+void Tiny::Machine::Write(UINT16 address, BYTE value) {
+	if (!_bus->Write(address, value)) {
+		return;
+	}
+	_dirtyPages[address >> 14] |= 1ull << ((address >> 8) & 63);
+	_capturePages[address >> 14] |= 1ull << ((address >> 8) & 63);
+	_cpu.Invalidate(*_bus, address, 1);
+}
+void Tiny::Machine::WriteRange(UINT16 address, const BYTE* data, UINT32 size) {
+	// Compare and copy a page at a time so pages that end up the same stay clean.
+	UINT32 current = address;
+	UINT32 end = address + size;
+	if (end > MemorySize) {
+		end = MemorySize;
+	}
+	while (current < end) {
+		UINT32 pageEnd = (current & ~(PageSize - 1)) + PageSize;
+		UINT32 chunk = (pageEnd < end ? pageEnd : end) - current;
+		if (memcmp(_memory + current, data, chunk) != 0) {
+			memcpy(_memory + current, data, chunk);
+			MarkDirty(static_cast<UINT16>(current), chunk);
+		}
+		data += chunk;
+		current += chunk;
+	}
+}
+void Tiny::Machine::MarkDirty(UINT16 address, UINT32 size) {
+	if (size == 0) {
+		return;
+	}
+	UINT32 lastAddress = address + size - 1;
+	if (lastAddress >= MemorySize) {
+		lastAddress = MemorySize - 1;
+	}
+	for (UINT32 page = address / PageSize; page <= lastAddress / PageSize; page++) {
+		_dirtyPages[page / 64] |= 1ull << (page % 64);
+		_capturePages[page / 64] |= 1ull << (page % 64);
+	}
+	_cpu.Invalidate(*_bus, address, (lastAddress - address) + 1);
+}
+void Tiny::Machine::SetState(const Tiny::MachineState& state) {
+	_frameCount = state.FrameCount;
+	_cpu.SetState(state.Cpu);
+}
+void Tiny::Machine::SetCaptureId(UINT64 captureId) {
+	_captureId = captureId;
+	memset(_capturePages, 0, sizeof(_capturePages));
+}
+BOOL Tiny::Machine::IsPageDirty(UINT32 page) const {
+	return (_dirtyPages[page / 64] >> (page % 64)) & 1;
+}
+BOOL Tiny::Machine::AnyPageDirty(UINT32 address, UINT32 size) const {
+	for (UINT32 page = address / PageSize; page <= (address + size - 1) / PageSize; page++) {
+		if (IsPageDirty(page)) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+Tiny::DirtyRows Tiny::Machine::DirtyRowsFromPages(UINT32 address, UINT32 size, UINT32 rowBytes) const {
+	Tiny::DirtyRows rows = NoDirtyRows;
+	for (UINT32 page = address / PageSize; page <= (address + size - 1) / PageSize; page++) {
+		if (!IsPageDirty(page)) {
+			continue;
+		}
+		// Clamp the page to the video mode's bytes before turning it into rows.
+		UINT32 first = page * PageSize < address ? address : page * PageSize;
+		UINT32 last = (page + 1) * PageSize < address + size ? (page + 1) * PageSize : address + size;
+		UINT32 top = (first - address) / rowBytes;
+		UINT32 bottom = ((last - address) + rowBytes - 1) / rowBytes;
+		if (rows.Top == rows.Bottom) {
+			rows.Top = top;
+		}
+		rows.Bottom = bottom;
+	}
+	return rows;
+}
+Tiny::Machine::~Machine() {
+	delete _bus;
+	_bus = nullptr;
+	if (_settings.Cartridge != nullptr) {
+		Tiny::Cartridge::UnmapMemory(_memory);
+	}
+	else {
+		delete[] _memory;
+	}
+	_memory = nullptr;
+	_frameCount = 0;
+}
+
+BYTE* Tiny::Machine::GetMemory() {
+	return _memory;
+}
+const BYTE* Tiny::Machine::GetMemory() const {
+	return _memory;
+}
+Tiny::MemoryBus* Tiny::Machine::GetBus() {
+	return _bus;
+}
+UINT64 Tiny::Machine::GetFrameCount() const {
+	return _frameCount;
+}
+Tiny::VideoMode Tiny::Machine::GetVideoMode() const {
+	return static_cast<Tiny::VideoMode>(_memory[SysFlagsAddress] & VideoModeMask);
+}
+Tiny::RenderStats Tiny::Machine::GetRenderStats() const {
+	return _renderStats;
+}
+const Tiny::PalletRenderer& Tiny::Machine::GetPalletRenderer() const {
+	return _palletRenderer;
+}
+const Tiny::TileRenderer& Tiny::Machine::GetTileRenderer() const {
+	return _tileRenderer;
+}
+const Tiny::SpriteRenderer& Tiny::Machine::GetSpriteRenderer() const {
+	return _spriteRenderer;
+}
+const Tiny::Cpu& Tiny::Machine::GetCpu() const {
+	return _cpu;
+}
+Tiny::MachineSettings Tiny::Machine::GetSettings() const {
+	return _settings;
+}
+Tiny::MachineState Tiny::Machine::GetState() const {
+	return { _frameCount, _cpu.GetState() };
+}
+UINT64 Tiny::Machine::GetCaptureId() const {
+	return _captureId;
+}
+BOOL Tiny::Machine::IsPageChangedSinceCapture(UINT32 page) const {
+	return (_capturePages[page / 64] >> (page % 64)) & 1;
+}
+UINT64 Tiny::Machine::GetStateHash() const {
+	// Every field is hashed one value at a time rather than as raw structs so padding never changes the hash.
+	Tiny::CpuState cpu = _cpu.GetState();
+	const UINT64 values[] = { _frameCount, cpu.Registers.PC, cpu.Registers.A, cpu.Registers.X, cpu.Registers.Y, cpu.Registers.SP,
+		static_cast<UINT64>(cpu.Registers.Zero != 0), static_cast<UINT64>(cpu.Registers.Carry != 0), static_cast<UINT64>(cpu.Running != 0), cpu.CycleDebt };
+	UINT64 hash = 14695981039346656037ull;
+	for (UINT32 i = 0; i < MemorySize; i++) {
+		hash = (hash ^ _memory[i]) * 1099511628211ull;
+	}
+	for (UINT64 value : values) {
+		for (UINT32 i = 0; i < 8; i++) {
+			hash = (hash ^ static_cast<BYTE>(value >> (i * 8))) * 1099511628211ull;
+		}
+	}
+	return hash;
+}
\ No newline at end of file
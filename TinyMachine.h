@@ -0,0 +1,161 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyVideo.h"
+#include "TinyPalletRenderer.h"
+#include "TinyTileRenderer.h"
+#include "TinySpriteRenderer.h"
+#include "TinyCpu.h"
+#include "TinyMemoryBus.h"
+#include "EZThreadPool.h"
+
+namespace Tiny {
+	class Machine; // Forward declaration of Machine so callbacks can take a Machine*.
+	class Cartridge; // Forward declaration of Cartridge since TinyCartridge.h needs the constants in this file.
+	typedef BYTE(*InputCallback)(Tiny::Machine* machine);
+	// The full 16 bit address space. See the MemSpec in TinyEmulator.txt.
+	constexpr UINT32 MemorySize = 0x10000;
+	// Writes are tracked per page so Render can tell which parts of video memory changed.
+	constexpr UINT32 PageSize = 256;
+	constexpr UINT32 PageCount = MemorySize / PageSize;
+	constexpr UINT16 InputsAddress = 0x0000;
+	constexpr UINT16 SysFlagsAddress = 0x0001;
+	// 100000 cycles per frame is 6 million cycles per second at 60 FPS.
+	constexpr UINT32 DefaultCyclesPerFrame = 100000;
+	// Bits of the Inputs register at InputsAddress.
+	namespace Input {
+		constexpr BYTE Up = 1 << 0; // W
+		constexpr BYTE Down = 1 << 1; // S
+		constexpr BYTE Left = 1 << 2; // A
+		constexpr BYTE Right = 1 << 3; // D
+		constexpr BYTE Jump = 1 << 4; // Space
+		constexpr BYTE Action = 1 << 5; // J
+		constexpr BYTE SpecialA = 1 << 6; // K
+		constexpr BYTE SpecialB = 1 << 7; // L
+	}
+	struct RenderStats {
+		// Number of Render calls which changed at least one row of the frame buffer.
+		UINT64 FramesRendered;
+		// Number of Render calls which found nothing to do. The last frame can be presented again as is.
+		UINT64 FramesSkipped;
+		// Number of frame buffer rows converted and not converted across all Render calls.
+		UINT64 RowsConverted;
+		UINT64 RowsSkipped;
+	};
+	// Everything about a machine outside of its memory. Together with memory this is all a Tiny::SaveState holds.
+	struct MachineState {
+		UINT64 FrameCount;
+		Tiny::CpuState Cpu;
+	};
+	struct MachineSettings {
+		// This is a user defined pointer which can point to anything.
+		// It works just like EZ::ProgramSettings::UserData and can be read back with GetUserDataAs().
+		void* UserData;
+		// This callback is called once at the start of every Step to latch the Inputs register.
+		// It returns the Input bits which are held down for the frame about to be stepped.
+		// This is where a keyboard, a recording or a script plugs into the machine.
+		// If InputCallback == nullptr then the Inputs register is left alone so the host can write it directly.
+		Tiny::InputCallback InputCallback;
+		// If ThreadPool != nullptr then video modes which can be split up are rendered across its threads.
+		// One pool can be shared by many machines as long as they don't Render at the same time.
+		// Else every video mode renders on the thread calling Render.
+		EZ::ThreadPool* ThreadPool;
+		// The number of CPU cycles each Step runs for unless the program executes WAIT first.
+		// If CyclesPerFrame == 0 then DefaultCyclesPerFrame is used.
+		UINT32 CyclesPerFrame;
+		// If Cartridge != nullptr then memory starts as a copy on write view of the cartridge image instead of zeros.
+		// The whole pages of its ROM are read straight from the cartridge and guest writes to them are dropped.
+		// Many machines can share one cartridge, which must outlive all of them.
+		const Tiny::Cartridge* Cartridge;
+	};
+	class Machine {
+	public:
+		Machine(Tiny::MachineSettings settings);
+		// Starts the CPU from the address in the reset vector. Call this after loading a program into memory.
+		// Until Reset is called the CPU is stopped and memory only changes when the host writes it.
+		void Reset();
+		// Latches the Inputs register and runs the CPU for one frame's worth of cycles.
+		void Step();
+		// Converts video memory into B8G8R8A8 pixels using the VideoMode selected in SysFlags.
+		// frameBuffer is owned by the caller and must hold ScreenHeight rows of stride bytes each.
+		// stride must be at least ScreenWidth * 4.
+		// Only rows whose video memory was written since the last Render are converted so frameBuffer must still
+		// hold the last frame. Passing a different frameBuffer or stride than last time converts every row.
+		// Returns the rows which changed. If no rows changed the frame is identical to the last one.
+		Tiny::DirtyRows Render(BYTE* frameBuffer, UINT32 stride);
+		// Reads and writes go through the bus like the CPU's do, so MMIO handlers and write watches see them.
+		BYTE Read(UINT16 address) const;
+		// Writes to memory and marks the page dirty if value is different than what was there.
+		// Like every way of changing memory this also throws away any instructions the CPU decoded from it.
+		void Write(UINT16 address, BYTE value);
+		// Copies size bytes into memory starting at address and marks the pages which changed as dirty.
+		void WriteRange(UINT16 address, const BYTE* data, UINT32 size);
+		// Marks size bytes starting at address as changed. Anyone writing through GetMemory() must call this
+		// afterwards or Render won't know to redraw those bytes and the CPU may run stale instructions.
+		void MarkDirty(UINT16 address, UINT32 size);
+		// Puts back everything GetState returned. Memory is restored separately through WriteRange.
+		void SetState(const Tiny::MachineState& state);
+		// Names the current contents of memory captureId and forgets which pages changed before now.
+		// Tiny::SaveState calls this after capturing or restoring so the next capture only copies pages changed since.
+		void SetCaptureId(UINT64 captureId);
+		~Machine();
+
+		BYTE* GetMemory();
+		const BYTE* GetMemory() const;
+		// Peripherals map their MMIO registers and debuggers watch writes here.
+		// GetMemory(), WriteRange and the renderers bypass it and see memory as it is.
+		Tiny::MemoryBus* GetBus();
+		UINT64 GetFrameCount() const;
+		Tiny::VideoMode GetVideoMode() const;
+		Tiny::RenderStats GetRenderStats() const;
+		const Tiny::PalletRenderer& GetPalletRenderer() const;
+		const Tiny::TileRenderer& GetTileRenderer() const;
+		const Tiny::SpriteRenderer& GetSpriteRenderer() const;
+		const Tiny::Cpu& GetCpu() const;
+		Tiny::MachineSettings GetSettings() const;
+		Tiny::MachineState GetState() const;
+		UINT64 GetCaptureId() const;
+		// Returns TRUE if page was written since the last SetCaptureId.
+		BOOL IsPageChangedSinceCapture(UINT32 page) const;
+		// Returns a 64 bit FNV-1a hash of memory and of everything GetState returns.
+		// Machines with equal hashes are in the same state, which is how replays prove they are deterministic.
+		UINT64 GetStateHash() const;
+
+		template <typename T> T* GetUserDataAs() const;
+
+	private:
+		BOOL IsPageDirty(UINT32 page) const;
+		// Returns TRUE if any page overlapping size bytes starting at address is dirty.
+		BOOL AnyPageDirty(UINT32 address, UINT32 size) const;
+		// Returns the rows covering every dirty page overlapping size bytes starting at address,
+		// for a video mode which stores rowBytes bytes per row starting at address.
+		Tiny::DirtyRows DirtyRowsFromPages(UINT32 address, UINT32 size, UINT32 rowBytes) const;
+
+		// Either MemorySize bytes of the heap or a view from MachineSettings::Cartridge.
+		BYTE* _memory;
+		Tiny::MemoryBus* _bus;
+		UINT64 _frameCount;
+
+		UINT64 _dirtyPages[PageCount / 64];
+		// Like _dirtyPages but only cleared by SetCaptureId instead of by every Render.
+		UINT64 _capturePages[PageCount / 64];
+		UINT64 _captureId;
+		BOOL _renderValid;
+		BYTE* _lastFrameBuffer;
+		UINT32 _lastStride;
+		Tiny::RenderStats _renderStats;
+
+		Tiny::VideoMode _lastVideoMode;
+		Tiny::PalletRenderer _palletRenderer;
+		Tiny::TileRenderer _tileRenderer;
+		Tiny::SpriteRenderer _spriteRenderer;
+
+		Tiny::Cpu _cpu;
+
+		Tiny::MachineSettings _settings;
+	};
+}
+// This is defined here not in TinyMachine.cpp because the source code for
+// functions using templates must be #included wherever they are called.
+template <typename T> T* Tiny::Machine::GetUserDataAs() const {
+	return reinterpret_cast<T*>(_settings.UserData);
+}
\ No newline at end of file
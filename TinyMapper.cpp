@@ -0,0 +1,99 @@
+#include "TinyMapper.h"
+#include "EZError.h"
+
+Tiny::Mapper::Mapper(Tiny::MemoryBus* bus, Tiny::MapperSettings settings) {
+	_settings = settings;
+	if (_settings.WindowCount > MaxBankWindows) {
+		throw EZ::Error("A mapper has at most MaxBankWindows windows.");
+	}
+	for (UINT32 i = 0; i < _settings.WindowCount; i++) {
+		const Tiny::BankWindow& window = _settings.Windows[i];
+		if (window.Size == 0 || window.Address % BusPageSize != 0 || window.Size % BusPageSize != 0
+			|| window.Address < BusPageSize || window.Address + window.Size > 0x10000) {
+			throw EZ::Error("Bank windows must be whole pages outside the register page.");
+		}
+		for (UINT32 j = 0; j < i; j++) {
+			const Tiny::BankWindow& other = _settings.Windows[j];
+			if (window.Address < other.Address + other.Size && other.Address < window.Address + window.Size) {
+				throw EZ::Error("Bank windows must not overlap.");
+			}
+		}
+		if ((window.Ram ? _settings.RamSize : (_settings.Rom != nullptr ? _settings.RomSize : 0)) < window.Size) {
+			throw EZ::Error("Every bank window needs at least one bank behind it.");
+		}
+	}
+	_bus = bus;
+	for (UINT32 page = 0; page < BusPageCount; page++) {
+		_previousPages[page] = _bus->GetPageMemory(page);
+		_previousReadOnly[page] = _bus->IsPageReadOnly(page);
+	}
+	_ram = new BYTE[_settings.RamSize]();
+	for (UINT32 i = 0; i < MaxBankWindows; i++) {
+		_banks[i] = 0;
+	}
+	for (UINT32 i = 0; i < _settings.WindowCount; i++) {
+		SelectBank(i, 0);
+	}
+	if (_settings.WindowCount != 0) {
+		// Writes to MMIO never reach memory so the registers read back from _banks.
+		_bus->MapMmio(BankSelectAddress, _settings.WindowCount, ReadBankSelect, WriteBankSelect, this);
+	}
+}
+void Tiny::Mapper::SelectBank(UINT32 window, BYTE bank) {
+	const Tiny::BankWindow& bankWindow = _settings.Windows[window];
+	bank = static_cast<BYTE>(bank % GetBankCount(window));
+	_banks[window] = bank;
+	UINT32 offset = bank * bankWindow.Size;
+	if (bankWindow.Ram) {
+		_bus->MapMemory(bankWindow.Address, bankWindow.Size, _ram + offset);
+	}
+	else {
+		_bus->MapRom(bankWindow.Address, bankWindow.Size, _settings.Rom + offset);
+	}
+}
+BYTE Tiny::Mapper::ReadBankSelect(void* context, UINT16 address) {
+	Tiny::Mapper* mapper = reinterpret_cast<Tiny::Mapper*>(context);
+	return mapper->_banks[address - BankSelectAddress];
+}
+void Tiny::Mapper::WriteBankSelect(void* context, UINT16 address, BYTE value) {
+	Tiny::Mapper* mapper = reinterpret_cast<Tiny::Mapper*>(context);
+	mapper->SelectBank(address - BankSelectAddress, value);
+}
+Tiny::Mapper::~Mapper() {
+	if (_settings.WindowCount != 0) {
+		_bus->UnmapMmio(BankSelectAddress);
+	}
+	for (UINT32 i = 0; i < _settings.WindowCount; i++) {
+		const Tiny::BankWindow& window = _settings.Windows[i];
+		for (UINT32 page = window.Address / BusPageSize; page < (window.Address + window.Size) / BusPageSize; page++) {
+			UINT16 address = static_cast<UINT16>(page * BusPageSize);
+			if (_previousReadOnly[page]) {
+				_bus->MapRom(address, BusPageSize, _previousPages[page]);
+			}
+			else {
+				// The page was writable before so its memory was never const.
+				_bus->MapMemory(address, BusPageSize, const_cast<BYTE*>(_previousPages[page]));
+			}
+		}
+	}
+	delete[] _ram;
+	_ram = nullptr;
+	_bus = nullptr;
+}
+
+BYTE Tiny::Mapper::GetBank(UINT32 window) const {
+	return _banks[window];
+}
+UINT32 Tiny::Mapper::GetBankCount(UINT32 window) const {
+	const Tiny::BankWindow& bankWindow = _settings.Windows[window];
+	UINT32 storeSize = bankWindow.Ram ? _settings.RamSize : _settings.RomSize;
+	UINT32 count = storeSize / bankWindow.Size;
+	// Bank numbers are a byte so at most 256 banks can be reached.
+	return count > 256 ? 256 : count;
+}
+BYTE* Tiny::Mapper::GetRam() {
+	return _ram;
+}
+Tiny::MapperSettings Tiny::Mapper::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMemoryBus.h"
+
+namespace Tiny {
+	constexpr UINT32 MaxBankWindows = 4;
+	// One bank select register per window from here on in the register page. See the MemSpec in TinyEmulator.txt.
+	constexpr UINT16 BankSelectAddress = 0x0004;
+	// A range of the address space which shows one bank of a larger store at a time.
+	struct BankWindow {
+		// The first address of the window. Must be a multiple of BusPageSize and outside the register page.
+		UINT16 Address;
+		// Bytes in the window, which is also the size of each bank behind it. Must be a multiple of BusPageSize.
+		UINT32 Size;
+		// If Ram is TRUE the banks are the mapper's RAM and the guest can write them.
+		// Else they are MapperSettings::Rom and writes to the window are dropped.
+		BOOL Ram;
+	};
+	struct MapperSettings {
+		Tiny::BankWindow Windows[MaxBankWindows];
+		UINT32 WindowCount;
+		// The read only banks, such as Tiny::Cartridge::GetBanks(). Bank n of a window is the Size bytes starting at
+		// Rom + n * Size. Must outlive the mapper. If Rom == nullptr only RAM windows can be used.
+		const BYTE* Rom;
+		UINT32 RomSize;
+		// Bytes of RAM the mapper allocates for RAM windows, split into banks the same way as Rom. It starts zeroed.
+		UINT32 RamSize;
+	};
+	// Lets a program use more than the 64 KB it can address by switching banks of a larger ROM or RAM store into
+	// windows of the address space. Writing a bank number to a window's bank select register switches its bank in.
+	// Bank numbers past the last bank wrap around. Reading the register returns the bank switched in.
+	// A switch only repoints the window's pages on the bus, so it costs the same few pointer writes for any bank size
+	// and the CPU keeps what it decoded from every bank while it is switched out.
+	// The renderers, GetMemory() and save states see the machine's own memory, so video memory should stay outside
+	// every window and the banks switched in and the RAM banks are not part of a Tiny::SaveState.
+	class Mapper {
+	public:
+		// Maps the bank select registers on bus and switches bank 0 into every window. bus must outlive the mapper.
+		// Throws an EZ::Error if a window isn't whole pages outside the register page, windows overlap or a window has
+		// no bank behind it.
+		Mapper(Tiny::MemoryBus* bus, Tiny::MapperSettings settings);
+		// Switches bank into window exactly as if the guest wrote it to the window's bank select register.
+		void SelectBank(UINT32 window, BYTE bank);
+		// Unmaps the bank select registers and maps every window's pages back to what they were mapped to before the
+		// mapper, so pages which were read only, such as a cartridge's ROM, stay read only.
+		// The RAM banks are freed so see MemoryBus::MapMemory about the CPU running code from them.
+		~Mapper();
+
+		BYTE GetBank(UINT32 window) const;
+		UINT32 GetBankCount(UINT32 window) const;
+		// Returns the RamSize bytes of banked RAM.
+		BYTE* GetRam();
+		Tiny::MapperSettings GetSettings() const;
+
+	private:
+		static BYTE ReadBankSelect(void* context, UINT16 address);
+		static void WriteBankSelect(void* context, UINT16 address, BYTE value);
+
+		Tiny::MemoryBus* _bus;
+		// What each page of the windows was mapped to before the mapper, indexed by page.
+		const BYTE* _previousPages[BusPageCount];
+		BOOL _previousReadOnly[BusPageCount];
+		BYTE* _ram;
+		BYTE _banks[MaxBankWindows];
+		Tiny::MapperSettings _settings;
+	};
+}
\ No newline at end of file
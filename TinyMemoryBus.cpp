@@ -0,0 +1,149 @@
+#include "TinyMemoryBus.h"
+#include "EZError.h"
+#include <algorithm>
+
+Tiny::MemoryBus::MemoryBus(BYTE* memory) {
+	_memory = memory;
+	for (UINT32 page = 0; page < BusPageCount; page++) {
+		_pageMemory[page] = _memory + (page * BusPageSize);
+		_pageFlags[page] = 0;
+	}
+	_mappingGeneration = 0;
+	UpdatePages();
+}
+void Tiny::MemoryBus::MapMmio(UINT16 address, UINT32 size, Tiny::MmioReadCallback read, Tiny::MmioWriteCallback write, void* context) {
+	if (size == 0) {
+		return;
+	}
+	MmioRange range = { address, (std::min)(size, 0x10000u - address), read, write, context };
+	_mmio.push_back(range);
+	UpdatePages();
+}
+void Tiny::MemoryBus::UnmapMmio(UINT16 address) {
+	_mmio.erase(std::remove_if(_mmio.begin(), _mmio.end(), [address](const MmioRange& range) {
+		return range.Address == address;
+	}), _mmio.end());
+	UpdatePages();
+}
+void Tiny::MemoryBus::WatchWrites(UINT16 address, UINT32 size, Tiny::WriteWatchCallback callback, void* context) {
+	if (size == 0) {
+		return;
+	}
+	WatchRange range = { address, (std::min)(size, 0x10000u - address), callback, context };
+	_watches.push_back(range);
+	UpdatePages();
+}
+void Tiny::MemoryBus::UnwatchWrites(Tiny::WriteWatchCallback callback, void* context) {
+	_watches.erase(std::remove_if(_watches.begin(), _watches.end(), [callback, context](const WatchRange& range) {
+		return range.Callback == callback && range.Context == context;
+	}), _watches.end());
+	UpdatePages();
+}
+void Tiny::MemoryBus::MapMemory(UINT16 address, UINT32 size, BYTE* memory) {
+	MapPages(address, size, memory, FALSE);
+}
+void Tiny::MemoryBus::MapRom(UINT16 address, UINT32 size, const BYTE* memory) {
+	// The pages never get a write pointer and WriteSlow drops writes to them so memory is never written.
+	MapPages(address, size, const_cast<BYTE*>(memory), memory != nullptr);
+}
+void Tiny::MemoryBus::MapPages(UINT16 address, UINT32 size, BYTE* memory, BOOL readOnly) {
+	if (address % BusPageSize != 0 || size % BusPageSize != 0 || address + static_cast<UINT64>(size) > 0x10000) {
+		throw EZ::Error("Memory must be mapped in whole pages.");
+	}
+	if (address < BusPageSize && size != 0) {
+		throw EZ::Error("The register page can't be mapped to other memory.");
+	}
+	for (UINT32 page = address / BusPageSize; page < (address + size) / BusPageSize; page++) {
+		UINT32 offset = (page * BusPageSize) - address;
+		_pageMemory[page] = memory != nullptr ? memory + offset : _memory + (page * BusPageSize);
+		_pageFlags[page] = static_cast<BYTE>((_pageFlags[page] & ~ReadOnly) | (readOnly ? ReadOnly : 0));
+		UpdatePage(page);
+	}
+	_mappingGeneration++;
+}
+void Tiny::MemoryBus::UpdatePages() {
+	for (UINT32 page = 0; page < BusPageCount; page++) {
+		_pageFlags[page] &= ReadOnly;
+	}
+	// MMIO pages lose both pointers. Watched pages only lose the write pointer since reading them is plain.
+	for (const MmioRange& range : _mmio) {
+		for (UINT32 page = range.Address / BusPageSize; page <= (range.Address + range.Size - 1) / BusPageSize; page++) {
+			_pageFlags[page] |= ReadHooked | WriteHooked;
+		}
+	}
+	for (const WatchRange& range : _watches) {
+		for (UINT32 page = range.Address / BusPageSize; page <= (range.Address + range.Size - 1) / BusPageSize; page++) {
+			_pageFlags[page] |= WriteHooked;
+		}
+	}
+	for (UINT32 page = 0; page < BusPageCount; page++) {
+		UpdatePage(page);
+	}
+}
+void Tiny::MemoryBus::UpdatePage(UINT32 page) {
+	BYTE flags = _pageFlags[page];
+	_readPages[page] = (flags & ReadHooked) == 0 ? _pageMemory[page] : nullptr;
+	_writePages[page] = (flags & (WriteHooked | ReadOnly)) == 0 ? _pageMemory[page] : nullptr;
+}
+BYTE Tiny::MemoryBus::ReadSlow(UINT16 address) const {
+	// Walk backwards so the range mapped last wins.
+	for (size_t i = _mmio.size(); i > 0; i--) {
+		const MmioRange& range = _mmio[i - 1];
+		if (address - range.Address < range.Size) {
+			return range.Read != nullptr ? range.Read(range.Context, address) : _pageMemory[address >> 8][address & 0xFF];
+		}
+	}
+	return _pageMemory[address >> 8][address & 0xFF];
+}
+BOOL Tiny::MemoryBus::WriteSlow(UINT16 address, BYTE value) {
+	for (size_t i = _mmio.size(); i > 0; i--) {
+		const MmioRange& range = _mmio[i - 1];
+		if (address - range.Address < range.Size) {
+			if (range.Write != nullptr) {
+				range.Write(range.Context, address, value);
+			}
+			return FALSE;
+		}
+	}
+	if ((_pageFlags[address >> 8] & ReadOnly) != 0) {
+		return FALSE;
+	}
+	BYTE& target = _pageMemory[address >> 8][address & 0xFF];
+	BYTE oldValue = target;
+	if (oldValue == value) {
+		return FALSE;
+	}
+	target = value;
+	// Index instead of iterating so a callback which adds or removes watches can't invalidate the loop.
+	for (size_t i = 0; i < _watches.size(); i++) {
+		WatchRange range = _watches[i];
+		if (address - range.Address < range.Size) {
+			range.Callback(range.Context, address, oldValue, value);
+		}
+	}
+	return TRUE;
+}
+Tiny::MemoryBus::~MemoryBus() {
+	_mmio.clear();
+	_watches.clear();
+	_memory = nullptr;
+}
+
+BYTE* Tiny::MemoryBus::GetMemory() {
+	return _memory;
+}
+const BYTE* Tiny::MemoryBus::GetMemory() const {
+	return _memory;
+}
+BOOL Tiny::MemoryBus::IsPageHooked(UINT32 page) const {
+	return _readPages[page] == nullptr || _writePages[page] == nullptr;
+}
+const BYTE* Tiny::MemoryBus::GetPageMemory(UINT32 page) const {
+	return _pageMemory[page];
+}
+BOOL Tiny::MemoryBus::IsPageReadOnly(UINT32 page) const {
+	return (_pageFlags[page] & ReadOnly) != 0;
+}
+UINT64 Tiny::MemoryBus::GetMappingGeneration() const {
+	return _mappingGeneration;
+}
\ No newline at end of file
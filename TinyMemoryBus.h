@@ -0,0 +1,128 @@
+#pragma once
+#include "EZPlatform.h"
+#include <vector>
+
+namespace Tiny {
+	// Pages of the bus. The same 256 bytes Tiny::Machine tracks dirty pages in.
+	constexpr UINT32 BusPageSize = 256;
+	constexpr UINT32 BusPageCount = 0x10000 / BusPageSize;
+	// Called for every read of an address mapped with MapMmio. Returns the byte the reader sees.
+	typedef BYTE(*MmioReadCallback)(void* context, UINT16 address);
+	// Called for every write of an address mapped with MapMmio. Memory behind the address is not changed.
+	typedef void (*MmioWriteCallback)(void* context, UINT16 address, BYTE value);
+	// Called after a write changed a byte inside a range passed to WatchWrites.
+	typedef void (*WriteWatchCallback)(void* context, UINT16 address, BYTE oldValue, BYTE newValue);
+	// Routes the guest's reads and writes of the 16 bit address space.
+	// Every 256 byte page has a read pointer and a write pointer. Pages of plain memory point straight at the start of
+	// the page so the fast path is one table load, a null check and one index into memory.
+	// Pages holding any MMIO address or watched byte get null pointers and every access to them takes the slow path,
+	// which looks the address up in the few ranges mapped on that page. Plain bytes on such a page still act like memory.
+	// Ranges are expected to be few and set up rarely, typically once when a peripheral is attached.
+	// Pages can also be pointed at memory other than the bus's own with MapMemory, which is how Tiny::Mapper swaps
+	// banks in without copying them.
+	// Tiny::Cpu reads and writes the stack straight from the register page of the bus's own memory, so MMIO ranges and
+	// watches there never see stack accesses.
+	class MemoryBus {
+	public:
+		// memory must hold the full 64 KB address space and outlive the bus.
+		MemoryBus(BYTE* memory);
+		// Sends every read and write of size bytes starting at address to read and write instead of memory.
+		// If read == nullptr reads see memory. If write == nullptr writes are dropped.
+		// Ranges mapped later take precedence where they overlap earlier ones.
+		void MapMmio(UINT16 address, UINT32 size, Tiny::MmioReadCallback read, Tiny::MmioWriteCallback write, void* context);
+		// Removes every MMIO range starting at address.
+		void UnmapMmio(UINT16 address);
+		// Calls callback after every write which changes one of size bytes starting at address.
+		// Writes the CPU or the host make through the bus are seen. Writes straight into memory are not.
+		void WatchWrites(UINT16 address, UINT32 size, Tiny::WriteWatchCallback callback, void* context);
+		// Removes every watch using callback and context.
+		void UnwatchWrites(Tiny::WriteWatchCallback callback, void* context);
+		// Points the pages of size bytes starting at address at memory instead of the bus's own memory so the guest sees
+		// memory[0] at address. Only the page pointers change so this costs the same for any amount of memory.
+		// If memory == nullptr the pages see the bus's own memory again. memory must outlive the mapping.
+		// Tiny::Cpu keeps what it decoded from memory after it is unmapped, so memory must not be freed and reused for
+		// other code until the CPU is destroyed or Invalidate was called with the whole address space.
+		// Throws an EZ::Error if address or size isn't a multiple of BusPageSize or the range includes the register page,
+		// which the CPU reaches the stack in directly.
+		void MapMemory(UINT16 address, UINT32 size, BYTE* memory);
+		// The same as MapMemory except writes to the pages are dropped, so memory can be shared read only data such as
+		// the ROM and banks of a Tiny::Cartridge.
+		void MapRom(UINT16 address, UINT32 size, const BYTE* memory);
+		// Returns the byte at address as the guest sees it.
+		BYTE Read(UINT16 address) const;
+		// Writes value to address as the guest would. Returns TRUE if memory changed, which is FALSE for MMIO addresses
+		// and for writes of the byte already there.
+		BOOL Write(UINT16 address, BYTE value);
+		~MemoryBus();
+
+		BYTE* GetMemory();
+		const BYTE* GetMemory() const;
+		// Returns TRUE if any access to page takes the slow path.
+		BOOL IsPageHooked(UINT32 page) const;
+		// Returns the first byte of the memory page sees, which is in GetMemory() unless MapMemory or MapRom moved it.
+		const BYTE* GetPageMemory(UINT32 page) const;
+		// Returns TRUE if page was mapped with MapRom so writes to it are dropped.
+		BOOL IsPageReadOnly(UINT32 page) const;
+		// Returns a number which changes every time MapMemory or MapRom is called, so anything caching what the pages
+		// point at can tell when to look again.
+		UINT64 GetMappingGeneration() const;
+
+	private:
+		struct MmioRange {
+			UINT32 Address;
+			UINT32 Size;
+			Tiny::MmioReadCallback Read;
+			Tiny::MmioWriteCallback Write;
+			void* Context;
+		};
+		struct WatchRange {
+			UINT32 Address;
+			UINT32 Size;
+			Tiny::WriteWatchCallback Callback;
+			void* Context;
+		};
+		// Works out which pages MMIO ranges and watches cover, then points every page at its memory unless it is covered.
+		void UpdatePages();
+		// Points page at _pageMemory unless it is hooked.
+		void UpdatePage(UINT32 page);
+		void MapPages(UINT16 address, UINT32 size, BYTE* memory, BOOL readOnly);
+		BYTE ReadSlow(UINT16 address) const;
+		BOOL WriteSlow(UINT16 address, BYTE value);
+
+		// Bits of _pageFlags.
+		static constexpr BYTE ReadHooked = 1;
+		static constexpr BYTE WriteHooked = 2;
+		static constexpr BYTE ReadOnly = 4;
+
+		// Indexed by address >> 8. Plain pages hold the start of the memory they see and hooked pages hold nullptr.
+		BYTE* _readPages[BusPageCount];
+		BYTE* _writePages[BusPageCount];
+		// The start of the memory each page sees whether it is hooked or not. Pages mapped with MapRom are only read.
+		BYTE* _pageMemory[BusPageCount];
+		BYTE _pageFlags[BusPageCount];
+		BYTE* _memory;
+		UINT64 _mappingGeneration;
+		std::vector<MmioRange> _mmio;
+		std::vector<WatchRange> _watches;
+	};
+}
+
+// These are defined here not in TinyMemoryBus.cpp so the fast path inlines into the CPU loop.
+inline BYTE Tiny::MemoryBus::Read(UINT16 address) const {
+	const BYTE* page = _readPages[address >> 8];
+	if (page != nullptr) {
+		return page[address & 0xFF];
+	}
+	return ReadSlow(address);
+}
+inline BOOL Tiny::MemoryBus::Write(UINT16 address, BYTE value) {
+	BYTE* page = _writePages[address >> 8];
+	if (page != nullptr) {
+		if (page[address & 0xFF] == value) {
+			return FALSE;
+		}
+		page[address & 0xFF] = value;
+		return TRUE;
+	}
+	return WriteSlow(address, value);
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "TinyMovie.h"
+#include "EZCompression.h"
+#include "EZMappedFile.h"
+#include "EZError.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// Movie files start with this header. Every field is little endian.
+// Offset Size
+//  0      8   Magic "TinyMovi"
+//  8      4   MovieVersion
+// 12      4   Header size in bytes. The start state follows the header.
+// 16      4   Frame count
+// 20      4   Compressed inputs size
+// 24      4   Write count
+// 28      4   Start state size
+// 32      8   Final state hash, 0 if the recording was never stopped
+// 40      4   FNV-1a hash of the uncompressed inputs
+// 44      4   Reserved, always 0
+// After the header come the start state in the save state file format, the inputs compressed with EZ::Compress
+// one byte per frame and then every write as a 4 byte frame, a 2 byte address and a 1 byte value.
+constexpr BYTE MovieMagic[8] = { 'T', 'i', 'n', 'y', 'M', 'o', 'v', 'i' };
+constexpr UINT32 MovieHeaderSize = 48;
+constexpr UINT32 MovieWriteSize = 7;
+
+namespace {
+	UINT32 HashInputs(const BYTE* inputs, UINT32 size) {
+		UINT32 hash = 2166136261u;
+		for (UINT32 i = 0; i < size; i++) {
+			hash = (hash ^ inputs[i]) * 16777619u;
+		}
+		return hash;
+	}
+	void WriteLittleEndian(BYTE* destination, UINT64 value, UINT32 size) {
+		for (UINT32 i = 0; i < size; i++) {
+			destination[i] = static_cast<BYTE>(value >> (i * 8));
+		}
+	}
+	UINT64 ReadLittleEndian(const BYTE* source, UINT32 size) {
+		UINT64 value = 0;
+		for (UINT32 i = 0; i < size; i++) {
+			value |= static_cast<UINT64>(source[i]) << (i * 8);
+		}
+		return value;
+	}
+}
+
+Tiny::Movie::Movie() {
+	_startFrameCount = 0;
+	_finalHash = 0;
+	_started = FALSE;
+}
+void Tiny::Movie::StartRecording(Tiny::Machine* machine) {
+	// Copy rather than Capture so a rolling save state the caller keeps of machine stays incremental.
+	_startState.Copy(machine);
+	_startFrameCount = machine->GetFrameCount();
+	_inputs.clear();
+	_writes.clear();
+	_finalHash = 0;
+	_started = TRUE;
+}
+UINT32 Tiny::Movie::PrepareFrame(const Tiny::Machine* machine) {
+	if (!_started) {
+		throw EZ::Error("The movie is not recording.");
+	}
+	UINT64 frameCount = machine->GetFrameCount();
+	if (frameCount < _startFrameCount || frameCount - _startFrameCount > _inputs.size()) {
+		throw EZ::Error("The machine stepped frames the movie did not record.");
+	}
+	UINT32 frame = static_cast<UINT32>(frameCount - _startFrameCount);
+	if (frame < _inputs.size()) {
+		_inputs.resize(frame);
+		while (!_writes.empty() && _writes.back().Frame >= frame) {
+			_writes.pop_back();
+		}
+	}
+	_finalHash = 0;
+	return frame;
+}
+BYTE Tiny::Movie::RecordInput(const Tiny::Machine* machine, BYTE inputs) {
+	PrepareFrame(machine);
+	_inputs.push_back(inputs);
+	return inputs;
+}
+void Tiny::Movie::RecordWrite(Tiny::Machine* machine, UINT16 address, BYTE value) {
+	UINT32 frame = PrepareFrame(machine);
+	_writes.push_back({ frame, address, value });
+	machine->Write(address, value);
+}
+void Tiny::Movie::StopRecording(const Tiny::Machine* machine) {
+	_finalHash = machine->GetStateHash();
+}
+void Tiny::Movie::StartPlayback(Tiny::Machine* machine) const {
+	_startState.Restore(machine);
+}
+void Tiny::Movie::FinishPlayback(Tiny::Machine* machine) const {
+	PlayWrites(machine, _inputs.size());
+}
+BYTE Tiny::Movie::PlayInput(Tiny::Machine* machine) {
+	const Tiny::Movie* movie = machine->GetUserDataAs<const Tiny::Movie>();
+	UINT64 frame = machine->GetFrameCount() - movie->_startFrameCount;
+	movie->PlayWrites(machine, frame);
+	return frame < movie->_inputs.size() ? movie->_inputs[static_cast<size_t>(frame)] : 0;
+}
+void Tiny::Movie::PlayWrites(Tiny::Machine* machine, UINT64 frame) const {
+	if (_writes.empty()) {
+		return;
+	}
+	// Writes are sorted by frame so the ones for this frame are found without scanning the whole movie.
+	std::vector<Tiny::MovieWrite>::const_iterator write = std::lower_bound(_writes.begin(), _writes.end(), frame,
+		[](const Tiny::MovieWrite& write, UINT64 frame) { return write.Frame < frame; });
+	for (; write != _writes.end() && write->Frame == frame; write++) {
+		machine->Write(write->Address, write->Value);
+	}
+}
+BOOL Tiny::Movie::IsFinalState(const Tiny::Machine* machine) const {
+	return _finalHash != 0 && machine->GetStateHash() == _finalHash;
+}
+std::vector<BYTE> Tiny::Movie::Serialize() const {
+	if (!_started) {
+		throw EZ::Error("The movie is empty.");
+	}
+	std::vector<BYTE> startState = _startState.Serialize();
+	UINT32 frameCount = static_cast<UINT32>(_inputs.size());
+	std::vector<BYTE> data(MovieHeaderSize + startState.size() + EZ::GetCompressBound(frameCount) + (_writes.size() * MovieWriteSize));
+	memcpy(data.data() + MovieHeaderSize, startState.data(), startState.size());
+	BYTE* compressed = data.data() + MovieHeaderSize + startState.size();
+	UINT32 compressedSize = EZ::Compress(_inputs.data(), frameCount, compressed);
+	BYTE* writes = compressed + compressedSize;
+	for (const Tiny::MovieWrite& write : _writes) {
+		WriteLittleEndian(writes, write.Frame, 4);
+		WriteLittleEndian(writes + 4, write.Address, 2);
+		writes[6] = write.Value;
+		writes += MovieWriteSize;
+	}
+	data.resize(writes - data.data());
+
+	BYTE* header = data.data();
+	memcpy(header, MovieMagic, sizeof(MovieMagic));
+	WriteLittleEndian(header + 8, MovieVersion, 4);
+	WriteLittleEndian(header + 12, MovieHeaderSize, 4);
+	WriteLittleEndian(header + 16, frameCount, 4);
+	WriteLittleEndian(header + 20, compressedSize, 4);
+	WriteLittleEndian(header + 24, _writes.size(), 4);
+	WriteLittleEndian(header + 28, startState.size(), 4);
+	WriteLittleEndian(header + 32, _finalHash, 8);
+	WriteLittleEndian(header + 40, HashInputs(_inputs.data(), frameCount), 4);
+	WriteLittleEndian(header + 44, 0, 4);
+	return data;
+}
+void Tiny::Movie::Deserialize(const BYTE* data, UINT64 size) {
+	if (size < MovieHeaderSize || memcmp(data, MovieMagic, sizeof(MovieMagic)) != 0) {
+		throw EZ::Error("The data is not a Tiny movie.");
+	}
+	if (ReadLittleEndian(data + 8, 4) != MovieVersion) {
+		throw EZ::Error("The movie is from a different version of Tiny.");
+	}
+	UINT64 headerSize = ReadLittleEndian(data + 12, 4);
+	UINT32 frameCount = static_cast<UINT32>(ReadLittleEndian(data + 16, 4));
+	UINT64 compressedSize = ReadLittleEndian(data + 20, 4);
+	UINT64 writeCount = ReadLittleEndian(data + 24, 4);
+	UINT64 startStateSize = ReadLittleEndian(data + 28, 4);
+	if (headerSize < MovieHeaderSize || headerSize > size || startStateSize > size - headerSize
+		|| compressedSize > size - headerSize - startStateSize || writeCount * MovieWriteSize != size - headerSize - startStateSize - compressedSize) {
+		throw EZ::Error("The movie is corrupt.");
+	}
+	// Everything is read into locals first so a corrupt movie leaves this one alone.
+	Tiny::SaveState startState;
+	startState.Deserialize(data + headerSize, startStateSize);
+	std::vector<BYTE> inputs(frameCount);
+	if (!EZ::Decompress(data + headerSize + startStateSize, static_cast<UINT32>(compressedSize), inputs.data(), frameCount)
+		|| HashInputs(inputs.data(), frameCount) != ReadLittleEndian(data + 40, 4)) {
+		throw EZ::Error("The movie is corrupt.");
+	}
+	std::vector<Tiny::MovieWrite> writes(static_cast<size_t>(writeCount));
+	const BYTE* source = data + headerSize + startStateSize + compressedSize;
+	for (size_t i = 0; i < writes.size(); i++, source += MovieWriteSize) {
+		writes[i] = { static_cast<UINT32>(ReadLittleEndian(source, 4)), static_cast<UINT16>(ReadLittleEndian(source + 4, 2)), source[6] };
+		if (writes[i].Frame > frameCount || (i > 0 && writes[i].Frame < writes[i - 1].Frame)) {
+			throw EZ::Error("The movie is corrupt.");
+		}
+	}
+
+	_startState = startState;
+	_startFrameCount = startState.GetMachineState().FrameCount;
+	_inputs.swap(inputs);
+	_writes.swap(writes);
+	_finalHash = ReadLittleEndian(data + 32, 8);
+	_started = TRUE;
+}
+void Tiny::Movie::Save(LPCSTR filePath) const {
+	std::vector<BYTE> data = Serialize();
+	std::ofstream file(filePath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	file.close();
+	if (file.fail()) {
+		throw EZ::Error("Failed to write the movie file.");
+	}
+}
+void Tiny::Movie::Load(LPCSTR filePath) {
+	EZ::MappedFile file(filePath);
+	if (file.GetData() == nullptr) {
+		throw EZ::Error("The data is not a Tiny movie.");
+	}
+	Deserialize(file.GetData(), file.GetSize());
+}
+Tiny::Movie::~Movie() {
+	_started = FALSE;
+}
+
+UINT32 Tiny::Movie::GetFrameCount() const {
+	return static_cast<UINT32>(_inputs.size());
+}
+BYTE Tiny::Movie::GetInput(UINT32 frame) const {
+	return _inputs[frame];
+}
+const std::vector<Tiny::MovieWrite>& Tiny::Movie::GetWrites() const {
+	return _writes;
+}
+const Tiny::SaveState& Tiny::Movie::GetStartState() const {
+	return _startState;
+}
+UINT64 Tiny::Movie::GetFinalHash() const {
+	return _finalHash;
+}
\ No newline at end of file
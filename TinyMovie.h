@@ -0,0 +1,84 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMachine.h"
+#include "TinySaveState.h"
+#include <vector>
+
+namespace Tiny {
+	// Written into every movie file. Bump it whenever the layout or meaning of anything saved changes.
+	constexpr UINT32 MovieVersion = 1;
+	// A byte the host wrote into memory between two steps while recording.
+	struct MovieWrite {
+		// Index of the frame this write happened before, counting from the first recorded frame.
+		UINT32 Frame;
+		UINT16 Address;
+		BYTE Value;
+	};
+	// A recording of everything which came into a Tiny::Machine from outside: the state it started in, the Inputs
+	// register latched every frame and any bytes the host wrote between steps. The machine itself is deterministic
+	// so replaying a movie into the start state reproduces every frame exactly, and the hash of the final state
+	// proves it did.
+	class Movie {
+	public:
+		Movie();
+		// Forgets anything recorded or loaded before and starts a recording from the current state of machine.
+		void StartRecording(Tiny::Machine* machine);
+		// Records inputs as the Inputs register for the frame machine is about to step and returns inputs.
+		// Call this from an InputCallback, for example return movie->RecordInput(machine, ReadKeyboard()).
+		// If machine went back to a frame which was already recorded, for example by rewinding, everything recorded
+		// from that frame on is dropped first. Throws an EZ::Error if machine is before the recording started or
+		// stepped frames which weren't recorded.
+		BYTE RecordInput(const Tiny::Machine* machine, BYTE inputs);
+		// Writes value to machine and records it so replays write it at the same point between the same steps.
+		// Throws like RecordInput.
+		void RecordWrite(Tiny::Machine* machine, UINT16 address, BYTE value);
+		// Ends the recording at the current state of machine and keeps its hash so replays can be checked.
+		void StopRecording(const Tiny::Machine* machine);
+		// Restores machine to the state the recording started from. Use PlayInput as machine's InputCallback with
+		// this movie as its UserData, Step machine GetFrameCount() times and then call FinishPlayback.
+		// Throws an EZ::Error if nothing was recorded or loaded.
+		void StartPlayback(Tiny::Machine* machine) const;
+		// Makes the writes recorded after the last frame, which no Step is left to make.
+		void FinishPlayback(Tiny::Machine* machine) const;
+		// An InputCallback which replays the movie set as the machine's UserData. Makes the writes recorded before
+		// the frame being stepped and returns the inputs recorded for it. Frames past the end of the movie get 0.
+		static BYTE PlayInput(Tiny::Machine* machine);
+		// Returns TRUE if machine is in the state the recording stopped in. Replays which match after FinishPlayback
+		// went through exactly the same frames as the recording.
+		BOOL IsFinalState(const Tiny::Machine* machine) const;
+		// Returns the movie in the movie file format: a small versioned header, the start state in the save state
+		// file format, the compressed inputs and the writes.
+		std::vector<BYTE> Serialize() const;
+		// Replaces this movie with one in the movie file format.
+		// Throws an EZ::Error and leaves this movie alone if data is from a different MovieVersion or is corrupt.
+		void Deserialize(const BYTE* data, UINT64 size);
+		// Writes Serialize() to filePath. Throws an EZ::Error if the file can't be written.
+		void Save(LPCSTR filePath) const;
+		// Deserializes filePath by mapping it into memory.
+		void Load(LPCSTR filePath);
+		~Movie();
+
+		// Number of frames recorded.
+		UINT32 GetFrameCount() const;
+		// Returns the Inputs register recorded for frame.
+		BYTE GetInput(UINT32 frame) const;
+		const std::vector<Tiny::MovieWrite>& GetWrites() const;
+		const Tiny::SaveState& GetStartState() const;
+		// Returns the hash StopRecording took or 0 if the recording was never stopped.
+		UINT64 GetFinalHash() const;
+
+	private:
+		// Makes the writes recorded before frame.
+		void PlayWrites(Tiny::Machine* machine, UINT64 frame) const;
+		// Returns which frame of the recording machine is about to step and drops anything recorded from it on.
+		UINT32 PrepareFrame(const Tiny::Machine* machine);
+
+		Tiny::SaveState _startState;
+		UINT64 _startFrameCount;
+		std::vector<BYTE> _inputs;
+		// In the order they were made, so sorted by Frame.
+		std::vector<Tiny::MovieWrite> _writes;
+		UINT64 _finalHash;
+		BOOL _started;
+	};
+}
\ No newline at end of file
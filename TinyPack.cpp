@@ -0,0 +1,267 @@
+// TinyPack is the offline half of EZ::AssetPack. It decodes images once at build time into the premultiplied B8G8R8A8
+// layout EZ::BitmapAsset describes and writes them into one pack, so the program loading the pack never decodes anything.
+// It only depends on the portable files so it also builds on Linux, for example:
+// g++ -O2 -std=c++17 TinyPack.cpp EZAssetPack.cpp EZMappedFile.cpp EZClock.cpp EZError.cpp -o TinyPack
+// Usage: TinyPack packFile [name=]imageFile...
+//        TinyPack --list packFile
+// Every image is added under name, or under its file name without the directory and extension if no name is given.
+// Images can be uncompressed 24 or 32 bit BMP files, binary PPM (P6) files or PAM (P7) files with a depth of 3 or 4.
+// 32 bit BMP files are only read as having alpha if their header has an alpha mask. Everything else is straight alpha.
+// --list opens a pack the way a program would, prints every bitmap in it and how long opening it took.
+
+#include "EZAssetPack.h"
+#include "EZMappedFile.h"
+#include "EZClock.h"
+#include "EZError.h"
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Image {
+	UINT32 Width;
+	UINT32 Height;
+	// Width * Height straight alpha R8G8B8A8 pixels, top row first.
+	std::vector<BYTE> Pixels;
+};
+
+UINT32 ReadLittleEndian(const BYTE* source, UINT32 size) {
+	UINT32 value = 0;
+	for (UINT32 i = 0; i < size; i++) {
+		value |= static_cast<UINT32>(source[i]) << (i * 8);
+	}
+	return value;
+}
+
+// Scales the bits of pixel selected by mask to 0 - 255. A mask of 0 reads as fullValue.
+BYTE ReadMaskedChannel(UINT32 pixel, UINT32 mask, BYTE fullValue) {
+	if (mask == 0) {
+		return fullValue;
+	}
+	UINT32 shift = 0;
+	while (((mask >> shift) & 1) == 0) {
+		shift++;
+	}
+	UINT64 maximum = mask >> shift;
+	return static_cast<BYTE>(((((pixel & mask) >> shift) * 255ull) + (maximum / 2)) / maximum);
+}
+
+Image DecodeBmp(const BYTE* data, UINT64 size) {
+	if (size < 54 || data[0] != 'B' || data[1] != 'M') {
+		throw EZ::Error("The BMP file is corrupt.");
+	}
+	UINT32 pixelOffset = ReadLittleEndian(data + 10, 4);
+	UINT32 infoSize = ReadLittleEndian(data + 14, 4);
+	INT32 width = static_cast<INT32>(ReadLittleEndian(data + 18, 4));
+	INT32 height = static_cast<INT32>(ReadLittleEndian(data + 22, 4));
+	UINT32 bitCount = ReadLittleEndian(data + 28, 2);
+	UINT32 compression = ReadLittleEndian(data + 30, 4);
+	// BI_RGB is 0 and BI_BITFIELDS is 3. Anything else is compressed or palletized.
+	if (infoSize < 40 || width <= 0 || height == 0 || height == INT32_MIN || (bitCount != 24 && bitCount != 32)
+		|| (compression != 0 && !(compression == 3 && bitCount == 32))) {
+		throw EZ::Error("Only uncompressed 24 and 32 bit BMP files are supported.");
+	}
+	UINT32 redMask = 0x00FF0000;
+	UINT32 greenMask = 0x0000FF00;
+	UINT32 blueMask = 0x000000FF;
+	UINT32 alphaMask = 0;
+	if (compression == 3) {
+		// The masks are either part of a V4 or V5 header or follow a plain 40 byte header.
+		if (14 + 40 + 12 > size) {
+			throw EZ::Error("The BMP file is corrupt.");
+		}
+		redMask = ReadLittleEndian(data + 54, 4);
+		greenMask = ReadLittleEndian(data + 58, 4);
+		blueMask = ReadLittleEndian(data + 62, 4);
+		if (infoSize >= 56 && 14 + 56 <= size) {
+			alphaMask = ReadLittleEndian(data + 66, 4);
+		}
+	}
+
+	Image image = { };
+	image.Width = static_cast<UINT32>(width);
+	// A negative height means rows are stored top first instead of bottom first.
+	BOOL topDown = height < 0;
+	image.Height = static_cast<UINT32>(topDown ? -height : height);
+	UINT64 rowBytes = ((static_cast<UINT64>(image.Width) * bitCount + 31) / 32) * 4;
+	if (pixelOffset > size || rowBytes * image.Height > size - pixelOffset) {
+		throw EZ::Error("The BMP file is corrupt.");
+	}
+	image.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+	for (UINT32 y = 0; y < image.Height; y++) {
+		const BYTE* row = data + pixelOffset + (rowBytes * (topDown ? y : image.Height - 1 - y));
+		BYTE* destination = image.Pixels.data() + (static_cast<size_t>(y) * image.Width * 4);
+		for (UINT32 x = 0; x < image.Width; x++) {
+			if (bitCount == 24) {
+				destination[0] = row[2];
+				destination[1] = row[1];
+				destination[2] = row[0];
+				destination[3] = 255;
+				row += 3;
+			}
+			else {
+				UINT32 pixel = ReadLittleEndian(row, 4);
+				destination[0] = ReadMaskedChannel(pixel, redMask, 0);
+				destination[1] = ReadMaskedChannel(pixel, greenMask, 0);
+				destination[2] = ReadMaskedChannel(pixel, blueMask, 0);
+				destination[3] = ReadMaskedChannel(pixel, alphaMask, 255);
+				row += 4;
+			}
+			destination += 4;
+		}
+	}
+	return image;
+}
+
+// Reads the next whitespace separated token of a Netpbm header, skipping # comments.
+std::string ReadToken(const BYTE* data, UINT64 size, UINT64* position) {
+	while (*position < size) {
+		if (data[*position] == '#') {
+			while (*position < size && data[*position] != '\n') {
+				(*position)++;
+			}
+		}
+		else if (isspace(data[*position])) {
+			(*position)++;
+		}
+		else {
+			break;
+		}
+	}
+	std::string token;
+	while (*position < size && !isspace(data[*position])) {
+		token += static_cast<char>(data[*position]);
+		(*position)++;
+	}
+	return token;
+}
+UINT32 ReadNumber(const std::string& token) {
+	if (token.empty() || token.size() > 9 || token.find_first_not_of("0123456789") != std::string::npos) {
+		throw EZ::Error("The PPM or PAM header is corrupt.");
+	}
+	return static_cast<UINT32>(std::stoul(token));
+}
+
+Image DecodeNetpbm(const BYTE* data, UINT64 size) {
+	UINT64 position = 2;
+	UINT32 width = 0;
+	UINT32 height = 0;
+	UINT32 depth = 3;
+	UINT32 maximum = 0;
+	if (data[1] == '6') {
+		width = ReadNumber(ReadToken(data, size, &position));
+		height = ReadNumber(ReadToken(data, size, &position));
+		maximum = ReadNumber(ReadToken(data, size, &position));
+	}
+	else {
+		depth = 0;
+		while (true) {
+			std::string key = ReadToken(data, size, &position);
+			if (key == "ENDHDR" || key.empty()) {
+				break;
+			}
+			if (key == "TUPLTYPE") {
+				ReadToken(data, size, &position);
+				continue;
+			}
+			UINT32 value = ReadNumber(ReadToken(data, size, &position));
+			if (key == "WIDTH") { width = value; }
+			else if (key == "HEIGHT") { height = value; }
+			else if (key == "DEPTH") { depth = value; }
+			else if (key == "MAXVAL") { maximum = value; }
+		}
+	}
+	// Exactly one whitespace byte separates the header from the pixels.
+	position++;
+	if (width == 0 || height == 0 || maximum != 255 || (depth != 3 && depth != 4)) {
+		throw EZ::Error("Only 8 bit PPM and PAM files with 3 or 4 channels are supported.");
+	}
+	UINT64 pixelCount = static_cast<UINT64>(width) * height;
+	if (position > size || pixelCount * depth > size - position) {
+		throw EZ::Error("The PPM or PAM file is corrupt.");
+	}
+	Image image = { };
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.resize(static_cast<size_t>(pixelCount) * 4);
+	const BYTE* source = data + position;
+	for (UINT64 i = 0; i < pixelCount; i++) {
+		image.Pixels[(i * 4) + 0] = source[0];
+		image.Pixels[(i * 4) + 1] = source[1];
+		image.Pixels[(i * 4) + 2] = source[2];
+		image.Pixels[(i * 4) + 3] = depth == 4 ? source[3] : 255;
+		source += depth;
+	}
+	return image;
+}
+
+Image DecodeImage(LPCSTR filePath) {
+	EZ::MappedFile file(filePath);
+	const BYTE* data = file.GetData();
+	UINT64 size = file.GetSize();
+	if (size >= 2 && data[0] == 'B' && data[1] == 'M') {
+		return DecodeBmp(data, size);
+	}
+	if (size >= 2 && data[0] == 'P' && (data[1] == '6' || data[1] == '7')) {
+		return DecodeNetpbm(data, size);
+	}
+	throw EZ::Error("Images must be BMP, PPM or PAM files.");
+}
+
+// Returns the file name of filePath without its directory or extension.
+std::string AssetName(const std::string& filePath) {
+	size_t start = filePath.find_last_of("/\\");
+	start = start == std::string::npos ? 0 : start + 1;
+	size_t end = filePath.find_last_of('.');
+	if (end == std::string::npos || end < start) {
+		end = filePath.size();
+	}
+	return filePath.substr(start, end - start);
+}
+
+int List(LPCSTR packPath) {
+	UINT64 start = EZ::GetNanoseconds();
+	EZ::AssetPack pack(packPath);
+	std::vector<EZ::BitmapAsset> bitmaps;
+	for (UINT32 i = 0; i < pack.GetAssetCount(); i++) {
+		bitmaps.push_back(pack.GetBitmap(i));
+	}
+	UINT64 nanoseconds = EZ::GetNanoseconds() - start;
+	for (UINT32 i = 0; i < pack.GetAssetCount(); i++) {
+		std::cout << pack.GetName(i) << " " << bitmaps[i].Width << "x" << bitmaps[i].Height << std::endl;
+	}
+	std::cout << "Opened " << pack.GetAssetCount() << " bitmaps in " << (nanoseconds / 1000.0) << " microseconds" << std::endl;
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cout << "Usage: TinyPack packFile [name=]imageFile..." << std::endl;
+		std::cout << "       TinyPack --list packFile" << std::endl;
+		return 1;
+	}
+	try {
+		if (strcmp(argv[1], "--list") == 0) {
+			return List(argv[2]);
+		}
+		EZ::AssetPackWriter writer;
+		for (int i = 2; i < argc; i++) {
+			std::string argument = argv[i];
+			size_t equals = argument.find('=');
+			std::string name = equals == std::string::npos ? AssetName(argument) : argument.substr(0, equals);
+			std::string filePath = equals == std::string::npos ? argument : argument.substr(equals + 1);
+			Image image = DecodeImage(filePath.c_str());
+			EZ::PremultiplyRGBA(image.Pixels.data(), image.Pixels.data(), image.Width * image.Height);
+			writer.AddBitmap(name.c_str(), { image.Width, image.Height, image.Pixels.data() });
+		}
+		writer.Save(argv[1]);
+		std::cout << "Packed " << writer.GetAssetCount() << " bitmaps into " << argv[1] << std::endl;
+	}
+	catch (EZ::Error& error) {
+		error.PrintAndFree();
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
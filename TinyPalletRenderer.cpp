@@ -0,0 +1,45 @@
+#include "TinyPalletRenderer.h"
+#include "TinyKernels.h"
+#include <cstring>
+
+Tiny::PalletRenderer::PalletRenderer() {
+	memset(_pallet, 0, sizeof(_pallet));
+	memset(_palletShadow, 0, sizeof(_palletShadow));
+	_palletValid = FALSE;
+	_palletRebuildCount = 0;
+}
+Tiny::DirtyRows Tiny::PalletRenderer::Render(const BYTE* memory, BYTE* frameBuffer, UINT32 stride, Tiny::DirtyRows rows, BOOL checkPallet) {
+	if ((checkPallet || !_palletValid) && UpdatePallet(memory)) {
+		// Every pixel may use a color which just changed.
+		rows = AllDirtyRows;
+	}
+
+	const BYTE* pixels = memory + PalletPixelAddress;
+	if (stride == ScreenWidth * 4) {
+		Tiny::UnpackPallet(pixels + (rows.Top * PalletRowBytes), _pallet, frameBuffer + (rows.Top * stride), ScreenWidth * (rows.Bottom - rows.Top));
+		return rows;
+	}
+	for (UINT32 y = rows.Top; y < rows.Bottom; y++) {
+		Tiny::UnpackPallet(pixels + (y * PalletRowBytes), _pallet, frameBuffer + (y * stride), ScreenWidth);
+	}
+	return rows;
+}
+BOOL Tiny::PalletRenderer::UpdatePallet(const BYTE* memory) {
+	// Comparing 192 bytes is far cheaper than re-expanding the pallet every frame.
+	const BYTE* pallet = memory + PalletAddress;
+	if (_palletValid && memcmp(pallet, _palletShadow, PalletBytes) == 0) {
+		return FALSE;
+	}
+	memcpy(_palletShadow, pallet, PalletBytes);
+	Tiny::ExpandPallet(pallet, _pallet);
+	_palletValid = TRUE;
+	_palletRebuildCount++;
+	return TRUE;
+}
+Tiny::PalletRenderer::~PalletRenderer() {
+	_palletValid = FALSE;
+}
+
+UINT64 Tiny::PalletRenderer::GetPalletRebuildCount() const {
+	return _palletRebuildCount;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyVideo.h"
+
+namespace Tiny {
+	// Rasterizes VideoMode::BitmapWithPallet.
+	// The R8G8B8 pallet is kept pre-expanded to B8G8R8A8 and is only rebuilt when the pallet bytes in memory change.
+	class PalletRenderer {
+	public:
+		PalletRenderer();
+		// memory is the full 64 KB of guest memory. frameBuffer and stride work like Tiny::Machine::Render.
+		// Only the given rows are converted unless the pallet changed, in which case every row is.
+		// If checkPallet == FALSE the pallet bytes are assumed to be unchanged and aren't compared.
+		// Returns the rows which were actually converted.
+		Tiny::DirtyRows Render(const BYTE* memory, BYTE* frameBuffer, UINT32 stride, Tiny::DirtyRows rows, BOOL checkPallet);
+		~PalletRenderer();
+
+		UINT64 GetPalletRebuildCount() const;
+
+	private:
+		// Rebuilds _pallet if the pallet bytes in memory are different than the last time it was built.
+		// Returns TRUE if the pallet was rebuilt.
+		BOOL UpdatePallet(const BYTE* memory);
+
+		UINT32 _pallet[PalletColorCount];
+		BYTE _palletShadow[PalletBytes];
+		BOOL _palletValid;
+		UINT64 _palletRebuildCount;
+	};
+}
\ No newline at end of file
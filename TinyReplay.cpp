@@ -0,0 +1,134 @@
+// TinyReplay plays a Tiny::Movie back headless as fast as the machine can go and checks it ends in the recorded state.
+// It is the performance regression workload: the same frames every build, timed exactly, with a hash proving the
+// emulation didn't change. It only depends on the portable files so it also builds on Linux, for example:
+// g++ -O2 -std=c++17 -pthread TinyReplay.cpp TinyMovie.cpp TinyWorkload.cpp TinySaveState.cpp TinyMachine.cpp TinyCartridge.cpp TinyPalletRenderer.cpp TinyTileRenderer.cpp TinySpriteRenderer.cpp TinyCpu.cpp TinyMemoryBus.cpp EZThreadPool.cpp TinyKernels.cpp EZCpu.cpp EZClock.cpp EZProfiler.cpp EZCompression.cpp EZMappedFile.cpp EZError.cpp -o TinyReplay
+// Usage: TinyReplay [movieFile]
+//        TinyReplay --record movieFile [frames]
+// With no arguments the standard workload movie is recorded in memory and replayed.
+// --record writes the standard workload movie, DefaultFrameCount frames long unless frames is given.
+// Replays print the time taken, the frames per second and the final state hash and
+// exit with 1 if the replay didn't end in the recorded state.
+
+#include "TinyMovie.h"
+#include "TinyWorkload.h"
+#include "EZProfiler.h"
+#include "EZError.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+constexpr UINT32 DefaultFrameCount = 100000;
+// The workload switches video mode this often so every renderer is part of it.
+constexpr UINT32 VideoModeSwitchInterval = 25000;
+
+struct Recording {
+	Tiny::Movie* Movie;
+	UINT32 InputState;
+};
+
+// Records a deterministic pseudo random input byte every frame.
+BYTE RecordScriptedInput(Tiny::Machine* machine) {
+	Recording* recording = machine->GetUserDataAs<Recording>();
+	recording->InputState ^= recording->InputState << 13;
+	recording->InputState ^= recording->InputState >> 17;
+	recording->InputState ^= recording->InputState << 5;
+	return recording->Movie->RecordInput(machine, static_cast<BYTE>(recording->InputState));
+}
+
+// Records the standard workload: Tiny::LoadWorkload with scripted inputs, switching video mode
+// through SysFlags every VideoModeSwitchInterval frames.
+Tiny::Movie* RecordWorkload(UINT32 frameCount) {
+	Tiny::Movie* movie = new Tiny::Movie();
+	Recording recording = { movie, 0x12345678 };
+	Tiny::MachineSettings machineSettings = { };
+	machineSettings.UserData = &recording;
+	machineSettings.InputCallback = RecordScriptedInput;
+	Tiny::Machine* machine = new Tiny::Machine(machineSettings);
+	Tiny::LoadWorkload(machine);
+
+	movie->StartRecording(machine);
+	for (UINT32 i = 0; i < frameCount; i++) {
+		if (i % VideoModeSwitchInterval == 0) {
+			movie->RecordWrite(machine, Tiny::SysFlagsAddress, static_cast<BYTE>((i / VideoModeSwitchInterval) & Tiny::VideoModeMask));
+		}
+		machine->Step();
+	}
+	movie->StopRecording(machine);
+	delete machine;
+	return movie;
+}
+
+// Replays movie rendering every frame and prints how fast it went. Returns TRUE if it ended in the recorded state.
+BOOL Replay(const Tiny::Movie* movie) {
+	Tiny::MachineSettings machineSettings = { };
+	machineSettings.UserData = const_cast<Tiny::Movie*>(movie);
+	machineSettings.InputCallback = Tiny::Movie::PlayInput;
+	Tiny::Machine* machine = new Tiny::Machine(machineSettings);
+	BYTE* frameBuffer = new BYTE[Tiny::FrameBufferSize];
+	EZ::Profiler* profiler = new EZ::Profiler(0);
+
+	movie->StartPlayback(machine);
+	UINT32 frameCount = movie->GetFrameCount();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (UINT32 i = 0; i < frameCount; i++) {
+		machine->Step();
+		machine->Render(frameBuffer, Tiny::ScreenWidth * 4);
+		profiler->Tick();
+	}
+	movie->FinishPlayback(machine);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	BOOL matched = movie->IsFinalState(machine);
+	std::cout << "Frames: " << frameCount << " Seconds: " << seconds << " FPS: " << (frameCount / seconds) << std::endl;
+	std::cout << "Final state hash: " << std::hex << machine->GetStateHash() << " recorded: " << movie->GetFinalHash() << std::dec << std::endl;
+	std::cout << "Determinism: " << (matched ? "ok" : "FAILED, the replay ended in a different state") << std::endl;
+	profiler->PrintReport();
+
+	delete profiler;
+	delete[] frameBuffer;
+	delete machine;
+	return matched;
+}
+
+int main(int argc, char** argv) {
+	Tiny::Movie* movie = nullptr;
+	try {
+		if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+			if (argc < 3) {
+				EZ::Error("--record needs a movie file.").PrintAndFree();
+				return 1;
+			}
+			UINT32 frameCount = DefaultFrameCount;
+			if (argc > 3) {
+				frameCount = static_cast<UINT32>(strtoul(argv[3], nullptr, 10));
+			}
+			if (frameCount == 0) {
+				EZ::Error("frames must be a positive integer.").PrintAndFree();
+				return 1;
+			}
+			movie = RecordWorkload(frameCount);
+			movie->Save(argv[2]);
+			std::cout << "Recorded " << frameCount << " frames. Final state hash: " << std::hex << movie->GetFinalHash() << std::dec << std::endl;
+			delete movie;
+			return 0;
+		}
+		if (argc > 1) {
+			movie = new Tiny::Movie();
+			movie->Load(argv[1]);
+		}
+		else {
+			movie = RecordWorkload(DefaultFrameCount);
+		}
+	}
+	catch (EZ::Error& error) {
+		error.PrintAndFree();
+		delete movie;
+		return 1;
+	}
+
+	BOOL matched = Replay(movie);
+	delete movie;
+	return matched ? 0 : 1;
+}
\ No newline at end of file
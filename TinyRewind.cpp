@@ -0,0 +1,188 @@
+#include "TinyRewind.h"
+#include "EZCompression.h"
+#include "EZClock.h"
+#include "EZError.h"
+#include <cstring>
+
+namespace {
+	void XorInto(BYTE* destination, const BYTE* source, UINT32 size) {
+		// 8 bytes at a time. The compiler turns this into vector instructions.
+		UINT32 i = 0;
+		for (; i + 8 <= size; i += 8) {
+			UINT64 a;
+			UINT64 b;
+			memcpy(&a, destination + i, sizeof(a));
+			memcpy(&b, source + i, sizeof(b));
+			a ^= b;
+			memcpy(destination + i, &a, sizeof(a));
+		}
+		for (; i < size; i++) {
+			destination[i] ^= source[i];
+		}
+	}
+}
+
+Tiny::RewindBuffer::RewindBuffer(Tiny::RewindSettings settings) {
+	_settings = settings;
+	if (_settings.CapacityBytes == 0) {
+		_settings.CapacityBytes = DefaultRewindCapacityBytes;
+	}
+	if (_settings.CapacityBytes < 4 * EZ::GetCompressBound(MemorySize)) {
+		_settings.CapacityBytes = 4 * EZ::GetCompressBound(MemorySize);
+	}
+	if (_settings.KeyframeInterval == 0) {
+		_settings.KeyframeInterval = DefaultKeyframeInterval;
+	}
+	_buffer.resize(_settings.CapacityBytes);
+	_newest.resize(MemorySize);
+	_scratch.resize(MemorySize);
+	_compressedDelta.resize(EZ::GetCompressBound(MemorySize));
+	_compressedKeyframe.resize(EZ::GetCompressBound(MemorySize));
+	_pushesSinceKeyframe = 0;
+	_stats = { };
+}
+void Tiny::RewindBuffer::Push(const Tiny::Machine* machine) {
+	UINT64 start = EZ::GetNanoseconds();
+	const BYTE* memory = machine->GetMemory();
+	UINT32 deltaSize = 0;
+	if (!_entries.empty()) {
+		memcpy(_scratch.data(), memory, MemorySize);
+		XorInto(_scratch.data(), _newest.data(), MemorySize);
+		deltaSize = EZ::Compress(_scratch.data(), MemorySize, _compressedDelta.data());
+	}
+	UINT32 keyframeSize = 0;
+	if (_entries.empty() || _pushesSinceKeyframe + 1 >= _settings.KeyframeInterval) {
+		keyframeSize = EZ::Compress(memory, MemorySize, _compressedKeyframe.data());
+	}
+
+	UINT32 offset = Reserve(deltaSize + keyframeSize);
+	memcpy(_buffer.data() + offset, _compressedDelta.data(), deltaSize);
+	memcpy(_buffer.data() + offset + deltaSize, _compressedKeyframe.data(), keyframeSize);
+	_entries.push_back({ offset, deltaSize, keyframeSize, machine->GetState() });
+	memcpy(_newest.data(), memory, MemorySize);
+
+	if (keyframeSize != 0) {
+		_pushesSinceKeyframe = 0;
+		_stats.Keyframes++;
+	}
+	else {
+		_pushesSinceKeyframe++;
+	}
+	_stats.Pushes++;
+	_stats.BytesUsed += deltaSize + keyframeSize;
+	_stats.UncompressedBytes += MemorySize;
+	_stats.CompressedBytes += deltaSize + keyframeSize;
+	UINT64 elapsed = EZ::GetNanoseconds() - start;
+	_stats.PushNanoseconds += elapsed;
+	if (elapsed > _stats.MaxPushNanoseconds) {
+		_stats.MaxPushNanoseconds = elapsed;
+	}
+}
+BOOL Tiny::RewindBuffer::Pop(Tiny::Machine* machine, UINT32 count) {
+	if (_entries.empty() || count == 0) {
+		return FALSE;
+	}
+	UINT64 start = EZ::GetNanoseconds();
+	if (count > _entries.size()) {
+		count = static_cast<UINT32>(_entries.size());
+	}
+	size_t target = _entries.size() - count;
+
+	// Walking back from the newest state takes count - 1 deltas. Starting at the nearest keyframe at or before
+	// target takes one keyframe and then target - keyframe deltas. Take whichever is less work.
+	size_t keyframe = target;
+	while (keyframe > 0 && _entries[keyframe].KeyframeSize == 0 && target - keyframe < count) {
+		keyframe--;
+	}
+	const Entry& keyframeEntry = _entries[keyframe];
+	if (keyframeEntry.KeyframeSize != 0 && target - keyframe + 1 < count - 1) {
+		Decode(keyframeEntry.Offset + keyframeEntry.DeltaSize, keyframeEntry.KeyframeSize);
+		memcpy(_newest.data(), _scratch.data(), MemorySize);
+		for (size_t i = keyframe + 1; i <= target; i++) {
+			Decode(_entries[i].Offset, _entries[i].DeltaSize);
+			XorInto(_newest.data(), _scratch.data(), MemorySize);
+		}
+	}
+	else {
+		for (size_t i = _entries.size() - 1; i > target; i--) {
+			Decode(_entries[i].Offset, _entries[i].DeltaSize);
+			XorInto(_newest.data(), _scratch.data(), MemorySize);
+		}
+	}
+	machine->WriteRange(0, _newest.data(), MemorySize);
+	machine->SetState(_entries[target].MachineState);
+
+	// Step _newest back once more to the state which is newest after the pop.
+	if (target > 0) {
+		Decode(_entries[target].Offset, _entries[target].DeltaSize);
+		XorInto(_newest.data(), _scratch.data(), MemorySize);
+	}
+	while (_entries.size() > target) {
+		_stats.BytesUsed -= _entries.back().DeltaSize + _entries.back().KeyframeSize;
+		_entries.pop_back();
+	}
+	// Count from the keyframe the newest entry belongs to so keyframes stay KeyframeInterval apart.
+	_pushesSinceKeyframe = 0;
+	for (size_t i = _entries.size(); i > 0 && _entries[i - 1].KeyframeSize == 0 && _pushesSinceKeyframe < _settings.KeyframeInterval; i--) {
+		_pushesSinceKeyframe++;
+	}
+
+	_stats.Pops += count;
+	UINT64 elapsed = EZ::GetNanoseconds() - start;
+	_stats.PopNanoseconds += elapsed;
+	if (elapsed > _stats.MaxPopNanoseconds) {
+		_stats.MaxPopNanoseconds = elapsed;
+	}
+	return TRUE;
+}
+UINT32 Tiny::RewindBuffer::Reserve(UINT32 size) {
+	UINT32 offset = 0;
+	if (!_entries.empty()) {
+		const Entry& newest = _entries.back();
+		offset = newest.Offset + newest.DeltaSize + newest.KeyframeSize;
+	}
+	// Entries sit in the buffer oldest to newest going around the ring, so the entries just past the newest one
+	// are the oldest. If the new entry doesn't fit before the end of the buffer it goes at the start instead
+	// and everything between the newest entry and the end is older than what is at the start so it goes first.
+	if (offset + size > _settings.CapacityBytes) {
+		while (!_entries.empty() && _entries.front().Offset >= offset) {
+			Evict();
+		}
+		offset = 0;
+	}
+	while (!_entries.empty()) {
+		const Entry& oldest = _entries.front();
+		if (oldest.Offset >= offset + size || offset >= oldest.Offset + oldest.DeltaSize + oldest.KeyframeSize) {
+			break;
+		}
+		Evict();
+	}
+	return offset;
+}
+void Tiny::RewindBuffer::Evict() {
+	_stats.BytesUsed -= _entries.front().DeltaSize + _entries.front().KeyframeSize;
+	_stats.Evictions++;
+	_entries.pop_front();
+}
+void Tiny::RewindBuffer::Decode(UINT32 offset, UINT32 size) {
+	if (!EZ::Decompress(_buffer.data() + offset, size, _scratch.data(), MemorySize)) {
+		throw EZ::Error("Rewind history is corrupt.");
+	}
+}
+void Tiny::RewindBuffer::Clear() {
+	_entries.clear();
+	_pushesSinceKeyframe = 0;
+	_stats.BytesUsed = 0;
+}
+Tiny::RewindBuffer::~RewindBuffer() {
+	_entries.clear();
+}
+
+Tiny::RewindStats Tiny::RewindBuffer::GetStats() const {
+	Tiny::RewindStats stats = _stats;
+	stats.EntryCount = static_cast<UINT32>(_entries.size());
+	return stats;
+}
+Tiny::RewindSettings Tiny::RewindBuffer::GetSettings() const {
+	return _settings;
+}
\ No newline at end of file
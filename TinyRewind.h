@@ -0,0 +1,92 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMachine.h"
+#include <deque>
+#include <vector>
+
+namespace Tiny {
+	// 4MB holds minutes of typical frames since most frames change a few hundred bytes.
+	constexpr UINT32 DefaultRewindCapacityBytes = 4 * 1024 * 1024;
+	// One full state per second at 60 steps per second.
+	constexpr UINT32 DefaultKeyframeInterval = 60;
+	struct RewindSettings {
+		// The most bytes of compressed history kept. Once full the oldest history is dropped to make room.
+		// If CapacityBytes == 0 then DefaultRewindCapacityBytes is used. Anything below 4 * EZ::GetCompressBound(MemorySize), room for two entries
+		// which each hold a worst case compressed delta and keyframe, is raised to that.
+		UINT32 CapacityBytes;
+		// Every KeyframeInterval pushes the full state is stored along with the delta.
+		// Jumping back any number of states decodes at most this many deltas.
+		// If KeyframeInterval == 0 then DefaultKeyframeInterval is used.
+		UINT32 KeyframeInterval;
+	};
+	struct RewindStats {
+		UINT64 Pushes;
+		// Number of states removed by Pop.
+		UINT64 Pops;
+		UINT64 Keyframes;
+		// Number of states dropped to stay within CapacityBytes.
+		UINT64 Evictions;
+		// States held right now and the bytes of the buffer they use.
+		UINT32 EntryCount;
+		UINT32 BytesUsed;
+		// Bytes of memory pushed and the bytes they compressed to. Their ratio is how well history compresses.
+		UINT64 UncompressedBytes;
+		UINT64 CompressedBytes;
+		// Time spent in Push and Pop in total and the longest single call.
+		UINT64 PushNanoseconds;
+		UINT64 MaxPushNanoseconds;
+		UINT64 PopNanoseconds;
+		UINT64 MaxPopNanoseconds;
+	};
+	// Keeps the recent history of a Tiny::Machine in a fixed amount of memory so it can be played backwards.
+	// Each state is stored as the XOR of its memory with the state before it, which is zero almost everywhere,
+	// compressed with EZ::Compress. XOR undoes itself so the newest state steps back one delta at a time and
+	// popping one state costs one small decompress no matter how much history there is.
+	// Every KeyframeInterval states also keep their full memory so jumping far back starts from the nearest keyframe
+	// and decodes at most KeyframeInterval deltas instead of walking back through every state in between.
+	class RewindBuffer {
+	public:
+		RewindBuffer(Tiny::RewindSettings settings);
+		// Stores the current state of machine as the newest state.
+		void Push(const Tiny::Machine* machine);
+		// Removes the newest count states and restores the oldest of those to machine, so Pop(machine) restores
+		// the state last pushed and Pop(machine, 60) goes back 60 states at once. Only pages which differ are written
+		// so Render only redraws what changed. If fewer than count states are held the oldest one is restored.
+		// Returns FALSE and leaves machine alone if there is no history left.
+		BOOL Pop(Tiny::Machine* machine, UINT32 count = 1);
+		// Drops all history.
+		void Clear();
+		~RewindBuffer();
+
+		Tiny::RewindStats GetStats() const;
+		Tiny::RewindSettings GetSettings() const;
+
+	private:
+		struct Entry {
+			// Where the compressed bytes are in _buffer. The delta against the state before comes first and
+			// is empty for the first state pushed. A keyframe's full memory follows it.
+			UINT32 Offset;
+			UINT32 DeltaSize;
+			UINT32 KeyframeSize;
+			Tiny::MachineState MachineState;
+		};
+		// Makes room for size bytes after the newest entry by dropping the oldest entries.
+		// Returns the offset the new entry goes at.
+		UINT32 Reserve(UINT32 size);
+		// Drops the oldest entry.
+		void Evict();
+		// Decompresses size bytes at offset in _buffer into _scratch.
+		void Decode(UINT32 offset, UINT32 size);
+
+		Tiny::RewindSettings _settings;
+		std::vector<BYTE> _buffer;
+		std::deque<Entry> _entries;
+		// Memory of the newest entry, which deltas are taken against and undone from.
+		std::vector<BYTE> _newest;
+		std::vector<BYTE> _scratch;
+		std::vector<BYTE> _compressedDelta;
+		std::vector<BYTE> _compressedKeyframe;
+		UINT32 _pushesSinceKeyframe;
+		Tiny::RewindStats _stats;
+	};
+}
\ No newline at end of file
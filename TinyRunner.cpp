@@ -0,0 +1,223 @@
+// TinyRunner steps a Tiny::Machine without a window or renderer and reports how fast it went.
+// It only depends on the portable files so it also builds on Linux, for example:
+// g++ -O2 -std=c++17 -pthread TinyRunner.cpp TinyMachine.cpp TinyCartridge.cpp TinyPalletRenderer.cpp TinyTileRenderer.cpp TinySpriteRenderer.cpp TinyCpu.cpp TinyMemoryBus.cpp TinyAudio.cpp TinyInput.cpp EZAudio.cpp EZThreadPool.cpp TinyKernels.cpp EZCpu.cpp EZClock.cpp EZFrameScheduler.cpp EZProfiler.cpp EZMappedFile.cpp EZError.cpp -o TinyRunner
+// Usage: TinyRunner [frames] [videoMode] [framerate] [traceFile] [wavFile]
+// videoMode is the number written to the VideoMode bits of SysFlags. See TinyEmulator.txt.
+// If framerate is given the frames are paced by an EZ::FrameScheduler the way EZ::Program paces them
+// and the measured frame time jitter is reported. Else frames run as fast as possible. A framerate of 0 means as fast as possible too.
+// Percentiles of the frame time and of every profiled stage are always printed, and so is how long input waited
+// in the Tiny::InputQueue between being pushed and latched.
+// If traceFile is given every profiled scope is also written there as Chrome trace event JSON. A traceFile of - skips it.
+// If wavFile is given a Tiny::AudioUnit plays a tune written into the audio registers every few frames and the
+// samples are written there through an EZ::AudioStream, so the Audio stage shows up in the report. Frames run as fast
+// as possible outrun any real sink so then every frame waits for its samples to reach the file.
+
+#include "TinyMachine.h"
+#include "TinyAudio.h"
+#include "TinyInput.h"
+#include "EZFrameScheduler.h"
+#include "EZProfiler.h"
+#include "EZError.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+constexpr UINT64 DefaultFrameCount = 100000;
+// Frames each note of the tune lasts.
+constexpr UINT64 FramesPerNote = 15;
+
+// Plays the next note of a looping arpeggio on the square channels with a drum on the noise channel every other note,
+// written through the machine like a game would write the registers.
+void PlayTune(Tiny::Machine* machine, UINT64 frame) {
+	const UINT16 notes[] = { 262, 330, 392, 523, 392, 330 };
+	if (frame % FramesPerNote != 0) {
+		return;
+	}
+	UINT64 note = frame / FramesPerNote;
+	for (UINT32 channel = 0; channel < Tiny::AudioChannelCount; channel++) {
+		UINT16 frequency = notes[note % 6];
+		if (channel == 1) {
+			frequency = notes[(note + 2) % 6] / 2;
+		}
+		else if (channel == 2) {
+			frequency = notes[note % 6] / 4;
+		}
+		else if (channel == 3) {
+			if ((note & 1) != 0) {
+				continue;
+			}
+			frequency = 8000;
+		}
+		UINT16 address = static_cast<UINT16>(Tiny::AudioChannelsAddress + (channel * Tiny::AudioChannelBytes));
+		machine->Write(address + Tiny::AudioRegister::Frequency, static_cast<BYTE>(frequency));
+		machine->Write(address + Tiny::AudioRegister::Frequency + 1, static_cast<BYTE>(frequency >> 8));
+		machine->Write(address + Tiny::AudioRegister::Volume, channel == 3 ? 160 : 96);
+		machine->Write(address + Tiny::AudioRegister::Envelope, static_cast<BYTE>(channel == 3 ? -16 : -4));
+		machine->Write(address + Tiny::AudioRegister::Control, Tiny::AudioControl::Trigger);
+	}
+}
+
+// Pushes the buttons which changed from held to a deterministic pseudo random input byte into queue before every
+// frame the way the window thread would, so the whole input path is exercised.
+void PushScriptedInput(Tiny::InputQueue* queue, UINT32* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	BYTE inputs = static_cast<BYTE>(*state);
+	BYTE held = queue->GetHeld();
+	if ((inputs & ~held) != 0) {
+		queue->Push(static_cast<BYTE>(inputs & ~held), TRUE);
+	}
+	if ((held & ~inputs) != 0) {
+		queue->Push(static_cast<BYTE>(held & ~inputs), FALSE);
+	}
+}
+BYTE LatchInput(Tiny::Machine* machine) {
+	return machine->GetUserDataAs<Tiny::InputQueue>()->Latch();
+}
+
+int main(int argc, char** argv) {
+	UINT64 frameCount = DefaultFrameCount;
+	if (argc > 1) {
+		frameCount = strtoull(argv[1], nullptr, 10);
+	}
+	if (frameCount == 0) {
+		EZ::Error("frames must be a positive integer.").PrintAndFree();
+		return 1;
+	}
+	UINT32 videoMode = 0;
+	if (argc > 2) {
+		videoMode = static_cast<UINT32>(strtoul(argv[2], nullptr, 10));
+	}
+	if (videoMode > Tiny::VideoModeMask) {
+		EZ::Error("videoMode must be between 0 and 3.").PrintAndFree();
+		return 1;
+	}
+	UINT32 framerate = 0;
+	if (argc > 3) {
+		framerate = static_cast<UINT32>(strtoul(argv[3], nullptr, 10));
+	}
+
+	UINT32 inputState = 0x12345678;
+	Tiny::InputQueue* inputQueue = new Tiny::InputQueue({ });
+	Tiny::MachineSettings machineSettings = { };
+	machineSettings.UserData = inputQueue;
+	machineSettings.InputCallback = LatchInput;
+
+	Tiny::Machine* machine = new Tiny::Machine(machineSettings);
+	BYTE* memory = machine->GetMemory();
+	memory[Tiny::SysFlagsAddress] = static_cast<BYTE>(videoMode);
+	// Fill video memory with a pattern so every video mode has something to draw.
+	for (UINT32 i = Tiny::VideoAddress; i < Tiny::MemorySize; i++) {
+		memory[i] = static_cast<BYTE>((i * 31) ^ (i >> 8));
+	}
+	machine->MarkDirty(0, Tiny::MemorySize);
+	BYTE* frameBuffer = new BYTE[Tiny::FrameBufferSize];
+	BOOL tracing = argc > 4 && std::string(argv[4]) != "-";
+
+	EZ::WavFileSink* wavSink = nullptr;
+	EZ::AudioStream* audioStream = nullptr;
+	Tiny::AudioUnit* audio = nullptr;
+	if (argc > 5) {
+		try {
+			wavSink = new EZ::WavFileSink(argv[5], Tiny::DefaultAudioSampleRate);
+		}
+		catch (EZ::Error& error) {
+			error.PrintAndFree();
+			return 1;
+		}
+		EZ::AudioStreamSettings streamSettings = { };
+		streamSettings.Sink = wavSink->GetSink();
+		audioStream = new EZ::AudioStream(streamSettings);
+		Tiny::AudioUnitSettings audioSettings = { };
+		audioSettings.Stream = audioStream;
+		audio = new Tiny::AudioUnit(machine->GetBus(), audioSettings);
+		// The wave channel plays a triangle.
+		for (UINT32 i = 0; i < Tiny::AudioWaveBytes; i++) {
+			INT32 level = i < 16 ? (i * 16) - 128 : 127 - ((i - 16) * 16);
+			machine->Write(static_cast<UINT16>(Tiny::AudioWaveAddress + i), static_cast<BYTE>(level));
+		}
+	}
+
+	EZ::FrameSchedulerSettings schedulerSettings = { };
+	schedulerSettings.MaximumFramerate = framerate;
+	schedulerSettings.StepRate = framerate;
+	EZ::FrameScheduler* scheduler = new EZ::FrameScheduler(schedulerSettings);
+	EZ::Profiler* profiler = new EZ::Profiler(0);
+	if (tracing) {
+		profiler->StartTrace();
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	UINT64 i = 0;
+	while (i < frameCount) {
+		UINT32 steps = scheduler->BeginFrame();
+		for (UINT32 step = 0; step < steps && i < frameCount; step++, i++) {
+			if (audio != nullptr) {
+				PlayTune(machine, i);
+			}
+			PushScriptedInput(inputQueue, &inputState);
+			machine->Step();
+			if (audio != nullptr) {
+				audio->Step();
+				if (framerate == 0) {
+					audioStream->Flush();
+				}
+			}
+			// Change one byte of video memory per frame like a game would so the partial redraw path is exercised.
+			UINT16 address = static_cast<UINT16>(Tiny::VideoAddress + ((i * 257) % (Tiny::MemorySize - Tiny::VideoAddress)));
+			machine->Write(address, static_cast<BYTE>(machine->Read(address) + 1));
+			machine->Render(frameBuffer, Tiny::ScreenWidth * 4);
+			profiler->Tick();
+		}
+		scheduler->EndFrame();
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	// Fold the last frame into a checksum so the work can't be optimized away and runs can be compared.
+	UINT32 checksum = 2166136261u;
+	for (UINT32 i = 0; i < Tiny::FrameBufferSize; i++) {
+		checksum = (checksum ^ frameBuffer[i]) * 16777619u;
+	}
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "Frames: " << frameCount << " Seconds: " << seconds << " FPS: " << (frameCount / seconds) << std::endl;
+	Tiny::RenderStats stats = machine->GetRenderStats();
+	std::cout << "Frames rendered: " << stats.FramesRendered << " Frames skipped: " << stats.FramesSkipped << std::endl;
+	std::cout << "Rows converted: " << stats.RowsConverted << " Rows skipped: " << stats.RowsSkipped << std::endl;
+	std::cout << "Checksum: " << std::hex << checksum << std::dec << std::endl;
+	if (framerate != 0) {
+		EZ::FrameStats frameStats = scheduler->GetStats();
+		std::cout << "Frame time mean: " << (frameStats.MeanFrameNanoseconds / 1000) << "us jitter: " << (frameStats.JitterNanoseconds / 1000) << "us";
+		std::cout << " min: " << (frameStats.MinFrameNanoseconds / 1000) << "us max: " << (frameStats.MaxFrameNanoseconds / 1000) << "us";
+		std::cout << " max wake lateness: " << (frameStats.MaxWakeLatenessNanoseconds / 1000) << "us" << std::endl;
+		std::cout << "Steps dropped: " << frameStats.StepsDropped << std::endl;
+	}
+	profiler->PrintReport();
+	Tiny::InputStats inputStats = inputQueue->GetStats();
+	std::cout << "Input events: " << inputStats.EventsLatched << " latency mean: " << (inputStats.EventsLatched == 0 ? 0 : inputStats.TotalLatencyNanoseconds / inputStats.EventsLatched);
+	std::cout << "ns max: " << inputStats.MaxLatencyNanoseconds << "ns" << std::endl;
+	if (audio != nullptr) {
+		EZ::AudioStreamStats audioStats = audioStream->GetStats();
+		std::cout << "Audio samples written: " << audioStats.SamplesWritten << " dropped: " << audioStats.SamplesDropped << std::endl;
+	}
+	if (tracing) {
+		profiler->StopTrace();
+		if (!profiler->WriteChromeTrace(argv[4])) {
+			EZ::Error("Failed to write the trace file.").PrintAndFree();
+		}
+	}
+
+	// The stream hands the sink everything left in its ring before the WAV header is finished.
+	delete audio;
+	delete audioStream;
+	delete wavSink;
+	delete profiler;
+	delete scheduler;
+	delete[] frameBuffer;
+	delete machine;
+	delete inputQueue;
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "TinySaveState.h"
+#include "EZCompression.h"
+#include "EZMappedFile.h"
+#include "EZError.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+// Save state files start with this header. Every field is little endian.
+// Offset Size
+//  0      8   Magic "TinySave"
+//  8      4   SaveStateVersion
+// 12      4   Header size in bytes. The compressed memory starts here.
+// 16      8   Frame count
+// 24      2   PC
+// 26      1   A
+// 27      1   X
+// 28      1   Y
+// 29      1   SP
+// 30      1   Flags. Bit 0 is Zero, bit 1 is Carry and bit 2 is set while the CPU is running.
+// 31      1   Reserved, always 0
+// 32      4   CPU cycle debt
+// 36      4   Uncompressed memory size, always MemorySize
+// 40      4   Compressed memory size
+// 44      4   FNV-1a hash of the uncompressed memory
+constexpr BYTE SaveStateMagic[8] = { 'T', 'i', 'n', 'y', 'S', 'a', 'v', 'e' };
+constexpr UINT32 SaveStateHeaderSize = 48;
+
+namespace {
+	UINT64 NextCaptureId() {
+		static std::atomic<UINT64> nextCaptureId(1);
+		return nextCaptureId.fetch_add(1);
+	}
+	UINT32 HashMemory(const BYTE* memory, UINT32 size) {
+		UINT32 hash = 2166136261u;
+		for (UINT32 i = 0; i < size; i++) {
+			hash = (hash ^ memory[i]) * 16777619u;
+		}
+		return hash;
+	}
+	void WriteLittleEndian(BYTE* destination, UINT64 value, UINT32 size) {
+		for (UINT32 i = 0; i < size; i++) {
+			destination[i] = static_cast<BYTE>(value >> (i * 8));
+		}
+	}
+	UINT64 ReadLittleEndian(const BYTE* source, UINT32 size) {
+		UINT64 value = 0;
+		for (UINT32 i = 0; i < size; i++) {
+			value |= static_cast<UINT64>(source[i]) << (i * 8);
+		}
+		return value;
+	}
+}
+
+Tiny::SaveState::SaveState() {
+	_machineState = { };
+	_captureId = 0;
+	_copiedPageCount = 0;
+}
+void Tiny::SaveState::Capture(Tiny::Machine* machine, const Tiny::SaveState* previous) {
+	BOOL incremental = previous != nullptr && previous->_captureId != 0 && previous->_captureId == machine->GetCaptureId();
+	const BYTE* memory = machine->GetMemory();
+	_copiedPageCount = 0;
+	for (UINT32 page = 0; page < PageCount; page++) {
+		if (incremental && !machine->IsPageChangedSinceCapture(page)) {
+			if (previous != this) {
+				_pages[page] = previous->_pages[page];
+			}
+			continue;
+		}
+		std::shared_ptr<Tiny::SavedPage> copy = std::make_shared<Tiny::SavedPage>();
+		memcpy(copy->Bytes, memory + (page * PageSize), PageSize);
+		_pages[page] = copy;
+		_copiedPageCount++;
+	}
+	_machineState = machine->GetState();
+	_captureId = NextCaptureId();
+	machine->SetCaptureId(_captureId);
+}
+void Tiny::SaveState::Copy(const Tiny::Machine* machine) {
+	const BYTE* memory = machine->GetMemory();
+	for (UINT32 page = 0; page < PageCount; page++) {
+		std::shared_ptr<Tiny::SavedPage> copy = std::make_shared<Tiny::SavedPage>();
+		memcpy(copy->Bytes, memory + (page * PageSize), PageSize);
+		_pages[page] = copy;
+	}
+	_copiedPageCount = PageCount;
+	_machineState = machine->GetState();
+	_captureId = NextCaptureId();
+}
+void Tiny::SaveState::Restore(Tiny::Machine* machine) const {
+	if (_captureId == 0) {
+		throw EZ::Error("Nothing was captured or loaded into this save state.");
+	}
+	for (UINT32 page = 0; page < PageCount; page++) {
+		machine->WriteRange(static_cast<UINT16>(page * PageSize), _pages[page]->Bytes, PageSize);
+	}
+	machine->SetState(_machineState);
+	machine->SetCaptureId(_captureId);
+}
+std::vector<BYTE> Tiny::SaveState::Serialize() const {
+	if (_captureId == 0) {
+		throw EZ::Error("Nothing was captured or loaded into this save state.");
+	}
+	std::vector<BYTE> memory(MemorySize);
+	for (UINT32 page = 0; page < PageCount; page++) {
+		memcpy(memory.data() + (page * PageSize), _pages[page]->Bytes, PageSize);
+	}
+
+	std::vector<BYTE> data(SaveStateHeaderSize + EZ::GetCompressBound(MemorySize));
+	UINT32 compressedSize = EZ::Compress(memory.data(), MemorySize, data.data() + SaveStateHeaderSize);
+	data.resize(SaveStateHeaderSize + compressedSize);
+
+	const Tiny::CpuState& cpu = _machineState.Cpu;
+	BYTE flags = (cpu.Registers.Zero ? 1 : 0) | (cpu.Registers.Carry ? 2 : 0) | (cpu.Running ? 4 : 0);
+	BYTE* header = data.data();
+	memcpy(header, SaveStateMagic, sizeof(SaveStateMagic));
+	WriteLittleEndian(header + 8, SaveStateVersion, 4);
+	WriteLittleEndian(header + 12, SaveStateHeaderSize, 4);
+	WriteLittleEndian(header + 16, _machineState.FrameCount, 8);
+	WriteLittleEndian(header + 24, cpu.Registers.PC, 2);
+	header[26] = cpu.Registers.A;
+	header[27] = cpu.Registers.X;
+	header[28] = cpu.Registers.Y;
+	header[29] = cpu.Registers.SP;
+	header[30] = flags;
+	header[31] = 0;
+	WriteLittleEndian(header + 32, cpu.CycleDebt, 4);
+	WriteLittleEndian(header + 36, MemorySize, 4);
+	WriteLittleEndian(header + 40, compressedSize, 4);
+	WriteLittleEndian(header + 44, HashMemory(memory.data(), MemorySize), 4);
+	return data;
+}
+void Tiny::SaveState::Deserialize(const BYTE* data, UINT64 size) {
+	if (size < SaveStateHeaderSize || memcmp(data, SaveStateMagic, sizeof(SaveStateMagic)) != 0) {
+		throw EZ::Error("The data is not a Tiny save state.");
+	}
+	if (ReadLittleEndian(data + 8, 4) != SaveStateVersion) {
+		throw EZ::Error("The save state is from a different version of Tiny.");
+	}
+	UINT64 headerSize = ReadLittleEndian(data + 12, 4);
+	UINT64 compressedSize = ReadLittleEndian(data + 40, 4);
+	if (headerSize < SaveStateHeaderSize || headerSize > size || compressedSize > size - headerSize || ReadLittleEndian(data + 36, 4) != MemorySize) {
+		throw EZ::Error("The save state is corrupt.");
+	}
+	std::vector<BYTE> memory(MemorySize);
+	if (!EZ::Decompress(data + headerSize, static_cast<UINT32>(compressedSize), memory.data(), MemorySize)
+		|| HashMemory(memory.data(), MemorySize) != ReadLittleEndian(data + 44, 4)) {
+		throw EZ::Error("The save state is corrupt.");
+	}
+	BYTE flags = data[30];
+	BYTE sp = data[29];
+	if (sp < StackBottomAddress) {
+		throw EZ::Error("The save state is corrupt.");
+	}
+
+	for (UINT32 page = 0; page < PageCount; page++) {
+		std::shared_ptr<Tiny::SavedPage> copy = std::make_shared<Tiny::SavedPage>();
+		memcpy(copy->Bytes, memory.data() + (page * PageSize), PageSize);
+		_pages[page] = copy;
+	}
+	_machineState = { };
+	_machineState.FrameCount = ReadLittleEndian(data + 16, 8);
+	_machineState.Cpu.Registers.PC = static_cast<UINT16>(ReadLittleEndian(data + 24, 2));
+	_machineState.Cpu.Registers.A = data[26];
+	_machineState.Cpu.Registers.X = data[27];
+	_machineState.Cpu.Registers.Y = data[28];
+	_machineState.Cpu.Registers.SP = sp;
+	_machineState.Cpu.Registers.Zero = (flags & 1) ? TRUE : FALSE;
+	_machineState.Cpu.Registers.Carry = (flags & 2) ? TRUE : FALSE;
+	_machineState.Cpu.Running = (flags & 4) ? TRUE : FALSE;
+	_machineState.Cpu.CycleDebt = static_cast<UINT32>(ReadLittleEndian(data + 32, 4));
+	// The loaded memory is new to every machine so the first capture after restoring it copies everything.
+	_captureId = NextCaptureId();
+	_copiedPageCount = PageCount;
+}
+void Tiny::SaveState::Save(LPCSTR filePath) const {
+	std::vector<BYTE> data = Serialize();
+	std::ofstream file(filePath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	file.close();
+	if (file.fail()) {
+		throw EZ::Error("Failed to write the save state file.");
+	}
+}
+void Tiny::SaveState::Load(LPCSTR filePath) {
+	EZ::MappedFile file(filePath);
+	if (file.GetData() == nullptr) {
+		throw EZ::Error("The data is not a Tiny save state.");
+	}
+	Deserialize(file.GetData(), file.GetSize());
+}
+Tiny::SaveState::~SaveState() {
+	_captureId = 0;
+}
+
+const BYTE* Tiny::SaveState::GetPage(UINT32 page) const {
+	return _pages[page] == nullptr ? nullptr : _pages[page]->Bytes;
+}
+Tiny::MachineState Tiny::SaveState::GetMachineState() const {
+	return _machineState;
+}
+UINT32 Tiny::SaveState::GetCopiedPageCount() const {
+	return _copiedPageCount;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMachine.h"
+#include <memory>
+#include <vector>
+
+namespace Tiny {
+	// Written into every save state file. Bump it whenever the layout or meaning of anything saved changes
+	// so old files are refused instead of being restored wrong.
+	constexpr UINT32 SaveStateVersion = 1;
+	// One page of memory as it was captured. Captured pages never change so save states can share them.
+	struct SavedPage {
+		BYTE Bytes[PageSize];
+	};
+	// A snapshot of a whole Tiny::Machine: all of memory including the Inputs and SysFlags registers and video memory,
+	// the frame count and the CPU registers.
+	// Memory is kept as pages which are shared between save states, so capturing only copies the pages written since
+	// the previous capture. A frame usually writes a handful of pages which makes capturing every frame cost microseconds.
+	class SaveState {
+	public:
+		SaveState();
+		// Captures machine. If previous was the last state captured from or restored to machine then only pages written
+		// since then are copied and the rest are shared with previous. Else every page is copied.
+		// previous may be this state, which keeps one rolling snapshot up to date for the cost of the pages that changed.
+		void Capture(Tiny::Machine* machine, const Tiny::SaveState* previous = nullptr);
+		// Captures machine by copying every page without becoming the last state captured from it, so a rolling
+		// snapshot someone else keeps with Capture stays incremental.
+		void Copy(const Tiny::Machine* machine);
+		// Puts machine back the way it was when this state was captured. Only pages which differ are written so the
+		// next Render only redraws what really changed and the CPU keeps the instructions it decoded everywhere else.
+		// Throws an EZ::Error if nothing was captured or loaded into this state.
+		void Restore(Tiny::Machine* machine) const;
+		// Returns the state in the save state file format: a small versioned header followed by compressed memory.
+		std::vector<BYTE> Serialize() const;
+		// Replaces this state with one in the save state file format.
+		// Throws an EZ::Error and leaves this state alone if data is from a different SaveStateVersion or is corrupt.
+		void Deserialize(const BYTE* data, UINT64 size);
+		// Writes Serialize() to filePath. Throws an EZ::Error if the file can't be written.
+		void Save(LPCSTR filePath) const;
+		// Deserializes filePath by mapping it into memory instead of reading it through a buffer.
+		void Load(LPCSTR filePath);
+		~SaveState();
+
+		// Returns nullptr if nothing was captured or loaded.
+		const BYTE* GetPage(UINT32 page) const;
+		Tiny::MachineState GetMachineState() const;
+		// Number of pages the last Capture had to copy rather than share.
+		UINT32 GetCopiedPageCount() const;
+
+	private:
+		std::shared_ptr<const Tiny::SavedPage> _pages[PageCount];
+		Tiny::MachineState _machineState;
+		// Names the memory these pages hold. See Tiny::Machine::SetCaptureId.
+		UINT64 _captureId;
+		UINT32 _copiedPageCount;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "TinySpriteRenderer.h"
+#include "EZProfiler.h"
+#include <cstring>
+
+Tiny::SpriteRenderer::SpriteRenderer() {
+	memset(_sprites, 0, sizeof(_sprites));
+	memset(_spriteShadow, 0, sizeof(_spriteShadow));
+	_spritesValid = FALSE;
+	_spritesRebuiltCount = 0;
+
+	memset(_instanceX, 0, sizeof(_instanceX));
+	memset(_instanceY, 0, sizeof(_instanceY));
+	memset(_instanceSprite, 0, sizeof(_instanceSprite));
+	memset(_binSizes, 0, sizeof(_binSizes));
+
+	_backgroundColor = 0;
+	_frameBuffer = nullptr;
+	_stride = 0;
+}
+void Tiny::SpriteRenderer::Render(const BYTE* memory, BYTE* frameBuffer, UINT32 stride, EZ::ThreadPool* threadPool) {
+	UpdateSprites(memory + SpriteTableAddress);
+	BinInstances(memory);
+
+	const BYTE* background = memory + BackgroundColorAddress;
+	BYTE bgra[4] = { background[2], background[1], background[0], 0xFF };
+	memcpy(&_backgroundColor, bgra, 4);
+	_frameBuffer = frameBuffer;
+	_stride = stride;
+
+	if (threadPool != nullptr) {
+		threadPool->ParallelFor(SpriteBandCount, DrawBandTask, this);
+	}
+	else {
+		for (UINT32 bandIndex = 0; bandIndex < SpriteBandCount; bandIndex++) {
+			DrawBand(bandIndex);
+		}
+	}
+
+	_frameBuffer = nullptr;
+}
+void Tiny::SpriteRenderer::DrawBandTask(void* context, UINT32 bandIndex) {
+	reinterpret_cast<Tiny::SpriteRenderer*>(context)->DrawBand(bandIndex);
+}
+void Tiny::SpriteRenderer::DrawBand(UINT32 bandIndex) {
+	EZ::ProfileScope scope("SpriteBand");
+	UINT32 bandTop = bandIndex * SpriteBandHeight;
+	UINT32 bandBottom = bandTop + SpriteBandHeight;
+	if (bandBottom > ScreenHeight) {
+		bandBottom = ScreenHeight;
+	}
+
+	for (UINT32 y = bandTop; y < bandBottom; y++) {
+		BYTE* row = _frameBuffer + (y * _stride);
+		for (UINT32 x = 0; x < ScreenWidth; x++) {
+			memcpy(row + (x * 4), &_backgroundColor, 4);
+		}
+	}
+
+	const UINT16* bin = _bins[bandIndex];
+	UINT32 binSize = _binSizes[bandIndex];
+	for (UINT32 i = 0; i < binSize; i++) {
+		UINT32 instance = bin[i];
+		UINT32 instanceX = _instanceX[instance];
+		UINT32 instanceY = _instanceY[instance];
+		const UINT32* sprite = _sprites[_instanceSprite[instance]];
+
+		// Clip to the band vertically and to the right edge of the screen horizontally.
+		UINT32 top = instanceY > bandTop ? instanceY : bandTop;
+		UINT32 bottom = instanceY + SpriteSize < bandBottom ? instanceY + SpriteSize : bandBottom;
+		UINT32 width = ScreenWidth - instanceX < SpriteSize ? ScreenWidth - instanceX : SpriteSize;
+		for (UINT32 y = top; y < bottom; y++) {
+			BYTE* destination = _frameBuffer + (y * _stride) + (instanceX * 4);
+			memcpy(destination, sprite + ((y - instanceY) * SpriteSize), width * 4);
+		}
+	}
+}
+void Tiny::SpriteRenderer::UpdateSprites(const BYTE* spriteTable) {
+	for (UINT32 spriteIndex = 0; spriteIndex < SpriteCount; spriteIndex++) {
+		const BYTE* source = spriteTable + (spriteIndex * SpriteBytes);
+		BYTE* shadow = _spriteShadow + (spriteIndex * SpriteBytes);
+		if (_spritesValid && memcmp(source, shadow, SpriteBytes) == 0) {
+			continue;
+		}
+		memcpy(shadow, source, SpriteBytes);
+		for (UINT32 pixel = 0; pixel < SpriteSize * SpriteSize; pixel++) {
+			BYTE bgra[4] = { source[2], source[1], source[0], 0xFF };
+			memcpy(&_sprites[spriteIndex][pixel], bgra, 4);
+			source += 3;
+		}
+		_spritesRebuiltCount++;
+	}
+	_spritesValid = TRUE;
+}
+void Tiny::SpriteRenderer::BinInstances(const BYTE* memory) {
+	const BYTE* positions = memory + InstancePositionAddress;
+	const BYTE* sprites = memory + InstanceSpriteAddress;
+	memset(_binSizes, 0, sizeof(_binSizes));
+
+	// Walking instances in order and appending keeps every bin sorted so overdraw order is the same in every band.
+	for (UINT32 instance = 0; instance < InstanceCount; instance += 4) {
+		const BYTE* packed = sprites + ((instance / 4) * 3);
+		UINT32 spriteIndices = packed[0] | (packed[1] << 8) | (packed[2] << 16);
+		for (UINT32 i = 0; i < 4; i++) {
+			UINT32 current = instance + i;
+			UINT32 instanceY = positions[(current * 2) + 1];
+			if (instanceY >= ScreenHeight) {
+				continue;
+			}
+			_instanceX[current] = positions[current * 2];
+			_instanceY[current] = static_cast<BYTE>(instanceY);
+			_instanceSprite[current] = static_cast<BYTE>((spriteIndices >> (i * 6)) & 0x3F);
+
+			// A 4 row sprite touches at most two bands.
+			UINT32 firstBand = instanceY / SpriteBandHeight;
+			UINT32 lastBand = (instanceY + SpriteSize - 1) / SpriteBandHeight;
+			if (lastBand >= SpriteBandCount) {
+				lastBand = SpriteBandCount - 1;
+			}
+			for (UINT32 band = firstBand; band <= lastBand; band++) {
+				_bins[band][_binSizes[band]++] = static_cast<UINT16>(current);
+			}
+		}
+	}
+}
+Tiny::SpriteRenderer::~SpriteRenderer() {
+	_spritesValid = FALSE;
+}
+
+UINT64 Tiny::SpriteRenderer::GetSpritesRebuiltCount() const {
+	return _spritesRebuiltCount;
+}
\ No newline at end of file
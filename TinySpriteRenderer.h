@@ -0,0 +1,51 @@
+#pragma once
+#include "EZPlatform.h"
+#include "EZThreadPool.h"
+#include "TinyVideo.h"
+
+namespace Tiny {
+	// Height in rows of the horizontal bands the screen is split into for VideoMode::ShaderGraph.
+	constexpr UINT32 SpriteBandHeight = 16;
+	constexpr UINT32 SpriteBandCount = (ScreenHeight + SpriteBandHeight - 1) / SpriteBandHeight;
+	// Rasterizes VideoMode::ShaderGraph.
+	// Instances are first sorted into bins, one per band of SpriteBandHeight rows, keeping instance order inside each bin.
+	// Each band is then cleared to the background color and its bin drawn on top, clipped to the band.
+	// Bands never share rows so they can be drawn on different threads and still give the same result as one thread.
+	class SpriteRenderer {
+	public:
+		SpriteRenderer();
+		// memory is the full 64 KB of guest memory. frameBuffer and stride work like Tiny::Machine::Render.
+		// If threadPool != nullptr the bands are split across its threads. Else they are all drawn on the calling thread.
+		// Every row is always redrawn.
+		void Render(const BYTE* memory, BYTE* frameBuffer, UINT32 stride, EZ::ThreadPool* threadPool);
+		~SpriteRenderer();
+
+		// Total number of sprites re-expanded because their pixels changed.
+		UINT64 GetSpritesRebuiltCount() const;
+
+	private:
+		static void DrawBandTask(void* context, UINT32 bandIndex);
+		void DrawBand(UINT32 bandIndex);
+		// Re-expands every sprite whose bytes differ from _spriteShadow.
+		void UpdateSprites(const BYTE* spriteTable);
+		// Decodes every on screen instance and adds it to the bin of each band it touches.
+		void BinInstances(const BYTE* memory);
+
+		UINT32 _sprites[SpriteCount][SpriteSize * SpriteSize];
+		BYTE _spriteShadow[SpriteTableBytes];
+		BOOL _spritesValid;
+		UINT64 _spritesRebuiltCount;
+
+		// Decoded instances. Only the ones listed in a bin are valid for the current frame.
+		BYTE _instanceX[InstanceCount];
+		BYTE _instanceY[InstanceCount];
+		BYTE _instanceSprite[InstanceCount];
+		UINT16 _bins[SpriteBandCount][InstanceCount];
+		UINT32 _binSizes[SpriteBandCount];
+
+		// Only valid during Render so DrawBand can reach them from the worker threads.
+		UINT32 _backgroundColor;
+		BYTE* _frameBuffer;
+		UINT32 _stride;
+	};
+}
\ No newline at end of file
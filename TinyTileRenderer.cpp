@@ -0,0 +1,105 @@
+#include "TinyTileRenderer.h"
+#include <cstring>
+
+Tiny::TileRenderer::TileRenderer() {
+	memset(_tiles, 0, sizeof(_tiles));
+	memset(_tableShadow, 0, sizeof(_tableShadow));
+	memset(_gridShadow, 0, sizeof(_gridShadow));
+	memset(_tileDirty, 0, sizeof(_tileDirty));
+	_valid = FALSE;
+	_lastFrameBuffer = nullptr;
+	_lastStride = 0;
+
+	_tilesRebuiltCount = 0;
+	_blocksDrawnCount = 0;
+}
+Tiny::DirtyRows Tiny::TileRenderer::Render(const BYTE* memory, BYTE* frameBuffer, UINT32 stride) {
+	if (frameBuffer != _lastFrameBuffer || stride != _lastStride) {
+		Invalidate();
+	}
+	const BYTE* grid = memory + TileGridAddress;
+	const BYTE* tileTable = memory + TileTableAddress;
+
+	if (!_valid) {
+		// Make every tile look changed so the whole cache is rebuilt and every block is drawn.
+		memcpy(_tableShadow, tileTable, TileTableBytes);
+		for (UINT32 i = 0; i < TileTableBytes; i++) {
+			_tableShadow[i] = ~_tableShadow[i];
+		}
+	}
+	BOOL anyTileDirty = UpdateTiles(tileTable);
+	Tiny::DirtyRows rows = NoDirtyRows;
+
+	for (UINT32 gridY = 0; gridY < TileGridHeight; gridY++) {
+		const BYTE* gridRow = grid + (gridY * TileGridWidth);
+		BYTE* shadowRow = _gridShadow + (gridY * TileGridWidth);
+		// Most rows don't change at all so check the whole row with one compare before looking at cells.
+		if (_valid && !anyTileDirty && memcmp(gridRow, shadowRow, TileGridWidth) == 0) {
+			continue;
+		}
+		for (UINT32 gridX = 0; gridX < TileGridWidth; gridX++) {
+			BYTE tileIndex = gridRow[gridX];
+			if (_valid && tileIndex == shadowRow[gridX] && !_tileDirty[tileIndex]) {
+				continue;
+			}
+			DrawBlock(frameBuffer, stride, gridX, gridY, tileIndex);
+			shadowRow[gridX] = tileIndex;
+			if (rows.Top == rows.Bottom) {
+				rows.Top = gridY * TileSize;
+			}
+			rows.Bottom = (gridY + 1) * TileSize;
+		}
+	}
+
+	if (anyTileDirty) {
+		memset(_tileDirty, 0, sizeof(_tileDirty));
+	}
+	_valid = TRUE;
+	_lastFrameBuffer = frameBuffer;
+	_lastStride = stride;
+	return rows;
+}
+void Tiny::TileRenderer::Invalidate() {
+	_valid = FALSE;
+}
+BOOL Tiny::TileRenderer::UpdateTiles(const BYTE* tileTable) {
+	BOOL anyTileDirty = FALSE;
+	for (UINT32 tileIndex = 0; tileIndex < TileCount; tileIndex++) {
+		const BYTE* source = tileTable + (tileIndex * TileBytes);
+		BYTE* shadow = _tableShadow + (tileIndex * TileBytes);
+		if (memcmp(source, shadow, TileBytes) == 0) {
+			continue;
+		}
+		memcpy(shadow, source, TileBytes);
+		// Convert from R8G8B8 to B8G8R8A8 once here instead of every time the tile is drawn.
+		for (UINT32 pixel = 0; pixel < TileSize * TileSize; pixel++) {
+			BYTE bgra[4] = { source[2], source[1], source[0], 0xFF };
+			memcpy(&_tiles[tileIndex][pixel], bgra, 4);
+			source += 3;
+		}
+		_tileDirty[tileIndex] = TRUE;
+		anyTileDirty = TRUE;
+		_tilesRebuiltCount++;
+	}
+	return anyTileDirty;
+}
+void Tiny::TileRenderer::DrawBlock(BYTE* frameBuffer, UINT32 stride, UINT32 gridX, UINT32 gridY, BYTE tileIndex) {
+	BYTE* destination = frameBuffer + (gridY * TileSize * stride) + (gridX * TileSize * 4);
+	const UINT32* tile = _tiles[tileIndex];
+	for (UINT32 row = 0; row < TileSize; row++) {
+		memcpy(destination, tile + (row * TileSize), TileSize * 4);
+		destination += stride;
+	}
+	_blocksDrawnCount++;
+}
+Tiny::TileRenderer::~TileRenderer() {
+	_valid = FALSE;
+	_lastFrameBuffer = nullptr;
+}
+
+UINT64 Tiny::TileRenderer::GetTilesRebuiltCount() const {
+	return _tilesRebuiltCount;
+}
+UINT64 Tiny::TileRenderer::GetBlocksDrawnCount() const {
+	return _blocksDrawnCount;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyVideo.h"
+
+namespace Tiny {
+	// Rasterizes VideoMode::Tiles incrementally.
+	// Every tile is kept pre-expanded to B8G8R8A8. Each Render compares the grid and tile table against what was drawn
+	// last time and only redraws the 4x4 blocks whose tile index changed or whose tile's pixels changed.
+	// This relies on frameBuffer still holding the last frame. Passing a different frameBuffer or stride than last time
+	// or calling Invalidate() makes the next Render redraw every block.
+	class TileRenderer {
+	public:
+		TileRenderer();
+		// memory is the full 64 KB of guest memory. frameBuffer and stride work like Tiny::Machine::Render.
+		// Returns the rows covering every block which was redrawn.
+		Tiny::DirtyRows Render(const BYTE* memory, BYTE* frameBuffer, UINT32 stride);
+		// Forgets what was drawn so the next Render redraws the whole screen.
+		void Invalidate();
+		~TileRenderer();
+
+		// Total number of tiles re-expanded because their pixels changed.
+		UINT64 GetTilesRebuiltCount() const;
+		// Total number of 4x4 blocks written to a frame buffer.
+		UINT64 GetBlocksDrawnCount() const;
+
+	private:
+		// Re-expands every tile whose bytes differ from _tableShadow and marks it in _tileDirty.
+		// Returns TRUE if any tile changed.
+		BOOL UpdateTiles(const BYTE* tileTable);
+		void DrawBlock(BYTE* frameBuffer, UINT32 stride, UINT32 gridX, UINT32 gridY, BYTE tileIndex);
+
+		UINT32 _tiles[TileCount][TileSize * TileSize];
+		BYTE _tableShadow[TileTableBytes];
+		BYTE _gridShadow[TileGridBytes];
+		BOOL _tileDirty[TileCount];
+		BOOL _valid;
+		BYTE* _lastFrameBuffer;
+		UINT32 _lastStride;
+
+		UINT64 _tilesRebuiltCount;
+		UINT64 _blocksDrawnCount;
+	};
+}
\ No newline at end of file
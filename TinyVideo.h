@@ -0,0 +1,79 @@
+#pragma once
+#include "EZPlatform.h"
+
+namespace Tiny {
+	constexpr UINT32 ScreenWidth = 256;
+	constexpr UINT32 ScreenHeight = 144;
+	// Size in bytes of one B8G8R8A8 frame with no padding between rows.
+	constexpr UINT32 FrameBufferSize = ScreenWidth * ScreenHeight * 4;
+
+	// The low 2 bits of the SysFlags register select the video mode. See the MemSpec in TinyEmulator.txt.
+	enum class VideoMode : BYTE {
+		// One 8 bit gray value per pixel.
+		Grayscale = 0,
+		// 6 bit pixels indexing a 64 color R8G8B8 pallet.
+		BitmapWithPallet = 1,
+		// A 64x36 grid of indices into a table of 256 4x4 R8G8B8 tiles.
+		Tiles = 2,
+		// A background color and 1024 instances of 64 4x4 R8G8B8 sprites.
+		ShaderGraph = 3,
+	};
+	constexpr BYTE VideoModeMask = 0x03;
+	// Video memory starts right after the register page for every video mode.
+	constexpr UINT16 VideoAddress = 0x0100;
+
+	// A range of frame buffer rows from Top up to but not including Bottom.
+	// Top == Bottom means no rows.
+	struct DirtyRows {
+		UINT32 Top;
+		UINT32 Bottom;
+	};
+	constexpr Tiny::DirtyRows NoDirtyRows = { 0, 0 };
+	constexpr Tiny::DirtyRows AllDirtyRows = { 0, ScreenHeight };
+
+	// VideoMode::Grayscale
+	constexpr UINT32 GrayscaleBytes = ScreenWidth * ScreenHeight;
+
+	// VideoMode::BitmapWithPallet
+	// Every 3 bytes hold 4 pixels. Reading the 3 bytes as a little endian 24 bit number
+	// the first pixel is bits 0 to 5, the second bits 6 to 11 and so on.
+	constexpr UINT32 PalletColorCount = 64;
+	constexpr UINT32 PalletPixelBytes = (ScreenWidth * ScreenHeight * 6) / 8;
+	constexpr UINT32 PalletRowBytes = (ScreenWidth * 6) / 8;
+	constexpr UINT32 PalletBytes = PalletColorCount * 3;
+	constexpr UINT16 PalletPixelAddress = VideoAddress;
+	constexpr UINT16 PalletAddress = PalletPixelAddress + PalletPixelBytes;
+	constexpr UINT32 PalletModeBytes = PalletPixelBytes + PalletBytes;
+
+	// VideoMode::Tiles
+	// The grid holds one tile index per 4x4 block of the screen, row by row.
+	// Each tile is 16 R8G8B8 pixels, row by row.
+	constexpr UINT32 TileSize = 4;
+	constexpr UINT32 TileCount = 256;
+	constexpr UINT32 TileBytes = TileSize * TileSize * 3;
+	constexpr UINT32 TileGridWidth = ScreenWidth / TileSize;
+	constexpr UINT32 TileGridHeight = ScreenHeight / TileSize;
+	constexpr UINT32 TileGridBytes = TileGridWidth * TileGridHeight;
+	constexpr UINT32 TileTableBytes = TileCount * TileBytes;
+	constexpr UINT16 TileGridAddress = VideoAddress;
+	constexpr UINT16 TileTableAddress = TileGridAddress + TileGridBytes;
+	constexpr UINT32 TileModeBytes = TileGridBytes + TileTableBytes;
+
+	// VideoMode::ShaderGraph
+	// Every instance has an X and a Y byte giving the top left pixel of its sprite and a 6 bit sprite index.
+	// The X and Y bytes are stored as pairs for all instances followed by all the sprite indices packed
+	// like BitmapWithPallet pixels. Sprites are 16 R8G8B8 pixels stored row by row.
+	// Instances are opaque and are drawn in order so higher instances cover lower ones.
+	constexpr UINT32 SpriteSize = 4;
+	constexpr UINT32 SpriteCount = 64;
+	constexpr UINT32 SpriteBytes = SpriteSize * SpriteSize * 3;
+	constexpr UINT32 InstanceCount = 1024;
+	constexpr UINT32 InstancePositionBytes = InstanceCount * 2;
+	constexpr UINT32 InstanceSpriteBytes = (InstanceCount * 6) / 8;
+	constexpr UINT32 SpriteTableBytes = SpriteCount * SpriteBytes;
+	constexpr UINT16 BackgroundColorAddress = VideoAddress;
+	constexpr UINT16 InstancePositionAddress = BackgroundColorAddress + 3;
+	constexpr UINT16 InstanceSpriteAddress = InstancePositionAddress + InstancePositionBytes;
+	constexpr UINT16 SpriteTableAddress = InstanceSpriteAddress + InstanceSpriteBytes;
+	constexpr UINT32 ShaderGraphModeBytes = 3 + InstancePositionBytes + InstanceSpriteBytes + SpriteTableBytes;
+}
\ No newline at end of file
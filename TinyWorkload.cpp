@@ -0,0 +1,30 @@
+#include "TinyWorkload.h"
+
+const BYTE WorkloadProgram[] = {
+	0x04, 0x00, 0x00, // 0x9000 LDA 0x0000
+	0x13, 0x00, 0x80, // 0x9003 ADD 0x8000
+	0x0A, 0x00, 0x80, // 0x9006 STA 0x8000
+	0x16, 0x3F, // 0x9009 AND #0x3F
+	0x12, 0x01, // 0x900B ADD #1
+	0x0A, 0x18, 0x90, // 0x900D STA 0x9018
+	0x06, 0x00, // 0x9010 LDX #0
+	0x0F, // 0x9012 TXA
+	0x13, 0x00, 0x80, // 0x9013 ADD 0x8000
+	0x0B, 0x00, 0x01, // 0x9016 STA 0x0100,X
+	0x1F, // 0x9019 INX
+	0x27, 0x12, 0x90, // 0x901A JNZ 0x9012
+	0x02, // 0x901D WAIT
+	0x25, 0x00, 0x90, // 0x901E JMP 0x9000
+};
+
+void Tiny::LoadWorkload(Tiny::Machine* machine) {
+	BYTE* memory = machine->GetMemory();
+	for (UINT32 i = Tiny::VideoAddress; i < Tiny::MemorySize; i++) {
+		memory[i] = static_cast<BYTE>((i * 31) ^ (i >> 8));
+	}
+	machine->MarkDirty(0, Tiny::MemorySize);
+	machine->WriteRange(WorkloadProgramAddress, WorkloadProgram, sizeof(WorkloadProgram));
+	machine->Write(Tiny::ResetVectorAddress, static_cast<BYTE>(WorkloadProgramAddress));
+	machine->Write(Tiny::ResetVectorAddress + 1, static_cast<BYTE>(WorkloadProgramAddress >> 8));
+	machine->Reset();
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+#include "EZPlatform.h"
+#include "TinyMachine.h"
+
+namespace Tiny {
+	// Where LoadWorkload puts WorkloadProgram.
+	constexpr UINT16 WorkloadProgramAddress = 0x9000;
+	// Fills video memory with a pattern, loads the workload program and resets machine so it starts running it.
+	// Every frame the program adds the Inputs register to a counter, then fills one page of video memory picked
+	// by the counter and WAITs. It patches its own store instruction every frame so the self modifying code path
+	// is exercised too. The headless tools run it as a small but complete game-like load.
+	void LoadWorkload(Tiny::Machine* machine);
+}
\ No newline at end of file